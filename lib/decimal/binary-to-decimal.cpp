@@ -7,7 +7,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "big-radix-floating-point.h"
+#include "shortest-digits.h"
 #include "flang/decimal/decimal.h"
+#include <cstring>
 
 namespace Fortran::decimal {
 
@@ -331,6 +333,32 @@ ConversionToDecimalResult ConvertToDecimal(char *buffer, std::size_t size,
       return {"Inf", 3, 0, Exact};
     }
   } else {
+    if constexpr (HasShortestDigitsFastPath<PREC>) {
+      if ((flags & Minimize) && !x.IsZero()) {
+        BinaryFloatingPointNumber<PREC> magnitude{x};
+        if (x.IsNegative()) {
+          magnitude.Negate();
+        }
+        char shortest[maxShortestDigits];
+        int decimalExponent{0};
+        int length{ShortestDigits(shortest, decimalExponent, magnitude)};
+        if (length > 0 && length <= digits &&
+            size >= static_cast<std::size_t>(length) + 2) {
+          char *p{buffer};
+          if (x.IsNegative()) {
+            *p++ = '-';
+          } else if (flags & AlwaysSign) {
+            *p++ = '+';
+          }
+          std::memcpy(p, shortest, length);
+          p += length;
+          *p = '\0';
+          return {buffer, static_cast<std::size_t>(p - buffer), decimalExponent,
+              Exact};
+        }
+        // Otherwise, fall back to exact big-radix arithmetic.
+      }
+    }
     using Big = BigRadixFloatingPointNumber<PREC>;
     Big number{x, rounding};
     if ((flags & Minimize) && !x.IsZero()) {
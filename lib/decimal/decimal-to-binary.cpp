@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "big-radix-floating-point.h"
+#include "short-decimal.h"
 #include "flang/common/bit-population-count.h"
 #include "flang/common/leading-zero-bit-count.h"
 #include "flang/decimal/binary-floating-point.h"
@@ -115,13 +116,15 @@ bool BigRadixFloatingPointNumber<PREC, LOG10RADIX>::ParseNumber(
       }
       const char *expDig{q};
       while (*q >= '0' && *q <= '9') {
-        expo = 10 * expo + *q++ - '0';
+        if (q < expDig + 8) {
+          expo = 10 * expo + *q - '0';  // can't overflow
+        }
+        ++q;
       }
       if (q >= expDig + 8) {
         // There's a ridiculous number of nonzero exponent digits.
         // The decimal->binary conversion routine will cope with
-        // returning 0 or Inf, but we must ensure that "expo" didn't
-        // overflow back around to something legal.
+        // returning 0 or Inf, but "expo" holds only the leading digits.
         expo = 10 * Real::decimalRange;
         exponent_ = 0;
       }
@@ -386,6 +389,11 @@ BigRadixFloatingPointNumber<PREC, LOG10RADIX>::ConvertToBinary(const char *&p) {
 template<int PREC>
 ConversionToBinaryResult<PREC> ConvertToBinary(
     const char *&p, enum FortranRounding rounding) {
+  if constexpr (HasShortDecimalFastPath<PREC>) {
+    if (auto result{ConvertShortDecimalToBinary<PREC>(p, rounding)}) {
+      return *result;
+    }
+  }
   return BigRadixFloatingPointNumber<PREC>{rounding}.ConvertToBinary(p);
 }
 
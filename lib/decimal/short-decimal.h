@@ -0,0 +1,44 @@
+//===-- lib/decimal/short-decimal.h -----------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FORTRAN_DECIMAL_SHORT_DECIMAL_H_
+#define FORTRAN_DECIMAL_SHORT_DECIMAL_H_
+
+// A fast path for decimal-to-binary conversion of the common case:
+// a number with no more than 19 significant decimal digits, whose
+// correctly rounded binary32 or binary64 value is normal.  It uses the
+// algorithm of Daniel Lemire ("Number Parsing at a Gigabyte per Second",
+// 2021, after Michael Eisel), in which a single 64x64->128-bit product
+// with a table entry approximating a power of five usually determines
+// the result; a second product resolves most of the remaining cases.
+// When the value cannot be determined unambiguously, or when it is
+// subnormal or overflows, or the rounding mode is not round to nearest,
+// the caller must use the exact algorithm in BigRadixFloatingPointNumber.
+
+#include "flang/decimal/decimal.h"
+#include <optional>
+
+namespace Fortran::decimal {
+
+template<int PREC>
+constexpr bool HasShortDecimalFastPath{PREC == 24 || PREC == 53};
+
+// When the text at p is a short decimal number that can be converted
+// here, advances p past it and returns the result; otherwise, returns
+// nothing and leaves p alone.  Accepts the same syntax as
+// BigRadixFloatingPointNumber::ParseNumber().
+template<int PREC>
+std::optional<ConversionToBinaryResult<PREC>> ConvertShortDecimalToBinary(
+    const char *&p, enum FortranRounding);
+
+extern template std::optional<ConversionToBinaryResult<24>>
+ConvertShortDecimalToBinary<24>(const char *&, enum FortranRounding);
+extern template std::optional<ConversionToBinaryResult<53>>
+ConvertShortDecimalToBinary<53>(const char *&, enum FortranRounding);
+}
+#endif
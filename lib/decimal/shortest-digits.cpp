@@ -0,0 +1,272 @@
+//===-- lib/decimal/shortest-digits.cpp -----------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "shortest-digits.h"
+#include "flang/common/leading-zero-bit-count.h"
+#include <cinttypes>
+#include <cmath>
+
+namespace Fortran::decimal {
+
+// An unnormalized floating-point value f * 2**e with a 64-bit significand
+struct DiyFp {
+  std::uint64_t f;
+  int e;
+};
+
+static DiyFp Normalize(DiyFp x) {
+  int shift{common::LeadingZeroBitCount(x.f)};
+  return {x.f << shift, x.e - shift};
+}
+
+// The upper 64 bits of the 128-bit product, rounded; its error is at
+// most half of a unit in the last place.
+static DiyFp Multiply(DiyFp x, DiyFp y) {
+  constexpr std::uint64_t mask32{0xffffffff};
+  std::uint64_t a{x.f >> 32}, b{x.f & mask32};
+  std::uint64_t c{y.f >> 32}, d{y.f & mask32};
+  std::uint64_t ac{a * c}, bc{b * c}, ad{a * d}, bd{b * d};
+  std::uint64_t middle{(bd >> 32) + (ad & mask32) + (bc & mask32)};
+  middle += std::uint64_t{1} << 31;  // round
+  return {ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64};
+}
+
+// Normalized approximations of 10**decimalExponent, rounded to nearest,
+// for every eighth power of ten from 10**-348 to 10**340.
+struct CachedPower {
+  std::uint64_t significand;
+  std::int16_t binaryExponent;
+  std::int16_t decimalExponent;
+};
+static constexpr CachedPower cachedPowers[]{
+{0xfa8fd5a0081c0288, -1220, -348},
+    {0xbaaee17fa23ebf76, -1193, -340},
+    {0x8b16fb203055ac76, -1166, -332},
+    {0xcf42894a5dce35ea, -1140, -324},
+    {0x9a6bb0aa55653b2d, -1113, -316},
+    {0xe61acf033d1a45df, -1087, -308},
+    {0xab70fe17c79ac6ca, -1060, -300},
+    {0xff77b1fcbebcdc4f, -1034, -292},
+    {0xbe5691ef416bd60c, -1007, -284},
+    {0x8dd01fad907ffc3c, -980, -276},
+    {0xd3515c2831559a83, -954, -268},
+    {0x9d71ac8fada6c9b5, -927, -260},
+    {0xea9c227723ee8bcb, -901, -252},
+    {0xaecc49914078536d, -874, -244},
+    {0x823c12795db6ce57, -847, -236},
+    {0xc21094364dfb5637, -821, -228},
+    {0x9096ea6f3848984f, -794, -220},
+    {0xd77485cb25823ac7, -768, -212},
+    {0xa086cfcd97bf97f4, -741, -204},
+    {0xef340a98172aace5, -715, -196},
+    {0xb23867fb2a35b28e, -688, -188},
+    {0x84c8d4dfd2c63f3b, -661, -180},
+    {0xc5dd44271ad3cdba, -635, -172},
+    {0x936b9fcebb25c996, -608, -164},
+    {0xdbac6c247d62a584, -582, -156},
+    {0xa3ab66580d5fdaf6, -555, -148},
+    {0xf3e2f893dec3f126, -529, -140},
+    {0xb5b5ada8aaff80b8, -502, -132},
+    {0x87625f056c7c4a8b, -475, -124},
+    {0xc9bcff6034c13053, -449, -116},
+    {0x964e858c91ba2655, -422, -108},
+    {0xdff9772470297ebd, -396, -100},
+    {0xa6dfbd9fb8e5b88f, -369, -92},
+    {0xf8a95fcf88747d94, -343, -84},
+    {0xb94470938fa89bcf, -316, -76},
+    {0x8a08f0f8bf0f156b, -289, -68},
+    {0xcdb02555653131b6, -263, -60},
+    {0x993fe2c6d07b7fac, -236, -52},
+    {0xe45c10c42a2b3b06, -210, -44},
+    {0xaa242499697392d3, -183, -36},
+    {0xfd87b5f28300ca0e, -157, -28},
+    {0xbce5086492111aeb, -130, -20},
+    {0x8cbccc096f5088cc, -103, -12},
+    {0xd1b71758e219652c, -77, -4},
+    {0x9c40000000000000, -50, 4},
+    {0xe8d4a51000000000, -24, 12},
+    {0xad78ebc5ac620000, 3, 20},
+    {0x813f3978f8940984, 30, 28},
+    {0xc097ce7bc90715b3, 56, 36},
+    {0x8f7e32ce7bea5c70, 83, 44},
+    {0xd5d238a4abe98068, 109, 52},
+    {0x9f4f2726179a2245, 136, 60},
+    {0xed63a231d4c4fb27, 162, 68},
+    {0xb0de65388cc8ada8, 189, 76},
+    {0x83c7088e1aab65db, 216, 84},
+    {0xc45d1df942711d9a, 242, 92},
+    {0x924d692ca61be758, 269, 100},
+    {0xda01ee641a708dea, 295, 108},
+    {0xa26da3999aef774a, 322, 116},
+    {0xf209787bb47d6b85, 348, 124},
+    {0xb454e4a179dd1877, 375, 132},
+    {0x865b86925b9bc5c2, 402, 140},
+    {0xc83553c5c8965d3d, 428, 148},
+    {0x952ab45cfa97a0b3, 455, 156},
+    {0xde469fbd99a05fe3, 481, 164},
+    {0xa59bc234db398c25, 508, 172},
+    {0xf6c69a72a3989f5c, 534, 180},
+    {0xb7dcbf5354e9bece, 561, 188},
+    {0x88fcf317f22241e2, 588, 196},
+    {0xcc20ce9bd35c78a5, 614, 204},
+    {0x98165af37b2153df, 641, 212},
+    {0xe2a0b5dc971f303a, 667, 220},
+    {0xa8d9d1535ce3b396, 694, 228},
+    {0xfb9b7cd9a4a7443c, 720, 236},
+    {0xbb764c4ca7a44410, 747, 244},
+    {0x8bab8eefb6409c1a, 774, 252},
+    {0xd01fef10a657842c, 800, 260},
+    {0x9b10a4e5e9913129, 827, 268},
+    {0xe7109bfba19c0c9d, 853, 276},
+    {0xac2820d9623bf429, 880, 284},
+    {0x80444b5e7aa7cf85, 907, 292},
+    {0xbf21e44003acdd2d, 933, 300},
+    {0x8e679c2f5e44ff8f, 960, 308},
+    {0xd433179d9c8cb841, 986, 316},
+    {0x9e19db92b4e31ba9, 1013, 324},
+    {0xeb96bf6ebadf77d9, 1039, 332},
+    {0xaf87023b9bf0ee6b, 1066, 340},
+};
+static constexpr int firstCachedPower{-348};
+static constexpr int cachedPowerStep{8};
+
+// The scaled values must have binary exponents in this range, so that
+// their integral parts fit in 32 bits and their fractions in 64 bits.
+static constexpr int minimalTargetExponent{-60};
+static constexpr int maximalTargetExponent{-32};
+
+// Finds a cached power of ten c such that multiplying a normalized value
+// with binary exponent e by c yields a binary exponent in the target range.
+static const CachedPower &CachedPowerFor(int e) {
+  int minExponent{minimalTargetExponent - (e + 64)};
+  int k{static_cast<int>(std::ceil((minExponent + 63) * 0.30102999566398114))};
+  int index{(k - firstCachedPower - 1) / cachedPowerStep + 1};
+  return cachedPowers[index];
+}
+
+// Adjusts the last digit downward toward the value while the digits
+// remain within the interval that is safe despite the errors of the
+// scaled boundaries (each up to "unit"), and then verifies that the
+// result is unambiguously the nearest candidate to the value.
+// All of the arguments are in units of the scaled values.
+static bool RoundWeed(char *digits, int length, std::uint64_t distanceToHigh,
+    std::uint64_t unsafeInterval, std::uint64_t rest, std::uint64_t tenKappa,
+    std::uint64_t unit) {
+  std::uint64_t smallDistance{distanceToHigh - unit};
+  std::uint64_t bigDistance{distanceToHigh + unit};
+  while (rest < smallDistance && unsafeInterval - rest >= tenKappa &&
+      (rest + tenKappa < smallDistance ||
+          smallDistance - rest >= rest + tenKappa - smallDistance)) {
+    --digits[length - 1];
+    rest += tenKappa;
+  }
+  if (rest < bigDistance && unsafeInterval - rest >= tenKappa &&
+      (rest + tenKappa < bigDistance ||
+          bigDistance - rest > rest + tenKappa - bigDistance)) {
+    return false;  // can't tell which candidate is nearest
+  }
+  return 2 * unit <= rest && rest <= unsafeInterval - 4 * unit;
+}
+
+// Generates digits of "high" until they fall within the interval
+// (low, high), widened by one unit in each direction to account for
+// the errors of scaling, so that the result is known to lie in the true
+// interval only after RoundWeed has succeeded.  Sets kappa to the
+// power of ten by which the digits must be scaled.
+static int GenerateDigits(char *digits, DiyFp low, DiyFp w, DiyFp high,
+    int &kappa) {
+  std::uint64_t unit{1};
+  DiyFp tooLow{low.f - unit, low.e};
+  DiyFp tooHigh{high.f + unit, high.e};
+  std::uint64_t unsafeInterval{tooHigh.f - tooLow.f};
+  int shift{-w.e};
+  std::uint64_t one{std::uint64_t{1} << shift};
+  std::uint32_t integrals{static_cast<std::uint32_t>(tooHigh.f >> shift)};
+  std::uint64_t fractionals{tooHigh.f & (one - 1)};
+  std::uint32_t divisor{1};
+  kappa = 1;
+  while (kappa < 10 && integrals / 10 >= divisor) {
+    divisor *= 10;
+    ++kappa;
+  }
+  int length{0};
+  while (kappa > 0) {
+    digits[length++] = '0' + integrals / divisor;
+    integrals %= divisor;
+    --kappa;
+    std::uint64_t rest{(std::uint64_t{integrals} << shift) + fractionals};
+    if (rest < unsafeInterval) {
+      return RoundWeed(digits, length, tooHigh.f - w.f, unsafeInterval, rest,
+                 std::uint64_t{divisor} << shift, unit)
+          ? length
+          : 0;
+    }
+    divisor /= 10;
+  }
+  while (length < maxShortestDigits) {
+    fractionals *= 10;
+    unit *= 10;
+    unsafeInterval *= 10;
+    digits[length++] = '0' + (fractionals >> shift);
+    fractionals &= one - 1;
+    --kappa;
+    if (fractionals < unsafeInterval) {
+      return RoundWeed(digits, length, (tooHigh.f - w.f) * unit,
+                 unsafeInterval, fractionals, one, unit)
+          ? length
+          : 0;
+    }
+  }
+  return 0;
+}
+
+template<int PREC>
+int ShortestDigits(char (&digits)[maxShortestDigits], int &decimalExponent,
+    BinaryFloatingPointNumber<PREC> x) {
+  using Binary = BinaryFloatingPointNumber<PREC>;
+  static_assert(HasShortestDigitsFastPath<PREC>);
+  // x == f * 2**e exactly
+  std::uint64_t f{static_cast<std::uint64_t>(x.Fraction())};
+  int e{x.UnbiasedExponent() - Binary::significandBits};
+  // The boundaries m- and m+ are halfway to the adjacent values.  The
+  // lower one is closer when f is a power of two above the least
+  // normal exponent.
+  DiyFp high{Normalize({2 * f + 1, e - 1})};
+  DiyFp low{2 * f - 1, e - 1};
+  if (f == std::uint64_t{1} << Binary::significandBits &&
+      x.BiasedExponent() > 1) {
+    low = {4 * f - 1, e - 2};
+  }
+  low.f <<= low.e - high.e;
+  low.e = high.e;
+  DiyFp w{Normalize({f, e})};
+  const CachedPower &power{CachedPowerFor(high.e)};
+  DiyFp scale{power.significand, power.binaryExponent};
+  int kappa{0};
+  int length{GenerateDigits(digits, Multiply(low, scale), Multiply(w, scale),
+      Multiply(high, scale), kappa)};
+  if (length == 0 || digits[0] == '0') {
+    return 0;
+  }
+  while (digits[length - 1] == '0') {
+    --length;
+  }
+  // The digits, as an integer, are scaled by 10**(kappa - decimalExponent)
+  decimalExponent = length + kappa - power.decimalExponent;
+  return length;
+}
+
+template int ShortestDigits<8>(
+    char (&)[maxShortestDigits], int &, BinaryFloatingPointNumber<8>);
+template int ShortestDigits<11>(
+    char (&)[maxShortestDigits], int &, BinaryFloatingPointNumber<11>);
+template int ShortestDigits<24>(
+    char (&)[maxShortestDigits], int &, BinaryFloatingPointNumber<24>);
+template int ShortestDigits<53>(
+    char (&)[maxShortestDigits], int &, BinaryFloatingPointNumber<53>);
+}
@@ -0,0 +1,52 @@
+//===-- lib/decimal/shortest-digits.h ---------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FORTRAN_DECIMAL_SHORTEST_DIGITS_H_
+#define FORTRAN_DECIMAL_SHORTEST_DIGITS_H_
+
+// A fast path for minimized binary-to-decimal conversion, using the
+// Grisu3 algorithm of Florian Loitsch ("Printing Floating-Point Numbers
+// Quickly and Accurately with Integers", PLDI 2010).  It works with
+// 64-bit integer arithmetic and a small table of cached powers of ten,
+// so it applies only to formats whose significands fit with room to spare
+// (binary32 and binary64, and the 16-bit formats).  For a small fraction
+// of values it cannot prove that its result is both the shortest and
+// correct; the caller must then fall back to the exact algorithm
+// in BigRadixFloatingPointNumber.
+
+#include "flang/decimal/binary-floating-point.h"
+
+namespace Fortran::decimal {
+
+// The most digits that can be produced, plus slack
+static constexpr int maxShortestDigits{24};
+
+// For a finite, positive, nonzero x, tries to produce the fewest decimal
+// digits that will read back to x with RoundNearest, and the nearest
+// such digits to x when there are several candidates.  On success, stores
+// the digits (without a NUL) and returns their count, setting
+// decimalExponent as it is defined in ConversionToDecimalResult; otherwise
+// returns zero.
+template<int PREC>
+int ShortestDigits(char (&digits)[maxShortestDigits], int &decimalExponent,
+    BinaryFloatingPointNumber<PREC> x);
+
+template<int PREC>
+constexpr bool HasShortestDigitsFastPath{
+    PREC <= 53 && BinaryFloatingPointNumber<PREC>::isImplicitMSB};
+
+extern template int ShortestDigits<8>(
+    char (&)[maxShortestDigits], int &, BinaryFloatingPointNumber<8>);
+extern template int ShortestDigits<11>(
+    char (&)[maxShortestDigits], int &, BinaryFloatingPointNumber<11>);
+extern template int ShortestDigits<24>(
+    char (&)[maxShortestDigits], int &, BinaryFloatingPointNumber<24>);
+extern template int ShortestDigits<53>(
+    char (&)[maxShortestDigits], int &, BinaryFloatingPointNumber<53>);
+}
+#endif
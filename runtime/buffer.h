@@ -21,26 +21,82 @@ namespace Fortran::runtime::io {
 
 void LeftShiftBufferCircularly(char *, std::size_t bytes, std::size_t shift);
 
+// When output buffered in a FileFrame is written to its file
+enum class Buffering {
+  Default,  // Line for terminals, else Full
+  Unbuffered,  // after each transfer
+  Line,  // at the end of each statement, and when the buffer is full
+  Full,  // when the buffer is full or the flush threshold is reached
+  // As Full, but a full buffer is written by a background thread while
+  // the program fills another, and sequential input is read ahead into
+  // the other buffer.  Only for sequential access to regular files.
+  Background,
+};
+
+struct BufferingPolicy {
+  Buffering mode{Buffering::Default};
+  std::size_t bufferBytes{0};  // 0: defaultBufferBytes
+  std::size_t flushThreshold{0};  // dirty bytes that force a flush; 0: none
+};
+
+// A window of a file that has been mapped into memory
+struct MappedRegion {
+  char *base{nullptr};
+  std::int64_t fileOffset{0};  // of base[0]; page-aligned
+  std::size_t bytes{0};  // mapped length
+  std::size_t valid{0};  // leading mapped bytes that lie within the file
+};
+
 // Maintains a view of a contiguous region of a file in a memory buffer.
 // The valid data in the buffer may be circular, but any active frame
 // will also be contiguous in memory.  The requirement stems from the need to
 // preserve read data that may be reused by means of Tn/TLn edit descriptors
 // without needing to position the file (which may not always be possible,
 // e.g. a socket) and a general desire to reduce system call counts.
+// When STORE permits, frames for reading instead point directly into
+// a window of the file that has been mapped into memory, and no data
+// are copied.
 template<typename STORE> class FileFrame {
 public:
   using FileOffset = std::int64_t;
+  static constexpr std::size_t defaultBufferBytes{64 << 10};
 
-  ~FileFrame() { FreeMemoryAndNullify(buffer_); }
+  ~FileFrame() {
+    STORE::UnmapRegion(map_);
+    FreeMemoryAndNullify(buffer_);
+    FreeMemoryAndNullify(spare_);
+  }
 
   // The valid data in the buffer begins at buffer_[start_] and proceeds
   // with possible wrap-around for length_ bytes.  The current frame
   // is offset by frame_ bytes into that region and is guaranteed to
   // be contiguous for at least as many bytes as were requested.
 
+  BufferingPolicy &bufferingPolicy() { return policy_; }
+
+  // Closed units are recycled with their buffers (see UnitMap), so that
+  // an OPEN needn't allocate one.
+  char *TakeBuffer(std::size_t &size) {
+    char *buffer{buffer_};
+    size = size_;
+    buffer_ = nullptr;
+    size_ = 0;
+    return buffer;
+  }
+  void AdoptBuffer(char *buffer, std::size_t size) {
+    FreeMemory(buffer_);
+    buffer_ = buffer;
+    size_ = size;
+  }
+
   FileOffset FrameAt() const { return fileOffset_ + frame_; }
-  char *Frame() const { return buffer_ + start_ + frame_; }
+  char *Frame() const {
+    return (map_.base ? map_.base : buffer_) + start_ + frame_;
+  }
   std::size_t FrameLength() const {
+    if (map_.base) {
+      return length_ - std::min(frame_, length_);  // frame may be past EOF
+    }
     return std::min<std::size_t>(length_ - frame_, size_ - (start_ + frame_));
   }
 
@@ -48,6 +104,11 @@ public:
   std::size_t ReadFrame(
       FileOffset at, std::size_t bytes, IoErrorHandler &handler) {
     Flush(handler);
+    FinishWriteBehind(handler);
+    if (Store().mayMap() && ReadMappedFrame(at, bytes, handler)) {
+      return FrameLength();
+    }
+    ReleaseMappedFrame();
     Reallocate(bytes, handler);
     if (at < fileOffset_ || at > fileOffset_ + length_) {
       Reset(at);
@@ -58,13 +119,14 @@ public:
       if (start_ + bytes > size_) {
         // Frame would wrap around; shift current data (if any) to force
         // contiguity.
-        RUNTIME_CHECK(handler, length_ < size_);
-        if (start_ + length_ <= size_) {
+        RUNTIME_CHECK(handler, length_ < static_cast<std::int64_t>(size_));
+        if (start_ + length_ <= static_cast<std::int64_t>(size_)) {
           // [......abcde..] -> [abcde........]
           std::memmove(buffer_, buffer_ + start_, length_);
         } else {
           // [cde........ab] -> [abcde........]
-          auto n{start_ + length_ - size_};  // 3 for cde
+          // n is 3 for cde
+          auto n{start_ + length_ - static_cast<std::int64_t>(size_)};
           RUNTIME_CHECK(handler, length_ >= n);
           std::memmove(buffer_ + n, buffer_ + start_, length_ - n);  // cdeab
           LeftShiftBufferCircularly(buffer_, length_, n);  // abcde
@@ -74,25 +136,38 @@ public:
     }
     while (FrameLength() < bytes) {
       auto next{start_ + length_};
-      RUNTIME_CHECK(handler, next < size_);
+      RUNTIME_CHECK(handler, next < static_cast<std::int64_t>(size_));
       auto minBytes{bytes - FrameLength()};
       auto maxBytes{size_ - next};
+      if (auto got{TakeReadAhead(
+              fileOffset_ + length_, buffer_ + next, maxBytes, handler)}) {
+        length_ += got;
+        continue;
+      }
       auto got{Store().Read(
           fileOffset_ + length_, buffer_ + next, minBytes, maxBytes, handler)};
       length_ += got;
-      RUNTIME_CHECK(handler, length_ < size_);
+      // may fill the buffer
+      RUNTIME_CHECK(handler, length_ <= static_cast<std::int64_t>(size_));
       if (got < minBytes) {
         break;  // error or EOF & program can handle it
       }
+      StartReadAhead(fileOffset_ + length_, handler);
     }
     return FrameLength();
   }
 
+  // Frames may be written in any order; data already in the buffer
+  // are coalesced with them when they're contiguous.
   void WriteFrame(FileOffset at, std::size_t bytes, IoErrorHandler &handler) {
+    ReleaseMappedFrame();
+    DiscardReadAhead();
     if (!dirty_ || at < fileOffset_ || at > fileOffset_ + length_ ||
-        start_ + (at - fileOffset_) + bytes > size_) {
+        start_ + (at - fileOffset_) + bytes > size_ ||
+        (policy_.flushThreshold > 0 &&
+            static_cast<std::size_t>(length_) >= policy_.flushThreshold)) {
       Flush(handler);
-      fileOffset_ = at;
+      Reset(at);
       Reallocate(bytes, handler);
     }
     dirty_ = true;
@@ -100,31 +175,148 @@ public:
     length_ = std::max<std::int64_t>(length_, frame_ + bytes);
   }
 
+  // The valid data, which may wrap around, are written all at once.
+  // Data that could not be written are discarded.  With write-behind,
+  // contiguous data are instead written in the background from this
+  // buffer while the next is filled; an error in that write is signaled
+  // by whatever next waits for it.  Writes are never concurrent, so
+  // they reach the file in order.
   void Flush(IoErrorHandler &handler) {
     if (dirty_) {
-      while (length_ > 0) {
+      if (length_ > 0) {
+        FinishWriteBehind(handler);
         std::size_t chunk{std::min<std::size_t>(length_, size_ - start_)};
-        std::size_t put{
-            Store().Write(fileOffset_, buffer_ + start_, chunk, handler)};
-        length_ -= put;
-        start_ += put;
-        fileOffset_ += put;
-        if (put < chunk) {
-          break;
+        if (policy_.mode == Buffering::Background &&
+            chunk == static_cast<std::size_t>(length_)) {
+          DiscardReadAhead();
+          behind_ = Store().WriteAsynchronously(
+              fileOffset_, buffer_ + start_, chunk, handler);
+          fileOffset_ += chunk;
+          std::swap(buffer_, spare_);
+          std::swap(size_, spareSize_);
+        } else {
+          fileOffset_ += Store().Write(fileOffset_, buffer_ + start_, chunk,
+              buffer_, length_ - chunk, handler);
         }
+        ++flushes_;
       }
       Reset(fileOffset_);
     }
   }
+  std::uint64_t flushes() const { return flushes_; }
+
+  // Flushes the buffer and waits for any background transfer, so that
+  // the file is complete; needed before it is closed.
+  void Drain(IoErrorHandler &handler) {
+    Flush(handler);
+    FinishWriteBehind(handler);
+    DiscardReadAhead();
+  }
+
+  // Must be called before the file is closed.
+  void ReleaseMappedFrame() {
+    if (map_.base) {
+      STORE::UnmapRegion(map_);
+      Reset(0);
+    }
+  }
 
 private:
   STORE &Store() { return static_cast<STORE &>(*this); }
 
+  void FinishWriteBehind(IoErrorHandler &handler) {
+    if (behind_ >= 0) {
+      Store().Wait(behind_, handler);
+      behind_ = -1;
+    }
+  }
+
+  // Reads the next bufferful in the background into the spare buffer
+  void StartReadAhead(FileOffset at, IoErrorHandler &handler) {
+    if (policy_.mode == Buffering::Background && behind_ < 0 &&
+        ahead_ < 0 && aheadLength_ == 0 && !aheadAtEnd_) {
+      if (spareSize_ < size_) {
+        FreeMemory(spare_);
+        spare_ =
+            reinterpret_cast<char *>(AllocateMemoryOrCrash(handler, size_));
+        spareSize_ = size_;
+      }
+      aheadAt_ = at;
+      aheadStart_ = 0;
+      ahead_ = Store().ReadAsynchronously(at, spare_, spareSize_, handler);
+    }
+  }
+
+  // Moves data that were read ahead from the file at the offset, if
+  // any, into the buffer, and starts reading the next bufferful.
+  std::size_t TakeReadAhead(FileOffset at, char *to, std::size_t maxBytes,
+      IoErrorHandler &handler) {
+    if (ahead_ >= 0) {
+      IoErrorHandler probe{handler};  // errors recur when read in place
+      probe.HasIoStat();
+      probe.HasEndLabel();
+      aheadLength_ = Store().Wait(ahead_, probe);
+      aheadAtEnd_ = aheadLength_ < spareSize_;
+      ahead_ = -1;
+    }
+    if (aheadLength_ == 0) {
+      return 0;
+    } else if (at != aheadAt_) {
+      DiscardReadAhead();  // the program has moved elsewhere in the file
+      return 0;
+    }
+    std::size_t got{std::min(maxBytes, aheadLength_)};
+    std::memcpy(to, spare_ + aheadStart_, got);
+    aheadAt_ += got;
+    aheadStart_ += got;
+    aheadLength_ -= got;
+    if (aheadLength_ == 0) {
+      StartReadAhead(aheadAt_, handler);
+    }
+    return got;
+  }
+
+  void DiscardReadAhead() {
+    if (ahead_ >= 0) {
+      IoErrorHandler probe{"read-ahead"};
+      probe.HasIoStat();
+      probe.HasEndLabel();
+      Store().Wait(ahead_, probe);
+      ahead_ = -1;
+    }
+    aheadLength_ = 0;
+    aheadAtEnd_ = false;
+  }
+
+  // Windows are remapped as frames move beyond them.  Each new window is
+  // advised to be read sequentially, unless the frame moved backward.
+  bool ReadMappedFrame(
+      FileOffset at, std::size_t bytes, IoErrorHandler &handler) {
+    if (!map_.base || at < map_.fileOffset ||
+        at + bytes > map_.fileOffset + map_.bytes) {
+      bool sequential{map_.base ? at >= map_.fileOffset : at == 0};
+      STORE::UnmapRegion(map_);
+      if (!Store().MapRegion(
+              at, std::max(bytes, mapWindow), sequential, map_, handler)) {
+        return false;
+      }
+    }
+    start_ = 0;
+    fileOffset_ = map_.fileOffset;
+    length_ = map_.valid;
+    frame_ = at - map_.fileOffset;
+    return true;
+  }
+
   void Reallocate(std::size_t bytes, const Terminator &terminator) {
-    if (bytes > size_) {
+    // An empty buffer, as adopted, may be smaller than the policy asks.
+    if (bytes > size_ || (length_ == 0 && size_ < policy_.bufferBytes)) {
       char *old{buffer_};
       auto oldSize{size_};
-      size_ = std::max(bytes, minBuffer);
+      // Grow geometrically, so that a long record being located by
+      // repeated extension of its frame costs linear time
+      size_ = std::max({bytes, 2 * oldSize,
+          policy_.bufferBytes > 0 ? policy_.bufferBytes : defaultBufferBytes});
       buffer_ =
           reinterpret_cast<char *>(AllocateMemoryOrCrash(terminator, size_));
       auto chunk{std::min<std::int64_t>(length_, oldSize - start_)};
@@ -142,17 +334,17 @@ private:
   }
 
   void DiscardLeadingBytes(std::size_t n, const Terminator &terminator) {
-    RUNTIME_CHECK(terminator, length_ >= n);
+    RUNTIME_CHECK(terminator, length_ >= static_cast<std::int64_t>(n));
     length_ -= n;
     if (length_ == 0) {
       start_ = 0;
     } else {
       start_ += n;
-      if (start_ >= size_) {
+      if (start_ >= static_cast<std::int64_t>(size_)) {
         start_ -= size_;
       }
     }
-    if (frame_ >= n) {
+    if (frame_ >= static_cast<std::int64_t>(n)) {
       frame_ -= n;
     } else {
       frame_ = 0;
@@ -160,7 +352,8 @@ private:
     fileOffset_ += n;
   }
 
-  static constexpr std::size_t minBuffer{64 << 10};
+  static constexpr std::size_t mapWindow{
+      sizeof(void *) > 4 ? std::size_t{256} << 20 : std::size_t{16} << 20};
 
   char *buffer_{nullptr};
   std::size_t size_{0};  // current allocated buffer size
@@ -169,6 +362,19 @@ private:
   std::int64_t length_{0};  // valid data length (can wrap)
   std::int64_t frame_{0};  // offset of current frame in valid data
   bool dirty_{false};
+  std::uint64_t flushes_{0};  // that wrote data
+  // Buffering::Background: the other buffer, which is being written when
+  // behind_ is an asynchronous transfer ID, or into which the bytes of
+  // the file at aheadAt_ are being read when ahead_ is one, or hold
+  // aheadLength_ bytes from spare_[aheadStart_] that were read.
+  char *spare_{nullptr};
+  std::size_t spareSize_{0};
+  int behind_{-1}, ahead_{-1};
+  FileOffset aheadAt_{0};
+  std::size_t aheadStart_{0}, aheadLength_{0};
+  bool aheadAtEnd_{false};  // the last read ahead reached the end
+  BufferingPolicy policy_;
+  MappedRegion map_;  // when frames are mapped rather than buffered
 };
 }
 #endif  // FORTRAN_RUNTIME_BUFFER_H_
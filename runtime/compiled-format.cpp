@@ -0,0 +1,334 @@
+//===-- runtime/compiled-format.cpp -----------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "format.h"
+#include "memory.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+namespace Fortran::runtime::io {
+
+// Lexes a FORMAT exactly as FormatControl<>::CueUpNextDataEdit() and
+// GetNextDataEdit() would, but once, producing FormatOps.  Rather than
+// crashing on an error, it fails; the FORMAT is then interpreted instead,
+// so that errors are reported when (and if) they are reached.
+class FormatCompiler {
+public:
+  FormatCompiler(const char *format, int formatLength)
+    : format_{format}, formatLength_{formatLength} {}
+
+  int maxNesting() const { return maxNesting_; }
+
+  // Returns the number of FormatOps, or -1 on failure; ops may be null
+  // in order to just count them.
+  int Compile(FormatOp *ops) {
+    int count{0};
+    auto add{[&](const FormatOp &op) {
+      if (ops) {
+        ops[count] = op;
+      }
+      ++count;
+    }};
+    int height{0};
+    offset_ = 0;
+    while (true) {
+      std::optional<int> repeat;
+      bool unlimited{false};
+      char ch{Capitalize(GetNextChar())};
+      while (ch == ',' || ch == ':') {
+        if (ch == ':') {
+          add(FormatOp{FormatOp::Kind::Colon});
+        }
+        ch = Capitalize(GetNextChar());
+      }
+      if (ch == '-' || ch == '+' || (ch >= '0' && ch <= '9')) {
+        repeat = GetIntField(ch);
+        ch = GetNextChar();
+      } else if (ch == '*') {
+        unlimited = true;
+        ch = GetNextChar();
+        if (ch != '(') {
+          return -1;
+        }
+      }
+      if (failed_) {
+        return -1;
+      }
+      if (ch == '(') {
+        if (height >= maxMaxHeight) {
+          return -1;
+        }
+        FormatOp op{FormatOp::Kind::LeftParen};
+        if (unlimited || height == 0) {
+          op.repeat = FormatOp::unlimited;
+        } else if (repeat) {
+          op.repeat = std::max(*repeat, 1) - 1;
+        } else {
+          op.repeat = 0;
+        }
+        add(op);
+        maxNesting_ = std::max(maxNesting_, ++height);
+      } else if (height == 0) {
+        return -1;
+      } else if (ch == ')') {
+        add(FormatOp{FormatOp::Kind::RightParen});
+        if (--height == 0) {
+          return count;  // the rest of the FORMAT is never reached
+        }
+      } else if (ch == '\'' || ch == '"') {
+        char quote{ch};
+        int start{offset_};
+        while (offset_ < formatLength_ && format_[offset_] != quote) {
+          ++offset_;
+        }
+        if (offset_ >= formatLength_) {
+          return -1;
+        }
+        ++offset_;
+        int chars{offset_ - start};
+        if (PeekNext() != quote) {
+          --chars;  // a doubled quote is emitted once, as in CueUpNextDataEdit
+        }
+        FormatOp op{FormatOp::Kind::Literal};
+        op.textOffset = start;
+        op.width = chars;
+        add(op);
+      } else if (ch == 'H') {
+        if (!repeat || *repeat < 1 || offset_ + *repeat > formatLength_) {
+          return -1;
+        }
+        FormatOp op{FormatOp::Kind::Literal};
+        op.textOffset = offset_;
+        op.width = *repeat;
+        add(op);
+        offset_ += *repeat;
+      } else if (ch >= 'A' && ch <= 'Z') {
+        int start{offset_ - 1};
+        char next{Capitalize(PeekNext())};
+        if (next >= 'A' && next <= 'Z') {
+          ++offset_;
+        } else {
+          next = '\0';
+        }
+        if (ch == 'E' ||
+            (!next &&
+                (ch == 'A' || ch == 'I' || ch == 'B' || ch == 'O' ||
+                    ch == 'Z' || ch == 'F' || ch == 'D' || ch == 'G' ||
+                    ch == 'L'))) {
+          offset_ = start;
+          FormatOp op{GetDataEdit()};
+          op.repeat = repeat && *repeat > 0 ? *repeat : 1;
+          add(op);
+        } else {
+          if (ch == 'T') {  // Tn, TLn, TRn
+            repeat = GetIntField();
+          }
+          FormatOp op{FormatOp::Kind::Control, ch, next};
+          op.repeat = repeat ? *repeat : 1;
+          add(op);
+        }
+      } else if (ch == '/') {
+        FormatOp op{FormatOp::Kind::Slash};
+        op.repeat = repeat && *repeat > 0 ? *repeat : 1;
+        add(op);
+      } else {
+        return -1;
+      }
+      if (failed_) {
+        return -1;
+      }
+    }
+  }
+
+private:
+  static constexpr int maxMaxHeight{100};
+
+  static constexpr char Capitalize(char ch) {
+    return ch >= 'a' && ch <= 'z' ? ch + 'A' - 'a' : ch;
+  }
+  void SkipBlanks() {
+    while (offset_ < formatLength_ && format_[offset_] == ' ') {
+      ++offset_;
+    }
+  }
+  char PeekNext() {
+    SkipBlanks();
+    return offset_ < formatLength_ ? format_[offset_] : '\0';
+  }
+  char GetNextChar() {
+    SkipBlanks();
+    if (offset_ >= formatLength_) {
+      failed_ = true;
+      return '\0';
+    }
+    return format_[offset_++];
+  }
+
+  int GetIntField(char firstCh = '\0') {
+    char ch{firstCh ? firstCh : PeekNext()};
+    if (ch != '-' && ch != '+' && (ch < '0' || ch > '9')) {
+      failed_ = true;
+      return 0;
+    }
+    int result{0};
+    bool negate{ch == '-'};
+    if (negate) {
+      firstCh = '\0';
+      ch = PeekNext();
+    }
+    while (ch >= '0' && ch <= '9') {
+      if (result >
+          std::numeric_limits<int>::max() / 10 - (static_cast<int>(ch) - '0')) {
+        failed_ = true;
+        return 0;
+      }
+      result = 10 * result + ch - '0';
+      if (firstCh) {
+        firstCh = '\0';
+      } else {
+        ++offset_;
+      }
+      ch = PeekNext();
+    }
+    if (negate && (result *= -1) > 0) {
+      failed_ = true;
+    }
+    return result;
+  }
+
+  FormatOp GetDataEdit() {
+    FormatOp op{FormatOp::Kind::Data, Capitalize(GetNextChar())};
+    if (op.descriptor == 'E') {
+      char variation{static_cast<char>(Capitalize(PeekNext()))};
+      if (variation == 'N' || variation == 'S' || variation == 'X') {
+        op.variation = variation;
+        ++offset_;
+      }
+    }
+    if (op.descriptor != 'A' || (PeekNext() >= '0' && PeekNext() <= '9')) {
+      op.width = GetIntField();
+      op.fields |= FormatOp::hasWidth;
+    }
+    if (PeekNext() == '.') {
+      ++offset_;
+      op.digits = GetIntField();
+      op.fields |= FormatOp::hasDigits;
+      char ch{PeekNext()};
+      if (ch == 'e' || ch == 'E' || ch == 'd' || ch == 'D') {
+        ++offset_;
+        op.expoDigits = GetIntField();
+        op.fields |= FormatOp::hasExpoDigits;
+      }
+    }
+    return op;
+  }
+
+  const char *format_;
+  int formatLength_;
+  int offset_{0};
+  int maxNesting_{0};
+  bool failed_{false};
+};
+
+const CompiledFormat *CompiledFormat::Create(const Terminator &terminator,
+    const char *format, std::size_t formatLength) {
+  int length{static_cast<int>(formatLength)};
+  if (static_cast<std::size_t>(length) != formatLength) {
+    return nullptr;
+  }
+  FormatCompiler compiler{format, length};
+  int ops{compiler.Compile(nullptr)};
+  if (ops <= 0) {
+    return nullptr;
+  }
+  std::size_t bytes{
+      sizeof(CompiledFormat) + ops * sizeof(FormatOp) + formatLength};
+  auto *compiled{
+      new (AllocateMemoryOrCrash(terminator, bytes)) CompiledFormat};
+  compiled->ops_ = ops;
+  compiled->textLength_ = length;
+  compiled->maxNesting_ = compiler.maxNesting();
+  compiler.Compile(const_cast<FormatOp *>(&compiled->op(0)));
+  std::memcpy(const_cast<char *>(compiled->text()), format, formatLength);
+  return compiled;
+}
+
+bool CompiledFormat::Matches(
+    const char *format, std::size_t formatLength) const {
+  return formatLength == static_cast<std::size_t>(textLength_) &&
+      std::memcmp(text(), format, formatLength) == 0;
+}
+
+// Compiled FORMATs are cached by the address and length of their text.
+// Each entry is published with a single atomic pointer, so hits take no
+// lock, and a FORMAT is compiled before its entry is published; a thread
+// that loses a race to publish one interprets its FORMAT that once.  The
+// text is compared on each hit, since a FORMAT in a CHARACTER variable,
+// or in storage that has been reused, can change; the entry is then
+// replaced, but only a few times, after which that slot's FORMATs are
+// interpreted.  Published entries are never freed, since an I/O
+// statement may be using one.
+static constexpr int formatCacheSize{256};
+static constexpr int formatCacheProbes{4};
+static constexpr int maxFormatReplacements{16};
+struct CachedFormat {
+  const char *format;
+  std::size_t formatLength;
+  const CompiledFormat *compiled;
+  int replacements;  // of earlier entries in its slot
+};
+static std::atomic<const CachedFormat *> formatCache[formatCacheSize];
+
+// Compiles a FORMAT and publishes it in a slot in place of an entry,
+// if any; returns null if either fails.
+static const CompiledFormat *Publish(const Terminator &terminator,
+    std::atomic<const CachedFormat *> &slot, const CachedFormat *replaced,
+    const char *format, std::size_t formatLength) {
+  const CompiledFormat *compiled{
+      CompiledFormat::Create(terminator, format, formatLength)};
+  if (!compiled) {
+    return nullptr;
+  }
+  CachedFormat &entry{New<CachedFormat>{}(terminator,
+      CachedFormat{format, formatLength, compiled,
+          replaced ? replaced->replacements + 1 : 0})};
+  if (slot.compare_exchange_strong(
+          replaced, &entry, std::memory_order_acq_rel)) {
+    return compiled;
+  }
+  FreeMemory(&entry);
+  FreeMemory(const_cast<CompiledFormat *>(compiled));
+  return nullptr;
+}
+
+const CompiledFormat *CompiledFormat::LookUpOrCreate(
+    const Terminator &terminator, const char *format,
+    std::size_t formatLength) {
+  std::size_t hash{
+      (reinterpret_cast<std::uintptr_t>(format) >> 3) ^ formatLength};
+  for (int j{0}; j < formatCacheProbes; ++j) {
+    auto &slot{formatCache[(hash + j) % formatCacheSize]};
+    const CachedFormat *entry{slot.load(std::memory_order_acquire)};
+    if (!entry) {
+      return Publish(terminator, slot, nullptr, format, formatLength);
+    }
+    if (entry->format == format && entry->formatLength == formatLength) {
+      if (entry->compiled->Matches(format, formatLength)) {
+        return entry->compiled;
+      } else if (entry->replacements < maxFormatReplacements) {
+        return Publish(terminator, slot, entry, format, formatLength);
+      } else {
+        return nullptr;
+      }
+    }
+  }
+  return nullptr;  // no room nearby; interpret it
+}
+}
@@ -7,6 +7,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "descriptor.h"
+#include "element-runs.h"
+#include "memory.h"
+#include "terminator.h"
 #include "flang/common/idioms.h"
 #include <cassert>
 #include <cstdlib>
@@ -64,12 +67,20 @@ void Descriptor::Establish(const DerivedType &dt, void *p, int rank,
   new (a) DescriptorAddendum{&dt};
 }
 
+// A descriptor of Create() is a small block from the runtime's allocator,
+// deleted by operator delete below.
+static Descriptor *AllocateDescriptor(std::size_t bytes) {
+  Terminator terminator{__FILE__, __LINE__};
+  return static_cast<Descriptor *>(AllocateMemoryOrCrash(terminator, bytes));
+}
+
+void Descriptor::operator delete(void *p) { FreeMemory(p); }
+
 std::unique_ptr<Descriptor> Descriptor::Create(TypeCode t,
     std::size_t elementBytes, void *p, int rank, const SubscriptValue *extent,
     ISO::CFI_attribute_t attribute) {
   std::size_t bytes{SizeInBytes(rank, true)};
-  Descriptor *result{reinterpret_cast<Descriptor *>(new char[bytes])};
-  CHECK(result);
+  Descriptor *result{AllocateDescriptor(bytes)};
   result->Establish(t, elementBytes, p, rank, extent, attribute, true);
   return std::unique_ptr<Descriptor>{result};
 }
@@ -78,8 +89,7 @@ std::unique_ptr<Descriptor> Descriptor::Create(TypeCategory c, int kind,
     void *p, int rank, const SubscriptValue *extent,
     ISO::CFI_attribute_t attribute) {
   std::size_t bytes{SizeInBytes(rank, true)};
-  Descriptor *result{reinterpret_cast<Descriptor *>(new char[bytes])};
-  CHECK(result);
+  Descriptor *result{AllocateDescriptor(bytes)};
   result->Establish(c, kind, p, rank, extent, attribute, true);
   return std::unique_ptr<Descriptor>{result};
 }
@@ -87,8 +97,7 @@ std::unique_ptr<Descriptor> Descriptor::Create(TypeCategory c, int kind,
 std::unique_ptr<Descriptor> Descriptor::Create(const DerivedType &dt, void *p,
     int rank, const SubscriptValue *extent, ISO::CFI_attribute_t attribute) {
   std::size_t bytes{SizeInBytes(rank, true, dt.lenParameters())};
-  Descriptor *result{reinterpret_cast<Descriptor *>(new char[bytes])};
-  CHECK(result);
+  Descriptor *result{AllocateDescriptor(bytes)};
   result->Establish(dt, p, rank, extent, attribute);
   return std::unique_ptr<Descriptor>{result};
 }
@@ -131,11 +140,13 @@ void Descriptor::Destroy(char *data, bool finalize) const {
         finalize = false;
       }
       if (const DerivedType * dt{addendum->derivedType()}) {
-        std::size_t elements{Elements()};
-        std::size_t elementBytes{ElementBytes()};
-        for (std::size_t j{0}; j < elements; ++j) {
-          dt->Destroy(data + j * elementBytes, finalize);
-        }
+        ElementRuns{*this, nullptr, data}.ForEachRun(
+            [&](char *first, std::size_t count, std::ptrdiff_t stride) {
+              for (std::size_t j{0}; j < count; ++j, first += stride) {
+                dt->Destroy(first, finalize);
+              }
+              return true;
+            });
       }
     }
   }
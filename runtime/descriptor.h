@@ -128,6 +128,8 @@ public:
   Descriptor(const Descriptor &);
 
   ~Descriptor();
+  // Of descriptors from Create()
+  static void operator delete(void *);
 
   void Establish(TypeCode t, std::size_t elementBytes, void *p = nullptr,
       int rank = maxRank, const SubscriptValue *extent = nullptr,
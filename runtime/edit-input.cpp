@@ -0,0 +1,550 @@
+//===-- runtime/edit-input.cpp ----------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "edit-input.h"
+#include "magic-numbers.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace Fortran::runtime::io {
+
+static constexpr bool IsBlank(char ch) { return ch == ' ' || ch == '\t'; }
+
+// Gets the characters of a formatted input field of the given width and
+// consumes them.  The field is shorter when the record is; that is an
+// error with PAD='NO', and otherwise the missing characters are blanks.
+static bool GetFormattedField(IoStatementState &io, const DataEdit &edit,
+    std::size_t width, const char *&field, std::size_t &length) {
+  std::size_t bytes{io.GetNextInputBytes(field)};
+  if (io.InError()) {
+    return false;
+  }
+  length = std::min(bytes, width);
+  if (length < width && !edit.modes.pad) {
+    io.GetIoErrorHandler().SignalEor();
+    return false;
+  }
+  return io.HandleRelativePosition(length);
+}
+
+// Gets an undelimited list-directed value, at which GetNextDataEdit() has
+// positioned the input, and consumes it.
+static bool GetListDirectedValue(IoStatementState &io, const DataEdit &edit,
+    const char *&value, std::size_t &length) {
+  std::size_t bytes{io.GetNextInputBytes(value)};
+  if (io.InError()) {
+    return false;
+  }
+  length = ListDirectedStatementState<true>::ValueLength(
+      value, value + bytes, (edit.modes.editingFlags & decimalComma) != 0);
+  return io.HandleRelativePosition(length);
+}
+
+// A numeric input field; an edit descriptor without a width (which is
+// not standard for input) reads a value as if list-directed.
+static bool GetNumericField(IoStatementState &io, const DataEdit &edit,
+    const char *&field, std::size_t &length) {
+  if (edit.IsListDirected() || !edit.width) {
+    return GetListDirectedValue(io, edit, field, length);
+  }
+  return GetFormattedField(
+      io, edit, std::max(*edit.width, 0), field, length);
+}
+
+static bool SignalBadInput(IoErrorHandler &handler, const char *what,
+    const char *field, std::size_t length) {
+  handler.SignalError(FORTRAN_RUNTIME_IOSTAT_BAD_INPUT,
+      "Bad %s input field '%.*s'", what, static_cast<int>(length), field);
+  return false;
+}
+
+static inline int DigitValue(char ch) {
+  if (ch >= '0' && ch <= '9') {
+    return ch - '0';
+  }
+  ch |= 0x20;  // lower case
+  if (ch >= 'a' && ch <= 'f') {
+    return ch - 'a' + 10;
+  }
+  return 99;
+}
+
+// Interprets an INTEGER input field in a base; blanks are ignored, or
+// are zeros under BZ editing.  Only a decimal value may have a sign; the
+// others are bit patterns that must fit in the item.
+static bool ConvertInteger(IoErrorHandler &handler, const char *field,
+    std::size_t length, int base, bool blankZero, void *x, int kind) {
+  const char *p{field}, *end{field + length};
+  while (p < end && IsBlank(*p)) {
+    ++p;
+  }
+  bool negative{false};
+  if (base == 10 && p < end && (*p == '-' || *p == '+')) {
+    negative = *p++ == '-';
+  }
+  static constexpr std::uint64_t maxU64{
+      std::numeric_limits<std::uint64_t>::max()};
+  std::uint64_t value{0};
+  bool overflow{false};
+  for (; p < end; ++p) {
+    int digit{DigitValue(*p)};
+    if (digit >= base) {
+      if (!IsBlank(*p)) {
+        return SignalBadInput(handler, "INTEGER", field, length);
+      } else if (!blankZero) {
+        continue;
+      }
+      digit = 0;
+    }
+    if (value <= maxU64 / 16 - 1) {
+      value = base * value + digit;  // can't overflow
+    } else if (value > (maxU64 - digit) / base) {
+      overflow = true;
+    } else {
+      value = base * value + digit;
+    }
+  }
+  int bits{8 * kind};
+  std::uint64_t limit{bits >= 64 ? maxU64 : (std::uint64_t{1} << bits) - 1};
+  if (base == 10) {
+    limit = (limit >> 1) + negative;
+  }
+  if (overflow || value > limit) {
+    handler.SignalError(FORTRAN_RUNTIME_IOSTAT_BAD_INPUT,
+        "INTEGER input field '%.*s' overflows INTEGER(KIND=%d)",
+        static_cast<int>(length), field, kind);
+    return false;
+  }
+  auto n{static_cast<std::int64_t>(negative ? 0 - value : value)};
+  switch (kind) {
+  case 1: *reinterpret_cast<std::int8_t *>(x) = n; return true;
+  case 2: *reinterpret_cast<std::int16_t *>(x) = n; return true;
+  case 4: *reinterpret_cast<std::int32_t *>(x) = n; return true;
+  case 8: *reinterpret_cast<std::int64_t *>(x) = n; return true;
+  default:
+    handler.Crash("INTEGER(KIND=%d) input is not yet implemented", kind);
+    return false;
+  }
+}
+
+bool ConvertIntegerInputValue(IoErrorHandler &handler, const char *value,
+    std::size_t length, void *x, int kind) {
+  return ConvertInteger(handler, value, length, 10, false, x, kind);
+}
+
+bool EditIntegerInput(
+    IoStatementState &io, const DataEdit &edit, void *x, int kind) {
+  int base{10};
+  switch (edit.descriptor) {
+  case DataEdit::ListDirectedNullValue: return !io.InError();
+  case DataEdit::ListDirected:
+  case 'G':
+  case 'I': break;
+  case 'B': base = 2; break;
+  case 'O': base = 8; break;
+  case 'Z': base = 16; break;
+  default:
+    io.GetIoErrorHandler().Crash(
+        "Data edit descriptor '%c' may not be used with an INTEGER data item",
+        edit.descriptor);
+    return false;
+  }
+  const char *field{nullptr};
+  std::size_t length{0};
+  return GetNumericField(io, edit, field, length) &&
+      ConvertInteger(io.GetIoErrorHandler(), field, length, base,
+          (edit.modes.editingFlags & blankZero) != 0, x, kind);
+}
+
+// Appends a decimal exponent to a buffer
+static char *FormatExponent(char *p, int exponent) {
+  *p++ = 'e';
+  if (exponent < 0) {
+    *p++ = '-';
+    exponent = -exponent;
+  }
+  char digits[12];
+  int n{0};
+  do {
+    digits[n++] = '0' + exponent % 10;
+    exponent /= 10;
+  } while (exponent > 0);
+  while (n > 0) {
+    *p++ = digits[--n];
+  }
+  return p;
+}
+
+// The most characters of a REAL input field that are converted after its
+// blanks, leading and trailing zeros, and decimal point are removed;
+// the significant digits of a longer field are truncated, and a final
+// nonzero digit stands for any nonzero digits that were dropped.
+static constexpr std::size_t maxRealInputChars{256};
+
+// Rewrites a REAL input field as a NUL-terminated string that
+// decimal::ConvertToBinary() accepts: blanks are removed (or become
+// zeros under BZ editing), and only the significant digits are copied;
+// the position of the decimal point (or comma), trailing zeros, an
+// implied decimal point (the d in Fw.d), the scale factor kP (which
+// applies only when the field has no exponent), and any exponent are
+// combined into one 'e' exponent.  So a wide field costs nothing for
+// its padding.  An exponent may also be a sign and digits without a
+// letter.  A blank field is zero.  Returns false when the field is not
+// a number.
+static bool NormalizeRealInput(char *buffer, const char *field,
+    std::size_t length, const MutableModes &modes, int impliedDigits,
+    int scale) {
+  const char *p{field}, *end{field + length};
+  bool zeroBlanks{(modes.editingFlags & blankZero) != 0};
+  char point{modes.editingFlags & decimalComma ? ',' : '.'};
+  char *q{buffer};
+  while (p < end && IsBlank(*p)) {
+    ++p;
+  }
+  if (p < end && (*p == '-' || *p == '+')) {
+    *q++ = *p++;
+  }
+  if (p < end && ((*p | 0x20) == 'i' || (*p | 0x20) == 'n')) {
+    // Inf, Infinity, or NaN, perhaps followed by a parenthesized payload
+    while (IsBlank(end[-1])) {
+      --end;
+    }
+    char name[9]{};
+    for (int j{0}; j < 8 && p < end && !IsBlank(*p) && *p != '('; ++j) {
+      name[j] = *p++ & ~0x20;  // upper case
+    }
+    if (p < end && *p == '(' && end[-1] == ')') {
+      p = end;
+    }
+    if (p < end) {
+      return false;
+    } else if (std::strcmp(name, "INF") == 0 ||
+        std::strcmp(name, "INFINITY") == 0) {
+      std::memcpy(q, "Inf", 4);
+      return true;
+    } else if (std::strcmp(name, "NAN") == 0) {
+      std::memcpy(q, "NaN", 4);
+      return true;
+    }
+    return false;
+  }
+  char *digits{q};
+  bool anyDigit{false}, hasPoint{false}, sticky{false};
+  int zeros{0};  // not yet copied, including digits dropped
+  int fractionDigits{0};
+  for (; p < end; ++p) {
+    char ch{*p};
+    if (IsBlank(ch)) {
+      if (!zeroBlanks) {
+        continue;
+      }
+      ch = '0';
+    }
+    if (ch >= '0' && ch <= '9') {
+      anyDigit = true;
+      fractionDigits += hasPoint;
+      if (ch == '0') {
+        zeros += q > digits;  // leading zeros are dropped
+      } else if (q + zeros >= buffer + maxRealInputChars - 1) {
+        ++zeros;  // truncated, leaving room for the sticky digit
+        sticky = true;
+      } else {
+        for (; zeros > 0; --zeros) {
+          *q++ = '0';
+        }
+        *q++ = ch;
+      }
+    } else if (ch == point && !hasPoint) {
+      hasPoint = true;
+    } else {
+      break;
+    }
+  }
+  int exponent{0};
+  bool hasExponent{false};
+  if (p < end) {
+    switch (*p | 0x20) {
+    case 'e':
+    case 'd':
+    case 'q':
+      for (++p; p < end && IsBlank(*p); ++p) {
+      }
+      break;
+    default:
+      if (*p != '+' && *p != '-') {
+        return false;
+      }
+    }
+    bool negativeExponent{false};
+    if (p < end && (*p == '+' || *p == '-')) {
+      negativeExponent = *p++ == '-';
+    }
+    bool anyExponentDigit{false};
+    for (; p < end; ++p) {
+      if (*p >= '0' && *p <= '9') {
+        exponent = std::min(10 * exponent + (*p - '0'), 99999999);
+        anyExponentDigit = true;
+      } else if (!IsBlank(*p)) {
+        return false;
+      } else if (zeroBlanks) {
+        exponent = std::min(10 * exponent, 99999999);
+        anyExponentDigit = true;
+      }
+    }
+    if (!anyExponentDigit) {
+      return false;
+    }
+    hasExponent = true;
+    if (negativeExponent) {
+      exponent = -exponent;
+    }
+  }
+  if (!anyDigit && (hasPoint || hasExponent || q > buffer)) {
+    return false;
+  }
+  if (q == digits) {
+    *q++ = '0';  // a zero or blank field
+  }
+  if (sticky) {
+    *q++ = '1';  // between the truncated value and the next one up
+    --zeros;
+  }
+  exponent += zeros - fractionDigits;
+  if (!hasPoint) {
+    exponent -= impliedDigits;
+  }
+  if (!hasExponent) {
+    exponent -= scale;
+  }
+  if (exponent != 0) {
+    q = FormatExponent(q, exponent);
+  }
+  *q = '\0';
+  return true;
+}
+
+template<int binaryPrecision>
+static bool ConvertReal(IoErrorHandler &handler, const char *field,
+    std::size_t length, void *x, const MutableModes &modes, int impliedDigits,
+    int scale) {
+  char buffer[maxRealInputChars + 32];
+  if (!NormalizeRealInput(
+          buffer, field, length, modes, impliedDigits, scale)) {
+    return SignalBadInput(handler, "REAL", field, length);
+  }
+  const char *p{buffer};
+  auto converted{decimal::ConvertToBinary<binaryPrecision>(p, modes.round)};
+  if ((converted.flags & decimal::Invalid) || *p != '\0') {
+    return SignalBadInput(handler, "REAL", field, length);
+  }
+  std::memcpy(x, &converted.binary.raw, sizeof converted.binary.raw);
+  return true;
+}
+
+template<int binaryPrecision>
+bool ConvertRealInputValue(IoErrorHandler &handler, const char *value,
+    std::size_t length, void *x, const MutableModes &modes) {
+  return ConvertReal<binaryPrecision>(handler, value, length, x, modes, 0, 0);
+}
+
+template<int binaryPrecision>
+bool EditRealInput(IoStatementState &io, const DataEdit &edit, void *x) {
+  const char *field{nullptr};
+  std::size_t length{0};
+  switch (edit.descriptor) {
+  case DataEdit::ListDirectedNullValue: return !io.InError();
+  case DataEdit::ListDirected:
+    return GetListDirectedValue(io, edit, field, length) &&
+        ConvertRealInputValue<binaryPrecision>(
+            io.GetIoErrorHandler(), field, length, x, edit.modes);
+  case 'F':
+  case 'E':  // incl. EN, ES, & EX
+  case 'D':
+  case 'G':
+    return GetNumericField(io, edit, field, length) &&
+        ConvertReal<binaryPrecision>(io.GetIoErrorHandler(), field, length, x,
+            edit.modes, edit.digits.value_or(0), edit.modes.scale);
+  case 'B':
+  case 'O':
+  case 'Z':
+    return EditIntegerInput(io, edit, x, binaryPrecision == 24 ? 4 : 8);
+  default:
+    io.GetIoErrorHandler().Crash(
+        "Data edit descriptor '%c' may not be used with a REAL data item",
+        edit.descriptor);
+    return false;
+  }
+}
+
+// (re,im) or (re;im) with DECIMAL='COMMA'; blanks and record boundaries
+// may appear around the parts.
+template<int binaryPrecision>
+bool EditListDirectedComplexInput(
+    IoStatementState &io, const DataEdit &edit, void *x) {
+  if (edit.descriptor == DataEdit::ListDirectedNullValue) {
+    return !io.InError();
+  }
+  auto expect{[&](char ch) {
+    std::optional<char> next{io.NextNonBlank(true)};
+    if (!next || *next != ch) {
+      if (!io.InError()) {
+        io.GetIoErrorHandler().SignalError(FORTRAN_RUNTIME_IOSTAT_BAD_INPUT,
+            "Bad COMPLEX input value: expected '%c'", ch);
+      }
+      return false;
+    }
+    return io.HandleRelativePosition(1);
+  }};
+  auto part{[&](int j) {
+    char *item{reinterpret_cast<char *>(x)};
+    std::size_t partBytes{binaryPrecision == 24 ? 4 : 8};
+    return io.NextNonBlank(true).has_value() &&
+        EditRealInput<binaryPrecision>(io, edit, item + j * partBytes);
+  }};
+  return expect('(') && part(0) &&
+      expect(edit.modes.editingFlags & decimalComma ? ';' : ',') && part(1) &&
+      expect(')');
+}
+
+static bool ConvertLogical(IoErrorHandler &handler, const char *field,
+    std::size_t length, bool &x) {
+  const char *p{field}, *end{field + length};
+  while (p < end && IsBlank(*p)) {
+    ++p;
+  }
+  if (p < end && *p == '.') {
+    ++p;
+  }
+  if (p < end && (*p | 0x20) == 't') {
+    x = true;
+  } else if (p < end && (*p | 0x20) == 'f') {
+    x = false;
+  } else {
+    return SignalBadInput(handler, "LOGICAL", field, length);
+  }
+  return true;  // the rest of the field is ignored
+}
+
+bool EditLogicalInput(IoStatementState &io, const DataEdit &edit, bool &x) {
+  const char *field{nullptr};
+  std::size_t length{0};
+  switch (edit.descriptor) {
+  case DataEdit::ListDirectedNullValue: return !io.InError();
+  case DataEdit::ListDirected:
+    return GetListDirectedValue(io, edit, field, length) &&
+        ConvertLogical(io.GetIoErrorHandler(), field, length, x);
+  case 'L':
+  case 'G':
+    return GetFormattedField(io, edit, std::max(edit.width.value_or(1), 0),
+               field, length) &&
+        ConvertLogical(io.GetIoErrorHandler(), field, length, x);
+  default:
+    io.GetIoErrorHandler().Crash(
+        "Data edit descriptor '%c' may not be used with a LOGICAL data item",
+        edit.descriptor);
+    return false;
+  }
+}
+
+// A list-directed CHARACTER value is either delimited by apostrophes or
+// quotation marks, with doubled delimiters within, and may continue
+// across records; or it is undelimited, and ends at a blank, a value
+// separator, a slash, or the end of the record.
+static bool EditListDirectedDefaultCharacterInput(IoStatementState &io,
+    const DataEdit &edit, char *x, std::size_t length) {
+  std::size_t got{0};
+  auto store{[&](const char *p, std::size_t n) {
+    n = std::min(n, length - got);
+    std::memcpy(x + got, p, n);
+    got += n;
+  }};
+  const char *p{nullptr};
+  std::size_t bytes{io.GetNextInputBytes(p)};
+  if (io.InError()) {
+    return false;
+  }
+  if (bytes > 0 && (*p == '\'' || *p == '"')) {
+    char quote{*p};
+    io.HandleRelativePosition(1);
+    while (true) {
+      bytes = io.GetNextInputBytes(p);
+      if (io.InError()) {
+        return false;
+      }
+      const char *q{static_cast<const char *>(std::memchr(p, quote, bytes))};
+      if (!q) {
+        store(p, bytes);
+        if (!io.HandleRelativePosition(bytes) || !io.AdvanceRecord()) {
+          return false;
+        }
+        continue;
+      }
+      std::size_t n = q - p;
+      store(p, n);
+      if (n + 1 < bytes && q[1] == quote) {
+        store(q, 1);
+        io.HandleRelativePosition(n + 2);
+      } else {
+        io.HandleRelativePosition(n + 1);
+        break;
+      }
+    }
+  } else {
+    char comma{edit.modes.editingFlags & decimalComma ? ';' : ','};
+    std::size_t n{0};
+    while (n < bytes && !IsBlank(p[n]) && p[n] != comma && p[n] != '/') {
+      ++n;
+    }
+    store(p, n);
+    io.HandleRelativePosition(n);
+  }
+  std::fill_n(x + got, length - got, ' ');
+  return true;
+}
+
+bool EditDefaultCharacterInput(
+    IoStatementState &io, const DataEdit &edit, char *x, std::size_t length) {
+  switch (edit.descriptor) {
+  case DataEdit::ListDirectedNullValue: return !io.InError();
+  case DataEdit::ListDirected:
+    return EditListDirectedDefaultCharacterInput(io, edit, x, length);
+  case 'A':
+  case 'G': break;
+  default:
+    io.GetIoErrorHandler().Crash("Data edit descriptor '%c' may not be used "
+                                 "with a CHARACTER data item",
+        edit.descriptor);
+    return false;
+  }
+  // The field is as wide as the item when there's no w.  A wider field
+  // supplies its rightmost characters; a narrower one is padded.
+  std::size_t width{edit.width ? std::max(*edit.width, 0) : length};
+  const char *field{nullptr};
+  std::size_t got{0};
+  if (!GetFormattedField(io, edit, width, field, got)) {
+    return false;
+  }
+  std::size_t skip{width > length ? width - length : 0};
+  std::size_t n{got > skip ? got - skip : 0};
+  std::memcpy(x, field + skip, n);
+  std::fill_n(x + n, length - n, ' ');
+  return true;
+}
+
+template bool EditRealInput<24>(IoStatementState &, const DataEdit &, void *);
+template bool EditRealInput<53>(IoStatementState &, const DataEdit &, void *);
+template bool EditListDirectedComplexInput<24>(
+    IoStatementState &, const DataEdit &, void *);
+template bool EditListDirectedComplexInput<53>(
+    IoStatementState &, const DataEdit &, void *);
+template bool ConvertRealInputValue<24>(IoErrorHandler &, const char *,
+    std::size_t, void *, const MutableModes &);
+template bool ConvertRealInputValue<53>(IoErrorHandler &, const char *,
+    std::size_t, void *, const MutableModes &);
+}
@@ -0,0 +1,63 @@
+//===-- runtime/edit-input.h ------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FORTRAN_RUNTIME_EDIT_INPUT_H_
+#define FORTRAN_RUNTIME_EDIT_INPUT_H_
+
+// Input data editing for INTEGER (I, B, O, Z, and G), REAL (F, E, EN,
+// ES, D, G, and B/O/Z), LOGICAL (L and G), and default CHARACTER (A and
+// G) data items, and list-directed input (13.10.3) of those types and of
+// COMPLEX.  See subclauses in 13.7.2 of Fortran 2018 for the detailed
+// specifications of the edit descriptors.  A list-directed null value
+// leaves its item unchanged.
+// REAL input fields are rewritten into a canonical form and converted
+// by the same decimal-to-binary conversion templates used in the f18
+// front-end.
+
+#include "format.h"
+#include "io-stmt.h"
+#include "flang/decimal/decimal.h"
+
+namespace Fortran::runtime::io {
+
+class IoStatementState;
+
+// These store into an item of the indicated kind.
+bool EditIntegerInput(IoStatementState &, const DataEdit &, void *, int kind);
+template<int binaryPrecision>
+bool EditRealInput(IoStatementState &, const DataEdit &, void *);
+template<int binaryPrecision>
+bool EditListDirectedComplexInput(IoStatementState &, const DataEdit &, void *);
+bool EditLogicalInput(IoStatementState &, const DataEdit &, bool &);
+bool EditDefaultCharacterInput(
+    IoStatementState &, const DataEdit &, char *, std::size_t length);
+
+// Conversions of complete list-directed values that have been scanned
+// in place by ListDirectedStatementState<true>::ScanValueInPlace(), for
+// the fast paths that read runs of array elements.  Errors are signaled
+// to the handler.
+bool ConvertIntegerInputValue(
+    IoErrorHandler &, const char *, std::size_t length, void *, int kind);
+template<int binaryPrecision>
+bool ConvertRealInputValue(IoErrorHandler &, const char *, std::size_t length,
+    void *, const MutableModes &);
+
+extern template bool EditRealInput<24>(
+    IoStatementState &, const DataEdit &, void *);
+extern template bool EditRealInput<53>(
+    IoStatementState &, const DataEdit &, void *);
+extern template bool EditListDirectedComplexInput<24>(
+    IoStatementState &, const DataEdit &, void *);
+extern template bool EditListDirectedComplexInput<53>(
+    IoStatementState &, const DataEdit &, void *);
+extern template bool ConvertRealInputValue<24>(IoErrorHandler &, const char *,
+    std::size_t, void *, const MutableModes &);
+extern template bool ConvertRealInputValue<53>(IoErrorHandler &, const char *,
+    std::size_t, void *, const MutableModes &);
+}
+#endif  // FORTRAN_RUNTIME_EDIT_INPUT_H_
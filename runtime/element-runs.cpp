@@ -0,0 +1,40 @@
+//===-- runtime/element-runs.cpp --------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "element-runs.h"
+
+namespace Fortran::runtime {
+
+ElementRuns::ElementRuns(
+    const Descriptor &descriptor, const int *permutation, const char *base)
+  : base_{const_cast<char *>(
+        base ? base : descriptor.Element<const char>(std::size_t{0}))},
+    elementBytes_{descriptor.ElementBytes()} {
+  extent_[0] = 1;
+  byteStride_[0] = elementBytes_;
+  int n{0};  // dimensions so far, when positive
+  for (int j{0}; j < descriptor.rank(); ++j) {
+    const Dimension &dim{
+        descriptor.GetDimension(permutation ? permutation[j] : j)};
+    SubscriptValue extent{dim.Extent()};
+    elements_ *= extent;
+    if (extent == 1) {
+      continue;  // its stride doesn't matter
+    }
+    if (n > 0 &&
+        dim.ByteStride() == extent_[n - 1] * byteStride_[n - 1]) {
+      extent_[n - 1] *= extent;  // collapse it into the last
+    } else {
+      extent_[n] = extent;
+      byteStride_[n] = dim.ByteStride();
+      ++n;
+    }
+  }
+  dimensions_ = n > 0 ? n : 1;
+}
+}
@@ -0,0 +1,87 @@
+//===-- runtime/element-runs.h ----------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Traversal of the elements of an array described by a Descriptor as
+// runs of elements at a constant byte stride, rather than one element at
+// a time by subscripts.  Adjacent dimensions are collapsed into one
+// whenever the stride of the second is the extent of the first times its
+// stride, so that a contiguous array, or a section that is contiguous in
+// its leading dimensions, yields long runs that may be moved with
+// memcpy(); a section with a constant stride yields runs for a tight
+// strided loop.  An optional permutation of the dimensions, as with
+// Descriptor::IncrementSubscripts(), gives the traversal order; then only
+// dimensions that are adjacent in the permuted order are collapsed.
+
+#ifndef FORTRAN_RUNTIME_ELEMENT_RUNS_H_
+#define FORTRAN_RUNTIME_ELEMENT_RUNS_H_
+
+#include "descriptor.h"
+#include <cstddef>
+
+namespace Fortran::runtime {
+
+class ElementRuns {
+public:
+  // Dimension permutation[0] varies most rapidly, then permutation[1],
+  // &c.; the default is array element order.  The elements may be
+  // located at another base address with the same layout.
+  explicit ElementRuns(const Descriptor &, const int *permutation = nullptr,
+      const char *base = nullptr);
+
+  std::size_t elements() const { return elements_; }
+  // The number of dimensions after collapsing; 1 for a scalar
+  int dimensions() const { return dimensions_; }
+  std::size_t runLength() const { return extent_[0]; }
+  std::ptrdiff_t runByteStride() const { return byteStride_[0]; }
+  // The whole traversal is a single run of adjacent elements.
+  bool IsContiguous() const {
+    return dimensions_ == 1 &&
+        (elements_ <= 1 ||
+            byteStride_[0] == static_cast<std::ptrdiff_t>(elementBytes_));
+  }
+
+  // Calls run(first, count, byteStride) for each run in order, until it
+  // returns false; returns false in that case.
+  template<typename RUN> bool ForEachRun(RUN run) const {
+    if (elements_ == 0) {
+      return true;
+    }
+    std::size_t runs{elements_ / extent_[0]};
+    if (runs == 1) {
+      return run(base_, extent_[0], byteStride_[0]);
+    }
+    SubscriptValue subscript[maxRank]{};
+    char *first{base_};
+    for (std::size_t j{0}; j < runs; ++j) {
+      if (!run(first, extent_[0], byteStride_[0])) {
+        return false;
+      }
+      // Advance to the next run; each step back to the start of an
+      // exhausted dimension is undone by a step in the next one.
+      for (int k{1}; k < dimensions_; ++k) {
+        first += byteStride_[k];
+        if (++subscript[k] < extent_[k]) {
+          break;
+        }
+        first -= extent_[k] * byteStride_[k];
+        subscript[k] = 0;
+      }
+    }
+    return true;
+  }
+
+private:
+  char *base_;
+  std::size_t elementBytes_;
+  std::size_t elements_{1};
+  int dimensions_{1};
+  SubscriptValue extent_[maxRank];
+  std::ptrdiff_t byteStride_[maxRank];
+};
+}
+#endif  // FORTRAN_RUNTIME_ELEMENT_RUNS_H_
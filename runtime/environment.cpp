@@ -7,13 +7,30 @@
 //===----------------------------------------------------------------------===//
 
 #include "environment.h"
+#include "buffer.h"
+#include "reduction.h"
+#include "tools.h"
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <limits>
 
 namespace Fortran::runtime {
 ExecutionEnvironment executionEnvironment;
 
+static void GetByteCount(const char *name, std::size_t &bytes) {
+  if (auto *x{std::getenv(name)}) {
+    char *end;
+    auto n{std::strtoll(x, &end, 10)};
+    if (n > 0 && *end == '\0') {
+      bytes = n;
+    } else {
+      std::fprintf(
+          stderr, "Fortran runtime: %s=%s is invalid; ignored\n", name, x);
+    }
+  }
+}
+
 void ExecutionEnvironment::Configure(
     int ac, const char *av[], const char *env[]) {
   argc = ac;
@@ -34,6 +51,101 @@ void ExecutionEnvironment::Configure(
     }
   }
 
+  buffering = io::Buffering::Default;
+  if (auto *x{std::getenv("FORT_BUFFERING")}) {
+    static const char *keywords[]{
+        "UNBUFFERED", "LINE", "FULL", "BACKGROUND", nullptr};
+    switch (IdentifyValue(x, std::strlen(x), keywords)) {
+    case 0: buffering = io::Buffering::Unbuffered; break;
+    case 1: buffering = io::Buffering::Line; break;
+    case 2: buffering = io::Buffering::Full; break;
+    case 3: buffering = io::Buffering::Background; break;
+    default:
+      std::fprintf(stderr,
+          "Fortran runtime: FORT_BUFFERING=%s is invalid; ignored\n", x);
+    }
+  }
+  bufferBytes = 0;
+  GetByteCount("FORT_BUFFER_SIZE", bufferBytes);
+  flushThreshold = 0;
+  GetByteCount("FORT_FLUSH_THRESHOLD", flushThreshold);
+  maxSubrecordBytes = 0;
+  GetByteCount("FORT_MAX_SUBRECORD_LENGTH", maxSubrecordBytes);
+
+  fileSchemes = 0;
+  if (auto *x{std::getenv("FORT_FILE_SCHEMES")}) {
+    static const char *keywords[]{"MEM", "GZIP", "ZSTD", nullptr};
+    for (const char *p{x}; *p;) {
+      std::size_t length{std::strcspn(p, ",")};
+      int which{IdentifyValue(p, length, keywords)};
+      if (which >= 0) {
+        fileSchemes |= 1u << (which + 1);  // io::Storage::Posix is 0
+      } else {
+        std::fprintf(stderr,
+            "Fortran runtime: FORT_FILE_SCHEMES=%s: '%.*s' is invalid; "
+            "ignored\n",
+            x, static_cast<int>(length), p);
+      }
+      p += length + (p[length] == ',');
+    }
+  }
+
+  ioStatistics = false;
+  if (auto *x{std::getenv("FORT_IO_STATS")}) {
+    ioStatistics = std::strcmp(x, "0") != 0 && *x != '\0';
+  }
+  ioStatisticsFile = std::getenv("FORT_IO_STATS_FILE");
+  if (ioStatisticsFile) {
+    if (*ioStatisticsFile == '\0') {
+      ioStatisticsFile = nullptr;
+    } else {
+      ioStatistics = true;
+    }
+  }
+  ioCounters = false;
+  if (auto *x{std::getenv("FORT_IO_COUNTERS")}) {
+    ioCounters = std::strcmp(x, "0") != 0 && *x != '\0';
+  }
+
+  summation = Summation::Pairwise;
+  if (auto *x{std::getenv("FORT_SUMMATION")}) {
+    static const char *keywords[]{"PAIRWISE", "KAHAN", "SEQUENTIAL", nullptr};
+    switch (IdentifyValue(x, std::strlen(x), keywords)) {
+    case 0: summation = Summation::Pairwise; break;
+    case 1: summation = Summation::Kahan; break;
+    case 2: summation = Summation::Sequential; break;
+    default:
+      std::fprintf(stderr,
+          "Fortran runtime: FORT_SUMMATION=%s is invalid; ignored\n", x);
+    }
+  }
+
+  matmulThreads = 0;
+  if (auto *x{std::getenv("FORT_MATMUL_THREADS")}) {
+    char *end;
+    auto n{std::strtol(x, &end, 10)};
+    if (n > 0 && n < std::numeric_limits<int>::max() && *end == '\0') {
+      matmulThreads = n;
+    } else {
+      std::fprintf(stderr,
+          "Fortran runtime: FORT_MATMUL_THREADS=%s is invalid; ignored\n", x);
+    }
+  }
+
+  arrayAlignment = 0;
+  GetByteCount("FORT_ARRAY_ALIGNMENT", arrayAlignment);
+  if (arrayAlignment > 4096 || (arrayAlignment & (arrayAlignment - 1))) {
+    std::fprintf(stderr,
+        "Fortran runtime: FORT_ARRAY_ALIGNMENT=%zd is not a power of two "
+        "up to 4096; ignored\n",
+        arrayAlignment);
+    arrayAlignment = 0;
+  }
+  memoryStatistics = false;
+  if (auto *x{std::getenv("FORT_MEMORY_STATS")}) {
+    memoryStatistics = std::strcmp(x, "0") != 0 && *x != '\0';
+  }
+
   // TODO: Set RP/ROUND='PROCESSOR_DEFINED' from environment
 }
 }
@@ -10,8 +10,14 @@
 #define FORTRAN_RUNTIME_ENVIRONMENT_H_
 
 #include "flang/decimal/decimal.h"
+#include <cstddef>
 
 namespace Fortran::runtime {
+namespace io {
+enum class Buffering;  // see buffer.h
+}
+enum class Summation;  // see reduction.h
+
 struct ExecutionEnvironment {
   void Configure(int argc, const char *argv[], const char *envp[]);
 
@@ -20,6 +26,25 @@ struct ExecutionEnvironment {
   const char **envp;
   int listDirectedOutputLineLengthLimit;
   enum decimal::FortranRounding defaultOutputRoundingMode;
+  // Defaults for the buffering of external units; 0 values are unset
+  io::Buffering buffering;  // FORT_BUFFERING=UNBUFFERED, LINE, FULL, ...
+  std::size_t bufferBytes;  // FORT_BUFFER_SIZE
+  std::size_t flushThreshold;  // FORT_FLUSH_THRESHOLD
+  // Of unformatted sequential subrecords; 0 is unset
+  std::size_t maxSubrecordBytes;  // FORT_MAX_SUBRECORD_LENGTH
+  // FILE= name schemes, one bit for each io::Storage (see storage.h)
+  unsigned fileSchemes;  // FORT_FILE_SCHEMES=MEM,GZIP,ZSTD
+  // Statistics of external I/O (see io-stats.h)
+  bool ioStatistics;  // FORT_IO_STATS=1
+  const char *ioStatisticsFile;  // FORT_IO_STATS_FILE; else to stderr
+  bool ioCounters;  // FORT_IO_COUNTERS=1: report each unit's at CLOSE
+  // Of REAL and COMPLEX SUM and DOT_PRODUCT
+  Summation summation;  // FORT_SUMMATION=PAIRWISE, KAHAN, SEQUENTIAL
+  // Threads of a large MATMUL; 0 and 1 are serial
+  std::size_t matmulThreads;  // FORT_MATMUL_THREADS
+  // Of array data, a power of two; 0 is unset (see memory.h)
+  std::size_t arrayAlignment;  // FORT_ARRAY_ALIGNMENT
+  bool memoryStatistics;  // FORT_MEMORY_STATS=1
 };
 extern ExecutionEnvironment executionEnvironment;
 }
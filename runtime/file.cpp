@@ -12,7 +12,12 @@
 #include <cerrno>
 #include <cstring>
 #include <fcntl.h>
+#include <limits>
+#include <new>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace Fortran::runtime::io {
@@ -20,6 +25,7 @@ namespace Fortran::runtime::io {
 void OpenFile::set_path(OwningPtr<char> &&path, std::size_t bytes) {
   path_ = std::move(path);
   pathLength_ = bytes;
+  storage_ = IdentifyStorage(path_.get(), pathLength_);
 }
 
 void OpenFile::Open(
@@ -45,6 +51,7 @@ void OpenFile::Open(
       }
       ::unlink(path);
     }
+    ExamineFile();
     return;
   case OpenStatus::Replace: flags |= O_CREAT | O_TRUNC; break;
   case OpenStatus::Unknown:
@@ -56,6 +63,7 @@ void OpenFile::Open(
   }
   // If we reach this point, we're opening a new file
   if (fd_ >= 0) {
+    WaitAll(handler);
     if (fd_ <= 2) {
       // don't actually close a standard file descriptor, we might need it
     } else if (::close(fd_) != 0) {
@@ -66,16 +74,24 @@ void OpenFile::Open(
     handler.Crash(
         "FILE= is required unless STATUS='OLD' and unit is connected");
   }
+  if (storage_ == Storage::Memory && (flags & O_ACCMODE) == O_WRONLY &&
+      !(flags & (O_TRUNC | O_EXCL))) {
+    flags = (flags & ~O_ACCMODE) | O_RDWR;  // to load the old contents
+  }
   fd_ = ::open(path_.get(), flags, 0600);
   if (fd_ < 0) {
     handler.SignalErrno();
+    storage_ = Storage::Posix;
+    return;
   }
-  pending_.reset();
   knownSize_.reset();
   if (position == Position::Append && !RawSeekToEnd()) {
     handler.SignalErrno();
   }
-  isTerminal_ = ::isatty(fd_) == 1;
+  ExamineFile();
+  if (storage_ != Storage::Posix) {
+    OpenStorage(handler);
+  }
 }
 
 void OpenFile::Predefine(int fd) {
@@ -85,15 +101,22 @@ void OpenFile::Predefine(int fd) {
   pathLength_ = 0;
   position_ = 0;
   knownSize_.reset();
+  storage_ = Storage::Posix;
   nextId_ = 0;
-  pending_.reset();
+  ExamineFile();
+  // The descriptor may not be positioned at the start
+  mayMap_ = false;
+  mayPosition_ = false;
 }
 
 void OpenFile::Close(CloseStatus status, IoErrorHandler &handler) {
+  WaitAll(handler);
   CriticalSection criticalSection{lock_};
   CheckOpen(handler);
-  pending_.reset();
   knownSize_.reset();
+  if (storage_ != Storage::Posix) {
+    CloseStorage(status, handler);
+  }
   switch (status) {
   case CloseStatus::Keep: break;
   case CloseStatus::Delete:
@@ -103,6 +126,7 @@ void OpenFile::Close(CloseStatus status, IoErrorHandler &handler) {
     break;
   }
   path_.reset();
+  mayMap_ = false;
   if (fd_ >= 0) {
     if (::close(fd_) != 0) {
       handler.SignalErrno();
@@ -111,24 +135,21 @@ void OpenFile::Close(CloseStatus status, IoErrorHandler &handler) {
   }
 }
 
-std::size_t OpenFile::Read(FileOffset at, char *buffer, std::size_t minBytes,
-    std::size_t maxBytes, IoErrorHandler &handler) {
-  if (maxBytes == 0) {
-    return 0;
-  }
-  CriticalSection criticalSection{lock_};
-  CheckOpen(handler);
-  if (!Seek(at, handler)) {
-    return 0;
-  }
-  if (maxBytes < minBytes) {
-    minBytes = maxBytes;
-  }
-  std::size_t got{0};
-  while (got < minBytes) {
-    auto chunk{::read(fd_, buffer + got, maxBytes - got)};
+// Repeats a transfer until at least minBytes have been moved, retrying
+// after EAGAIN, EWOULDBLOCK, and EINTR; returns the bytes moved.  A write
+// that moves nothing would never finish, and is an error.
+template<typename TRANSFER>
+static std::size_t Repeat(std::size_t minBytes, bool isRead,
+    IoErrorHandler &handler, TRANSFER transfer) {
+  std::size_t done{0};
+  while (done < minBytes) {
+    auto chunk{transfer(done)};
     if (chunk == 0) {
-      handler.SignalEnd();
+      if (isRead) {
+        handler.SignalEnd();
+      } else {
+        handler.SignalError(EIO);
+      }
       break;
     }
     if (chunk < 0) {
@@ -138,10 +159,52 @@ std::size_t OpenFile::Read(FileOffset at, char *buffer, std::size_t minBytes,
         break;
       }
     } else {
-      position_ += chunk;
-      got += chunk;
+      done += chunk;
     }
   }
+  return done;
+}
+
+std::size_t OpenFile::Read(FileOffset at, char *buffer, std::size_t minBytes,
+    std::size_t maxBytes, IoErrorHandler &handler) {
+  if (maxBytes == 0) {
+    return 0;
+  }
+  if (maxBytes < minBytes) {
+    minBytes = maxBytes;
+  }
+  IoStatisticsTimer timer{statistics_.transferTime};
+  if (storage_ == Storage::Memory) {
+    CriticalSection criticalSection{lock_};
+    CheckOpen(handler);
+    std::size_t got{memory_.Read(at, buffer, minBytes, maxBytes, handler)};
+    statistics_.bytesRead.fetch_add(got, std::memory_order_relaxed);
+    return got;
+  }
+#if _XOPEN_SOURCE >= 500 || _POSIX_C_SOURCE >= 200809L
+  if (mayPosition_) {
+    // Positional reads neither use nor move the file position, so they
+    // need no lock and may proceed concurrently.
+    CheckOpen(handler);
+    std::size_t got{Repeat(minBytes, true, handler, [&](std::size_t done) {
+      statistics_.readCalls.fetch_add(1, std::memory_order_relaxed);
+      return ::pread(fd_, buffer + done, maxBytes - done, at + done);
+    })};
+    statistics_.bytesRead.fetch_add(got, std::memory_order_relaxed);
+    return got;
+  }
+#endif
+  CriticalSection criticalSection{lock_};
+  CheckOpen(handler);
+  if (!Seek(at, handler)) {
+    return 0;
+  }
+  std::size_t got{Repeat(minBytes, true, handler, [&](std::size_t done) {
+    statistics_.readCalls.fetch_add(1, std::memory_order_relaxed);
+    return ::read(fd_, buffer + done, maxBytes - done);
+  })};
+  position_ += got;
+  statistics_.bytesRead.fetch_add(got, std::memory_order_relaxed);
   return got;
 }
 
@@ -150,35 +213,117 @@ std::size_t OpenFile::Write(FileOffset at, const char *buffer,
   if (bytes == 0) {
     return 0;
   }
+  IoStatisticsTimer timer{statistics_.transferTime};
+  std::size_t put;
+  if (storage_ == Storage::Memory) {
+    CriticalSection criticalSection{lock_};
+    CheckOpen(handler);
+    put = memory_.Write(at, buffer, bytes, handler);
+    statistics_.bytesWritten.fetch_add(put, std::memory_order_relaxed);
+    return put;
+  }
+#if _XOPEN_SOURCE >= 500 || _POSIX_C_SOURCE >= 200809L
+  if (mayPosition_) {
+    CheckOpen(handler);
+    put = Repeat(bytes, false, handler, [&](std::size_t done) {
+      statistics_.writeCalls.fetch_add(1, std::memory_order_relaxed);
+      return ::pwrite(fd_, buffer + done, bytes - done, at + done);
+    });
+    statistics_.bytesWritten.fetch_add(put, std::memory_order_relaxed);
+    CriticalSection criticalSection{lock_};
+    if (knownSize_ && at + static_cast<FileOffset>(put) > *knownSize_) {
+      knownSize_ = at + put;
+    }
+    return put;
+  }
+#endif
   CriticalSection criticalSection{lock_};
   CheckOpen(handler);
   if (!Seek(at, handler)) {
     return 0;
   }
-  std::size_t put{0};
-  while (put < bytes) {
-    auto chunk{::write(fd_, buffer + put, bytes - put)};
-    if (chunk >= 0) {
-      position_ += chunk;
-      put += chunk;
-    } else {
-      auto err{errno};
-      if (err != EAGAIN && err != EWOULDBLOCK && err != EINTR) {
-        handler.SignalError(err);
-        break;
-      }
+  FilterWriteGuard guard{filter_ >= 0};
+  put = Repeat(bytes, false, handler, [&](std::size_t done) {
+    statistics_.writeCalls.fetch_add(1, std::memory_order_relaxed);
+    return ::write(fd_, buffer + done, bytes - done);
+  });
+  position_ += put;
+  if (knownSize_ && position_ > *knownSize_) {
+    knownSize_ = position_;
+  }
+  statistics_.bytesWritten.fetch_add(put, std::memory_order_relaxed);
+  return put;
+}
+
+std::size_t OpenFile::Write(FileOffset at, const char *first,
+    std::size_t firstBytes, const char *second, std::size_t secondBytes,
+    IoErrorHandler &handler) {
+  if (secondBytes == 0 || storage_ == Storage::Memory) {
+    std::size_t put{Write(at, first, firstBytes, handler)};
+    if (put < firstBytes) {
+      return put;
+    }
+    return put + Write(at + put, second, secondBytes, handler);
+  }
+  IoStatisticsTimer timer{statistics_.transferTime};
+  std::size_t bytes{firstBytes + secondBytes};
+  // Returns the pieces that remain after the first done bytes
+  auto pieces{[&](std::size_t done, struct iovec (&iov)[2]) {
+    if (done < firstBytes) {
+      iov[0].iov_base = const_cast<char *>(first + done);
+      iov[0].iov_len = firstBytes - done;
+      iov[1].iov_base = const_cast<char *>(second);
+      iov[1].iov_len = secondBytes;
+      return 2;
     }
+    iov[0].iov_base = const_cast<char *>(second + (done - firstBytes));
+    iov[0].iov_len = bytes - done;
+    return 1;
+  }};
+  std::size_t put;
+#ifdef __linux__
+  if (mayPosition_) {
+    CheckOpen(handler);
+    put = Repeat(bytes, false, handler, [&](std::size_t done) {
+      struct iovec iov[2];
+      int count{pieces(done, iov)};
+      statistics_.writeCalls.fetch_add(1, std::memory_order_relaxed);
+      return ::pwritev(fd_, iov, count, at + done);
+    });
+    statistics_.bytesWritten.fetch_add(put, std::memory_order_relaxed);
+    CriticalSection criticalSection{lock_};
+    if (knownSize_ && at + static_cast<FileOffset>(put) > *knownSize_) {
+      knownSize_ = at + put;
+    }
+    return put;
+  }
+#endif
+  CriticalSection criticalSection{lock_};
+  CheckOpen(handler);
+  if (!Seek(at, handler)) {
+    return 0;
   }
+  FilterWriteGuard guard{filter_ >= 0};
+  put = Repeat(bytes, false, handler, [&](std::size_t done) {
+    struct iovec iov[2];
+    int count{pieces(done, iov)};
+    statistics_.writeCalls.fetch_add(1, std::memory_order_relaxed);
+    return ::writev(fd_, iov, count);
+  });
+  position_ += put;
   if (knownSize_ && position_ > *knownSize_) {
     knownSize_ = position_;
   }
+  statistics_.bytesWritten.fetch_add(put, std::memory_order_relaxed);
   return put;
 }
 
 void OpenFile::Truncate(FileOffset at, IoErrorHandler &handler) {
   CriticalSection criticalSection{lock_};
   CheckOpen(handler);
-  if (!knownSize_ || *knownSize_ != at) {
+  if (storage_ == Storage::Memory) {
+    memory_.Truncate(at);
+  } else if (!knownSize_ || *knownSize_ != at) {
     if (::ftruncate(fd_, at) != 0) {
       handler.SignalErrno();
     }
@@ -186,107 +331,298 @@ void OpenFile::Truncate(FileOffset at, IoErrorHandler &handler) {
   }
 }
 
-// The operation is performed immediately; the results are saved
-// to be claimed by a later WAIT statement.
-// TODO: True asynchronicity
-int OpenFile::ReadAsynchronously(
-    FileOffset at, char *buffer, std::size_t bytes, IoErrorHandler &handler) {
+bool OpenFile::MapRegion(FileOffset at, std::size_t bytes, bool sequential,
+    MappedRegion &region, IoErrorHandler &handler) {
   CriticalSection criticalSection{lock_};
   CheckOpen(handler);
-  int iostat{0};
-  for (std::size_t got{0}; got < bytes;) {
-#if _XOPEN_SOURCE >= 500 || _POSIX_C_SOURCE >= 200809L
-    auto chunk{::pread(fd_, buffer + got, bytes - got, at)};
+  IoStatisticsTimer timer{statistics_.transferTime};
+  struct stat buf;
+  if (::fstat(fd_, &buf) != 0) {
+    mayMap_ = false;
+    return false;
+  }
+  static const FileOffset pageSize{::sysconf(_SC_PAGESIZE)};
+  FileOffset start{at - at % pageSize};
+  std::size_t length{bytes + static_cast<std::size_t>(at - start)};
+#ifdef _LARGEFILE64_SOURCE
+  void *p{::mmap64(nullptr, length, PROT_READ, MAP_PRIVATE, fd_, start)};
 #else
-    auto chunk{Seek(at, handler) ? ::read(fd_, buffer + got, bytes - got) : -1};
+  void *p{::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd_, start)};
 #endif
-    if (chunk == 0) {
-      iostat = FORTRAN_RUNTIME_IOSTAT_END;
-      break;
+  if (p == MAP_FAILED) {
+    mayMap_ = false;
+    return false;
+  }
+  ::posix_madvise(
+      p, length, sequential ? POSIX_MADV_SEQUENTIAL : POSIX_MADV_RANDOM);
+  knownSize_ = buf.st_size;
+  region.base = static_cast<char *>(p);
+  region.fileOffset = start;
+  region.bytes = length;
+  region.valid = buf.st_size <= start
+      ? 0
+      : std::min<std::size_t>(length, buf.st_size - start);
+  statistics_.readCalls.fetch_add(1, std::memory_order_relaxed);
+  statistics_.bytesRead.fetch_add(region.valid, std::memory_order_relaxed);
+  return true;
+}
+
+void OpenFile::UnmapRegion(MappedRegion &region) {
+  if (region.base) {
+    ::munmap(region.base, region.bytes);
+    region = MappedRegion{};
+  }
+}
+
+// Asynchronous transfers are performed by a small pool of detached worker
+// threads, created on demand, that live for the rest of the program.
+// If no thread can be started, transfers are performed immediately.
+struct AsynchronousRequest {
+  OpenFile &file;
+  int id;
+  bool isRead;
+  OpenFile::FileOffset at;
+  char *buffer;
+  std::size_t bytes;
+  AsynchronousRequest *next{nullptr};
+};
+
+class AsynchronousIoPool {
+public:
+  static constexpr int maxWorkers{4};
+
+  void Submit(AsynchronousRequest &);
+  static void Perform(AsynchronousRequest &);
+
+private:
+  static void *Worker(void *);
+  bool StartWorker();  // lock_ must be held
+
+  Lock lock_;
+  ConditionVariable work_;
+  AsynchronousRequest *head_{nullptr}, *tail_{nullptr};
+  int workers_{0}, idle_{0};
+};
+
+// Never destroyed, as idle workers may be waiting on it at program exit
+alignas(AsynchronousIoPool) static char
+    asynchronousIoPoolStorage[sizeof(AsynchronousIoPool)];
+static AsynchronousIoPool &asynchronousIoPool{
+    *new (asynchronousIoPoolStorage) AsynchronousIoPool};
+
+void AsynchronousIoPool::Submit(AsynchronousRequest &request) {
+  {
+    CriticalSection criticalSection{lock_};
+    if (idle_ > 0 || StartWorker() || workers_ > 0) {
+      if (tail_) {
+        tail_->next = &request;
+      } else {
+        head_ = &request;
+      }
+      tail_ = &request;
+      work_.Signal();
+      return;
     }
-    if (chunk < 0) {
-      auto err{errno};
-      if (err != EAGAIN && err != EWOULDBLOCK && err != EINTR) {
-        iostat = err;
-        break;
+  }
+  Perform(request);
+}
+
+bool AsynchronousIoPool::StartWorker() {
+  pthread_t thread;
+  if (workers_ < maxWorkers &&
+      ::pthread_create(&thread, nullptr, &Worker, this) == 0) {
+    ::pthread_detach(thread);
+    ++workers_;
+    return true;
+  } else {
+    return false;
+  }
+}
+
+void *AsynchronousIoPool::Worker(void *arg) {
+  auto &pool{*static_cast<AsynchronousIoPool *>(arg)};
+  while (true) {
+    AsynchronousRequest *request;
+    {
+      CriticalSection criticalSection{pool.lock_};
+      while (!pool.head_) {
+        ++pool.idle_;
+        pool.work_.Wait(pool.lock_);
+        --pool.idle_;
+      }
+      request = pool.head_;
+      if (!(pool.head_ = request->next)) {
+        pool.tail_ = nullptr;
       }
-    } else {
-      at += chunk;
-      got += chunk;
     }
+    Perform(*request);
   }
-  return PendingResult(handler, iostat);
+  return nullptr;
 }
 
-// TODO: True asynchronicity
-int OpenFile::WriteAsynchronously(FileOffset at, const char *buffer,
-    std::size_t bytes, IoErrorHandler &handler) {
-  CriticalSection criticalSection{lock_};
-  CheckOpen(handler);
-  int iostat{0};
-  for (std::size_t put{0}; put < bytes;) {
+// Runs on a worker thread (or in place); frees the request.
+void AsynchronousIoPool::Perform(AsynchronousRequest &request) {
+  OpenFile &file{request.file};
+  IoStatistics &statistics{file.statistics_};
+  auto at{request.at};
+  int ioStat{0};
+  std::size_t done{0};
+  {
+    // The file may be closed once the transfer is complete.
+    IoStatisticsTimer timer{statistics.transferTime};
+    while (done < request.bytes) {
+      char *buffer{request.buffer + done};
+      std::size_t bytes{request.bytes - done};
+      (request.isRead ? statistics.readCalls : statistics.writeCalls)
+          .fetch_add(1, std::memory_order_relaxed);
 #if _XOPEN_SOURCE >= 500 || _POSIX_C_SOURCE >= 200809L
-    auto chunk{::pwrite(fd_, buffer + put, bytes - put, at)};
+      auto chunk{request.isRead ? ::pread(file.fd_, buffer, bytes, at)
+                                : ::pwrite(file.fd_, buffer, bytes, at)};
 #else
-    auto chunk{
-        Seek(at, handler) ? ::write(fd_, buffer + put, bytes - put) : -1};
+      decltype(::read(file.fd_, buffer, bytes)) chunk{-1};
+      {
+        CriticalSection criticalSection{file.lock_};
+        if (file.RawSeek(at)) {
+          chunk = request.isRead ? ::read(file.fd_, buffer, bytes)
+                                 : ::write(file.fd_, buffer, bytes);
+        }
+        file.position_ = at + (chunk > 0 ? chunk : 0);
+      }
 #endif
-    if (chunk >= 0) {
-      at += chunk;
-      put += chunk;
-    } else {
-      auto err{errno};
-      if (err != EAGAIN && err != EWOULDBLOCK && err != EINTR) {
-        iostat = err;
+      if (chunk == 0) {  // as in Repeat()
+        ioStat = request.isRead ? FORTRAN_RUNTIME_IOSTAT_END : EIO;
         break;
       }
+      if (chunk < 0) {
+        auto err{errno};
+        if (err != EAGAIN && err != EWOULDBLOCK && err != EINTR) {
+          ioStat = err;
+          break;
+        }
+      } else {
+        at += chunk;
+        done += chunk;
+        (request.isRead ? statistics.bytesRead : statistics.bytesWritten)
+            .fetch_add(chunk, std::memory_order_relaxed);
+      }
     }
   }
-  return PendingResult(handler, iostat);
+  int id{request.id};
+  FreeMemory(&request);
+  file.CompletePending(id, ioStat, done);
 }
 
-void OpenFile::Wait(int id, IoErrorHandler &handler) {
-  std::optional<int> ioStat;
+int OpenFile::ReadAsynchronously(
+    FileOffset at, char *buffer, std::size_t bytes, IoErrorHandler &handler) {
+  return StartAsynchronously(at, buffer, bytes, true, handler);
+}
+
+int OpenFile::WriteAsynchronously(FileOffset at, const char *buffer,
+    std::size_t bytes, IoErrorHandler &handler) {
+  // The buffer is only read
+  return StartAsynchronously(
+      at, const_cast<char *>(buffer), bytes, false, handler);
+}
+
+int OpenFile::FailAsynchronously(int ioStat, IoErrorHandler &handler) {
+  int id;
   {
-    CriticalSection criticalSection{lock_};
-    Pending *prev{nullptr};
-    for (Pending *p{pending_.get()}; p; p = (prev = p)->next.get()) {
-      if (p->id == id) {
-        ioStat = p->ioStat;
-        if (prev) {
-          prev->next.reset(p->next.release());
-        } else {
-          pending_.reset(p->next.release());
-        }
-        break;
-      }
-    }
+    CriticalSection criticalSection{pendingLock_};
+    id = StartPending(handler);
   }
-  if (ioStat) {
-    handler.SignalError(*ioStat);
+  CompletePending(id, ioStat, 0);
+  return id;
+}
+
+std::size_t OpenFile::Wait(int id, IoErrorHandler &handler) {
+  CriticalSection criticalSection{pendingLock_};
+  if (Pending * p{WaitForPending(id)}) {
+    std::size_t bytes{p->bytes};
+    handler.SignalError(ReleasePending(*p));
+    return bytes;
   }
+  return 0;
 }
 
 void OpenFile::WaitAll(IoErrorHandler &handler) {
-  while (true) {
-    int ioStat;
-    {
-      CriticalSection criticalSection{lock_};
-      if (pending_) {
-        ioStat = pending_->ioStat;
-        pending_.reset(pending_->next.release());
-      } else {
-        return;
-      }
+  CriticalSection criticalSection{pendingLock_};
+  while (runningCount_ > 0) {
+    pendingDone_.Wait(pendingLock_);
+  }
+  for (int j{0}; j < pendingCapacity_; ++j) {
+    if (Pending & p{pending_.get()[j]}; p.id >= 0) {
+      handler.SignalError(ReleasePending(p));
     }
-    handler.SignalError(ioStat);
   }
+  handler.SignalError(unwaitedIoStat_);
+  unwaitedIoStat_ = 0;
 }
 
 void OpenFile::CheckOpen(const Terminator &terminator) {
   RUNTIME_CHECK(terminator, fd_ >= 0);
 }
 
+void OpenFile::ExamineFile() {
+  isTerminal_ = ::isatty(fd_) == 1;
+  struct stat buf;
+  if (::fstat(fd_, &buf) == 0) {
+    mayMap_ = mayRead_ && !mayWrite_ && S_ISREG(buf.st_mode);
+    mayPosition_ = S_ISREG(buf.st_mode);
+    blockSize_ = buf.st_blksize > 0 ? buf.st_blksize : 0;
+  } else {
+    mayMap_ = false;
+    mayPosition_ = false;
+    blockSize_ = 0;
+  }
+}
+
+// Completes the connection to a store other than the file descriptor.
+void OpenFile::OpenStorage(IoErrorHandler &handler) {
+  if (storage_ == Storage::Memory) {
+    if (!memory_.Load(fd_, handler)) {
+      ::close(fd_);
+      fd_ = -1;
+      storage_ = Storage::Posix;
+      return;
+    }
+    mayMap_ = false;
+    mayPosition_ = true;
+    isTerminal_ = false;
+    return;
+  }
+  if (mayRead_ && mayWrite_) {
+    handler.SignalError(EINVAL,
+        "A compressed file may be opened for reading or for writing, "
+        "but not both");
+    ::close(fd_);
+    fd_ = -1;
+  } else {
+    fd_ = StartFilter(storage_, fd_, mayRead_, filter_, handler);
+  }
+  if (fd_ < 0) {
+    storage_ = Storage::Posix;
+    return;
+  }
+  ExamineFile();  // a pipe
+}
+
+void OpenFile::CloseStorage(CloseStatus status, IoErrorHandler &handler) {
+  if (storage_ == Storage::Memory) {
+    if (status == CloseStatus::Keep && mayWrite_) {
+      memory_.Save(fd_, handler);
+    }
+    memory_.Release();
+  } else {
+    if (::close(fd_) != 0) {
+      handler.SignalErrno();
+    }
+    fd_ = -1;
+    FinishFilter(filter_, mayRead_, handler);
+    filter_ = -1;
+  }
+  storage_ = Storage::Posix;
+}
+
 bool OpenFile::Seek(FileOffset at, IoErrorHandler &handler) {
   if (at == position_) {
     return true;
@@ -321,9 +657,108 @@ bool OpenFile::RawSeekToEnd() {
   }
 }
 
-int OpenFile::PendingResult(const Terminator &terminator, int iostat) {
-  int id{nextId_++};
-  pending_.reset(&New<Pending>{}(terminator, id, iostat, std::move(pending_)));
+int OpenFile::StartAsynchronously(FileOffset at, char *buffer,
+    std::size_t bytes, bool isRead, IoErrorHandler &handler) {
+  {
+    CriticalSection criticalSection{lock_};
+    CheckOpen(handler);
+  }
+  int id;
+  {
+    CriticalSection criticalSection{pendingLock_};
+    id = StartPending(handler);
+  }
+  if (storage_ == Storage::Memory) {
+    // Completes at once; any error is reported by the WAIT
+    IoErrorHandler probe{handler};
+    probe.HasIoStat();
+    probe.HasEndLabel();
+    std::size_t done{isRead ? Read(at, buffer, bytes, bytes, probe)
+                            : Write(at, buffer, bytes, probe)};
+    CompletePending(id, probe.GetIoStat(), done);
+    return id;
+  }
+  asynchronousIoPool.Submit(New<AsynchronousRequest>{}(
+      handler, *this, id, isRead, at, buffer, bytes));
   return id;
 }
+
+OpenFile::Pending *OpenFile::FindPending(int id) {
+  if (id >= 0 && pendingCapacity_ > 0) {
+    Pending &p{pending_.get()[id & (pendingCapacity_ - 1)]};
+    if (p.id == id) {
+      return &p;
+    }
+  }
+  return nullptr;
+}
+
+int OpenFile::StartPending(const Terminator &terminator) {
+  int id{nextId_};
+  nextId_ = nextId_ < std::numeric_limits<int>::max() ? nextId_ + 1 : 0;
+  RUNTIME_CHECK(terminator, !FindPending(id));
+  while (pendingCapacity_ == 0 ||
+      pending_.get()[id & (pendingCapacity_ - 1)].id >= 0) {
+    if (pendingCapacity_ < maxPending) {
+      GrowPending(terminator);
+    } else if (Pending & p{pending_.get()[id & (pendingCapacity_ - 1)]};
+               !p.done) {
+      pendingDone_.Wait(pendingLock_);  // for a transfer maxPending ago
+    } else {
+      // Its ID= has not been waited for; keep its error for WAIT
+      // without ID=.
+      if (int ioStat{ReleasePending(p)}; ioStat != 0 && unwaitedIoStat_ == 0) {
+        unwaitedIoStat_ = ioStat;
+      }
+    }
+  }
+  Pending &p{pending_.get()[id & (pendingCapacity_ - 1)]};
+  p.id = id;
+  ++runningCount_;
+  return id;
+}
+
+// Doubles the capacity of the table; slots' relative IDs remain distinct.
+void OpenFile::GrowPending(const Terminator &terminator) {
+  int capacity{pendingCapacity_ > 0 ? 2 * pendingCapacity_ : 16};
+  Pending *table{static_cast<Pending *>(
+      AllocateMemoryOrCrash(terminator, capacity * sizeof(Pending)))};
+  for (int j{0}; j < capacity; ++j) {
+    new (&table[j]) Pending{};
+  }
+  for (int j{0}; j < pendingCapacity_; ++j) {
+    if (const Pending & p{pending_.get()[j]}; p.id >= 0) {
+      table[p.id & (capacity - 1)] = p;
+    }
+  }
+  pending_.reset(table);
+  pendingCapacity_ = capacity;
+}
+
+OpenFile::Pending *OpenFile::WaitForPending(int id) {
+  while (true) {
+    Pending *p{FindPending(id)};
+    if (!p || p->done) {
+      return p;
+    }
+    pendingDone_.Wait(pendingLock_);  // the table may grow meanwhile
+  }
+}
+
+int OpenFile::ReleasePending(Pending &p) {
+  int ioStat{p.ioStat};
+  p = Pending{};
+  return ioStat;
+}
+
+void OpenFile::CompletePending(int id, int ioStat, std::size_t bytes) {
+  CriticalSection criticalSection{pendingLock_};
+  if (Pending * p{FindPending(id)}) {
+    p->done = true;
+    p->ioStat = ioStat;
+    p->bytes = bytes;
+    --runningCount_;
+    pendingDone_.Broadcast();
+  }
+}
 }
@@ -11,9 +11,12 @@
 #ifndef FORTRAN_RUNTIME_FILE_H_
 #define FORTRAN_RUNTIME_FILE_H_
 
+#include "buffer.h"
 #include "io-error.h"
+#include "io-stats.h"
 #include "lock.h"
 #include "memory.h"
+#include "storage.h"
 #include <cinttypes>
 #include <optional>
 
@@ -41,12 +44,21 @@ public:
   void set_mayPosition(bool yes) { mayPosition_ = yes; }
   FileOffset position() const { return position_; }
   bool isTerminal() const { return isTerminal_; }
+  bool mayMap() const { return mayMap_; }  // regular file, read-only
+  std::size_t blockSize() const { return blockSize_; }  // preferred for I/O
+  Storage storage() const { return storage_; }
+  IoStatistics &statistics() { return statistics_; }
 
   bool IsOpen() const { return fd_ >= 0; }
   void Open(OpenStatus, Position, IoErrorHandler &);
   void Predefine(int fd);
   void Close(CloseStatus, IoErrorHandler &);
 
+  // Reads and writes of regular files (mayPosition()) are positional,
+  // so transfers at independent offsets may proceed concurrently.
+  // A FILE= name may select another store (see storage.h); a file
+  // staged in memory is positional, and a compressed stream is not.
+
   // Reads data into memory; returns amount acquired.  Synchronous.
   // Partial reads (less than minBytes) signify end-of-file.  If the
   // buffer is larger than minBytes, and extra returned data will be
@@ -58,30 +70,70 @@ public:
   // Writes data.  Synchronous.  Partial writes indicate program-handled
   // error conditions.
   std::size_t Write(FileOffset, const char *, std::size_t, IoErrorHandler &);
+  // Writes two pieces that are contiguous in the file, such as the parts
+  // of a wrapped circular buffer, with one system call when possible.
+  std::size_t Write(FileOffset, const char *, std::size_t, const char *,
+      std::size_t, IoErrorHandler &);
 
   // Truncates the file
   void Truncate(FileOffset, IoErrorHandler &);
 
-  // Asynchronous transfers
+  // Maps at least the given number of bytes of the file, starting at or
+  // before the offset, into memory for reading.  Returns false, and
+  // clears mayMap(), on failure.
+  bool MapRegion(FileOffset, std::size_t bytes, bool sequential,
+      MappedRegion &, IoErrorHandler &);
+  static void UnmapRegion(MappedRegion &);
+
+  // Asynchronous transfers are queued to a pool of worker threads and
+  // return an ID at once; Wait() and WaitAll() block until completion.
+  // Wait() returns the number of bytes transferred, which is short only
+  // after an error or, for a read, at the end of the file.
   int ReadAsynchronously(FileOffset, char *, std::size_t, IoErrorHandler &);
   int WriteAsynchronously(
       FileOffset, const char *, std::size_t, IoErrorHandler &);
-  void Wait(int id, IoErrorHandler &);
+  // A transfer that cannot start takes an ID all the same, and its
+  // error is reported by the WAIT.
+  int FailAsynchronously(int ioStat, IoErrorHandler &);
+  std::size_t Wait(int id, IoErrorHandler &);
   void WaitAll(IoErrorHandler &);
 
 private:
+  friend class AsynchronousIoPool;
+
+  // A slot in the table of pending asynchronous transfers, which is
+  // indexed by ID modulo its capacity (always a power of two).  The
+  // table grows to at most maxPending slots; then a new transfer waits
+  // for the one maxPending IDs earlier, and takes its slot if its ID has
+  // not been waited for.
+  static constexpr int maxPending{1024};
   struct Pending {
-    int id;
+    int id{-1};  // -1 when the slot is free
+    bool done{false};
     int ioStat{0};
-    OwningPtr<Pending> next;
+    std::size_t bytes{0};  // transferred
   };
 
   // lock_ must be held for these
   void CheckOpen(const Terminator &);
+  void ExamineFile();
   bool Seek(FileOffset, IoErrorHandler &);
   bool RawSeek(FileOffset);
   bool RawSeekToEnd();
-  int PendingResult(const Terminator &, int);
+  void OpenStorage(IoErrorHandler &);
+  void CloseStorage(CloseStatus, IoErrorHandler &);
+
+  // pendingLock_ must be held for these
+  Pending *FindPending(int id);
+  int StartPending(const Terminator &);
+  void GrowPending(const Terminator &);
+  Pending *WaitForPending(int id);
+  int ReleasePending(Pending &);
+
+  int StartAsynchronously(
+      FileOffset, char *, std::size_t, bool isRead, IoErrorHandler &);
+  // called by workers
+  void CompletePending(int id, int ioStat, std::size_t bytes);
 
   Lock lock_;
   int fd_{-1};
@@ -94,9 +146,21 @@ private:
   FileOffset position_{0};
   std::optional<FileOffset> knownSize_;
   bool isTerminal_{false};
-
-  int nextId_;
+  bool mayMap_{false};
+  std::size_t blockSize_{0};
+  Storage storage_{Storage::Posix};
+  MemoryFile memory_;  // Storage::Memory
+  pid_t filter_{-1};  // Storage::Gzip and Zstd
+  IoStatistics statistics_;
+
+  // Asynchronous transfers; workers don't take lock_
+  Lock pendingLock_;
+  ConditionVariable pendingDone_;
   OwningPtr<Pending> pending_;
+  int pendingCapacity_{0};
+  int runningCount_{0};  // not yet completed
+  int nextId_{0};
+  int unwaitedIoStat_{0};  // first error of a transfer never waited for
 };
 }
 #endif  // FORTRAN_RUNTIME_FILE_H_
@@ -16,6 +16,7 @@
 #include "main.h"
 #include "flang/common/format.h"
 #include "flang/decimal/decimal.h"
+#include <algorithm>
 #include <limits>
 
 namespace Fortran::runtime::io {
@@ -36,6 +37,15 @@ FormatControl<CONTEXT>::FormatControl(const Terminator &terminator,
   stack_[0].remaining = Iteration::unlimited;  // 13.4(8)
 }
 
+template<typename CONTEXT>
+FormatControl<CONTEXT>::FormatControl(
+    const Terminator &terminator, const CompiledFormat &compiled)
+  : compiled_{&compiled} {
+  if (!compiled.IsValid()) {
+    terminator.Crash("internal Fortran runtime error: invalid compiled FORMAT");
+  }
+}
+
 template<typename CONTEXT>
 int FormatControl<CONTEXT>::GetMaxParenthesisNesting(
     const Terminator &terminator, const CharType *format,
@@ -287,20 +297,109 @@ int FormatControl<CONTEXT>::CueUpNextDataEdit(Context &context, bool stop) {
   }
 }
 
+// Interprets a CompiledFormat; this mirrors CueUpNextDataEdit() above,
+// but the FORMAT has already been lexed and its repeat counts decoded.
+template<typename CONTEXT>
+int FormatControl<CONTEXT>::CueUpNextCompiledDataEdit(
+    Context &context, bool stop) {
+  if (dataRemaining_ > 0) {
+    return dataRemaining_;
+  }
+  int reverted{-1};  // catches unlimited repetition without data edits
+  while (true) {
+    const FormatOp &op{compiled_->op(offset_++)};
+    switch (op.kind) {
+    case FormatOp::Kind::LeftParen:
+      if (height_ >= maxHeight_) {
+        context.Crash("FORMAT stack overflow: too many nested parentheses");
+      }
+      stack_[height_].start = offset_ - 1;
+      stack_[height_].remaining = op.repeat;
+      ++height_;
+      break;
+    case FormatOp::Kind::RightParen:
+      if (height_ == 1) {
+        if (stop) {
+          return 0;  // end of FORMAT and no data items remain
+        }
+        context.AdvanceRecord();  // implied / before rightmost )
+      }
+      if (stack_[height_ - 1].remaining == Iteration::unlimited) {
+        offset_ = stack_[height_ - 1].start + 1;
+        if (offset_ == reverted) {
+          context.Crash(
+              "Unlimited repetition in FORMAT lacks data edit descriptors");
+        }
+        reverted = offset_;
+      } else if (stack_[height_ - 1].remaining-- > 0) {
+        offset_ = stack_[height_ - 1].start + 1;
+      } else {
+        --height_;
+      }
+      break;
+    case FormatOp::Kind::Literal:
+      context.Emit(compiled_->text() + op.textOffset,
+          static_cast<std::size_t>(op.width));
+      break;
+    case FormatOp::Kind::Control:
+      HandleControl(context, op.descriptor, op.variation, op.repeat);
+      break;
+    case FormatOp::Kind::Slash: context.AdvanceRecord(op.repeat); break;
+    case FormatOp::Kind::Colon:
+      if (stop) {
+        return 0;
+      }
+      break;
+    case FormatOp::Kind::Data: --offset_; return op.repeat;
+    }
+  }
+}
+
+template<typename CONTEXT>
+DataEdit FormatControl<CONTEXT>::GetNextCompiledDataEdit(
+    Context &context, int maxRepeat) {
+  int repeat{CueUpNextCompiledDataEdit(context)};
+  const FormatOp &op{compiled_->op(offset_)};
+  DataEdit edit;
+  edit.descriptor = op.descriptor;
+  edit.variation = op.variation;
+  if (op.fields & FormatOp::hasWidth) {
+    edit.width = op.width;
+  }
+  if (op.fields & FormatOp::hasDigits) {
+    edit.digits = op.digits;
+  }
+  if (op.fields & FormatOp::hasExpoDigits) {
+    edit.expoDigits = op.expoDigits;
+  }
+  edit.modes = context.mutableModes();
+  edit.repeat = std::min(repeat, maxRepeat);
+  dataRemaining_ = repeat - edit.repeat;
+  if (dataRemaining_ == 0) {
+    ++offset_;
+  }
+  return edit;
+}
+
 template<typename CONTEXT>
 DataEdit FormatControl<CONTEXT>::GetNextDataEdit(
     Context &context, int maxRepeat) {
 
   // TODO: DT editing
 
+  if (compiled_) {
+    return GetNextCompiledDataEdit(context, maxRepeat);
+  }
+
   // Return the next data edit descriptor
   int repeat{CueUpNextDataEdit(context)};
   auto start{offset_};
   DataEdit edit;
   edit.descriptor = static_cast<char>(Capitalize(GetNextChar(context)));
   if (edit.descriptor == 'E') {
-    edit.variation = static_cast<char>(Capitalize(PeekNext()));
-    if (edit.variation >= 'A' && edit.variation <= 'Z') {
+    char variation{static_cast<char>(Capitalize(PeekNext()))};
+    if (variation == 'N' || variation == 'S' || variation == 'X') {
+      edit.variation = variation;
       ++offset_;
     }
   }
@@ -326,6 +425,9 @@ DataEdit FormatControl<CONTEXT>::GetNextDataEdit(
 
   // Handle repeated nonparenthesized edit descriptors
   if (repeat > 1) {
+    if (height_ >= maxHeight_) {
+      context.Crash("FORMAT stack overflow: too many nested parentheses");
+    }
     stack_[height_].start = start;  // after repeat count
     stack_[height_].remaining = repeat;  // full count
     ++height_;
@@ -349,6 +451,10 @@ DataEdit FormatControl<CONTEXT>::GetNextDataEdit(
 
 template<typename CONTEXT>
 void FormatControl<CONTEXT>::FinishOutput(Context &context) {
+  if (compiled_) {
+    CueUpNextCompiledDataEdit(context, true);
+    return;
+  }
   CueUpNextDataEdit(context, true /* stop at colon or end of FORMAT */);
 }
 }
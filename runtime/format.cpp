@@ -50,4 +50,5 @@ bool DefaultFormatControlCallbacks::HandleRelativePosition(std::int64_t) {
 template class FormatControl<InternalFormattedIoStatementState<false>>;
 template class FormatControl<InternalFormattedIoStatementState<true>>;
 template class FormatControl<ExternalFormattedIoStatementState<false>>;
+template class FormatControl<ExternalFormattedIoStatementState<true>>;
 }
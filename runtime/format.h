@@ -16,6 +16,7 @@
 #include "terminator.h"
 #include "flang/common/Fortran.h"
 #include "flang/decimal/decimal.h"
+#include <algorithm>
 #include <cinttypes>
 #include <optional>
 
@@ -32,7 +33,7 @@ struct MutableModes {
   enum decimal::FortranRounding round{
       executionEnvironment
           .defaultOutputRoundingMode};  // RP/ROUND='PROCESSOR_DEFAULT'
-  bool pad{false};  // PAD= mode on READ
+  bool pad{true};  // PAD= mode on READ; PAD='YES' is the default
   char delim{'\0'};  // DELIM=
   short scale{0};  // kP
 };
@@ -45,9 +46,11 @@ struct DataEdit {
   static constexpr char ListDirected{'g'};  // non-COMPLEX list-directed
   static constexpr char ListDirectedRealPart{'r'};  // emit "(r," or "(r;"
   static constexpr char ListDirectedImaginaryPart{'z'};  // emit "z)"
+  static constexpr char ListDirectedNullValue{'n'};  // input: item unchanged
   constexpr bool IsListDirected() const {
     return descriptor == ListDirected || descriptor == ListDirectedRealPart ||
-        descriptor == ListDirectedImaginaryPart;
+        descriptor == ListDirectedImaginaryPart ||
+        descriptor == ListDirectedNullValue;
   }
 
   char variation{'\0'};  // N, S, or X for EN, ES, EX
@@ -71,6 +74,69 @@ struct DefaultFormatControlCallbacks : public IoErrorHandler {
   bool HandleRelativePosition(std::int64_t);
 };
 
+// One operation in a CompiledFormat
+struct FormatOp {
+  enum class Kind : std::uint8_t {
+    LeftParen,  // repeat: further iterations, or unlimited
+    RightParen,
+    Literal,  // character literal or Hollerith: width chars at textOffset
+    Control,  // descriptor & variation are its letters; repeat is its n
+    Slash,  // repeat: number of records to advance
+    Colon,
+    Data,  // data edit descriptor with its repeat count
+  };
+  enum Fields : std::uint8_t { hasWidth = 1, hasDigits = 2, hasExpoDigits = 4 };
+  static constexpr std::int32_t unlimited{-1};
+
+  Kind kind;
+  char descriptor{'\0'};  // capitalized
+  char variation{'\0'};
+  std::uint8_t fields{0};
+  std::int32_t repeat{1};
+  std::int32_t width{0};
+  std::int32_t digits{0};
+  std::int32_t expoDigits{0};
+  std::int32_t textOffset{0};
+};
+
+// A default-CHARACTER FORMAT that has been decoded once into a flat
+// sequence of FormatOps with resolved repeat counts and nesting, so that
+// repeated executions of an I/O statement need not rescan its text.
+// The representation is a single block of memory without pointers:
+// a header, the FormatOps, and then a copy of the original text (for
+// character literals, and to validate cache hits).  A compiler may emit
+// such a block as initialized data.
+class CompiledFormat {
+public:
+  static constexpr std::uint32_t signature{0x464d5431};  // "FMT1"
+
+  // Returns null if the FORMAT can't be compiled; it must then be
+  // interpreted, and any error in it will be reported as it is reached.
+  static const CompiledFormat *Create(
+      const Terminator &, const char *format, std::size_t formatLength);
+  // Caches compiled FORMATs by address and length.
+  static const CompiledFormat *LookUpOrCreate(
+      const Terminator &, const char *format, std::size_t formatLength);
+
+  bool IsValid() const { return signature_ == signature; }
+  bool Matches(const char *format, std::size_t formatLength) const;
+  int ops() const { return ops_; }
+  const FormatOp &op(int j) const {
+    return reinterpret_cast<const FormatOp *>(this + 1)[j];
+  }
+  const char *text() const {
+    return reinterpret_cast<const char *>(&op(ops_));
+  }
+  int textLength() const { return textLength_; }
+  int maxNesting() const { return maxNesting_; }
+
+private:
+  std::uint32_t signature_{signature};
+  std::int32_t ops_{0};
+  std::int32_t textLength_{0};
+  std::int32_t maxNesting_{0};
+};
+
 // Generates a sequence of DataEdits from a FORMAT statement or
 // default-CHARACTER string.  Driven by I/O item list processing.
 // Errors are fatal.  See clause 13.4 in Fortran 2018 for background.
@@ -78,10 +144,12 @@ template<typename CONTEXT> class FormatControl {
 public:
   using Context = CONTEXT;
   using CharType = typename Context::CharType;
+  static constexpr std::uint8_t maxMaxHeight{100};
 
   FormatControl() {}
   FormatControl(const Terminator &, const CharType *format,
       std::size_t formatLength, int maxHeight = maxMaxHeight);
+  FormatControl(const Terminator &, const CompiledFormat &);
 
   // Determines the max parenthesis nesting level by scanning and validating
   // the FORMAT string.
@@ -89,7 +157,7 @@ public:
       const Terminator &, const CharType *format, std::size_t formatLength);
 
   // For attempting to allocate in a user-supplied stack area
-  static std::size_t GetNeededSize(int maxHeight) {
+  static constexpr std::size_t GetNeededSize(int maxHeight) {
     return sizeof(FormatControl) -
         sizeof(Iteration) * (maxMaxHeight - maxHeight);
   }
@@ -101,13 +169,41 @@ public:
   // Emit any remaining character literals after the last data item.
   void FinishOutput(Context &);
 
-private:
-  static constexpr std::uint8_t maxMaxHeight{100};
+  // An upper bound on the stack height needed for a FORMAT, computed
+  // without validating it: the deepest parenthesis nesting outside
+  // character literals, plus one for a repeated data edit descriptor.
+  // Hollerith literals are not skipped, so a FORMAT with an H gets a full
+  // stack.
+  static constexpr int GetMaxHeightBound(
+      const CharType *format, std::size_t formatLength) {
+    int height{0}, maxHeight{0};
+    CharType quote{'\0'};
+    for (std::size_t j{0}; j < formatLength; ++j) {
+      CharType ch{format[j]};
+      if (quote != '\0') {
+        if (ch == quote) {
+          quote = '\0';  // a doubled quote just reenters the literal
+        }
+      } else if (ch == '\'' || ch == '"') {
+        quote = ch;
+      } else if (ch == '(') {
+        maxHeight = std::max(maxHeight, ++height);
+      } else if (ch == ')') {
+        --height;
+      } else if (ch == 'H' || ch == 'h') {
+        return maxMaxHeight;
+      }
+    }
+    return std::min<int>(maxHeight + 1, maxMaxHeight);
+  }
 
+private:
+  // Not initialized by default, so that construction does not touch
+  // entries beyond maxHeight_ in an incomplete stack_.
   struct Iteration {
-    static constexpr int unlimited{-1};
-    int start{0};  // offset in format_ of '(' or a repeated edit descriptor
-    int remaining{0};  // while >0, decrement and iterate
+    static constexpr int unlimited{FormatOp::unlimited};
+    int start;  // offset in format_ of '(' or a repeated edit descriptor
+    int remaining;  // while >0, decrement and iterate
   };
 
   void SkipBlanks() {
@@ -135,6 +231,10 @@ private:
   // pointing to the data edit.
   int CueUpNextDataEdit(Context &, bool stop = false);
 
+  // Alternatives to the above for a CompiledFormat
+  int CueUpNextCompiledDataEdit(Context &, bool stop = false);
+  DataEdit GetNextCompiledDataEdit(Context &, int maxRepeat);
+
   static constexpr CharType Capitalize(CharType ch) {
     return ch >= 'a' && ch <= 'z' ? ch + 'A' - 'a' : ch;
   }
@@ -147,6 +247,8 @@ private:
   const CharType *format_{nullptr};
   int formatLength_{0};
   int offset_{0};  // next item is at format_[offset_]
+  const CompiledFormat *compiled_{nullptr};  // if set, offset_ indexes its ops
+  int dataRemaining_{0};  // repetitions of a compiled data edit still to come
 
   // must be last, may be incomplete
   Iteration stack_[maxMaxHeight];
@@ -80,6 +80,42 @@ bool InternalDescriptorUnit<isInput>::Emit(
   return ok;
 }
 
+// Output that fits in the current record is stored there in place by
+// the caller; anything else is left to Emit(), which signals the error.
+template<bool isInput>
+char *InternalDescriptorUnit<isInput>::ReserveOutput(std::size_t bytes) {
+  if constexpr (isInput) {
+    return nullptr;
+  }
+  auto after{positionInRecord + static_cast<std::int64_t>(bytes)};
+  if (currentRecordNumber >= endfileRecordNumber.value_or(0) ||
+      after > static_cast<std::int64_t>(recordLength.value_or(0))) {
+    return nullptr;
+  }
+  char *p{descriptor().template Element<char>(at_) + positionInRecord};
+  positionInRecord = after;
+  furthestPositionInRecord = std::max(furthestPositionInRecord, after);
+  return p;
+}
+
+// Returns the rest of the current record, which is contiguous.
+template<bool isInput>
+std::size_t InternalDescriptorUnit<isInput>::GetNextInputBytes(
+    const char *&p, IoErrorHandler &handler) {
+  if constexpr (!isInput) {
+    handler.Crash("InternalDescriptorUnit<false>::GetNextInputBytes() called "
+                  "for an output statement");
+    return 0;
+  }
+  if (currentRecordNumber >= endfileRecordNumber.value_or(0)) {
+    handler.SignalEnd();
+    return 0;
+  }
+  p = descriptor().template Element<const char>(at_) + positionInRecord;
+  return std::max<std::int64_t>(
+      0, recordLength.value_or(0) - positionInRecord);
+}
+
 template<bool isInput>
 bool InternalDescriptorUnit<isInput>::AdvanceRecord(IoErrorHandler &handler) {
   if (currentRecordNumber >= endfileRecordNumber.value_or(0)) {
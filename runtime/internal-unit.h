@@ -30,6 +30,8 @@ public:
   void EndIoStatement();
 
   bool Emit(const char *, std::size_t bytes, IoErrorHandler &);
+  char *ReserveOutput(std::size_t bytes);  // null if it won't fit
+  std::size_t GetNextInputBytes(const char *&, IoErrorHandler &);
   bool AdvanceRecord(IoErrorHandler &);
   bool HandleAbsolutePosition(std::int64_t, IoErrorHandler &);
   bool HandleRelativePosition(std::int64_t, IoErrorHandler &);
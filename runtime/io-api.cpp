@@ -9,64 +9,136 @@
 // Implements the I/O statement API
 
 #include "io-api.h"
+#include "edit-input.h"
+#include "element-runs.h"
 #include "environment.h"
 #include "format.h"
+#include "io-stats.h"
 #include "io-stmt.h"
 #include "memory.h"
 #include "numeric-output.h"
 #include "terminator.h"
 #include "tools.h"
 #include "unit.h"
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <memory>
+#include <new>
 
 namespace Fortran::runtime::io {
 
+static_assert(RecommendedInternalIoScratchAreaBytes(0) >=
+    sizeof(InternalListIoStatementState<false>));
+static_assert(RecommendedInternalIoScratchAreaBytes(0) >=
+    sizeof(InternalListIoStatementState<true>));
+static_assert(RecommendedInternalIoScratchAreaBytes(1) >=
+    InternalFormattedIoStatementState<false>::GetNeededSize(2));
+static_assert(RecommendedInternalIoScratchAreaBytes(1) >=
+    InternalFormattedIoStatementState<true>::GetNeededSize(2));
+static_assert(alignof(InternalFormattedIoStatementState<false>) <=
+    alignof(void *));
+
+// Constructs the state of an internal I/O statement in the scratch area
+// loaned by the caller when that is large enough and suitably aligned, so
+// that no allocation takes place; otherwise allocates it.
+template<typename STATE, typename... A>
+static Cookie BeginInternalIo(void **scratchArea, std::size_t scratchBytes,
+    std::size_t neededBytes, const Terminator &terminator, A &&... xs) {
+  if (scratchArea && scratchBytes >= neededBytes &&
+      reinterpret_cast<std::uintptr_t>(scratchArea) % alignof(STATE) == 0) {
+    STATE *state{new (scratchArea) STATE{std::forward<A>(xs)...}};
+    state->set_free(false);
+    return &state->ioStatementState();
+  }
+  return &New<STATE>{}(terminator, std::forward<A>(xs)...).ioStatementState();
+}
+
+// Formatted internal I/O needs less scratch space when its FORMAT stack
+// is no deeper than the FORMAT can need.
+template<typename STATE, typename... A>
+static Cookie BeginInternalFormattedIo(void **scratchArea,
+    std::size_t scratchBytes, const char *format, std::size_t formatLength,
+    const char *sourceFile, int sourceLine, A &&... xs) {
+  Terminator terminator{sourceFile, sourceLine};
+  int maxHeight{STATE::maxMaxHeight};
+  if (scratchArea && scratchBytes < sizeof(STATE)) {
+    maxHeight =
+        STATE::FormatControlType::GetMaxHeightBound(format, formatLength);
+  }
+  return BeginInternalIo<STATE>(scratchArea, scratchBytes,
+      STATE::GetNeededSize(maxHeight), terminator, std::forward<A>(xs)...,
+      format, formatLength, sourceFile, sourceLine, maxHeight);
+}
+
 Cookie IONAME(BeginInternalArrayListOutput)(const Descriptor &descriptor,
-    void ** /*scratchArea*/, std::size_t /*scratchBytes*/,
-    const char *sourceFile, int sourceLine) {
-  Terminator oom{sourceFile, sourceLine};
-  return &New<InternalListIoStatementState<false>>{}(
-      oom, descriptor, sourceFile, sourceLine)
-              .ioStatementState();
+    void **scratchArea, std::size_t scratchBytes, const char *sourceFile,
+    int sourceLine) {
+  using State = InternalListIoStatementState<false>;
+  Terminator terminator{sourceFile, sourceLine};
+  return BeginInternalIo<State>(scratchArea, scratchBytes, sizeof(State),
+      terminator, descriptor, sourceFile, sourceLine);
+}
+
+Cookie IONAME(BeginInternalArrayListInput)(const Descriptor &descriptor,
+    void **scratchArea, std::size_t scratchBytes, const char *sourceFile,
+    int sourceLine) {
+  using State = InternalListIoStatementState<true>;
+  Terminator terminator{sourceFile, sourceLine};
+  return BeginInternalIo<State>(scratchArea, scratchBytes, sizeof(State),
+      terminator, descriptor, sourceFile, sourceLine);
 }
 
 Cookie IONAME(BeginInternalArrayFormattedOutput)(const Descriptor &descriptor,
-    const char *format, std::size_t formatLength, void ** /*scratchArea*/,
-    std::size_t /*scratchBytes*/, const char *sourceFile, int sourceLine) {
-  Terminator oom{sourceFile, sourceLine};
-  return &New<InternalFormattedIoStatementState<false>>{}(
-      oom, descriptor, format, formatLength, sourceFile, sourceLine)
-              .ioStatementState();
+    const char *format, std::size_t formatLength, void **scratchArea,
+    std::size_t scratchBytes, const char *sourceFile, int sourceLine) {
+  return BeginInternalFormattedIo<InternalFormattedIoStatementState<false>>(
+      scratchArea, scratchBytes, format, formatLength, sourceFile, sourceLine,
+      descriptor);
+}
+
+Cookie IONAME(BeginInternalArrayFormattedInput)(const Descriptor &descriptor,
+    const char *format, std::size_t formatLength, void **scratchArea,
+    std::size_t scratchBytes, const char *sourceFile, int sourceLine) {
+  return BeginInternalFormattedIo<InternalFormattedIoStatementState<true>>(
+      scratchArea, scratchBytes, format, formatLength, sourceFile, sourceLine,
+      descriptor);
 }
 
 Cookie IONAME(BeginInternalListOutput)(char *internal,
-    std::size_t internalLength, void ** /*scratchArea*/,
-    std::size_t /*scratchBytes*/, const char *sourceFile, int sourceLine) {
-  Terminator oom{sourceFile, sourceLine};
-  return &New<InternalListIoStatementState<false>>{}(
-      oom, internal, internalLength, sourceFile, sourceLine)
-              .ioStatementState();
+    std::size_t internalLength, void **scratchArea, std::size_t scratchBytes,
+    const char *sourceFile, int sourceLine) {
+  using State = InternalListIoStatementState<false>;
+  Terminator terminator{sourceFile, sourceLine};
+  return BeginInternalIo<State>(scratchArea, scratchBytes, sizeof(State),
+      terminator, internal, internalLength, sourceFile, sourceLine);
+}
+
+Cookie IONAME(BeginInternalListInput)(char *internal,
+    std::size_t internalLength, void **scratchArea, std::size_t scratchBytes,
+    const char *sourceFile, int sourceLine) {
+  using State = InternalListIoStatementState<true>;
+  Terminator terminator{sourceFile, sourceLine};
+  return BeginInternalIo<State>(scratchArea, scratchBytes, sizeof(State),
+      terminator, internal, internalLength, sourceFile, sourceLine);
 }
 
 Cookie IONAME(BeginInternalFormattedOutput)(char *internal,
     std::size_t internalLength, const char *format, std::size_t formatLength,
-    void ** /*scratchArea*/, std::size_t /*scratchBytes*/,
-    const char *sourceFile, int sourceLine) {
-  Terminator oom{sourceFile, sourceLine};
-  return &New<InternalFormattedIoStatementState<false>>{}(oom, internal,
-      internalLength, format, formatLength, sourceFile, sourceLine)
-              .ioStatementState();
+    void **scratchArea, std::size_t scratchBytes, const char *sourceFile,
+    int sourceLine) {
+  return BeginInternalFormattedIo<InternalFormattedIoStatementState<false>>(
+      scratchArea, scratchBytes, format, formatLength, sourceFile, sourceLine,
+      internal, internalLength);
 }
 
 Cookie IONAME(BeginInternalFormattedInput)(char *internal,
     std::size_t internalLength, const char *format, std::size_t formatLength,
-    void ** /*scratchArea*/, std::size_t /*scratchBytes*/,
-    const char *sourceFile, int sourceLine) {
-  Terminator oom{sourceFile, sourceLine};
-  return &New<InternalFormattedIoStatementState<true>>{}(oom, internal,
-      internalLength, format, formatLength, sourceFile, sourceLine)
-              .ioStatementState();
+    void **scratchArea, std::size_t scratchBytes, const char *sourceFile,
+    int sourceLine) {
+  return BeginInternalFormattedIo<InternalFormattedIoStatementState<true>>(
+      scratchArea, scratchBytes, format, formatLength, sourceFile, sourceLine,
+      internal, internalLength);
 }
 
 Cookie IONAME(BeginExternalListOutput)(
@@ -81,21 +153,97 @@ Cookie IONAME(BeginExternalListOutput)(
       file, sourceFile, sourceLine);
 }
 
-Cookie IONAME(BeginExternalFormattedOutput)(const char *format,
-    std::size_t formatLength, ExternalUnit unitNumber, const char *sourceFile,
-    int sourceLine) {
-  Terminator terminator{sourceFile, sourceLine};
+static ExternalFileUnit &GetFormattedOutputUnit(
+    ExternalUnit unitNumber, const Terminator &terminator) {
   int unit{unitNumber == DefaultUnit ? 6 : unitNumber};
   ExternalFileUnit &file{ExternalFileUnit::LookUpOrCrash(unit, terminator)};
   if (file.isUnformatted) {
     terminator.Crash("Formatted output attempted to unformatted file");
   }
+  return file;
+}
+
+// Finds or compiles a FORMAT for a unit's statement; its time is that of
+// FORMAT parsing for FORT_IO_STATS.
+static const CompiledFormat *LookUpFormat(ExternalFileUnit &file,
+    const Terminator &terminator, const char *format,
+    std::size_t formatLength) {
+  IoStatisticsTimer timer{file.statistics().formatTime};
+  return CompiledFormat::LookUpOrCreate(terminator, format, formatLength);
+}
+
+Cookie IONAME(BeginExternalFormattedOutput)(const char *format,
+    std::size_t formatLength, ExternalUnit unitNumber, const char *sourceFile,
+    int sourceLine) {
+  Terminator terminator{sourceFile, sourceLine};
+  ExternalFileUnit &file{GetFormattedOutputUnit(unitNumber, terminator)};
+  if (const CompiledFormat *
+      compiled{LookUpFormat(file, terminator, format, formatLength)}) {
+    return &file.BeginIoStatement<ExternalFormattedIoStatementState<false>>(
+        file, *compiled, sourceFile, sourceLine);
+  }
   IoStatementState &io{
       file.BeginIoStatement<ExternalFormattedIoStatementState<false>>(
           file, format, formatLength, sourceFile, sourceLine)};
   return &io;
 }
 
+static ExternalFileUnit &GetFormattedInputUnit(
+    ExternalUnit unitNumber, const Terminator &terminator) {
+  int unit{unitNumber == DefaultUnit ? 5 : unitNumber};
+  ExternalFileUnit &file{ExternalFileUnit::LookUpOrCrash(unit, terminator)};
+  if (file.isUnformatted) {
+    terminator.Crash("Formatted input attempted from unformatted file");
+  }
+  if (!file.mayRead()) {
+    terminator.Crash("Input attempted from unit %d, which is not connected "
+                     "with ACTION='READ' or 'READWRITE'",
+        unit);
+  }
+  return file;
+}
+
+Cookie IONAME(BeginExternalListInput)(
+    ExternalUnit unitNumber, const char *sourceFile, int sourceLine) {
+  Terminator terminator{sourceFile, sourceLine};
+  ExternalFileUnit &file{GetFormattedInputUnit(unitNumber, terminator)};
+  return &file.BeginIoStatement<ExternalListIoStatementState<true>>(
+      file, sourceFile, sourceLine);
+}
+
+Cookie IONAME(BeginExternalFormattedInput)(const char *format,
+    std::size_t formatLength, ExternalUnit unitNumber, const char *sourceFile,
+    int sourceLine) {
+  Terminator terminator{sourceFile, sourceLine};
+  ExternalFileUnit &file{GetFormattedInputUnit(unitNumber, terminator)};
+  if (const CompiledFormat *
+      compiled{LookUpFormat(file, terminator, format, formatLength)}) {
+    return &file.BeginIoStatement<ExternalFormattedIoStatementState<true>>(
+        file, *compiled, sourceFile, sourceLine);
+  }
+  return &file.BeginIoStatement<ExternalFormattedIoStatementState<true>>(
+      file, format, formatLength, sourceFile, sourceLine);
+}
+
+const CompiledFormat *IONAME(CompileFormat)(const char *format,
+    std::size_t formatLength, const char *sourceFile, int sourceLine) {
+  Terminator terminator{sourceFile, sourceLine};
+  return CompiledFormat::Create(terminator, format, formatLength);
+}
+
+Cookie IONAME(BeginExternalCompiledFormattedOutput)(
+    const CompiledFormat &compiled, ExternalUnit unitNumber,
+    const char *sourceFile, int sourceLine) {
+  Terminator terminator{sourceFile, sourceLine};
+  if (!compiled.IsValid()) {
+    terminator.Crash("BeginExternalCompiledFormattedOutput: invalid "
+                     "compiled FORMAT");
+  }
+  ExternalFileUnit &file{GetFormattedOutputUnit(unitNumber, terminator)};
+  return &file.BeginIoStatement<ExternalFormattedIoStatementState<false>>(
+      file, compiled, sourceFile, sourceLine);
+}
+
 Cookie IONAME(BeginUnformattedOutput)(
     ExternalUnit unitNumber, const char *sourceFile, int sourceLine) {
   Terminator terminator{sourceFile, sourceLine};
@@ -104,14 +252,35 @@ Cookie IONAME(BeginUnformattedOutput)(
   if (!file.isUnformatted) {
     terminator.Crash("Unformatted output attempted to formatted file");
   }
-  IoStatementState &io{
-      file.BeginIoStatement<UnformattedIoStatementState<false>>(
-          file, sourceFile, sourceLine)};
-  if (file.access == Access::Sequential && !file.recordLength.has_value()) {
-    // Filled in by UnformattedIoStatementState<false>::EndIoStatement()
-    io.Emit("\0\0\0\0", 4);  // placeholder for record length header
+  if (file.access == Access::Direct) {
+    return &New<DirectUnformattedIoStatementState<false>>{}(
+        terminator, file, sourceFile, sourceLine)
+                .ioStatementState();
   }
-  return &io;
+  return &file.BeginIoStatement<UnformattedIoStatementState<false>>(
+      file, sourceFile, sourceLine);
+}
+
+Cookie IONAME(BeginUnformattedInput)(
+    ExternalUnit unitNumber, const char *sourceFile, int sourceLine) {
+  Terminator terminator{sourceFile, sourceLine};
+  ExternalFileUnit &file{
+      ExternalFileUnit::LookUpOrCrash(unitNumber, terminator)};
+  if (!file.isUnformatted) {
+    terminator.Crash("Unformatted input attempted from formatted file");
+  }
+  if (!file.mayRead()) {
+    terminator.Crash("Input attempted from unit %d, which is not connected "
+                     "with ACTION='READ' or 'READWRITE'",
+        unitNumber);
+  }
+  if (file.access == Access::Direct) {
+    return &New<DirectUnformattedIoStatementState<true>>{}(
+        terminator, file, sourceFile, sourceLine)
+                .ioStatementState();
+  }
+  return &file.BeginIoStatement<UnformattedIoStatementState<true>>(
+      file, sourceFile, sourceLine);
 }
 
 Cookie IONAME(BeginOpenUnit)(  // OPEN(without NEWUNIT=)
@@ -129,6 +298,72 @@ Cookie IONAME(BeginOpenNewUnit)(  // OPEN(NEWUNIT=j)
       ExternalFileUnit::NewUnit(), sourceFile, sourceLine);
 }
 
+static ExternalFileUnit &GetAsynchronousUnit(ExternalUnit unitNumber,
+    std::int64_t rec, IoErrorHandler &handler) {
+  ExternalFileUnit &file{
+      ExternalFileUnit::LookUpOrCrash(unitNumber, handler)};
+  if (!file.mayAsynchronous()) {
+    handler.Crash("Asynchronous transfer attempted on unit %d opened without "
+                  "ASYNCHRONOUS='YES'",
+        unitNumber);
+  }
+  if (!file.isUnformatted || file.access != Access::Direct ||
+      !file.recordLength.has_value()) {
+    handler.Crash("Asynchronous transfer attempted on unit %d, which is not "
+                  "connected for unformatted direct access",
+        unitNumber);
+  }
+  if (rec < 1) {
+    handler.Crash("REC=%jd is invalid", static_cast<std::intmax_t>(rec));
+  }
+  file.Flush(handler);  // earlier synchronous output must precede
+  return file;
+}
+
+AsynchronousId IONAME(BeginAsynchronousOutput)(ExternalUnit unitNumber,
+    std::int64_t rec, const char *data, std::size_t bytes,
+    const char *sourceFile, int sourceLine) {
+  IoErrorHandler handler{sourceFile, sourceLine};
+  ExternalFileUnit &file{GetAsynchronousUnit(unitNumber, rec, handler)};
+  AsynchronousId id{bytes > *file.recordLength
+          ? file.FailAsynchronously(IostatRecordWriteOverflow, handler)
+          : file.WriteAsynchronously(
+                (rec - 1) * *file.recordLength, data, bytes, handler)};
+  file.Release();
+  return id;
+}
+
+AsynchronousId IONAME(BeginAsynchronousInput)(ExternalUnit unitNumber,
+    std::int64_t rec, char *data, std::size_t bytes, const char *sourceFile,
+    int sourceLine) {
+  IoErrorHandler handler{sourceFile, sourceLine};
+  ExternalFileUnit &file{GetAsynchronousUnit(unitNumber, rec, handler)};
+  AsynchronousId id{bytes > *file.recordLength
+          ? file.FailAsynchronously(IostatRecordReadOverflow, handler)
+          : file.ReadAsynchronously(
+                (rec - 1) * *file.recordLength, data, bytes, handler)};
+  file.Release();
+  return id;
+}
+
+Cookie IONAME(BeginWait)(ExternalUnit unitNumber, AsynchronousId id) {
+  Terminator terminator;
+  ExternalFileUnit &unit{
+      ExternalFileUnit::LookUpOrCrash(unitNumber, terminator)};
+  return &unit.BeginIoStatement<WaitStatementState>(unit, id);
+}
+
+Cookie IONAME(BeginWaitAll)(ExternalUnit unitNumber) {
+  if (ExternalFileUnit * unit{ExternalFileUnit::LookUp(unitNumber)}) {
+    return &unit->BeginIoStatement<WaitStatementState>(*unit, std::nullopt);
+  } else {
+    // WAIT(UNIT=bad unit) without ID= is a no-op, like CLOSE
+    Terminator oom;
+    return &New<NoopCloseStatementState>{}(oom, nullptr, 0)
+                .ioStatementState();
+  }
+}
+
 Cookie IONAME(BeginClose)(
     ExternalUnit unitNumber, const char *sourceFile, int sourceLine) {
   if (ExternalFileUnit * unit{ExternalFileUnit::LookUp(unitNumber)}) {
@@ -142,6 +377,19 @@ Cookie IONAME(BeginClose)(
   }
 }
 
+Cookie IONAME(BeginFlush)(
+    ExternalUnit unitNumber, const char *sourceFile, int sourceLine) {
+  if (ExternalFileUnit * unit{ExternalFileUnit::LookUp(unitNumber)}) {
+    return &unit->BeginIoStatement<FlushStatementState>(
+        *unit, sourceFile, sourceLine);
+  } else {
+    // FLUSH(UNIT=unconnected unit) has no effect
+    Terminator oom{sourceFile, sourceLine};
+    return &New<NoopCloseStatementState>{}(oom, sourceFile, sourceLine)
+                .ioStatementState();
+  }
+}
+
 // Control list items
 
 void IONAME(EnableHandlers)(
@@ -235,8 +483,54 @@ bool IONAME(SetPad)(Cookie cookie, const char *keyword, std::size_t length) {
   return true;
 }
 
-// TODO: SetPos (stream I/O)
-// TODO: SetRec (direct I/O)
+// Begins the data transfer at a record (REC=) or file position (POS=)
+static void SetTransferPosition(IoStatementState &io, std::int64_t offset) {
+  if (auto *ext{io.get_if<ExternalIoStatementBase>()}) {
+    ext->unit().SetPosition(offset);
+  } else if (auto *direct{
+                 io.get_if<DirectUnformattedIoStatementState<false>>()}) {
+    direct->SetPosition(offset);
+  } else if (auto *direct{
+                 io.get_if<DirectUnformattedIoStatementState<true>>()}) {
+    direct->SetPosition(offset);
+  }
+}
+
+bool IONAME(SetPos)(Cookie cookie, std::int64_t pos) {
+  IoStatementState &io{*cookie};
+  ConnectionState &connection{io.GetConnectionState()};
+  if (connection.access != Access::Stream) {
+    io.GetIoErrorHandler().Crash(
+        "POS= may not appear unless the unit is connected for stream access");
+    return false;
+  }
+  if (pos < 1) {
+    io.GetIoErrorHandler().Crash(
+        "POS=%jd is invalid", static_cast<std::intmax_t>(pos));
+    return false;
+  }
+  SetTransferPosition(io, pos - 1);
+  return true;
+}
+
+bool IONAME(SetRec)(Cookie cookie, std::int64_t rec) {
+  IoStatementState &io{*cookie};
+  ConnectionState &connection{io.GetConnectionState()};
+  if (connection.access != Access::Direct ||
+      !connection.recordLength.has_value()) {
+    io.GetIoErrorHandler().Crash(
+        "REC= may not appear unless the unit is connected for direct access");
+    return false;
+  }
+  if (rec < 1) {
+    io.GetIoErrorHandler().Crash(
+        "REC=%jd is invalid", static_cast<std::intmax_t>(rec));
+    return false;
+  }
+  connection.currentRecordNumber = rec;
+  SetTransferPosition(io, (rec - 1) * *connection.recordLength);
+  return true;
+}
 
 bool IONAME(SetRound)(Cookie cookie, const char *keyword, std::size_t length) {
   IoStatementState &io{*cookie};
@@ -434,6 +728,50 @@ bool IONAME(SetRecl)(Cookie cookie, std::size_t n) {
   return true;
 }
 
+bool IONAME(SetBuffering)(
+    Cookie cookie, const char *keyword, std::size_t length) {
+  IoStatementState &io{*cookie};
+  auto *open{io.get_if<OpenStatementState>()};
+  if (!open) {
+    io.GetIoErrorHandler().Crash(
+        "SetBuffering() called when not in an OPEN statement");
+  }
+  static const char *keywords[]{
+      "UNBUFFERED", "LINE", "FULL", "BACKGROUND", nullptr};
+  BufferingPolicy &policy{open->unit().bufferingPolicy()};
+  switch (IdentifyValue(keyword, length, keywords)) {
+  case 0: policy.mode = Buffering::Unbuffered; return true;
+  case 1: policy.mode = Buffering::Line; return true;
+  case 2: policy.mode = Buffering::Full; return true;
+  case 3: policy.mode = Buffering::Background; return true;
+  default:
+    open->Crash("Invalid BUFFERING='%.*s'", static_cast<int>(length), keyword);
+    return false;
+  }
+}
+
+bool IONAME(SetBufferSize)(Cookie cookie, std::size_t bytes) {
+  IoStatementState &io{*cookie};
+  auto *open{io.get_if<OpenStatementState>()};
+  if (!open) {
+    io.GetIoErrorHandler().Crash(
+        "SetBufferSize() called when not in an OPEN statement");
+  }
+  open->unit().bufferingPolicy().bufferBytes = bytes;
+  return true;
+}
+
+bool IONAME(SetFlushThreshold)(Cookie cookie, std::size_t bytes) {
+  IoStatementState &io{*cookie};
+  auto *open{io.get_if<OpenStatementState>()};
+  if (!open) {
+    io.GetIoErrorHandler().Crash(
+        "SetFlushThreshold() called when not in an OPEN statement");
+  }
+  open->unit().bufferingPolicy().flushThreshold = bytes;
+  return true;
+}
+
 bool IONAME(SetStatus)(Cookie cookie, const char *keyword, std::size_t length) {
   IoStatementState &io{*cookie};
   if (auto *open{io.get_if<OpenStatementState>()}) {
@@ -505,19 +843,266 @@ bool IONAME(GetNewUnit)(Cookie cookie, int &unit, int kind) {
 }
 
 // Data transfers
-// TODO: Input
 
-bool IONAME(OutputDescriptor)(Cookie cookie, const Descriptor &) {
+// For FORT_IO_STATS, adds the time of a data transfer call on an external
+// unit, less that of the reads and writes that it made, to the unit's
+// conversion time.
+class ConversionTimer {
+public:
+  explicit ConversionTimer(IoStatementState &io) {
+    if (IoStatisticsEnabled()) {
+      if (ExternalFileUnit * unit{io.GetExternalFileUnit()}) {
+        statistics_ = &unit->statistics();
+        transferTime_ =
+            statistics_->transferTime.load(std::memory_order_relaxed);
+        start_ = IoStatisticsClock();
+      }
+    }
+  }
+  ~ConversionTimer() {
+    if (statistics_) {
+      std::uint64_t elapsed{IoStatisticsClock() - start_};
+      std::uint64_t transfers{
+          statistics_->transferTime.load(std::memory_order_relaxed) -
+          transferTime_};
+      if (elapsed > transfers) {  // concurrent transfers may exceed it
+        statistics_->conversionTime.fetch_add(
+            elapsed - transfers, std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  IoStatistics *statistics_{nullptr};
+  std::uint64_t transferTime_{0}, start_{0};
+};
+
+static bool EditDefaultCharacterOutput(IoStatementState &io,
+    const DataEdit &edit, const char *x, std::size_t length) {
+  bool ok{true};
+  if (auto *list{io.get_if<ListDirectedStatementState<false>>()}) {
+    // List-directed default CHARACTER output
+    ok &= list->EmitLeadingSpaceOrAdvance(io, length, true);
+    MutableModes &modes{io.mutableModes()};
+    ConnectionState &connection{io.GetConnectionState()};
+    if (modes.delim) {
+      ok &= io.Emit(&modes.delim, 1);
+      for (std::size_t j{0}; j < length; ++j) {
+        if (list->NeedAdvance(connection, 2)) {
+          ok &= io.Emit(&modes.delim, 1) && io.AdvanceRecord() &&
+              io.Emit(&modes.delim, 1);
+        }
+        if (x[j] == modes.delim) {
+          ok &= io.EmitRepeated(modes.delim, 2);
+        } else {
+          ok &= io.Emit(&x[j], 1);
+        }
+      }
+      ok &= io.Emit(&modes.delim, 1);
+    } else {
+      std::size_t put{0};
+      while (put < length) {
+        auto chunk{std::min(length - put, connection.RemainingSpaceInRecord())};
+        ok &= io.Emit(x + put, chunk);
+        put += chunk;
+        if (put < length) {
+          ok &= io.AdvanceRecord() && io.Emit(" ", 1);
+        }
+      }
+      list->lastWasUndelimitedCharacter = true;
+    }
+  } else {
+    // Formatted default CHARACTER output
+    if (edit.descriptor != 'A' && edit.descriptor != 'G') {
+      io.GetIoErrorHandler().Crash("Data edit descriptor '%c' may not be used "
+                                   "with a CHARACTER data item",
+          edit.descriptor);
+      return false;
+    }
+    int len{static_cast<int>(length)};
+    int width{edit.width.value_or(len)};
+    ok &= io.EmitRepeated(' ', std::max(0, width - len)) &&
+        io.Emit(x, std::min(width, len));
+  }
+  return ok;
+}
+
+static bool EditLogicalOutput(
+    IoStatementState &io, const DataEdit &edit, bool truth) {
+  bool ok{true};
+  if (auto *list{io.get_if<ListDirectedStatementState<false>>()}) {
+    ok &= list->EmitLeadingSpaceOrAdvance(io, 1);
+  } else {
+    if (edit.descriptor != 'L' && edit.descriptor != 'G') {
+      io.GetIoErrorHandler().Crash(
+          "Data edit descriptor '%c' may not be used with a LOGICAL data item",
+          edit.descriptor);
+      return false;
+    }
+    ok &= io.EmitRepeated(' ', std::max(0, edit.width.value_or(1) - 1));
+  }
+  return ok && io.Emit(truth ? "T" : "F", 1);
+}
+
+// Edits a run of data items, fetching one data edit descriptor for as
+// many consecutive items as its repeat count will cover.
+template<typename EDIT>
+static bool EditItems(IoStatementState &io, std::size_t count, EDIT edit) {
+  std::size_t j{0};
+  while (j < count) {
+    int maxRepeat{static_cast<int>(std::min<std::size_t>(
+        count - j, std::numeric_limits<int>::max()))};
+    DataEdit dataEdit{io.GetNextDataEdit(maxRepeat)};
+    for (int k{std::max(dataEdit.repeat, 1)}; k > 0 && j < count; --k) {
+      if (!edit(dataEdit, j++)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template<typename INT>
+static bool FormattedIntegerOutput(IoStatementState &io, const char *first,
+    std::size_t count, std::ptrdiff_t stride) {
+  return EditItems(io, count, [&](const DataEdit &edit, std::size_t j) {
+    return EditIntegerOutput(
+        io, edit, *reinterpret_cast<const INT *>(first + j * stride));
+  });
+}
+
+template<int binaryPrecision, typename A>
+static bool FormattedRealOutput(IoStatementState &io, const char *first,
+    std::size_t count, std::ptrdiff_t stride) {
+  return EditItems(io, count, [&](const DataEdit &edit, std::size_t j) {
+    return RealOutputEditing<binaryPrecision>{
+        io, *reinterpret_cast<const A *>(first + j * stride)}
+        .Edit(edit);
+  });
+}
+
+template<int binaryPrecision, typename A>
+static bool FormattedComplexOutput(IoStatementState &io, const char *first,
+    std::size_t count, std::ptrdiff_t stride) {
+  if (io.get_if<ListDirectedStatementState<false>>()) {
+    DataEdit real, imaginary;
+    real.descriptor = DataEdit::ListDirectedRealPart;
+    imaginary.descriptor = DataEdit::ListDirectedImaginaryPart;
+    for (std::size_t j{0}; j < count; ++j) {
+      const A *x{reinterpret_cast<const A *>(first + j * stride)};
+      if (!RealOutputEditing<binaryPrecision>{io, x[0]}.Edit(real) ||
+          !RealOutputEditing<binaryPrecision>{io, x[1]}.Edit(imaginary)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  // Each part is a distinct data item for formatting.
+  return EditItems(io, 2 * count, [&](const DataEdit &edit, std::size_t j) {
+    const A *x{reinterpret_cast<const A *>(first + (j / 2) * stride)};
+    return RealOutputEditing<binaryPrecision>{io, x[j % 2]}.Edit(edit);
+  });
+}
+
+static bool FormattedDescriptorOutput(
+    IoStatementState &io, const Descriptor &descriptor) {
+  using RunEditor = bool (*)(
+      IoStatementState &, const char *, std::size_t, std::ptrdiff_t);
+  RunEditor editor{nullptr};
+  std::size_t elementBytes{descriptor.ElementBytes()};
+  switch (descriptor.type().Categorize()) {
+  case TypeCategory::Integer:
+    switch (elementBytes) {
+    case 1: editor = FormattedIntegerOutput<std::int8_t>; break;
+    case 2: editor = FormattedIntegerOutput<std::int16_t>; break;
+    case 4: editor = FormattedIntegerOutput<std::int32_t>; break;
+    case 8: editor = FormattedIntegerOutput<std::int64_t>; break;
+    }
+    break;
+  case TypeCategory::Real:
+    switch (descriptor.type().raw()) {
+    case CFI_type_float: editor = FormattedRealOutput<24, float>; break;
+    case CFI_type_double: editor = FormattedRealOutput<53, double>; break;
+    }
+    break;
+  case TypeCategory::Complex:
+    switch (descriptor.type().raw()) {
+    case CFI_type_float_Complex:
+      editor = FormattedComplexOutput<24, float>;
+      break;
+    case CFI_type_double_Complex:
+      editor = FormattedComplexOutput<53, double>;
+      break;
+    }
+    break;
+  case TypeCategory::Character:
+    return ElementRuns{descriptor}.ForEachRun(
+        [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+          return EditItems(io, count, [&](const DataEdit &edit, std::size_t j) {
+            return EditDefaultCharacterOutput(
+                io, edit, first + j * stride, elementBytes);
+          });
+        });
+  case TypeCategory::Logical:
+    return ElementRuns{descriptor}.ForEachRun(
+        [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+          return EditItems(io, count, [&](const DataEdit &edit, std::size_t j) {
+            return EditLogicalOutput(io, edit, first[j * stride] != 0);
+          });
+        });
+  case TypeCategory::Derived: break;
+  }
+  if (!editor) {
+    io.GetIoErrorHandler().Crash("OutputDescriptor: type code %d with %zd-byte "
+                                 "elements is not yet implemented",
+        descriptor.type().raw(), elementBytes);  // TODO
+    return false;
+  }
+  return ElementRuns{descriptor}.ForEachRun(
+      [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+        return editor(io, first, count, stride);
+      });
+}
+
+bool IONAME(OutputDescriptor)(Cookie cookie, const Descriptor &descriptor) {
   IoStatementState &io{*cookie};
-  io.GetIoErrorHandler().Crash(
-      "OutputDescriptor: not yet implemented");  // TODO
+  ConversionTimer timer{io};
+  if (!io.get_if<OutputStatementState>()) {
+    io.GetIoErrorHandler().Crash(
+        "OutputDescriptor() called for a non-output I/O statement");
+    return false;
+  }
+  if (descriptor.type().IsDerived()) {
+    io.GetIoErrorHandler().Crash(
+        "OutputDescriptor: derived type items are not yet implemented");
+    return false;  // TODO
+  }
+  if (io.get_if<UnformattedStatementState>()) {
+    // Unformatted transfers copy the bytes of each run, or of each
+    // element when the run is not contiguous.
+    std::size_t elementBytes{descriptor.ElementBytes()};
+    return ElementRuns{descriptor}.ForEachRun(
+        [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+          if (stride == static_cast<std::ptrdiff_t>(elementBytes)) {
+            return io.Emit(first, count * elementBytes);
+          }
+          for (std::size_t j{0}; j < count; ++j) {
+            if (!io.Emit(first + j * stride, elementBytes)) {
+              return false;
+            }
+          }
+          return true;
+        });
+  }
+  return FormattedDescriptorOutput(io, descriptor);
 }
 
 bool IONAME(OutputUnformattedBlock)(
     Cookie cookie, const char *x, std::size_t length) {
   IoStatementState &io{*cookie};
-  if (auto *unf{io.get_if<UnformattedIoStatementState<false>>()}) {
-    return unf->Emit(x, length);
+  ConversionTimer timer{io};
+  if (io.get_if<UnformattedStatementState>()) {
+    return io.Emit(x, length);
   }
   io.GetIoErrorHandler().Crash("OutputUnformatted() called for an I/O "
                                "statement that is not unformatted output");
@@ -526,6 +1111,7 @@ bool IONAME(OutputUnformattedBlock)(
 
 bool IONAME(OutputInteger64)(Cookie cookie, std::int64_t n) {
   IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
   if (!io.get_if<OutputStatementState>()) {
     io.GetIoErrorHandler().Crash(
         "OutputInteger64() called for a non-output I/O statement");
@@ -536,6 +1122,7 @@ bool IONAME(OutputInteger64)(Cookie cookie, std::int64_t n) {
 
 bool IONAME(OutputReal64)(Cookie cookie, double x) {
   IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
   if (!io.get_if<OutputStatementState>()) {
     io.GetIoErrorHandler().Crash(
         "OutputReal64() called for a non-output I/O statement");
@@ -547,6 +1134,7 @@ bool IONAME(OutputReal64)(Cookie cookie, double x) {
 bool IONAME(OutputComplex64)(Cookie cookie, double r, double z) {
   IoStatementState &io{*cookie};
   if (io.get_if<ListDirectedStatementState<false>>()) {
+    ConversionTimer timer{io};
     DataEdit real, imaginary;
     real.descriptor = DataEdit::ListDirectedRealPart;
     imaginary.descriptor = DataEdit::ListDirectedImaginaryPart;
@@ -558,85 +1146,319 @@ bool IONAME(OutputComplex64)(Cookie cookie, double r, double z) {
 
 bool IONAME(OutputAscii)(Cookie cookie, const char *x, std::size_t length) {
   IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
   if (!io.get_if<OutputStatementState>()) {
     io.GetIoErrorHandler().Crash(
         "OutputAscii() called for a non-output I/O statement");
     return false;
   }
-  bool ok{true};
-  if (auto *list{io.get_if<ListDirectedStatementState<false>>()}) {
-    // List-directed default CHARACTER output
-    ok &= list->EmitLeadingSpaceOrAdvance(io, length, true);
-    MutableModes &modes{io.mutableModes()};
-    ConnectionState &connection{io.GetConnectionState()};
-    if (modes.delim) {
-      ok &= io.Emit(&modes.delim, 1);
-      for (std::size_t j{0}; j < length; ++j) {
-        if (list->NeedAdvance(connection, 2)) {
-          ok &= io.Emit(&modes.delim, 1) && io.AdvanceRecord() &&
-              io.Emit(&modes.delim, 1);
-        }
-        if (x[j] == modes.delim) {
-          ok &= io.EmitRepeated(modes.delim, 2);
-        } else {
-          ok &= io.Emit(&x[j], 1);
-        }
+  return EditDefaultCharacterOutput(io, io.GetNextDataEdit(), x, length);
+}
+
+bool IONAME(OutputLogical)(Cookie cookie, bool truth) {
+  IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
+  if (!io.get_if<OutputStatementState>()) {
+    io.GetIoErrorHandler().Crash(
+        "OutputLogical() called for a non-output I/O statement");
+    return false;
+  }
+  if (io.get_if<UnformattedStatementState>()) {
+    char x = truth;
+    return io.Emit(&x, 1);
+  }
+  return EditLogicalOutput(io, io.GetNextDataEdit(), truth);
+}
+
+// Reads a run of list-directed INTEGER or REAL items.  The values in
+// each record are scanned in place and converted directly, with neither
+// a data edit descriptor nor an update of the position for each item.
+// A null value, repeat count, or slash is left to the general path, one
+// item (or one repetition) at a time.
+template<typename CONVERT, typename EDIT>
+static bool ListDirectedRunInput(IoStatementState &io,
+    ListDirectedStatementState<true> &list, std::size_t count,
+    CONVERT convert, EDIT edit) {
+  using Scan = ListDirectedStatementState<true>::Scan;
+  bool isDecimalComma{(io.mutableModes().editingFlags & decimalComma) != 0};
+  std::size_t j{0};
+  while (j < count) {
+    const char *start{nullptr};
+    std::size_t bytes{io.GetNextInputBytes(start)};
+    if (io.InError()) {
+      return false;
+    }
+    const char *p{start}, *end{start + bytes};
+    Scan scan{Scan::Other};
+    std::size_t length{0};
+    bool ok{true};
+    while (ok && j < count &&
+        (scan = list.ScanValueInPlace(p, end, length, isDecimalComma)) ==
+            Scan::Value) {
+      ok = convert(p, length, j++);
+      p += length;
+    }
+    io.HandleRelativePosition(p - start);
+    if (!ok) {
+      return false;
+    } else if (j == count) {
+      break;
+    } else if (scan == Scan::EndOfRecord) {
+      if (!io.AdvanceRecord()) {
+        return false;
       }
-      ok &= io.Emit(&modes.delim, 1);
     } else {
-      std::size_t put{0};
-      while (put < length) {
-        auto chunk{std::min(length - put, connection.RemainingSpaceInRecord())};
-        ok &= io.Emit(x + put, chunk);
-        put += chunk;
-        if (put < length) {
-          ok &= io.AdvanceRecord() && io.Emit(" ", 1);
+      int maxRepeat{static_cast<int>(std::min<std::size_t>(
+          count - j, std::numeric_limits<int>::max()))};
+      DataEdit dataEdit{io.GetNextDataEdit(maxRepeat)};
+      for (int k{std::max(dataEdit.repeat, 1)}; k > 0 && j < count; --k) {
+        if (!edit(dataEdit, j++)) {
+          return false;
         }
       }
-      list->lastWasUndelimitedCharacter = true;
     }
-  } else {
-    // Formatted default CHARACTER output
-    DataEdit edit{io.GetNextDataEdit()};
-    if (edit.descriptor != 'A' && edit.descriptor != 'G') {
-      io.GetIoErrorHandler().Crash("Data edit descriptor '%c' may not be used "
-                                   "with a CHARACTER data item",
-          edit.descriptor);
-      return false;
+  }
+  return true;
+}
+
+template<int KIND>
+static bool FormattedIntegerInput(IoStatementState &io, char *first,
+    std::size_t count, std::ptrdiff_t stride) {
+  auto edit{[&](const DataEdit &dataEdit, std::size_t j) {
+    return EditIntegerInput(io, dataEdit, first + j * stride, KIND);
+  }};
+  if (auto *list{io.get_if<ListDirectedStatementState<true>>()}) {
+    IoErrorHandler &handler{io.GetIoErrorHandler()};
+    return ListDirectedRunInput(io, *list, count,
+        [&](const char *value, std::size_t length, std::size_t j) {
+          return ConvertIntegerInputValue(
+              handler, value, length, first + j * stride, KIND);
+        },
+        edit);
+  }
+  return EditItems(io, count, edit);
+}
+
+template<int binaryPrecision>
+static bool FormattedRealInput(IoStatementState &io, char *first,
+    std::size_t count, std::ptrdiff_t stride) {
+  auto edit{[&](const DataEdit &dataEdit, std::size_t j) {
+    return EditRealInput<binaryPrecision>(io, dataEdit, first + j * stride);
+  }};
+  if (auto *list{io.get_if<ListDirectedStatementState<true>>()}) {
+    IoErrorHandler &handler{io.GetIoErrorHandler()};
+    const MutableModes &modes{io.mutableModes()};
+    return ListDirectedRunInput(io, *list, count,
+        [&](const char *value, std::size_t length, std::size_t j) {
+          return ConvertRealInputValue<binaryPrecision>(
+              handler, value, length, first + j * stride, modes);
+        },
+        edit);
+  }
+  return EditItems(io, count, edit);
+}
+
+template<int binaryPrecision>
+static bool FormattedComplexInput(IoStatementState &io, char *first,
+    std::size_t count, std::ptrdiff_t stride) {
+  if (io.get_if<ListDirectedStatementState<true>>()) {
+    return EditItems(io, count, [&](const DataEdit &edit, std::size_t j) {
+      return EditListDirectedComplexInput<binaryPrecision>(
+          io, edit, first + j * stride);
+    });
+  }
+  // Each part is a distinct data item for formatting.
+  std::size_t partBytes{binaryPrecision == 24 ? 4 : 8};
+  return EditItems(io, 2 * count, [&](const DataEdit &edit, std::size_t j) {
+    return EditRealInput<binaryPrecision>(
+        io, edit, first + (j / 2) * stride + (j % 2) * partBytes);
+  });
+}
+
+static bool FormattedDescriptorInput(
+    IoStatementState &io, const Descriptor &descriptor) {
+  using RunEditor =
+      bool (*)(IoStatementState &, char *, std::size_t, std::ptrdiff_t);
+  RunEditor editor{nullptr};
+  std::size_t elementBytes{descriptor.ElementBytes()};
+  switch (descriptor.type().Categorize()) {
+  case TypeCategory::Integer:
+    switch (elementBytes) {
+    case 1: editor = FormattedIntegerInput<1>; break;
+    case 2: editor = FormattedIntegerInput<2>; break;
+    case 4: editor = FormattedIntegerInput<4>; break;
+    case 8: editor = FormattedIntegerInput<8>; break;
     }
-    int len{static_cast<int>(length)};
-    int width{edit.width.value_or(len)};
-    ok &= io.EmitRepeated(' ', std::max(0, width - len)) &&
-        io.Emit(x, std::min(width, len));
+    break;
+  case TypeCategory::Real:
+    switch (descriptor.type().raw()) {
+    case CFI_type_float: editor = FormattedRealInput<24>; break;
+    case CFI_type_double: editor = FormattedRealInput<53>; break;
+    }
+    break;
+  case TypeCategory::Complex:
+    switch (descriptor.type().raw()) {
+    case CFI_type_float_Complex: editor = FormattedComplexInput<24>; break;
+    case CFI_type_double_Complex: editor = FormattedComplexInput<53>; break;
+    }
+    break;
+  case TypeCategory::Character:
+    return ElementRuns{descriptor}.ForEachRun(
+        [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+          char *x{const_cast<char *>(first)};
+          return EditItems(io, count, [&](const DataEdit &edit, std::size_t j) {
+            return EditDefaultCharacterInput(
+                io, edit, x + j * stride, elementBytes);
+          });
+        });
+  case TypeCategory::Logical:
+    return ElementRuns{descriptor}.ForEachRun(
+        [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+          char *x{const_cast<char *>(first)};
+          return EditItems(io, count, [&](const DataEdit &edit, std::size_t j) {
+            bool truth{false};
+            if (edit.descriptor == DataEdit::ListDirectedNullValue) {
+              return !io.InError();
+            } else if (!EditLogicalInput(io, edit, truth)) {
+              return false;
+            }
+            char *item{x + j * stride};
+            switch (elementBytes) {
+            case 1: *reinterpret_cast<std::int8_t *>(item) = truth; break;
+            case 2: *reinterpret_cast<std::int16_t *>(item) = truth; break;
+            case 4: *reinterpret_cast<std::int32_t *>(item) = truth; break;
+            default: *reinterpret_cast<std::int64_t *>(item) = truth; break;
+            }
+            return true;
+          });
+        });
+  case TypeCategory::Derived: break;
   }
-  return ok;
+  if (!editor) {
+    io.GetIoErrorHandler().Crash("InputDescriptor: type code %d with %zd-byte "
+                                 "elements is not yet implemented",
+        descriptor.type().raw(), elementBytes);  // TODO
+    return false;
+  }
+  // The elements are being defined, so the descriptor's const-qualified
+  // element addresses are writable.
+  return ElementRuns{descriptor}.ForEachRun(
+      [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+        return editor(io, const_cast<char *>(first), count, stride);
+      });
 }
 
-bool IONAME(OutputLogical)(Cookie cookie, bool truth) {
+bool IONAME(InputDescriptor)(Cookie cookie, const Descriptor &descriptor) {
   IoStatementState &io{*cookie};
-  if (!io.get_if<OutputStatementState>()) {
+  ConversionTimer timer{io};
+  if (!io.get_if<InputStatementState>()) {
     io.GetIoErrorHandler().Crash(
-        "OutputLogical() called for a non-output I/O statement");
+        "InputDescriptor() called for a non-input I/O statement");
     return false;
   }
-  if (auto *unf{io.get_if<UnformattedIoStatementState<false>>()}) {
-    char x = truth;
-    return unf->Emit(&x, 1);
+  if (descriptor.type().IsDerived()) {
+    io.GetIoErrorHandler().Crash(
+        "InputDescriptor: derived type items are not yet implemented");
+    return false;  // TODO
   }
-  bool ok{true};
-  if (auto *list{io.get_if<ListDirectedStatementState<false>>()}) {
-    ok &= list->EmitLeadingSpaceOrAdvance(io, 1);
-  } else {
-    DataEdit edit{io.GetNextDataEdit()};
-    if (edit.descriptor != 'L' && edit.descriptor != 'G') {
-      io.GetIoErrorHandler().Crash(
-          "Data edit descriptor '%c' may not be used with a LOGICAL data item",
-          edit.descriptor);
+  if (io.InError()) {
+    return false;
+  }
+  if (io.get_if<UnformattedStatementState>()) {
+    std::size_t elementBytes{descriptor.ElementBytes()};
+    return ElementRuns{descriptor}.ForEachRun(
+        [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+          char *data{const_cast<char *>(first)};
+          if (stride == static_cast<std::ptrdiff_t>(elementBytes)) {
+            return io.Receive(data, count * elementBytes);
+          }
+          for (std::size_t j{0}; j < count; ++j) {
+            if (!io.Receive(data + j * stride, elementBytes)) {
+              return false;
+            }
+          }
+          return true;
+        });
+  }
+  return FormattedDescriptorInput(io, descriptor);
+}
+
+bool IONAME(InputUnformattedBlock)(Cookie cookie, char *x, std::size_t length) {
+  IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
+  if (io.get_if<UnformattedStatementState>()) {
+    return !io.InError() && io.Receive(x, length);
+  }
+  io.GetIoErrorHandler().Crash("InputUnformattedBlock() called for an I/O "
+                               "statement that is not unformatted input");
+  return false;
+}
+
+bool IONAME(InputInteger64)(Cookie cookie, std::int64_t &n, int kind) {
+  IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
+  if (!io.get_if<InputStatementState>()) {
+    io.GetIoErrorHandler().Crash(
+        "InputInteger64() called for a non-input I/O statement");
+    return false;
+  }
+  return !io.InError() && EditIntegerInput(io, io.GetNextDataEdit(), &n, kind);
+}
+
+bool IONAME(InputReal32)(Cookie cookie, float &x) {
+  IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
+  if (!io.get_if<InputStatementState>()) {
+    io.GetIoErrorHandler().Crash(
+        "InputReal32() called for a non-input I/O statement");
+    return false;
+  }
+  return !io.InError() && EditRealInput<24>(io, io.GetNextDataEdit(), &x);
+}
+
+bool IONAME(InputReal64)(Cookie cookie, double &x) {
+  IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
+  if (!io.get_if<InputStatementState>()) {
+    io.GetIoErrorHandler().Crash(
+        "InputReal64() called for a non-input I/O statement");
+    return false;
+  }
+  return !io.InError() && EditRealInput<53>(io, io.GetNextDataEdit(), &x);
+}
+
+bool IONAME(InputAscii)(Cookie cookie, char *x, std::size_t length) {
+  IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
+  if (!io.get_if<InputStatementState>()) {
+    io.GetIoErrorHandler().Crash(
+        "InputAscii() called for a non-input I/O statement");
+    return false;
+  }
+  return !io.InError() &&
+      EditDefaultCharacterInput(io, io.GetNextDataEdit(), x, length);
+}
+
+bool IONAME(InputLogical)(Cookie cookie, bool &truth) {
+  IoStatementState &io{*cookie};
+  ConversionTimer timer{io};
+  if (!io.get_if<InputStatementState>()) {
+    io.GetIoErrorHandler().Crash(
+        "InputLogical() called for a non-input I/O statement");
+    return false;
+  }
+  if (io.InError()) {
+    return false;
+  }
+  if (io.get_if<UnformattedStatementState>()) {
+    char x;
+    if (!io.Receive(&x, 1)) {
       return false;
     }
-    ok &= io.EmitRepeated(' ', std::max(0, edit.width.value_or(1) - 1));
+    truth = x != 0;
+    return true;
   }
-  return ok && io.Emit(truth ? "T" : "F", 1);
+  return EditLogicalInput(io, io.GetNextDataEdit(), truth);
 }
 
 enum Iostat IONAME(EndIoStatement)(Cookie cookie) {
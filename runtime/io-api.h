@@ -23,6 +23,7 @@ class NamelistGroup;
 
 namespace Fortran::runtime::io {
 
+class CompiledFormat;
 class IoStatementState;
 using Cookie = IoStatementState *;
 using ExternalUnit = int;
@@ -44,10 +45,12 @@ extern "C" {
 // in which the library can maintain state across the calls that implement
 // the internal transfer; use of these blocks can reduce the need for dynamic
 // memory allocation &/or thread-local storage.  The block must be sufficiently
-// aligned to hold a pointer.
+// aligned to hold a pointer.  When a block of at least the recommended size
+// is loaned, the internal I/O statement performs no dynamic allocation;
+// smaller blocks are ignored.
 constexpr std::size_t RecommendedInternalIoScratchAreaBytes(
     int maxFormatParenthesesNestingDepth) {
-  return 32 + 8 * maxFormatParenthesesNestingDepth;
+  return 736 + 8 * maxFormatParenthesesNestingDepth;
 }
 
 // Internal I/O to/from character arrays &/or non-default-kind character
@@ -118,6 +121,18 @@ Cookie IONAME(BeginExternalNamelistInput)(const NamelistGroup &,
     ExternalUnit = DefaultUnit, const char *sourceFile = nullptr,
     int sourceLine = 0);
 
+// A FORMAT may be decoded in advance into a CompiledFormat (see format.h)
+// that remains valid for the life of the program; a compiler may instead
+// emit one as initialized data for a FORMAT statement.  The runtime also
+// caches FORMATs passed to BeginExternalFormattedOutput() on its own.
+// CompileFormat() returns null if the FORMAT can't be compiled (it may
+// still be valid and should then be passed as text).
+const CompiledFormat *IONAME(CompileFormat)(const char *format, std::size_t,
+    const char *sourceFile = nullptr, int sourceLine = 0);
+Cookie IONAME(BeginExternalCompiledFormattedOutput)(const CompiledFormat &,
+    ExternalUnit = DefaultUnit, const char *sourceFile = nullptr,
+    int sourceLine = 0);
+
 // Asynchronous I/O is supported (at most) for unformatted direct access
 // block transfers.
 AsynchronousId IONAME(BeginAsynchronousOutput)(ExternalUnit, std::int64_t REC,
@@ -243,6 +258,13 @@ bool IONAME(SetForm)(Cookie, const char *, std::size_t);
 // POSITION=ASIS, REWIND, APPEND
 bool IONAME(SetPosition)(Cookie, const char *, std::size_t);
 bool IONAME(SetRecl)(Cookie, std::size_t);  // RECL=
+// Extensions that override the buffering of output to the unit,
+// whose defaults otherwise come from the environment (FORT_BUFFERING,
+// FORT_BUFFER_SIZE, FORT_FLUSH_THRESHOLD) or the file itself.
+// BUFFERING=UNBUFFERED, LINE, FULL, BACKGROUND (see buffer.h)
+bool IONAME(SetBuffering)(Cookie, const char *, std::size_t);
+bool IONAME(SetBufferSize)(Cookie, std::size_t bytes);
+bool IONAME(SetFlushThreshold)(Cookie, std::size_t bytes);
 
 // STATUS can be set during an OPEN or CLOSE statement.
 // For OPEN: STATUS=OLD, NEW, SCRATCH, REPLACE, UNKNOWN
@@ -292,6 +314,12 @@ bool IONAME(InquireInteger64)(
 enum Iostat {
   // Other errors have values >1
   IostatInquireInternalUnit = FORTRAN_RUNTIME_IOSTAT_INQUIRE_INTERNAL_UNIT,
+  IostatBadInput = FORTRAN_RUNTIME_IOSTAT_BAD_INPUT,  // invalid input value
+  // unformatted input beyond the end of the record
+  IostatShortRecord = FORTRAN_RUNTIME_IOSTAT_SHORT_RECORD,
+  // asynchronous transfer longer than RECL=
+  IostatRecordWriteOverflow = FORTRAN_RUNTIME_IOSTAT_RECORD_WRITE_OVERFLOW,
+  IostatRecordReadOverflow = FORTRAN_RUNTIME_IOSTAT_RECORD_READ_OVERFLOW,
   IostatOk = 0,
   IostatEnd = FORTRAN_RUNTIME_IOSTAT_END,  // end-of-file & no error
   IostatEor = FORTRAN_RUNTIME_IOSTAT_EOR,  // end-of-record & no error or EOF
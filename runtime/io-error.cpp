@@ -9,6 +9,7 @@
 #include "io-error.h"
 #include "magic-numbers.h"
 #include <cerrno>
+#include <cstdarg>
 #include <cstdio>
 #include <cstring>
 
@@ -38,10 +39,20 @@ void IoErrorHandler::SignalError(int iostatOrErrno) {
   }
 }
 
+void IoErrorHandler::SignalError(
+    int iostatOrErrno, const char *message, ...) {
+  if (iostatOrErrno > 0 && !(flags_ & hasIoStat)) {
+    va_list ap;
+    va_start(ap, message);
+    CrashArgs(message, ap);
+  }
+  SignalError(iostatOrErrno);
+}
+
 void IoErrorHandler::SignalErrno() { SignalError(errno); }
 
 void IoErrorHandler::SignalEnd() {
-  if (flags_ & hasEnd) {
+  if (flags_ & (hasIoStat | hasEnd)) {
     if (!ioStat_ || ioStat_ < FORTRAN_RUNTIME_IOSTAT_END) {
       ioStat_ = FORTRAN_RUNTIME_IOSTAT_END;
     }
@@ -51,7 +62,7 @@ void IoErrorHandler::SignalEnd() {
 }
 
 void IoErrorHandler::SignalEor() {
-  if (flags_ & hasEor) {
+  if (flags_ & (hasIoStat | hasEor)) {
     if (!ioStat_ || ioStat_ < FORTRAN_RUNTIME_IOSTAT_EOR) {
       ioStat_ = FORTRAN_RUNTIME_IOSTAT_EOR;  // least priority
     }
@@ -29,11 +29,15 @@ public:
   void HasEorLabel() { flags_ |= hasEor; }
 
   void SignalError(int iostatOrErrno);
+  // Like SignalError(), but crashes with a message of its own when the
+  // error is not to be handled by the program.
+  void SignalError(int iostatOrErrno, const char *message, ...);
   void SignalErrno();
   void SignalEnd();
   void SignalEor();
 
   int GetIoStat() const { return ioStat_; }
+  bool InError() const { return ioStat_ != 0; }
 
 private:
   enum Flag : std::uint8_t {
@@ -0,0 +1,130 @@
+//===-- runtime/io-stats.cpp ------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "io-stats.h"
+#include "lock.h"
+#include "memory.h"
+#include "terminator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Fortran::runtime::io {
+
+// A row of the table; a unit that is opened again gets another.
+struct RetainedIoStatistics {
+  int unitNumber;
+  char path[48];  // the end of a longer name
+  std::uint64_t flushes, statements, records;
+  std::uint64_t readCalls, bytesRead, writeCalls, bytesWritten;
+  std::uint64_t transferTime, conversionTime, formatTime;
+};
+
+static Lock retainedLock;
+static RetainedIoStatistics *retained{nullptr};
+static std::size_t retainedCount{0}, retainedCapacity{0};
+
+void RetainIoStatistics(int unitNumber, const char *path, std::size_t flushes,
+    const IoStatistics &statistics) {
+  auto get{[](const std::atomic<std::uint64_t> &x) {
+    return x.load(std::memory_order_relaxed);
+  }};
+  if (get(statistics.statements) == 0 && get(statistics.readCalls) == 0 &&
+      get(statistics.writeCalls) == 0) {
+    return;  // e.g., a predefined unit that was not used
+  }
+  CriticalSection criticalSection{retainedLock};
+  if (retainedCount == retainedCapacity) {
+    std::size_t capacity{retainedCapacity > 0 ? 2 * retainedCapacity : 16};
+    Terminator terminator{__FILE__, __LINE__};
+    auto *rows{static_cast<RetainedIoStatistics *>(AllocateMemoryOrCrash(
+        terminator, capacity * sizeof(RetainedIoStatistics)))};
+    if (retainedCount > 0) {
+      std::memcpy(rows, retained, retainedCount * sizeof *rows);
+    }
+    FreeMemory(retained);
+    retained = rows;
+    retainedCapacity = capacity;
+  }
+  RetainedIoStatistics &row{retained[retainedCount++]};
+  row.unitNumber = unitNumber;
+  if (!path) {
+    path = "-";
+  }
+  std::size_t length{std::strlen(path)};
+  if (length >= sizeof row.path) {
+    path += length - (sizeof row.path - 1);
+    length = sizeof row.path - 1;
+  }
+  std::memcpy(row.path, path, length);
+  row.path[length] = '\0';
+  row.flushes = flushes;
+  row.statements = get(statistics.statements);
+  row.records = get(statistics.records);
+  row.readCalls = get(statistics.readCalls);
+  row.bytesRead = get(statistics.bytesRead);
+  row.writeCalls = get(statistics.writeCalls);
+  row.bytesWritten = get(statistics.bytesWritten);
+  row.transferTime = get(statistics.transferTime);
+  row.conversionTime = get(statistics.conversionTime);
+  row.formatTime = get(statistics.formatTime);
+}
+
+void ReportIoStatistics() {
+  CriticalSection criticalSection{retainedLock};
+  static bool reported{false};
+  if (reported) {
+    return;
+  }
+  reported = true;
+  std::FILE *out{stderr};
+  const char *name{executionEnvironment.ioStatisticsFile};
+  if (name && !(out = std::fopen(name, "w"))) {
+    std::fprintf(stderr, "Fortran runtime: FORT_IO_STATS_FILE=%s: ", name);
+    std::perror(nullptr);
+    out = stderr;
+  }
+  std::fprintf(out,
+      "Fortran runtime I/O statistics (times in milliseconds)\n"
+      "%6s %10s %10s %8s %8s %12s %8s %12s %9s %9s %9s  %s\n",
+      "unit", "statements", "records", "flushes", "reads", "read bytes",
+      "writes", "write bytes", "I/O time", "convert", "FORMAT", "file");
+  auto ms{[](std::uint64_t ns) { return ns / 1.0e6; }};
+  for (std::size_t j{0}; j < retainedCount; ++j) {
+    const RetainedIoStatistics &row{retained[j]};
+    std::fprintf(out,
+        "%6d %10ju %10ju %8ju %8ju %12ju %8ju %12ju %9.3f %9.3f %9.3f  %s\n",
+        row.unitNumber, static_cast<std::uintmax_t>(row.statements),
+        static_cast<std::uintmax_t>(row.records),
+        static_cast<std::uintmax_t>(row.flushes),
+        static_cast<std::uintmax_t>(row.readCalls),
+        static_cast<std::uintmax_t>(row.bytesRead),
+        static_cast<std::uintmax_t>(row.writeCalls),
+        static_cast<std::uintmax_t>(row.bytesWritten), ms(row.transferTime),
+        ms(row.conversionTime), ms(row.formatTime), row.path);
+  }
+  if (out != stderr) {
+    std::fclose(out);
+  }
+  FreeMemoryAndNullify(retained);
+  retainedCount = retainedCapacity = 0;
+}
+
+void ReportIoCounters(int unitNumber, const char *path, std::size_t flushes,
+    const IoStatistics &statistics) {
+  auto get{[](const std::atomic<std::uint64_t> &x) {
+    return static_cast<std::uintmax_t>(x.load(std::memory_order_relaxed));
+  }};
+  std::fprintf(stderr,
+      "Fortran runtime: unit %d (%s): %ju flushes; %ju write calls, "
+      "%ju bytes; %ju read calls, %ju bytes\n",
+      unitNumber, path ? path : "-", static_cast<std::uintmax_t>(flushes),
+      get(statistics.writeCalls), get(statistics.bytesWritten),
+      get(statistics.readCalls), get(statistics.bytesRead));
+}
+}
@@ -0,0 +1,92 @@
+//===-- runtime/io-stats.h --------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Statistics of the I/O on external units.  The data transferred by each
+// file and the system calls that transferred them are always counted.
+// When the environment variable FORT_IO_STATS is set (and not 0), each
+// unit also counts its statements and records, and times its reads and
+// writes, the parsing of FORMATs for it, and its data transfer calls;
+// a table of all the units is written at the end of the program, to
+// standard error or to the file that FORT_IO_STATS_FILE names.
+// Otherwise, each of these costs only a test of a flag.  When
+// FORT_IO_COUNTERS is set, each unit's counts of data and system calls
+// are also written to standard error as it is closed.
+
+#ifndef FORTRAN_RUNTIME_IO_STATS_H_
+#define FORTRAN_RUNTIME_IO_STATS_H_
+
+#include "environment.h"
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+
+namespace Fortran::runtime::io {
+
+// Positional transfers and direct access statements may be concurrent,
+// so the counts are atomic.  Times are in nanoseconds.  A mapping of a
+// file into memory for reading counts as a read of the bytes mapped.
+struct IoStatistics {
+  std::atomic<std::uint64_t> readCalls{0}, writeCalls{0};
+  std::atomic<std::uint64_t> bytesRead{0}, bytesWritten{0};
+  std::atomic<std::uint64_t> statements{0}, records{0};
+  // The time of OpenFile::Read() and Write(), of the lookup or compilation
+  // of FORMATs, and of data transfer calls less that of their reads and
+  // writes, i.e. the time of data conversion and buffering.  A FORMAT that
+  // is interpreted, rather than compiled, is parsed during its data
+  // transfer calls.
+  std::atomic<std::uint64_t> transferTime{0}, formatTime{0};
+  std::atomic<std::uint64_t> conversionTime{0};
+};
+
+inline bool IoStatisticsEnabled() { return executionEnvironment.ioStatistics; }
+
+inline std::uint64_t IoStatisticsClock() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Counts an event for FORT_IO_STATS
+inline void CountIoStatistic(std::atomic<std::uint64_t> &count) {
+  if (IoStatisticsEnabled()) {
+    count.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+// Adds the time of its scope to a total for FORT_IO_STATS
+class IoStatisticsTimer {
+public:
+  explicit IoStatisticsTimer(std::atomic<std::uint64_t> &total)
+    : total_{IoStatisticsEnabled() ? &total : nullptr} {
+    if (total_) {
+      start_ = IoStatisticsClock();
+    }
+  }
+  ~IoStatisticsTimer() {
+    if (total_) {
+      total_->fetch_add(
+          IoStatisticsClock() - start_, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  std::atomic<std::uint64_t> *total_;
+  std::uint64_t start_{0};
+};
+
+// Keeps the statistics of a unit that is being closed, or that remains
+// open at the end of the program, for the table.
+void RetainIoStatistics(int unitNumber, const char *path, std::size_t flushes,
+    const IoStatistics &);
+// Writes the table of the retained statistics, once.
+void ReportIoStatistics();
+// Writes the counts of a unit that is being closed, for FORT_IO_COUNTERS.
+void ReportIoCounters(int unitNumber, const char *path, std::size_t flushes,
+    const IoStatistics &);
+}
+#endif  // FORTRAN_RUNTIME_IO_STATS_H_
@@ -8,7 +8,10 @@
 
 #include "io-stmt.h"
 #include "connection.h"
+#include "environment.h"
 #include "format.h"
+#include "io-stats.h"
+#include "magic-numbers.h"
 #include "memory.h"
 #include "tools.h"
 #include "unit.h"
@@ -25,6 +28,17 @@ DataEdit IoStatementBase::GetNextDataEdit(int) {
         "statement");
 }
 
+bool IoStatementBase::Receive(char *, std::size_t) {
+  Crash("IoStatementBase::Receive() called for non-unformatted-input I/O "
+        "statement");
+}
+
+std::size_t IoStatementBase::GetNextInputBytes(const char *&) {
+  Crash("IoStatementBase::GetNextInputBytes() called for non-input I/O "
+        "statement");
+  return 0;
+}
+
 template<bool isInput, typename CHAR>
 InternalIoStatementState<isInput, CHAR>::InternalIoStatementState(
     Buffer scalar, std::size_t length, const char *sourceFile, int sourceLine)
@@ -45,6 +59,22 @@ bool InternalIoStatementState<isInput, CHAR>::Emit(
   return unit_.Emit(data, chars, *this);
 }
 
+template<bool isInput, typename CHAR>
+char *InternalIoStatementState<isInput, CHAR>::ReserveOutput(
+    std::size_t chars) {
+  if constexpr (isInput || sizeof(CharType) != 1) {
+    return nullptr;
+  } else {
+    return unit_.ReserveOutput(chars);
+  }
+}
+
+template<bool isInput, typename CHAR>
+std::size_t InternalIoStatementState<isInput, CHAR>::GetNextInputBytes(
+    const char *&p) {
+  return unit_.GetNextInputBytes(p, *this);
+}
+
 template<bool isInput, typename CHAR>
 bool InternalIoStatementState<isInput, CHAR>::AdvanceRecord(int n) {
   while (n-- > 0) {
@@ -55,6 +85,18 @@ bool InternalIoStatementState<isInput, CHAR>::AdvanceRecord(int n) {
   return true;
 }
 
+template<bool isInput, typename CHAR>
+bool InternalIoStatementState<isInput, CHAR>::HandleAbsolutePosition(
+    std::int64_t n) {
+  return unit_.HandleAbsolutePosition(n, *this);
+}
+
+template<bool isInput, typename CHAR>
+bool InternalIoStatementState<isInput, CHAR>::HandleRelativePosition(
+    std::int64_t n) {
+  return unit_.HandleRelativePosition(n, *this);
+}
+
 template<bool isInput, typename CHAR>
 int InternalIoStatementState<isInput, CHAR>::EndIoStatement() {
   if constexpr (!isInput) {
@@ -71,18 +113,20 @@ template<bool isInput, typename CHAR>
 InternalFormattedIoStatementState<isInput,
     CHAR>::InternalFormattedIoStatementState(Buffer buffer, std::size_t length,
     const CHAR *format, std::size_t formatLength, const char *sourceFile,
-    int sourceLine)
+    int sourceLine, int maxHeight)
   : InternalIoStatementState<isInput, CHAR>{buffer, length, sourceFile,
         sourceLine},
-    ioStatementState_{*this}, format_{*this, format, formatLength} {}
+    ioStatementState_{*this},
+    format_{*this, format, formatLength, maxHeight} {}
 
 template<bool isInput, typename CHAR>
 InternalFormattedIoStatementState<isInput,
     CHAR>::InternalFormattedIoStatementState(const Descriptor &d,
     const CHAR *format, std::size_t formatLength, const char *sourceFile,
-    int sourceLine)
+    int sourceLine, int maxHeight)
   : InternalIoStatementState<isInput, CHAR>{d, sourceFile, sourceLine},
-    ioStatementState_{*this}, format_{*this, format, formatLength} {}
+    ioStatementState_{*this},
+    format_{*this, format, formatLength, maxHeight} {}
 
 template<bool isInput, typename CHAR>
 int InternalFormattedIoStatementState<isInput, CHAR>::EndIoStatement() {
@@ -92,18 +136,6 @@ int InternalFormattedIoStatementState<isInput, CHAR>::EndIoStatement() {
   return InternalIoStatementState<isInput, CHAR>::EndIoStatement();
 }
 
-template<bool isInput, typename CHAR>
-bool InternalFormattedIoStatementState<isInput, CHAR>::HandleAbsolutePosition(
-    std::int64_t n) {
-  return unit_.HandleAbsolutePosition(n, *this);
-}
-
-template<bool isInput, typename CHAR>
-bool InternalFormattedIoStatementState<isInput, CHAR>::HandleRelativePosition(
-    std::int64_t n) {
-  return unit_.HandleRelativePosition(n, *this);
-}
-
 template<bool isInput, typename CHAR>
 InternalListIoStatementState<isInput, CHAR>::InternalListIoStatementState(
     Buffer buffer, std::size_t length, const char *sourceFile, int sourceLine)
@@ -119,7 +151,9 @@ InternalListIoStatementState<isInput, CHAR>::InternalListIoStatementState(
 
 ExternalIoStatementBase::ExternalIoStatementBase(
     ExternalFileUnit &unit, const char *sourceFile, int sourceLine)
-  : IoStatementBase{sourceFile, sourceLine}, unit_{unit} {}
+  : IoStatementBase{sourceFile, sourceLine}, unit_{unit} {
+  CountIoStatistic(unit.statistics().statements);
+}
 
 MutableModes &ExternalIoStatementBase::mutableModes() { return unit_.modes; }
 
@@ -133,7 +167,7 @@ int ExternalIoStatementBase::EndIoStatement() {
     unit_.leftTabLimit.reset();
   }
   auto result{IoStatementBase::EndIoStatement()};
-  unit_.EndIoStatement();  // annihilates *this in unit_.u_
+  unit_.EndIoStatement();  // annihilates *this
   return result;
 }
 
@@ -151,13 +185,42 @@ int OpenStatementState::EndIoStatement() {
   if (wasExtant_ && status_ != OpenStatus::Old) {
     Crash("OPEN statement for connected unit must have STATUS='OLD'");
   }
-  unit().OpenUnit(status_, position_, std::move(path_), pathLength_, *this);
-  return IoStatementBase::EndIoStatement();
+  ExternalFileUnit &unit{this->unit()};
+  unit.OpenUnit(status_, position_, std::move(path_), pathLength_, *this);
+  if (!wasExtant_ && !unit.IsOpen()) {
+    unit.AbandonUnit();
+  }
+  auto result{IoStatementBase::EndIoStatement()};
+  unit.EndIoStatement();  // annihilates *this
+  return result;
 }
 
+// The unit's statement lock, taken when the statement began, is held
+// until the unit has been closed and unregistered.
 int CloseStatementState::EndIoStatement() {
-  unit().CloseUnit(status_, *this);
-  return IoStatementBase::EndIoStatement();
+  IoErrorHandler handler{*this};
+  ExternalFileUnit &unit{this->unit()};
+  unit.CloseUnit(status_, handler);
+  unit.EndIoStatement();  // annihilates *this, and releases the unit
+  return handler.GetIoStat();
+}
+
+int WaitStatementState::EndIoStatement() {
+  if (id_) {
+    unit().Wait(*id_, *this);
+  } else {
+    unit().WaitAll(*this);
+  }
+  auto result{IoStatementBase::EndIoStatement()};
+  unit().EndIoStatement();  // annihilates *this
+  return result;
+}
+
+int FlushStatementState::EndIoStatement() {
+  unit().Drain(*this);
+  auto result{IoStatementBase::EndIoStatement()};
+  unit().EndIoStatement();  // annihilates *this
+  return result;
 }
 
 int NoopCloseStatementState::EndIoStatement() {
@@ -167,11 +230,17 @@ int NoopCloseStatementState::EndIoStatement() {
 }
 
 template<bool isInput> int ExternalIoStatementState<isInput>::EndIoStatement() {
-  if constexpr (!isInput) {
+  if constexpr (isInput) {
+    // Skip the rest of the record, even after an error in a data item,
+    // unless the statement has already reached the end of the file.
+    if (!unit().nonAdvancing && GetIoStat() != FORTRAN_RUNTIME_IOSTAT_END) {
+      unit().AdvanceRecord(*this);
+    }
+  } else {
     if (!unit().nonAdvancing) {
       unit().AdvanceRecord(*this);
     }
-    unit().FlushIfTerminal(*this);
+    unit().FlushOutput(*this);
   }
   return ExternalIoStatementBase::EndIoStatement();
 }
@@ -185,6 +254,15 @@ bool ExternalIoStatementState<isInput>::Emit(
   return unit().Emit(data, chars * sizeof(*data), *this);
 }
 
+template<bool isInput>
+char *ExternalIoStatementState<isInput>::ReserveOutput(std::size_t chars) {
+  if constexpr (isInput) {
+    return nullptr;
+  } else {
+    return unit().ReserveOutput(chars, *this);
+  }
+}
+
 template<bool isInput>
 bool ExternalIoStatementState<isInput>::Emit(
     const char16_t *data, std::size_t chars) {
@@ -207,6 +285,12 @@ bool ExternalIoStatementState<isInput>::Emit(
       reinterpret_cast<const char *>(data), chars * sizeof(*data), *this);
 }
 
+template<bool isInput>
+std::size_t ExternalIoStatementState<isInput>::GetNextInputBytes(
+    const char *&p) {
+  return unit().GetNextInputBytes(p, *this);
+}
+
 template<bool isInput>
 bool ExternalIoStatementState<isInput>::AdvanceRecord(int n) {
   while (n-- > 0) {
@@ -235,9 +319,20 @@ ExternalFormattedIoStatementState<isInput,
   : ExternalIoStatementState<isInput>{unit, sourceFile, sourceLine},
     mutableModes_{unit.modes}, format_{*this, format, formatLength} {}
 
+template<bool isInput, typename CHAR>
+ExternalFormattedIoStatementState<isInput,
+    CHAR>::ExternalFormattedIoStatementState(ExternalFileUnit &unit,
+    const CompiledFormat &compiled, const char *sourceFile, int sourceLine)
+  : ExternalIoStatementState<isInput>{unit, sourceFile, sourceLine},
+    mutableModes_{unit.modes}, format_{*this, compiled} {}
+
 template<bool isInput, typename CHAR>
 int ExternalFormattedIoStatementState<isInput, CHAR>::EndIoStatement() {
-  format_.FinishOutput(*this);
+  // On input, this processes any control edit descriptors (e.g., /)
+  // that follow the last data edit descriptor used.
+  if (!isInput || !this->InError()) {
+    format_.FinishOutput(*this);
+  }
   return ExternalIoStatementState<isInput>::EndIoStatement();
 }
 
@@ -249,10 +344,41 @@ bool IoStatementState::Emit(const char *data, std::size_t n) {
   return std::visit([=](auto &x) { return x.get().Emit(data, n); }, u_);
 }
 
+bool IoStatementState::Receive(char *data, std::size_t n) {
+  return std::visit([=](auto &x) { return x.get().Receive(data, n); }, u_);
+}
+
+std::size_t IoStatementState::GetNextInputBytes(const char *&p) {
+  return std::visit(
+      [&](auto &x) { return x.get().GetNextInputBytes(p); }, u_);
+}
+
 bool IoStatementState::AdvanceRecord(int n) {
   return std::visit([=](auto &x) { return x.get().AdvanceRecord(n); }, u_);
 }
 
+bool IoStatementState::HandleRelativePosition(std::int64_t n) {
+  return std::visit(
+      [=](auto &x) { return x.get().HandleRelativePosition(n); }, u_);
+}
+
+ExternalFileUnit *IoStatementState::GetExternalFileUnit() const {
+  return std::visit(
+      [](auto &x) -> ExternalFileUnit * {
+        using State = std::decay_t<decltype(x.get())>;
+        if constexpr (std::is_convertible_v<State &,
+                          ExternalIoStatementBase &> ||
+            std::is_convertible_v<State &,
+                DirectUnformattedIoStatementState<false> &> ||
+            std::is_convertible_v<State &,
+                DirectUnformattedIoStatementState<true> &>) {
+          return &x.get().unit();
+        }
+        return nullptr;
+      },
+      u_);
+}
+
 int IoStatementState::EndIoStatement() {
   return std::visit([](auto &x) { return x.get().EndIoStatement(); }, u_);
 }
@@ -276,13 +402,26 @@ IoErrorHandler &IoStatementState::GetIoErrorHandler() const {
       u_);
 }
 
+char *IoStatementState::ReserveOutput(std::size_t n) {
+  return std::visit([=](auto &x) { return x.get().ReserveOutput(n); }, u_);
+}
+
 bool IoStatementState::EmitRepeated(char ch, std::size_t n) {
   return std::visit(
       [=](auto &x) {
-        for (std::size_t j{0}; j < n; ++j) {
-          if (!x.get().Emit(&ch, 1)) {
+        auto &state{x.get()};
+        if (char *p{state.ReserveOutput(n)}) {
+          std::memset(p, ch, n);
+          return true;
+        }
+        char chunk[64];
+        std::memset(chunk, ch, std::min(n, sizeof chunk));
+        for (std::size_t left{n}; left > 0;) {
+          std::size_t bytes{std::min(left, sizeof chunk)};
+          if (!state.Emit(chunk, bytes)) {
             return false;
           }
+          left -= bytes;
         }
         return true;
       },
@@ -297,11 +436,45 @@ bool IoStatementState::EmitField(
   if (length > static_cast<std::size_t>(width)) {
     return EmitRepeated('*', width);
   } else {
-    return EmitRepeated(' ', static_cast<int>(width - length)) &&
-        Emit(p, length);
+    return OutputCursor{*this, width}
+        .Fill(' ', width - length)
+        .Put(p, length)
+        .Finish();
   }
 }
 
+static constexpr bool IsBlank(char ch) { return ch == ' ' || ch == '\t'; }
+
+// Works with IoStatementState and with the input statement state
+// classes themselves, which avoids dispatching for each character.
+template<typename IO>
+static std::optional<char> NextNonBlankIn(IO &io, bool acrossRecords) {
+  while (true) {
+    const char *p{nullptr};
+    std::size_t bytes{io.GetNextInputBytes(p)};
+    if (io.InError()) {
+      return std::nullopt;
+    }
+    std::size_t j{0};
+    while (j < bytes && IsBlank(p[j])) {
+      ++j;
+    }
+    if (j > 0) {
+      io.HandleRelativePosition(j);
+    }
+    if (j < bytes) {
+      return p[j];
+    }
+    if (!acrossRecords || !io.AdvanceRecord()) {
+      return std::nullopt;
+    }
+  }
+}
+
+std::optional<char> IoStatementState::NextNonBlank(bool acrossRecords) {
+  return NextNonBlankIn(*this, acrossRecords);
+}
+
 bool ListDirectedStatementState<false>::NeedAdvance(
     const ConnectionState &connection, std::size_t width) const {
   return connection.positionInRecord > 0 &&
@@ -326,28 +499,449 @@ bool ListDirectedStatementState<false>::EmitLeadingSpaceOrAdvance(
   return true;
 }
 
+// Classes of the characters that delimit list-directed input values,
+// so that a value can be scanned with one table lookup per character.
+enum ListInputCharClass : std::uint8_t {
+  blankClass = 1,
+  commaClass = 2,  // value separator, unless DECIMAL='COMMA'
+  semicolonClass = 4,  // value separator when DECIMAL='COMMA'
+  slashClass = 8,
+  closeClass = 16,  // ')' ends the imaginary part of a complex value
+};
+
+struct ListInputCharClasses {
+  constexpr ListInputCharClasses() {
+    classes[static_cast<unsigned char>(' ')] = blankClass;
+    classes[static_cast<unsigned char>('\t')] = blankClass;
+    classes[static_cast<unsigned char>(',')] = commaClass;
+    classes[static_cast<unsigned char>(';')] = semicolonClass;
+    classes[static_cast<unsigned char>('/')] = slashClass;
+    classes[static_cast<unsigned char>(')')] = closeClass;
+  }
+  std::uint8_t classes[256]{};
+};
+static constexpr ListInputCharClasses listInputCharClasses;
+
+static inline std::uint8_t ListInputCharClass(char ch) {
+  return listInputCharClasses.classes[static_cast<unsigned char>(ch)];
+}
+
+std::size_t ListDirectedStatementState<true>::ValueLength(
+    const char *p, const char *end, bool decimalComma) {
+  std::uint8_t stop(blankClass | slashClass | closeClass |
+      (decimalComma ? semicolonClass : commaClass));
+  const char *q{p};
+  while (q < end && !(ListInputCharClass(*q) & stop)) {
+    ++q;
+  }
+  return q - p;
+}
+
+template<typename STATE>
+DataEdit ListDirectedStatementState<true>::GetNextDataEdit(
+    STATE &io, int maxRepeat) {
+  DataEdit edit;
+  edit.descriptor = DataEdit::ListDirected;
+  edit.repeat = 1;
+  edit.modes = io.mutableModes();
+  if (hitSlash_) {
+    edit.descriptor = DataEdit::ListDirectedNullValue;
+    edit.repeat = maxRepeat;
+    return edit;
+  }
+  if (remaining_ > 0) {  // r*c or r*
+    if (repeatPosition_ < 0) {
+      edit.descriptor = DataEdit::ListDirectedNullValue;
+      edit.repeat = std::min(remaining_, maxRepeat);
+      remaining_ -= edit.repeat;
+    } else {
+      --remaining_;
+      io.HandleRelativePosition(
+          repeatPosition_ - io.GetConnectionState().positionInRecord);
+    }
+    return edit;
+  }
+  char comma{edit.modes.editingFlags & decimalComma ? ';' : ','};
+  std::optional<char> next{NextNonBlankIn(io, true)};
+  if (next && *next == comma && eatComma_) {
+    io.HandleRelativePosition(1);
+    next = NextNonBlankIn(io, true);
+  }
+  eatComma_ = true;
+  if (!next || *next == comma) {
+    // A null value, or the end of the file has been signaled
+    edit.descriptor = DataEdit::ListDirectedNullValue;
+    return edit;
+  }
+  if (*next == '/') {
+    io.HandleRelativePosition(1);
+    hitSlash_ = true;
+    edit.descriptor = DataEdit::ListDirectedNullValue;
+    edit.repeat = maxRepeat;
+    return edit;
+  }
+  // Look for a repeat count: r*c or r*
+  const char *p{nullptr};
+  std::size_t bytes{io.GetNextInputBytes(p)};
+  std::size_t j{0};
+  int repeat{0};
+  for (; j < bytes && p[j] >= '0' && p[j] <= '9'; ++j) {
+    if (repeat > (std::numeric_limits<int>::max() - 9) / 10) {
+      break;  // not a plausible repeat count; let the item reject it
+    }
+    repeat = 10 * repeat + p[j] - '0';
+  }
+  if (j == 0 || j == bytes || p[j] != '*') {
+    return edit;
+  }
+  if (repeat == 0) {
+    io.SignalError(FORTRAN_RUNTIME_IOSTAT_BAD_INPUT,
+        "Zero repeat count in list-directed input at '%.*s'",
+        static_cast<int>(j + 1), p);
+    edit.descriptor = DataEdit::ListDirectedNullValue;
+    return edit;
+  }
+  bool isNull{j + 1 == bytes ||
+      (ListInputCharClass(p[j + 1]) & (blankClass | slashClass)) != 0 ||
+      p[j + 1] == comma};
+  io.HandleRelativePosition(j + 1);
+  if (isNull) {
+    edit.descriptor = DataEdit::ListDirectedNullValue;
+    edit.repeat = std::min(repeat, maxRepeat);
+    remaining_ = repeat - edit.repeat;
+    repeatPosition_ = -1;
+  } else {
+    remaining_ = repeat - 1;
+    repeatPosition_ = io.GetConnectionState().positionInRecord;
+  }
+  return edit;
+}
+
+ListDirectedStatementState<true>::Scan
+ListDirectedStatementState<true>::ScanValueInPlace(
+    const char *&p, const char *end, std::size_t &length, bool decimalComma) {
+  if (remaining_ > 0 || hitSlash_) {
+    return Scan::Other;
+  }
+  char comma{decimalComma ? ';' : ','};
+  while (p < end && ListInputCharClass(*p) == blankClass) {
+    ++p;
+  }
+  if (p < end && *p == comma && eatComma_) {
+    eatComma_ = false;
+    for (++p; p < end && ListInputCharClass(*p) == blankClass; ++p) {
+    }
+  }
+  if (p == end) {
+    return Scan::EndOfRecord;
+  }
+  if (*p == comma || *p == '/') {
+    return Scan::Other;
+  }
+  length = ValueLength(p, end, decimalComma);
+  if (length == 0 || std::memchr(p, '*', length)) {
+    return Scan::Other;  // a repeat count, or not a value
+  }
+  eatComma_ = true;
+  return Scan::Value;
+}
+
+template DataEdit ListDirectedStatementState<true>::GetNextDataEdit(
+    InternalListIoStatementState<true> &, int);
+template DataEdit ListDirectedStatementState<true>::GetNextDataEdit(
+    ExternalListIoStatementState<true> &, int);
+
+static constexpr std::int64_t markerBytes{sizeof(std::int32_t)};
+
+static std::int64_t MaxSubrecordBytes(std::int64_t limit) {
+  std::size_t bytes{executionEnvironment.maxSubrecordBytes};
+  return bytes > 0 ? std::min(static_cast<std::int64_t>(bytes), limit) : limit;
+}
+
+template<bool isInput> bool UnformattedIoStatementState<isInput>::IsFramed() {
+  ExternalFileUnit &unit{this->unit()};
+  return unit.access == Access::Sequential && !unit.recordLength.has_value();
+}
+
+template<bool isInput>
+bool UnformattedIoStatementState<isInput>::BeginSubrecord() {
+  inRecord_ = true;
+  std::int32_t header{0};
+  if constexpr (isInput) {
+    if (!this->unit().Receive(
+            reinterpret_cast<char *>(&header), sizeof header, *this)) {
+      return false;
+    }
+    more_ = header < 0;
+    subrecordBytes_ = more_ ? -std::int64_t{header} : header;
+    return true;
+  } else {
+    // Patched by FinishSubrecord()
+    return ExternalIoStatementState<isInput>::Emit(
+        reinterpret_cast<const char *>(&header), sizeof header);
+  }
+}
+
+template<bool isInput>
+bool UnformattedIoStatementState<isInput>::Emit(
+    const char *data, std::size_t bytes) {
+  if (!IsFramed()) {
+    return ExternalIoStatementState<isInput>::Emit(data, bytes);
+  }
+  if (!inRecord_ && !BeginSubrecord()) {
+    return false;
+  }
+  ExternalFileUnit &unit{this->unit()};
+  std::int64_t maxBytes{MaxSubrecordBytes(defaultMaxSubrecordBytes)};
+  while (true) {
+    std::int64_t room{maxBytes -
+        (unit.furthestPositionInRecord - subrecordOffset_ - markerBytes)};
+    if (static_cast<std::int64_t>(bytes) <= room) {
+      return ExternalIoStatementState<isInput>::Emit(data, bytes);
+    }
+    if (!ExternalIoStatementState<isInput>::Emit(data, room) ||
+        !FinishSubrecord(true)) {
+      return false;
+    }
+    data += room;
+    bytes -= room;
+  }
+}
+
+// Appends the footer of the current subrecord and patches its header.
+// When more follow, the completed subrecord is flushed, and the header
+// of the next is begun.
+template<bool isInput>
+bool UnformattedIoStatementState<isInput>::FinishSubrecord(bool more) {
+  ExternalFileUnit &unit{this->unit()};
+  std::int64_t length{
+      unit.furthestPositionInRecord - subrecordOffset_ - markerBytes};
+  std::int32_t header{static_cast<std::int32_t>(more ? -length : length)};
+  std::int32_t footer{static_cast<std::int32_t>(continued_ ? -length : length)};
+  // TODO: Convert markers to little-endian on big-endian host?
+  std::int64_t end{unit.furthestPositionInRecord + markerBytes};
+  if (!(ExternalIoStatementState<isInput>::Emit(
+            reinterpret_cast<const char *>(&footer), sizeof footer) &&
+          this->HandleAbsolutePosition(subrecordOffset_) &&
+          ExternalIoStatementState<isInput>::Emit(
+              reinterpret_cast<const char *>(&header), sizeof header) &&
+          this->HandleAbsolutePosition(end))) {
+    return false;
+  }
+  if (more) {
+    unit.Flush(*this);
+    subrecordOffset_ = end;
+    continued_ = true;
+    return BeginSubrecord();
+  }
+  return true;
+}
+
+template<bool isInput>
+bool UnformattedIoStatementState<isInput>::Receive(
+    char *data, std::size_t bytes) {
+  if constexpr (!isInput) {
+    this->Crash("UnformattedIoStatementState::Receive called for output "
+                "statement");
+  }
+  ExternalFileUnit &unit{this->unit()};
+  if (!IsFramed()) {
+    return unit.Receive(data, bytes, *this);
+  }
+  if (!inRecord_ && !BeginSubrecord()) {
+    return false;
+  }
+  while (true) {
+    std::int64_t room{subrecordOffset_ + markerBytes + subrecordBytes_ -
+        unit.positionInRecord};
+    if (static_cast<std::int64_t>(bytes) <= room) {
+      return unit.Receive(data, bytes, *this);
+    }
+    if (!more_) {
+      this->SignalError(FORTRAN_RUNTIME_IOSTAT_SHORT_RECORD,
+          "Unformatted READ needs more data than the record at file offset "
+          "%jd holds",
+          static_cast<std::intmax_t>(unit.recordOffsetInFile));
+      return false;
+    }
+    if (!unit.Receive(data, room, *this) || !NextSubrecord()) {
+      return false;
+    }
+    data += room;
+    bytes -= room;
+  }
+}
+
+// Reads the footer of the current subrecord and the header of the next.
+template<bool isInput>
+bool UnformattedIoStatementState<isInput>::NextSubrecord() {
+  ExternalFileUnit &unit{this->unit()};
+  std::int64_t footerAt{subrecordOffset_ + markerBytes + subrecordBytes_};
+  std::int32_t markers[2];
+  if (!this->HandleAbsolutePosition(footerAt) ||
+      !unit.Receive(reinterpret_cast<char *>(markers), sizeof markers, *this)) {
+    return false;
+  }
+  subrecordOffset_ = footerAt + markerBytes;
+  more_ = markers[1] < 0;
+  subrecordBytes_ = more_ ? -std::int64_t{markers[1]} : markers[1];
+  return true;
+}
+
 template<bool isInput>
 int UnformattedIoStatementState<isInput>::EndIoStatement() {
-  auto &ext{static_cast<ExternalIoStatementState<isInput> &>(*this)};
-  ExternalFileUnit &unit{ext.unit()};
-  if (unit.access == Access::Sequential && !unit.recordLength.has_value()) {
-    // Overwrite the first four bytes of the record with its length,
-    // and also append the length.  These four bytes were skipped over
-    // in BeginUnformattedOutput().
-    // TODO: Break very large records up into subrecords with negative
-    // headers &/or footers
-    union {
-      std::uint32_t u;
-      char c[sizeof u];
-    } u;
-    u.u = unit.furthestPositionInRecord - sizeof u.c;
-    // TODO: Convert record length to little-endian on big-endian host?
-    if (!(ext.Emit(u.c, sizeof u.c) && ext.HandleAbsolutePosition(0) &&
-            ext.Emit(u.c, sizeof u.c) && ext.AdvanceRecord())) {
+  if (IsFramed()) {
+    if (!inRecord_ && !this->InError()) {
+      BeginSubrecord();  // an empty READ or WRITE still transfers a record
+    }
+    if constexpr (isInput) {
+      // Skip the rest of the record, including any later subrecords,
+      // unless its header could not be read.
+      if (inRecord_ && this->GetIoStat() != FORTRAN_RUNTIME_IOSTAT_END) {
+        while (more_ && NextSubrecord()) {
+        }
+        this->HandleAbsolutePosition(
+            subrecordOffset_ + markerBytes + subrecordBytes_ + markerBytes);
+      }
+    } else if (!this->InError()) {
+      FinishSubrecord(false);
+    }
+  }
+  return ExternalIoStatementState<isInput>::EndIoStatement();
+}
+
+template<bool isInput>
+DirectUnformattedIoStatementState<isInput>::DirectUnformattedIoStatementState(
+    ExternalFileUnit &unit, const char *sourceFile, int sourceLine)
+  : IoStatementBase{sourceFile, sourceLine}, unit_{unit}, ioStatementState_{
+                                                               *this} {
+  static_cast<ConnectionAttributes &>(connection_) = unit;
+  connection_.modes = unit.modes;
+  CountIoStatistic(unit.statistics().statements);
+  CountIoStatistic(unit.statistics().records);
+}
+
+template<bool isInput>
+void DirectUnformattedIoStatementState<isInput>::SetPosition(
+    std::int64_t offset) {
+  connection_.recordOffsetInFile = offset;
+  connection_.positionInRecord = 0;
+  positioned_ = true;
+  stageAt_ = 0;
+  stageBytes_ = 0;
+}
+
+template<bool isInput>
+bool DirectUnformattedIoStatementState<isInput>::CheckRecord(
+    std::size_t bytes) {
+  if (!positioned_) {
+    Crash("REC= is required for a data transfer on a unit connected for "
+          "direct access");
+  }
+  if (connection_.positionInRecord + static_cast<std::int64_t>(bytes) >
+      static_cast<std::int64_t>(*connection_.recordLength)) {
+    if constexpr (isInput) {
+      SignalError(FORTRAN_RUNTIME_IOSTAT_SHORT_RECORD,
+          "Unformatted READ needs more data than the record (RECL=%jd) holds",
+          static_cast<std::intmax_t>(*connection_.recordLength));
+    } else {
+      SignalEor();
+    }
+    return false;
+  }
+  return true;
+}
+
+template<bool isInput>
+bool DirectUnformattedIoStatementState<isInput>::Emit(
+    const char *data, std::size_t bytes) {
+  if constexpr (isInput) {
+    Crash("DirectUnformattedIoStatementState::Emit called for input "
+          "statement");
+  }
+  if (!CheckRecord(bytes)) {
+    return false;
+  }
+  if (bytes < sizeof stage_) {
+    if (stageBytes_ + bytes > sizeof stage_ && !FlushStage()) {
       return false;
     }
+    if (stageBytes_ == 0) {
+      stageAt_ = connection_.positionInRecord;
+    }
+    std::memcpy(stage_ + stageBytes_, data, bytes);
+    stageBytes_ += bytes;
+    connection_.positionInRecord += bytes;
+    return true;
+  }
+  if (!FlushStage()) {
+    return false;
   }
-  return ext.EndIoStatement();
+  std::size_t put{unit_.Write(
+      connection_.recordOffsetInFile + connection_.positionInRecord, data,
+      bytes, *this)};
+  connection_.positionInRecord += put;
+  return put == bytes;
+}
+
+template<bool isInput>
+bool DirectUnformattedIoStatementState<isInput>::FlushStage() {
+  if constexpr (!isInput) {
+    if (stageBytes_ > 0) {
+      std::size_t put{unit_.Write(connection_.recordOffsetInFile + stageAt_,
+          stage_, stageBytes_, *this)};
+      bool ok{put == stageBytes_};
+      stageBytes_ = 0;
+      return ok;
+    }
+  }
+  return true;
+}
+
+template<bool isInput>
+bool DirectUnformattedIoStatementState<isInput>::Receive(
+    char *data, std::size_t bytes) {
+  if constexpr (!isInput) {
+    Crash("DirectUnformattedIoStatementState::Receive called for output "
+          "statement");
+  }
+  if (!CheckRecord(bytes)) {
+    return false;
+  }
+  std::int64_t at{connection_.positionInRecord};
+  std::int64_t offset{connection_.recordOffsetInFile};
+  if (at < stageAt_ ||
+      at + static_cast<std::int64_t>(bytes) >
+          stageAt_ + static_cast<std::int64_t>(stageBytes_)) {
+    if (bytes >= sizeof stage_) {
+      if (unit_.Read(offset + at, data, bytes, bytes, *this) < bytes) {
+        return false;
+      }
+      connection_.positionInRecord += bytes;
+      return true;
+    }
+    // Stage the rest of the record, or as much of it as fits
+    std::size_t most{std::min<std::size_t>(
+        sizeof stage_, *connection_.recordLength - at)};
+    stageAt_ = at;
+    stageBytes_ = unit_.Read(offset + at, stage_, bytes, most, *this);
+    if (stageBytes_ < bytes) {
+      return false;
+    }
+  }
+  std::memcpy(data, stage_ + (at - stageAt_), bytes);
+  connection_.positionInRecord += bytes;
+  return true;
+}
+
+template<bool isInput>
+int DirectUnformattedIoStatementState<isInput>::EndIoStatement() {
+  FlushStage();
+  auto result{IoStatementBase::EndIoStatement()};
+  ExternalFileUnit &unit{unit_};
+  FreeMemory(this);
+  unit.Release();
+  return result;
 }
 
 template class InternalIoStatementState<false>;
@@ -355,8 +949,15 @@ template class InternalIoStatementState<true>;
 template class InternalFormattedIoStatementState<false>;
 template class InternalFormattedIoStatementState<true>;
 template class InternalListIoStatementState<false>;
+template class InternalListIoStatementState<true>;
 template class ExternalIoStatementState<false>;
+template class ExternalIoStatementState<true>;
 template class ExternalFormattedIoStatementState<false>;
+template class ExternalFormattedIoStatementState<true>;
 template class ExternalListIoStatementState<false>;
+template class ExternalListIoStatementState<true>;
 template class UnformattedIoStatementState<false>;
+template class UnformattedIoStatementState<true>;
+template class DirectUnformattedIoStatementState<false>;
+template class DirectUnformattedIoStatementState<true>;
 }
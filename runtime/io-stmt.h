@@ -16,7 +16,9 @@
 #include "format.h"
 #include "internal-unit.h"
 #include "io-error.h"
+#include <cstring>
 #include <functional>
+#include <optional>
 #include <type_traits>
 #include <variant>
 
@@ -28,6 +30,8 @@ class ExternalFileUnit;
 class OpenStatementState;
 class CloseStatementState;
 class NoopCloseStatementState;
+class WaitStatementState;
+class FlushStatementState;
 template<bool isInput, typename CHAR = char>
 class InternalFormattedIoStatementState;
 template<bool isInput, typename CHAR = char> class InternalListIoStatementState;
@@ -35,6 +39,7 @@ template<bool isInput, typename CHAR = char>
 class ExternalFormattedIoStatementState;
 template<bool isInput> class ExternalListIoStatementState;
 template<bool isInput> class UnformattedIoStatementState;
+template<bool isInput> class DirectUnformattedIoStatementState;
 
 // The Cookie type in the I/O API is a pointer (for C) to this class.
 class IoStatementState {
@@ -48,10 +53,14 @@ public:
   // which may not have good support in some use cases.
   DataEdit GetNextDataEdit(int = 1);
   bool Emit(const char *, std::size_t);
+  bool Receive(char *, std::size_t);  // unformatted input
+  std::size_t GetNextInputBytes(const char *&);
   bool AdvanceRecord(int = 1);
+  bool HandleRelativePosition(std::int64_t);
   int EndIoStatement();
   ConnectionState &GetConnectionState();
   MutableModes &mutableModes();
+  ExternalFileUnit *GetExternalFileUnit() const;  // null if internal
 
   // N.B.: this also works with base classes
   template<typename A> A *get_if() const {
@@ -65,20 +74,43 @@ public:
         u_);
   }
   IoErrorHandler &GetIoErrorHandler() const;
+  bool InError() const { return GetIoErrorHandler().InError(); }
 
   bool EmitRepeated(char, std::size_t);
   bool EmitField(const char *, std::size_t length, std::size_t width);
 
+  // Formatted output can be assembled in place in the buffer of the
+  // current record with one dispatch per field (see OutputCursor below).
+  // Returns the address of room for n characters at the current position,
+  // past which the position has moved, or null when there isn't such room
+  // and Emit() must be used instead, since it deals with errors.  All n
+  // characters must be stored there before the statement does anything
+  // else.
+  char *ReserveOutput(std::size_t n);
+
+  // Positions the input at the next nonblank character, if any, in the
+  // current record or, when acrossRecords, in a later one, and returns
+  // that character without consuming it.
+  std::optional<char> NextNonBlank(bool acrossRecords = false);
+
 private:
   std::variant<std::reference_wrapper<OpenStatementState>,
       std::reference_wrapper<CloseStatementState>,
       std::reference_wrapper<NoopCloseStatementState>,
+      std::reference_wrapper<WaitStatementState>,
+      std::reference_wrapper<FlushStatementState>,
       std::reference_wrapper<InternalFormattedIoStatementState<false>>,
       std::reference_wrapper<InternalFormattedIoStatementState<true>>,
       std::reference_wrapper<InternalListIoStatementState<false>>,
+      std::reference_wrapper<InternalListIoStatementState<true>>,
       std::reference_wrapper<ExternalFormattedIoStatementState<false>>,
+      std::reference_wrapper<ExternalFormattedIoStatementState<true>>,
       std::reference_wrapper<ExternalListIoStatementState<false>>,
-      std::reference_wrapper<UnformattedIoStatementState<false>>>
+      std::reference_wrapper<ExternalListIoStatementState<true>>,
+      std::reference_wrapper<UnformattedIoStatementState<false>>,
+      std::reference_wrapper<UnformattedIoStatementState<true>>,
+      std::reference_wrapper<DirectUnformattedIoStatementState<false>>,
+      std::reference_wrapper<DirectUnformattedIoStatementState<true>>>
       u_;
 };
 
@@ -88,6 +120,49 @@ struct IoStatementBase : public DefaultFormatControlCallbacks {
   using DefaultFormatControlCallbacks::DefaultFormatControlCallbacks;
   int EndIoStatement();
   DataEdit GetNextDataEdit(int = 1);  // crashing default
+  std::size_t GetNextInputBytes(const char *&);  // crashing default
+  bool Receive(char *, std::size_t);  // crashing default
+  char *ReserveOutput(std::size_t) { return nullptr; }  // use Emit()
+};
+
+// Assembles one formatted output field of a known length from its pieces.
+// When the record's buffer has room, they're stored there directly;
+// otherwise, each is emitted in turn, and the first error stops the rest.
+class OutputCursor {
+public:
+  OutputCursor(IoStatementState &io, std::size_t length)
+    : io_{io}, at_{io.ReserveOutput(length)}, end_{at_ ? at_ + length
+                                                      : nullptr} {}
+  OutputCursor &Put(const char *p, std::size_t n) {
+    if (at_) {
+      std::memcpy(at_, p, n);
+      at_ += n;
+    } else {
+      ok_ = ok_ && io_.Emit(p, n);
+    }
+    return *this;
+  }
+  OutputCursor &Fill(char ch, std::size_t n) {
+    if (at_) {
+      std::memset(at_, ch, n);
+      at_ += n;
+    } else {
+      ok_ = ok_ && io_.EmitRepeated(ch, n);
+    }
+    return *this;
+  }
+  bool Finish() {
+    if (at_ != end_) {
+      io_.GetIoErrorHandler().Crash(
+          "OutputCursor: formatted output field was not filled exactly");
+    }
+    return ok_;
+  }
+
+private:
+  IoStatementState &io_;
+  char *at_, *end_;
+  bool ok_{true};
 };
 
 struct InputStatementState {};
@@ -97,6 +172,7 @@ using IoDirectionState =
     std::conditional_t<isInput, InputStatementState, OutputStatementState>;
 
 struct FormattedStatementState {};
+struct UnformattedStatementState {};
 
 template<bool isInput> struct ListDirectedStatementState {};
 template<> struct ListDirectedStatementState<false /*output*/> {
@@ -106,6 +182,35 @@ template<> struct ListDirectedStatementState<false /*output*/> {
       IoStatementState &, std::size_t, bool isCharacter = false);
   bool lastWasUndelimitedCharacter{false};
 };
+template<> class ListDirectedStatementState<true /*input*/> {
+public:
+  // Positions the input at the next value and returns a list-directed
+  // edit for it, or a ListDirectedNullValue edit with a repeat count
+  // for null values (including all those after a slash).
+  template<typename STATE> DataEdit GetNextDataEdit(STATE &, int maxRepeat);
+
+  // The fast path for runs of numeric items: scans the characters
+  // in [p, end) of the current record, which the caller has yet to
+  // consume, for a value that is not preceded by a repeat count, a null
+  // value, or a slash.  Only separators are consumed; on Value, p points
+  // to the value and length is set, and the caller consumes the value.
+  // On EndOfRecord, the caller should advance to the next record.  On
+  // Other, GetNextDataEdit() must be used for the next item.
+  enum class Scan { Value, EndOfRecord, Other };
+  Scan ScanValueInPlace(
+      const char *&p, const char *end, std::size_t &length, bool decimalComma);
+
+  // The length of the undelimited value that begins at p, which ends at
+  // a blank, a value separator, a slash, or the end of the record.
+  static std::size_t ValueLength(
+      const char *p, const char *end, bool decimalComma);
+
+private:
+  int remaining_{0};  // repetitions of the current value still to come
+  std::int64_t repeatPosition_{-1};  // of a repeated value; -1 if null
+  bool hitSlash_{false};  // once a slash appears, all values are null
+  bool eatComma_{false};  // a value has been read; a comma separates it
+};
 
 template<bool isInput, typename CHAR = char>
 class InternalIoStatementState : public IoStatementBase,
@@ -119,9 +224,16 @@ public:
       const Descriptor &, const char *sourceFile = nullptr, int sourceLine = 0);
   int EndIoStatement();
   bool Emit(const CharType *, std::size_t chars /* not bytes */);
+  char *ReserveOutput(std::size_t);
   bool AdvanceRecord(int = 1);
+  std::size_t GetNextInputBytes(const char *&);
+  bool HandleRelativePosition(std::int64_t);
+  bool HandleAbsolutePosition(std::int64_t);
   ConnectionState &GetConnectionState() { return unit_; }
   MutableModes &mutableModes() { return unit_.modes; }
+  // Clear when the state was constructed in a scratch area loaned by
+  // the caller, rather than allocated.
+  void set_free(bool yes) { free_ = yes; }
 
 protected:
   bool free_{true};
@@ -135,25 +247,31 @@ class InternalFormattedIoStatementState
 public:
   using CharType = CHAR;
   using typename InternalIoStatementState<isInput, CharType>::Buffer;
+  using FormatControlType = FormatControl<InternalFormattedIoStatementState>;
+  static constexpr int maxMaxHeight{FormatControlType::maxMaxHeight};
   InternalFormattedIoStatementState(Buffer internal, std::size_t internalLength,
       const CharType *format, std::size_t formatLength,
-      const char *sourceFile = nullptr, int sourceLine = 0);
+      const char *sourceFile = nullptr, int sourceLine = 0,
+      int maxHeight = maxMaxHeight);
   InternalFormattedIoStatementState(const Descriptor &, const CharType *format,
       std::size_t formatLength, const char *sourceFile = nullptr,
-      int sourceLine = 0);
+      int sourceLine = 0, int maxHeight = maxMaxHeight);
+  // The bytes needed for a state whose FORMAT stack holds maxHeight entries
+  static constexpr std::size_t GetNeededSize(int maxHeight) {
+    return sizeof(InternalFormattedIoStatementState) -
+        sizeof(FormatControlType) + FormatControlType::GetNeededSize(maxHeight);
+  }
   IoStatementState &ioStatementState() { return ioStatementState_; }
   int EndIoStatement();
   DataEdit GetNextDataEdit(int maxRepeat = 1) {
     return format_.GetNextDataEdit(*this, maxRepeat);
   }
-  bool HandleRelativePosition(std::int64_t);
-  bool HandleAbsolutePosition(std::int64_t);
 
 private:
   IoStatementState ioStatementState_;  // points to *this
   using InternalIoStatementState<isInput, CharType>::unit_;
-  // format_ *must* be last; it may be partial someday
-  FormatControl<InternalFormattedIoStatementState> format_;
+  // format_ *must* be last; it may be partial
+  FormatControlType format_;
 };
 
 template<bool isInput, typename CHAR>
@@ -169,6 +287,10 @@ public:
       const Descriptor &, const char *sourceFile = nullptr, int sourceLine = 0);
   IoStatementState &ioStatementState() { return ioStatementState_; }
   DataEdit GetNextDataEdit(int maxRepeat = 1) {
+    if constexpr (isInput) {
+      return ListDirectedStatementState<isInput>::GetNextDataEdit(
+          *this, maxRepeat);
+    }
     DataEdit edit;
     edit.descriptor = DataEdit::ListDirected;
     edit.repeat = maxRepeat;
@@ -203,6 +325,8 @@ public:
   bool Emit(const char *, std::size_t chars /* not bytes */);
   bool Emit(const char16_t *, std::size_t chars /* not bytes */);
   bool Emit(const char32_t *, std::size_t chars /* not bytes */);
+  char *ReserveOutput(std::size_t);
+  std::size_t GetNextInputBytes(const char *&);
   bool AdvanceRecord(int = 1);
   bool HandleRelativePosition(std::int64_t);
   bool HandleAbsolutePosition(std::int64_t);
@@ -217,6 +341,8 @@ public:
   ExternalFormattedIoStatementState(ExternalFileUnit &, const CharType *format,
       std::size_t formatLength, const char *sourceFile = nullptr,
       int sourceLine = 0);
+  ExternalFormattedIoStatementState(ExternalFileUnit &, const CompiledFormat &,
+      const char *sourceFile = nullptr, int sourceLine = 0);
   MutableModes &mutableModes() { return mutableModes_; }
   int EndIoStatement();
   DataEdit GetNextDataEdit(int maxRepeat = 1) {
@@ -238,6 +364,10 @@ class ExternalListIoStatementState
 public:
   using ExternalIoStatementState<isInput>::ExternalIoStatementState;
   DataEdit GetNextDataEdit(int maxRepeat = 1) {
+    if constexpr (isInput) {
+      return ListDirectedStatementState<isInput>::GetNextDataEdit(
+          *this, maxRepeat);
+    }
     DataEdit edit;
     edit.descriptor = DataEdit::ListDirected;
     edit.repeat = maxRepeat;
@@ -246,11 +376,71 @@ public:
   }
 };
 
+// A sequential unformatted record is framed by a 4-byte header and a
+// matching footer that hold its length.  Records too long for that are
+// split into subrecords, each framed in the same way, as other compilers
+// do: a negative header means that more subrecords follow, and a
+// negative footer means that others preceded this one.  Each subrecord's
+// header is patched when the subrecord is complete, so a record of any
+// length streams through a bounded buffer.
 template<bool isInput>
-class UnformattedIoStatementState : public ExternalIoStatementState<isInput> {
+class UnformattedIoStatementState : public ExternalIoStatementState<isInput>,
+                                    public UnformattedStatementState {
 public:
   using ExternalIoStatementState<isInput>::ExternalIoStatementState;
+  // The gfortran default; FORT_MAX_SUBRECORD_LENGTH can reduce it.
+  static constexpr std::int64_t defaultMaxSubrecordBytes{2147483639};
+
+  bool Emit(const char *, std::size_t bytes);
+  char *ReserveOutput(std::size_t) { return nullptr; }  // not formatted
+  bool Receive(char *, std::size_t bytes);
+  int EndIoStatement();
+
+private:
+  bool IsFramed();
+  // Writes or reads a header; the first is deferred until the first
+  // transfer, so that any error is handled as the program requested.
+  bool BeginSubrecord();
+  bool FinishSubrecord(bool more);  // output
+  bool NextSubrecord();  // input: reads the footer & the next header
+  std::int64_t subrecordOffset_{0};  // of current header in the record
+  std::int64_t subrecordBytes_{0};  // input: length of the current one
+  bool inRecord_{false};  // the first header has been written or read
+  bool continued_{false};  // output: not the first subrecord
+  bool more_{false};  // input: more subrecords follow
+};
+
+// An unformatted direct access READ or WRITE moves data with positional
+// reads and writes between the file and the program's variables, at the
+// record that REC= selects.  It neither occupies the unit's statement
+// state nor uses its buffer, so that threads may transfer independent
+// records of one unit concurrently.  Short transfers are staged.
+template<bool isInput>
+class DirectUnformattedIoStatementState : public IoStatementBase,
+                                          public IoDirectionState<isInput>,
+                                          public UnformattedStatementState {
+public:
+  DirectUnformattedIoStatementState(
+      ExternalFileUnit &, const char *sourceFile = nullptr, int sourceLine = 0);
+  IoStatementState &ioStatementState() { return ioStatementState_; }
+  ExternalFileUnit &unit() { return unit_; }
+  ConnectionState &GetConnectionState() { return connection_; }
+  MutableModes &mutableModes() { return connection_.modes; }
+  void SetPosition(std::int64_t offset);  // REC=
+  bool Emit(const char *, std::size_t bytes);
+  bool Receive(char *, std::size_t bytes);
   int EndIoStatement();
+
+private:
+  bool CheckRecord(std::size_t bytes);
+  bool FlushStage();
+  ExternalFileUnit &unit_;
+  IoStatementState ioStatementState_;  // points to *this
+  ConnectionState connection_;  // the unit's attributes & this position
+  bool positioned_{false};
+  std::int64_t stageAt_{0};  // position in record of stage_[0]
+  std::size_t stageBytes_{0};
+  char stage_[512];
 };
 
 class OpenStatementState : public ExternalIoStatementBase {
@@ -285,6 +475,26 @@ private:
   CloseStatus status_{CloseStatus::Keep};
 };
 
+// WAIT(ID=) for one asynchronous transfer, or for all of them on the unit
+class WaitStatementState : public ExternalIoStatementBase {
+public:
+  WaitStatementState(ExternalFileUnit &unit, std::optional<int> id,
+      const char *sourceFile = nullptr, int sourceLine = 0)
+    : ExternalIoStatementBase{unit, sourceFile, sourceLine}, id_{id} {}
+  int EndIoStatement();
+
+private:
+  std::optional<int> id_;
+};
+
+// FLUSH: the unit's buffered output is written, and any transfers in
+// the background are complete.
+class FlushStatementState : public ExternalIoStatementBase {
+public:
+  using ExternalIoStatementBase::ExternalIoStatementBase;
+  int EndIoStatement();
+};
+
 class NoopCloseStatementState : public IoStatementBase {
 public:
   NoopCloseStatementState(const char *sourceFile, int sourceLine)
@@ -305,13 +515,21 @@ extern template class InternalIoStatementState<true>;
 extern template class InternalFormattedIoStatementState<false>;
 extern template class InternalFormattedIoStatementState<true>;
 extern template class InternalListIoStatementState<false>;
+extern template class InternalListIoStatementState<true>;
 extern template class ExternalIoStatementState<false>;
+extern template class ExternalIoStatementState<true>;
 extern template class ExternalFormattedIoStatementState<false>;
+extern template class ExternalFormattedIoStatementState<true>;
 extern template class ExternalListIoStatementState<false>;
+extern template class ExternalListIoStatementState<true>;
 extern template class UnformattedIoStatementState<false>;
+extern template class UnformattedIoStatementState<true>;
+extern template class DirectUnformattedIoStatementState<false>;
+extern template class DirectUnformattedIoStatementState<true>;
 extern template class FormatControl<InternalFormattedIoStatementState<false>>;
 extern template class FormatControl<InternalFormattedIoStatementState<true>>;
 extern template class FormatControl<ExternalFormattedIoStatementState<false>>;
+extern template class FormatControl<ExternalFormattedIoStatementState<true>>;
 
 }
 #endif  // FORTRAN_RUNTIME_IO_STMT_H_
@@ -6,11 +6,12 @@
 //
 //===----------------------------------------------------------------------===//
 
-// Wraps pthread_mutex_t (or whatever)
+// Wraps pthread_mutex_t and pthread_cond_t (or whatever)
 
 #ifndef FORTRAN_RUNTIME_LOCK_H_
 #define FORTRAN_RUNTIME_LOCK_H_
 
+#include "terminator.h"
 #include <pthread.h>
 
 namespace Fortran::runtime {
@@ -30,10 +31,41 @@ public:
     }
   }
 
+protected:
+  struct Recursive {};
+  explicit Lock(Recursive) {
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex_, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+  }
+
 private:
+  friend class ConditionVariable;
   pthread_mutex_t mutex_;
 };
 
+// A Lock that the thread holding it may take again; each Take() must
+// be matched by a Drop().
+class RecursiveLock : public Lock {
+public:
+  RecursiveLock() : Lock{Recursive{}} {}
+};
+
+// Waits for a state change that's published under a Lock
+class ConditionVariable {
+public:
+  ConditionVariable() { pthread_cond_init(&cond_, nullptr); }
+  ~ConditionVariable() { pthread_cond_destroy(&cond_); }
+  void Wait(Lock &lock) { pthread_cond_wait(&cond_, &lock.mutex_); }  // held
+  void Signal() { pthread_cond_signal(&cond_); }
+  void Broadcast() { pthread_cond_broadcast(&cond_); }
+
+private:
+  pthread_cond_t cond_;
+};
+
 class CriticalSection {
 public:
   explicit CriticalSection(Lock &lock) : lock_{lock} { lock_.Take(); }
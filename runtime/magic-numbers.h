@@ -27,6 +27,10 @@ and are used "raw" as IOSTAT values.
 #define FORTRAN_RUNTIME_IOSTAT_EOR (-2)
 #define FORTRAN_RUNTIME_IOSTAT_FLUSH (-3)
 #define FORTRAN_RUNTIME_IOSTAT_INQUIRE_INTERNAL_UNIT 255
+#define FORTRAN_RUNTIME_IOSTAT_BAD_INPUT 256
+#define FORTRAN_RUNTIME_IOSTAT_SHORT_RECORD 257
+#define FORTRAN_RUNTIME_IOSTAT_RECORD_WRITE_OVERFLOW 258
+#define FORTRAN_RUNTIME_IOSTAT_RECORD_READ_OVERFLOW 259
 
 #define FORTRAN_RUNTIME_STAT_FAILED_IMAGE 10
 #define FORTRAN_RUNTIME_STAT_LOCKED 11
@@ -8,6 +8,7 @@
 
 #include "main.h"
 #include "environment.h"
+#include "memory.h"
 #include "terminator.h"
 #include "unit.h"
 #include <cfenv>
@@ -32,6 +33,14 @@ extern "C" {
 void RTNAME(ProgramStart)(int argc, const char *argv[], const char *envp[]) {
   std::atexit(Fortran::runtime::NotifyOtherImagesOfNormalEnd);
   Fortran::runtime::executionEnvironment.Configure(argc, argv, envp);
+  if (Fortran::runtime::executionEnvironment.memoryStatistics) {
+    // Registered first so as to run last
+    std::atexit(Fortran::runtime::ReportMemoryStatistics);
+  }
+  if (Fortran::runtime::executionEnvironment.ioStatistics) {
+    // Also when the main program is not Fortran and just returns
+    std::atexit(Fortran::runtime::io::ExternalFileUnit::ReportStatistics);
+  }
   ConfigureFloatingPoint();
   Fortran::runtime::io::ExternalFileUnit::InitializePredefinedUnits();
 }
@@ -0,0 +1,488 @@
+//===-- runtime/matmul.cpp --------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "matmul.h"
+#include "environment.h"
+#include "memory.h"
+#include "terminator.h"
+#include <algorithm>
+#include <cinttypes>
+#include <complex>
+#include <cstring>
+#include <pthread.h>
+#include <utility>
+
+namespace Fortran::runtime {
+
+// An operand viewed as a matrix: element (i, j) is at base + i * iStride
+// + j * jStride bytes.  A vector is a matrix of one row or one column.
+template<typename T> struct Matrix {
+  const T &operator()(std::size_t i, std::size_t j) const {
+    return *reinterpret_cast<const T *>(base +
+        static_cast<std::ptrdiff_t>(i) * iStride +
+        static_cast<std::ptrdiff_t>(j) * jStride);
+  }
+  const char *base;
+  std::ptrdiff_t iStride, jStride;
+};
+
+template<typename T> static inline T Times(T x, T y) { return x * y; }
+// Without the special cases for infinities that make std::complex's
+// operator* a library call
+template<typename T>
+static inline std::complex<T> Times(std::complex<T> x, std::complex<T> y) {
+  return {x.real() * y.real() - x.imag() * y.imag(),
+      x.real() * y.imag() + x.imag() * y.real()};
+}
+
+template<typename T> static constexpr bool isComplex{false};
+template<typename R> static constexpr bool isComplex<std::complex<R>>{true};
+
+// The result is computed in tiles of tileRows x tileColumns elements,
+// held in registers; a column of a tile is 32 bytes when possible, or
+// holds 32 bytes of real parts and 32 of imaginary parts when COMPLEX.
+static constexpr std::size_t tileColumns{4};
+template<typename T>
+static constexpr std::size_t tileRows{std::clamp<std::size_t>(
+    (isComplex<T> ? 64 : 32) / sizeof(T), 2, 16)};
+// The operands are packed in blocks: a blockDepth x tileColumns panel of
+// B fits in the L1 cache, a blockRows x blockDepth block of A in L2, and
+// a blockDepth x blockColumns block of B in L3.
+template<typename T>
+static constexpr std::size_t blockDepth{2048 / sizeof(T)};
+template<typename T>
+static constexpr std::size_t blockRows{
+    256 * 1024 / (blockDepth<T> * sizeof(T)) / tileRows<T> * tileRows<T>};
+static constexpr std::size_t blockColumns{1024};
+// Each thread computes at least this many products.
+static constexpr std::size_t minimumThreadWork{std::size_t{1} << 22};
+static constexpr std::size_t maxThreads{64};
+
+static std::size_t RoundUp(std::size_t n, std::size_t multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+// Accumulates the product of a packed panel of A (depth x tileRows) and
+// a packed panel of B (depth x tileColumns) into the rows x columns tile
+// of the result at c, whose columns are ldc elements apart.  The tile's
+// accumulators are indexed only by constants (I...), so that the
+// compiler can keep them in registers.
+template<typename T, std::size_t... I>
+static void MultiplyTile(std::size_t depth, const T *a, const T *b, T *c,
+    std::size_t ldc, std::size_t rows, std::size_t columns,
+    std::index_sequence<I...>) {
+  constexpr std::size_t mr{sizeof...(I)};
+  static_assert(tileColumns == 4);
+  T c0[mr]{}, c1[mr]{}, c2[mr]{}, c3[mr]{};
+  for (std::size_t p{0}; p < depth; ++p, a += mr, b += tileColumns) {
+    T b0{b[0]}, b1{b[1]}, b2{b[2]}, b3{b[3]};
+    ((c0[I] += Times(a[I], b0)), ...);
+    ((c1[I] += Times(a[I], b1)), ...);
+    ((c2[I] += Times(a[I], b2)), ...);
+    ((c3[I] += Times(a[I], b3)), ...);
+  }
+  if (rows == mr && columns == tileColumns) {
+    ((c[I] += c0[I]), ...);
+    ((c[I + ldc] += c1[I]), ...);
+    ((c[I + 2 * ldc] += c2[I]), ...);
+    ((c[I + 3 * ldc] += c3[I]), ...);
+  } else {
+    const T *tile[tileColumns]{c0, c1, c2, c3};
+    for (std::size_t j{0}; j < columns; ++j) {
+      for (std::size_t i{0}; i < rows; ++i) {
+        c[i + j * ldc] += tile[j][i];
+      }
+    }
+  }
+}
+
+// A COMPLEX tile is computed with separate accumulators for the real
+// and imaginary parts, so that its products are those of vectors of
+// reals; its panels hold the real parts of each of their columns (or
+// rows) followed by the imaginary parts.
+template<typename R, std::size_t... I>
+static void MultiplyTile(std::size_t depth, const std::complex<R> *a,
+    const std::complex<R> *b, std::complex<R> *c, std::size_t ldc,
+    std::size_t rows, std::size_t columns, std::index_sequence<I...>) {
+  constexpr std::size_t mr{sizeof...(I)};
+  static_assert(tileColumns == 4);
+  const R *ap{reinterpret_cast<const R *>(a)};
+  const R *bp{reinterpret_cast<const R *>(b)};
+  R re0[mr]{}, re1[mr]{}, re2[mr]{}, re3[mr]{};
+  R im0[mr]{}, im1[mr]{}, im2[mr]{}, im3[mr]{};
+  for (std::size_t p{0}; p < depth;
+       ++p, ap += 2 * mr, bp += 2 * tileColumns) {
+    R br0{bp[0]}, br1{bp[1]}, br2{bp[2]}, br3{bp[3]};
+    R bi0{bp[4]}, bi1{bp[5]}, bi2{bp[6]}, bi3{bp[7]};
+    ((re0[I] += ap[I] * br0 - ap[I + mr] * bi0), ...);
+    ((im0[I] += ap[I] * bi0 + ap[I + mr] * br0), ...);
+    ((re1[I] += ap[I] * br1 - ap[I + mr] * bi1), ...);
+    ((im1[I] += ap[I] * bi1 + ap[I + mr] * br1), ...);
+    ((re2[I] += ap[I] * br2 - ap[I + mr] * bi2), ...);
+    ((im2[I] += ap[I] * bi2 + ap[I + mr] * br2), ...);
+    ((re3[I] += ap[I] * br3 - ap[I + mr] * bi3), ...);
+    ((im3[I] += ap[I] * bi3 + ap[I + mr] * br3), ...);
+  }
+  const R *re[tileColumns]{re0, re1, re2, re3};
+  const R *im[tileColumns]{im0, im1, im2, im3};
+  for (std::size_t j{0}; j < columns; ++j) {
+    for (std::size_t i{0}; i < rows; ++i) {
+      c[i + j * ldc] += std::complex<R>{re[j][i], im[j][i]};
+    }
+  }
+}
+
+// Stores n elements of a packed panel's column (or row) of m; the rest
+// are 0.
+template<typename T, typename F>
+static void PackPart(T *to, std::size_t n, std::size_t m, F element) {
+  if constexpr (isComplex<T>) {
+    auto *parts{reinterpret_cast<typename T::value_type *>(to)};
+    for (std::size_t j{0}; j < n; ++j) {
+      T x{element(j)};
+      parts[j] = x.real();
+      parts[j + m] = x.imag();
+    }
+    for (std::size_t j{n}; j < m; ++j) {
+      parts[j] = parts[j + m] = 0;
+    }
+  } else {
+    for (std::size_t j{0}; j < n; ++j) {
+      to[j] = element(j);
+    }
+    for (std::size_t j{n}; j < m; ++j) {
+      to[j] = T{0};
+    }
+  }
+}
+
+// Packs rows [i0, i0 + rows) and columns [p0, p0 + depth) of A into
+// panels of tileRows rows, each stored by columns; missing rows are 0.
+template<typename T>
+static void PackA(T *to, const Matrix<T> &a, std::size_t i0,
+    std::size_t rows, std::size_t p0, std::size_t depth) {
+  constexpr std::size_t mr{tileRows<T>};
+  for (std::size_t ir{0}; ir < rows; ir += mr) {
+    std::size_t m{std::min(mr, rows - ir)};
+    for (std::size_t p{0}; p < depth; ++p, to += mr) {
+      PackPart(to, m, mr,
+          [&](std::size_t i) { return a(i0 + ir + i, p0 + p); });
+    }
+  }
+}
+
+// Packs rows [p0, p0 + depth) and columns [j0, j0 + columns) of B into
+// panels of tileColumns columns, each stored by rows; missing columns
+// are 0.
+template<typename T>
+static void PackB(T *to, const Matrix<T> &b, std::size_t p0,
+    std::size_t depth, std::size_t j0, std::size_t columns) {
+  for (std::size_t jr{0}; jr < columns; jr += tileColumns) {
+    std::size_t n{std::min(tileColumns, columns - jr)};
+    for (std::size_t p{0}; p < depth; ++p, to += tileColumns) {
+      PackPart(to, n, tileColumns,
+          [&](std::size_t j) { return b(p0 + p, j0 + jr + j); });
+    }
+  }
+}
+
+// The product of A (rows x depth) and B (depth x columns) accumulated
+// into the zeroed contiguous result c (rows x columns)
+template<typename T> class MatrixProduct {
+public:
+  MatrixProduct(T *c, const Matrix<T> &a, const Matrix<T> &b,
+      std::size_t rows, std::size_t depth, std::size_t columns)
+    : c_{c}, a_{a}, b_{b}, rows_{rows}, depth_{depth}, columns_{columns} {}
+
+  // Divides the columns of the result among threads when there are
+  // enough of them and FORT_MATMUL_THREADS allows.
+  void Compute() const {
+    std::size_t threads{std::min({executionEnvironment.matmulThreads,
+        maxThreads, RoundUp(columns_, tileColumns) / tileColumns,
+        rows_ * depth_ * columns_ / minimumThreadWork})};
+    if (threads <= 1) {
+      Columns(0, columns_);
+      return;
+    }
+    Share share[maxThreads];
+    std::size_t each{RoundUp((columns_ + threads - 1) / threads, tileColumns)};
+    for (std::size_t t{0}; t < threads; ++t) {
+      share[t].product = this;
+      share[t].j0 = std::min(columns_, t * each);
+      share[t].j1 = std::min(columns_, share[t].j0 + each);
+      share[t].started = t > 0 &&
+          ::pthread_create(&share[t].thread, nullptr, &Thread, &share[t]) ==
+              0;
+    }
+    for (std::size_t t{0}; t < threads; ++t) {
+      if (share[t].started) {
+        ::pthread_join(share[t].thread, nullptr);
+      } else {
+        Columns(share[t].j0, share[t].j1);
+      }
+    }
+  }
+
+private:
+  struct Share {
+    const MatrixProduct *product;
+    std::size_t j0, j1;
+    pthread_t thread;
+    bool started;
+  };
+
+  static void *Thread(void *arg) {
+    const Share &share{*static_cast<const Share *>(arg)};
+    share.product->Columns(share.j0, share.j1);
+    return nullptr;
+  }
+
+  // Computes columns [j0, j1) of the result block by block.
+  void Columns(std::size_t j0, std::size_t j1) const {
+    constexpr std::size_t mr{tileRows<T>}, kc{blockDepth<T>},
+        mc{blockRows<T>}, nc{blockColumns};
+    if (j0 >= j1 || rows_ == 0 || depth_ == 0) {
+      return;
+    }
+    Terminator terminator{__FILE__, __LINE__};
+    std::size_t depth{std::min(kc, depth_)};
+    OwningPtr<T> packedA{static_cast<T *>(AllocateMemoryOrCrash(terminator,
+        std::min(mc, RoundUp(rows_, mr)) * depth * sizeof(T)))};
+    OwningPtr<T> packedB{static_cast<T *>(AllocateMemoryOrCrash(terminator,
+        std::min(nc, RoundUp(j1 - j0, tileColumns)) * depth * sizeof(T)))};
+    for (std::size_t jc{j0}; jc < j1; jc += nc) {
+      std::size_t n{std::min(nc, j1 - jc)};
+      for (std::size_t pc{0}; pc < depth_; pc += kc) {
+        std::size_t k{std::min(kc, depth_ - pc)};
+        PackB(packedB.get(), b_, pc, k, jc, n);
+        for (std::size_t ic{0}; ic < rows_; ic += mc) {
+          std::size_t m{std::min(mc, rows_ - ic)};
+          PackA(packedA.get(), a_, ic, m, pc, k);
+          for (std::size_t jr{0}; jr < n; jr += tileColumns) {
+            for (std::size_t ir{0}; ir < m; ir += mr) {
+              MultiplyTile(k, packedA.get() + ir * k, packedB.get() + jr * k,
+                  c_ + (ic + ir) + (jc + jr) * rows_, rows_,
+                  std::min(mr, m - ir), std::min(tileColumns, n - jr),
+                  std::make_index_sequence<mr>{});
+            }
+          }
+        }
+      }
+    }
+  }
+
+  T *c_;
+  Matrix<T> a_, b_;
+  std::size_t rows_, depth_, columns_;
+};
+
+// y = A x, accumulating four columns of A at a time when they are
+// contiguous
+template<typename T>
+static void MatrixTimesVector(T *y, const Matrix<T> &a, const Matrix<T> &x,
+    std::size_t rows, std::size_t depth) {
+  std::size_t p{0};
+  if (a.iStride == static_cast<std::ptrdiff_t>(sizeof(T))) {
+    for (; p + 4 <= depth; p += 4) {
+      const T *a0{&a(0, p)}, *a1{&a(0, p + 1)}, *a2{&a(0, p + 2)},
+          *a3{&a(0, p + 3)};
+      T x0{x(p, 0)}, x1{x(p + 1, 0)}, x2{x(p + 2, 0)}, x3{x(p + 3, 0)};
+      for (std::size_t i{0}; i < rows; ++i) {
+        y[i] += Times(a0[i], x0) + Times(a1[i], x1) + Times(a2[i], x2) +
+            Times(a3[i], x3);
+      }
+    }
+  }
+  for (; p < depth; ++p) {
+    T xp{x(p, 0)};
+    for (std::size_t i{0}; i < rows; ++i) {
+      y[i] += Times(a(i, p), xp);
+    }
+  }
+}
+
+template<typename T, std::size_t... I>
+static T Dot(const T *x, const T *y, std::size_t n, std::index_sequence<I...>) {
+  constexpr std::size_t lanes{sizeof...(I)};
+  T lane[lanes]{};
+  std::size_t j{0};
+  for (; j + lanes <= n; j += lanes) {
+    ((lane[I] += Times(x[j + I], y[j + I])), ...);
+  }
+  T sum{};
+  ((sum += lane[I]), ...);
+  for (; j < n; ++j) {
+    sum += Times(x[j], y[j]);
+  }
+  return sum;
+}
+
+// y = x B, as dot products of x with the columns of B when they are
+// contiguous
+template<typename T>
+static void VectorTimesMatrix(T *y, const Matrix<T> &x, const Matrix<T> &b,
+    std::size_t depth, std::size_t columns, const Terminator &terminator) {
+  if (b.iStride == static_cast<std::ptrdiff_t>(sizeof(T))) {
+    OwningPtr<T> gathered;
+    const T *xs{&x(0, 0)};
+    if (x.jStride != static_cast<std::ptrdiff_t>(sizeof(T))) {
+      gathered.reset(static_cast<T *>(AllocateMemoryOrCrash(
+          terminator, std::max<std::size_t>(depth, 1) * sizeof(T))));
+      for (std::size_t p{0}; p < depth; ++p) {
+        gathered.get()[p] = x(0, p);
+      }
+      xs = gathered.get();
+    }
+    for (std::size_t j{0}; j < columns; ++j) {
+      y[j] = Dot(xs, &b(0, j), depth, std::make_index_sequence<8>{});
+    }
+  } else {
+    for (std::size_t j{0}; j < columns; ++j) {
+      for (std::size_t p{0}; p < depth; ++p) {
+        y[j] += Times(x(0, p), b(p, j));
+      }
+    }
+  }
+}
+
+template<typename T>
+static void Multiply(char *c, const Matrix<T> &a, const Matrix<T> &b,
+    std::size_t rows, std::size_t depth, std::size_t columns,
+    const Terminator &terminator) {
+  T *result{reinterpret_cast<T *>(c)};
+  if (columns == 1) {
+    MatrixTimesVector(result, a, b, rows, depth);
+  } else if (rows == 1) {
+    VectorTimesMatrix(result, a, b, depth, columns, terminator);
+  } else {
+    MatrixProduct<T>{result, a, b, rows, depth, columns}.Compute();
+  }
+}
+
+// LOGICAL(1): c(i, j) = ANY(a(i, :) .AND. b(:, j))
+static void MultiplyLogical(char *c, const Matrix<std::uint8_t> &a,
+    const Matrix<std::uint8_t> &b, std::size_t rows, std::size_t depth,
+    std::size_t columns) {
+  for (std::size_t j{0}; j < columns; ++j, c += rows) {
+    for (std::size_t p{0}; p < depth; ++p) {
+      if (b(p, j) != 0) {
+        for (std::size_t i{0}; i < rows; ++i) {
+          c[i] |= a(i, p) != 0;
+        }
+      }
+    }
+  }
+}
+
+std::unique_ptr<Descriptor> MATMUL(
+    const Descriptor &matrixA, const Descriptor &matrixB) {
+  Terminator terminator{__FILE__, __LINE__};
+  int rankA{matrixA.rank()}, rankB{matrixB.rank()};
+  if (rankA < 1 || rankA > 2 || rankB < 1 || rankB > 2 ||
+      (rankA == 1 && rankB == 1)) {
+    terminator.Crash("MATMUL: MATRIX_A= has rank %d and MATRIX_B= rank %d",
+        rankA, rankB);
+  }
+  // A is rows x depth and B is depth x columns; a vector A is a row and
+  // a vector B is a column.
+  const Dimension &a0{matrixA.GetDimension(0)};
+  const Dimension &b0{matrixB.GetDimension(0)};
+  std::size_t rows{1}, depth, columns{1};
+  std::ptrdiff_t aI{0}, aJ, bI{b0.ByteStride()}, bJ{0};
+  if (rankA == 2) {
+    const Dimension &a1{matrixA.GetDimension(1)};
+    rows = a0.Extent();
+    aI = a0.ByteStride();
+    depth = a1.Extent();
+    aJ = a1.ByteStride();
+  } else {
+    depth = a0.Extent();
+    aJ = a0.ByteStride();
+  }
+  if (static_cast<std::size_t>(b0.Extent()) != depth) {
+    terminator.Crash("MATMUL: the shared dimension has extent %zd in "
+                     "MATRIX_A= but %jd in MATRIX_B=",
+        depth, static_cast<std::intmax_t>(b0.Extent()));
+  }
+  if (rankB == 2) {
+    const Dimension &b1{matrixB.GetDimension(1)};
+    columns = b1.Extent();
+    bJ = b1.ByteStride();
+  }
+  TypeCode type{matrixA.type()};
+  std::size_t bytes{matrixA.ElementBytes()};
+  if (matrixB.type().raw() != type.raw() || matrixB.ElementBytes() != bytes) {
+    terminator.Crash("MATMUL: arguments of distinct types or kinds are not "
+                     "supported");
+  }
+
+  SubscriptValue extent[2]{
+      static_cast<SubscriptValue>(rankA == 2 ? rows : columns),
+      static_cast<SubscriptValue>(columns)};
+  int rank{rankA + rankB - 2};
+  std::unique_ptr<Descriptor> result{Descriptor::Create(
+      type, bytes, nullptr, rank, extent, CFI_attribute_allocatable)};
+  SubscriptValue lowerBound[2]{1, 1};
+  int status{result->Allocate(lowerBound, extent, bytes)};
+  if (status != CFI_SUCCESS) {
+    terminator.Crash("MATMUL: Allocate failed (error %d)", status);
+  }
+  char *c{result->Element<char>(std::size_t{0})};
+  std::memset(c, 0, rows * columns * bytes);
+  const char *aBase{matrixA.Element<const char>(std::size_t{0})};
+  const char *bBase{matrixB.Element<const char>(std::size_t{0})};
+  auto multiply{[&](auto element) {
+    using T = decltype(element);
+    Multiply<T>(c, Matrix<T>{aBase, aI, aJ}, Matrix<T>{bBase, bI, bJ}, rows,
+        depth, columns, terminator);
+    return true;
+  }};
+  bool done{false};
+  switch (type.Categorize()) {
+  case TypeCategory::Integer:
+    switch (bytes) {
+    case 1: done = multiply(std::int8_t{}); break;
+    case 2: done = multiply(std::int16_t{}); break;
+    case 4: done = multiply(std::int32_t{}); break;
+    case 8: done = multiply(std::int64_t{}); break;
+    }
+    break;
+  case TypeCategory::Real:
+    if (bytes == sizeof(float)) {
+      done = multiply(float{});
+    } else if (bytes == sizeof(double)) {
+      done = multiply(double{});
+    } else if (bytes == sizeof(long double)) {
+      done = multiply(static_cast<long double>(0));
+    }
+    break;
+  case TypeCategory::Complex:
+    if (bytes == sizeof(std::complex<float>)) {
+      done = multiply(std::complex<float>{});
+    } else if (bytes == sizeof(std::complex<double>)) {
+      done = multiply(std::complex<double>{});
+    } else if (bytes == sizeof(std::complex<long double>)) {
+      done = multiply(std::complex<long double>{});
+    }
+    break;
+  case TypeCategory::Logical:
+    // LOGICAL(1); other kinds have INTEGER type codes
+    MultiplyLogical(c, Matrix<std::uint8_t>{aBase, aI, aJ},
+        Matrix<std::uint8_t>{bBase, bI, bJ}, rows, depth, columns);
+    done = true;
+    break;
+  default: break;
+  }
+  if (!done) {
+    terminator.Crash("MATMUL: arguments of type code %d with %zd-byte "
+                     "elements are not supported",
+        static_cast<int>(type.raw()), bytes);
+  }
+  return result;
+}
+}
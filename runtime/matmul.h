@@ -0,0 +1,33 @@
+//===-- runtime/matmul.h ----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// MATMUL of matrices and vectors of any layout described by descriptors.
+// The result is a new allocated descriptor.  Both arguments must be of
+// the same type and kind, one of INTEGER, REAL, COMPLEX, or LOGICAL; as
+// the type codes of LOGICAL kinds other than 1 are those of INTEGER,
+// their products are computed as INTEGER sums, which are nonzero (true)
+// when any of the products is true.
+//
+// Products of matrices are computed in cache-sized blocks of packed
+// copies of the operands.  When the environment variable
+// FORT_MATMUL_THREADS is greater than 1, the columns of a large result
+// are divided among up to that many threads.
+
+#ifndef FORTRAN_RUNTIME_MATMUL_H_
+#define FORTRAN_RUNTIME_MATMUL_H_
+
+#include "descriptor.h"
+#include <memory>
+
+namespace Fortran::runtime {
+
+// F2018 16.9.124: one argument may be a vector (rank 1), not both.
+std::unique_ptr<Descriptor> MATMUL(
+    const Descriptor &matrixA, const Descriptor &matrixB);
+}
+#endif  // FORTRAN_RUNTIME_MATMUL_H_
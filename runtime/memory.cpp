@@ -7,22 +7,214 @@
 //===----------------------------------------------------------------------===//
 
 #include "memory.h"
+#include "environment.h"
 #include "terminator.h"
+#include "flang/common/leading-zero-bit-count.h"
+#include <atomic>
+#include <cstdio>
 #include <cstdlib>
+#include <new>
+#include <pthread.h>
 
 namespace Fortran::runtime {
 
+// Each block has a header just before the address returned, which is
+// at the start of the malloc() block unless the block is array data.
+struct BlockHeader {
+  std::uint32_t offset;  // of the header in the malloc() block
+  std::uint16_t sizeClass;
+  bool counted;  // in the statistics
+  std::uint64_t bytes;  // as requested
+};
+static_assert(sizeof(BlockHeader) == 16);
+
+// Size classes of 16, 32, ..., 4096 bytes; larger blocks and array data
+// are not cached.
+static constexpr int sizeClasses{9};
+static constexpr std::uint16_t largeBlock{sizeClasses};
+static constexpr std::uint16_t arrayData{sizeClasses + 1};
+static constexpr std::size_t ClassBytes(int c) { return std::size_t{16} << c; }
+static int SizeClass(std::size_t bytes) {
+  int bits{bytes <= 16 ? 0 : common::BitsNeededFor(std::uint64_t{bytes - 1})};
+  return bits <= 4 ? 0 : bits - 4;
+}
+// A thread keeps up to 64 KiB of free blocks of each size class.
+static constexpr int maxCacheDepth{64};
+static constexpr int CacheDepth(int c) {
+  return ClassBytes(c) * maxCacheDepth <= 65536
+      ? maxCacheDepth
+      : static_cast<int>(65536 / ClassBytes(c));
+}
+
+// Trivially destructible, so that it remains valid while the thread
+// exits; its blocks are freed then by the destructor of threadCacheKey.
+struct ThreadCache {
+  void *block[sizeClasses][maxCacheDepth];  // malloc() blocks
+  int count[sizeClasses];
+  bool registered;
+};
+static thread_local ThreadCache threadCache;
+static pthread_key_t threadCacheKey;
+static pthread_once_t threadCacheKeyOnce = PTHREAD_ONCE_INIT;
+
+static void EmptyThreadCache(void *) {
+  ThreadCache &cache{threadCache};
+  for (int c{0}; c < sizeClasses; ++c) {
+    while (cache.count[c] > 0) {
+      std::free(cache.block[c][--cache.count[c]]);
+    }
+  }
+  cache.registered = false;
+}
+
+static void CreateThreadCacheKey() {
+  ::pthread_key_create(&threadCacheKey, EmptyThreadCache);
+}
+
+static ThreadCache &GetThreadCache() {
+  ThreadCache &cache{threadCache};
+  if (!cache.registered) {
+    ::pthread_once(&threadCacheKeyOnce, CreateThreadCacheKey);
+    ::pthread_setspecific(threadCacheKey, &cache);
+    cache.registered = true;
+  }
+  return cache;
+}
+
+// FORT_MEMORY_STATS; allocations are counted by size class, then those
+// of larger blocks and of array data.
+static struct {
+  std::atomic<std::uint64_t> allocations[sizeClasses + 2];
+  std::atomic<std::uint64_t> cacheHits[sizeClasses];
+  std::atomic<std::uint64_t> liveBytes, peakBytes, liveBlocks;
+} statistics;
+
+static void CountAllocation(std::size_t bytes, int which, bool hit) {
+  static constexpr auto relaxed{std::memory_order_relaxed};
+  statistics.allocations[which].fetch_add(1, relaxed);
+  if (hit) {
+    statistics.cacheHits[which].fetch_add(1, relaxed);
+  }
+  statistics.liveBlocks.fetch_add(1, relaxed);
+  std::uint64_t live{statistics.liveBytes.fetch_add(bytes, relaxed) + bytes};
+  std::uint64_t peak{statistics.peakBytes.load(relaxed)};
+  while (live > peak &&
+      !statistics.peakBytes.compare_exchange_weak(peak, live, relaxed)) {
+  }
+}
+
+// Places the header at offset in the malloc() block
+static void *Prepare(void *block, std::size_t offset, std::uint16_t sizeClass,
+    std::size_t bytes, bool hit) {
+  bool counted{executionEnvironment.memoryStatistics};
+  auto *header{new (static_cast<char *>(block) + offset)
+          BlockHeader{static_cast<std::uint32_t>(offset), sizeClass, counted,
+              bytes}};
+  if (counted) {
+    CountAllocation(bytes, sizeClass, hit);
+  }
+  return header + 1;
+}
+
+// Returns null when out of memory.
+static void *Allocate(std::size_t bytes) {
+  if (bytes <= ClassBytes(sizeClasses - 1)) {
+    int c{SizeClass(bytes)};
+    ThreadCache &cache{GetThreadCache()};
+    if (cache.count[c] > 0) {
+      return Prepare(cache.block[c][--cache.count[c]], 0, c, bytes, true);
+    }
+    void *block{std::malloc(sizeof(BlockHeader) + ClassBytes(c))};
+    return block ? Prepare(block, 0, c, bytes, false) : nullptr;
+  }
+  if (bytes > static_cast<std::size_t>(-1) - sizeof(BlockHeader)) {
+    return nullptr;
+  }
+  void *block{std::malloc(sizeof(BlockHeader) + bytes)};
+  return block ? Prepare(block, 0, largeBlock, bytes, false) : nullptr;
+}
+
 void *AllocateMemoryOrCrash(const Terminator &terminator, std::size_t bytes) {
-  if (void *p{std::malloc(bytes)}) {
+  if (void *p{Allocate(bytes)}) {
     return p;
   }
-  if (bytes > 0) {
-    terminator.Crash(
-        "Fortran runtime internal error: out of memory, needed %zd bytes",
-        bytes);
+  terminator.Crash(
+      "Fortran runtime internal error: out of memory, needed %zd bytes",
+      bytes);
+}
+
+void *AllocateArrayMemory(std::size_t bytes) {
+  std::size_t alignment{executionEnvironment.arrayAlignment};
+  if (alignment == 0) {
+    alignment = defaultArrayAlignment;
+  } else if (alignment < sizeof(BlockHeader)) {
+    alignment = sizeof(BlockHeader);
+  }
+  std::size_t extra{sizeof(BlockHeader) + alignment};
+  if (bytes > static_cast<std::size_t>(-1) - extra) {
+    return nullptr;
+  }
+  char *block{static_cast<char *>(std::malloc(bytes + extra))};
+  if (!block) {
+    return nullptr;
+  }
+  auto address{reinterpret_cast<std::uintptr_t>(block) + sizeof(BlockHeader)};
+  std::size_t offset{(alignment - address % alignment) % alignment};
+  return Prepare(block, offset, arrayData, bytes, false);
+}
+
+void FreeMemory(void *p) {
+  if (!p) {
+    return;
+  }
+  BlockHeader &header{static_cast<BlockHeader *>(p)[-1]};
+  void *block{reinterpret_cast<char *>(&header) - header.offset};
+  if (header.counted) {
+    statistics.liveBytes.fetch_sub(header.bytes, std::memory_order_relaxed);
+    statistics.liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+  }
+  if (int c{header.sizeClass}; c < sizeClasses) {
+    ThreadCache &cache{GetThreadCache()};
+    if (cache.count[c] < CacheDepth(c)) {
+      cache.block[c][cache.count[c]++] = block;
+      return;
+    }
+  }
+  std::free(block);
+}
+
+MemoryUsage GetMemoryUsage() {
+  MemoryUsage usage{statistics.liveBytes.load(), statistics.peakBytes.load(),
+      statistics.liveBlocks.load(), 0};
+  for (const auto &count : statistics.allocations) {
+    usage.allocations += count.load();
   }
-  return nullptr;
+  return usage;
 }
 
-void FreeMemory(void *p) { std::free(p); }
+void ReportMemoryStatistics() {
+  static std::atomic<bool> reported{false};
+  if (reported.exchange(true)) {
+    return;
+  }
+  std::FILE *out{stderr};
+  std::fprintf(out,
+      "Fortran runtime memory statistics\n%12s %12s %12s\n", "block bytes",
+      "allocations", "cache hits");
+  for (int c{0}; c < sizeClasses; ++c) {
+    std::fprintf(out, "%12zd %12ju %12ju\n", ClassBytes(c),
+        static_cast<std::uintmax_t>(statistics.allocations[c].load()),
+        static_cast<std::uintmax_t>(statistics.cacheHits[c].load()));
+  }
+  std::fprintf(out, "%12s %12ju\n%12s %12ju\n", "larger",
+      static_cast<std::uintmax_t>(statistics.allocations[largeBlock].load()),
+      "array data",
+      static_cast<std::uintmax_t>(statistics.allocations[arrayData].load()));
+  MemoryUsage usage{GetMemoryUsage()};
+  std::fprintf(out,
+      "peak live bytes %ju; at the end, %ju bytes live in %ju blocks\n",
+      static_cast<std::uintmax_t>(usage.peakBytes),
+      static_cast<std::uintmax_t>(usage.liveBytes),
+      static_cast<std::uintmax_t>(usage.liveBlocks));
+}
 }
@@ -6,12 +6,19 @@
 //
 //===----------------------------------------------------------------------===//
 
-// Thin wrapper around malloc()/free() to isolate the dependency,
-// ease porting, and provide an owning pointer.
+// The runtime's allocator, which isolates the dependency on malloc() and
+// free(), eases porting, and provides an owning pointer.  Small blocks
+// are recycled through per-thread caches of a few size classes.  Array
+// data are aligned to FORT_ARRAY_ALIGNMENT (default 64) bytes so that
+// kernels over them can assume it.  When FORT_MEMORY_STATS is set (and
+// not 0), blocks are counted by size class, along with the peak and live
+// bytes, and a table is written to standard error at the end of the
+// program.
 
 #ifndef FORTRAN_RUNTIME_MEMORY_H_
 #define FORTRAN_RUNTIME_MEMORY_H_
 
+#include <cinttypes>
 #include <memory>
 
 namespace Fortran::runtime {
@@ -23,6 +30,9 @@ class Terminator;
 template<typename A>[[nodiscard]] A &AllocateOrCrash(const Terminator &t) {
   return *reinterpret_cast<A *>(AllocateMemoryOrCrash(t, sizeof(A)));
 }
+// Returns null when out of memory.
+[[nodiscard]] void *AllocateArrayMemory(std::size_t bytes);
+// Of any block allocated here, including array data
 void FreeMemory(void *);
 template<typename A> void FreeMemory(A *p) {
   FreeMemory(reinterpret_cast<void *>(p));
@@ -61,6 +71,16 @@ template<typename A> struct Allocator {
   constexpr void deallocate(A *p, std::size_t) { FreeMemory(p); }
   const Terminator &terminator;
 };
+
+static constexpr std::size_t defaultArrayAlignment{64};
+
+// For FORT_MEMORY_STATS; all zero when it is not set
+struct MemoryUsage {
+  std::uint64_t liveBytes, peakBytes, liveBlocks, allocations;
+};
+MemoryUsage GetMemoryUsage();
+// Writes the table of FORT_MEMORY_STATS, once.
+void ReportMemoryStatistics();
 }
 
 #endif  // FORTRAN_RUNTIME_MEMORY_H_
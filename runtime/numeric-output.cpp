@@ -8,13 +8,90 @@
 
 #include "numeric-output.h"
 #include "flang/common/unsigned-const-division.h"
+#include <cstring>
 
 namespace Fortran::runtime::io {
 
+// Tables of the digit strings for all of the groups of GROUP digits in
+// a base, so that integer formatting can produce several digits at once.
+template<int BASE, int GROUP> struct DigitGroups {
+  static constexpr int entries{GROUP == 4 ? BASE * BASE * BASE * BASE
+                                          : BASE * BASE};
+  static_assert(GROUP == 2 || GROUP == 4);
+  constexpr DigitGroups() {
+    for (int j{0}; j < entries; ++j) {
+      for (int k{GROUP - 1}, n{j}; k >= 0; --k, n /= BASE) {
+        chars[GROUP * j + k] = "0123456789ABCDEF"[n % BASE];
+      }
+    }
+  }
+  char chars[GROUP * entries]{};
+};
+
+static constexpr DigitGroups<10, 2> decimalPairs;
+
+// Formats the decimal digits of n to the left of end, and returns the
+// position of the first.  The digits are produced in chunks of eight
+// so that the arithmetic on each chunk can be 32 bits wide, and then
+// in pairs by table lookup.  A zero value has no digits.
+static char *FormatDecimal(std::uint64_t n, char *end) {
+  char *p{end};
+  auto emitPair{[&](std::uint32_t pair) {
+    p -= 2;
+    std::memcpy(p, &decimalPairs.chars[2 * pair], 2);
+  }};
+  while (n >= 100000000) {
+    std::uint64_t quotient{
+        common::DivideUnsignedBy<std::uint64_t, 100000000>(n)};
+    auto chunk{static_cast<std::uint32_t>(n - 100000000 * quotient)};
+    for (int j{0}; j < 4; ++j) {  // exactly eight digits
+      std::uint32_t pairs{common::DivideUnsignedBy<std::uint32_t, 100>(chunk)};
+      emitPair(chunk - 100 * pairs);
+      chunk = pairs;
+    }
+    n = quotient;
+  }
+  auto rest{static_cast<std::uint32_t>(n)};
+  while (rest >= 100) {
+    std::uint32_t pairs{common::DivideUnsignedBy<std::uint32_t, 100>(rest)};
+    emitPair(rest - 100 * pairs);
+    rest = pairs;
+  }
+  if (rest >= 10) {
+    emitPair(rest);
+  } else if (rest > 0) {
+    *--p = '0' + rest;
+  }
+  return p;
+}
+
+// Formats the digits of n in base 2**LOG2BASE to the left of end, like
+// FormatDecimal(), GROUP digits at a time.
+template<int LOG2BASE, int GROUP>
+static char *FormatPowerOfTwoBase(std::uint64_t n, char *end) {
+  static constexpr DigitGroups<1 << LOG2BASE, GROUP> groups;
+  constexpr int groupBits{LOG2BASE * GROUP};
+  constexpr std::uint64_t groupMask{(std::uint64_t{1} << groupBits) - 1};
+  char *p{end};
+  for (; n > groupMask; n >>= groupBits) {
+    p -= GROUP;
+    std::memcpy(p, &groups.chars[GROUP * (n & groupMask)], GROUP);
+  }
+  for (; n > 0; n >>= LOG2BASE) {
+    *--p = groups.chars[GROUP * (n & ((1 << LOG2BASE) - 1)) + GROUP - 1];
+  }
+  return p;
+}
+
 bool EditIntegerOutput(
     IoStatementState &io, const DataEdit &edit, std::int64_t n) {
-  char buffer[66], *end = &buffer[sizeof buffer], *p = end;
-  std::uint64_t un{static_cast<std::uint64_t>(n < 0 ? -n : n)};
+  // The digits are formatted at the end of the buffer; the field is
+  // assembled around them in the record (see OutputCursor).
+  char buffer[64], *end = &buffer[sizeof buffer], *p = end;
+  std::uint64_t un{static_cast<std::uint64_t>(n)};
+  if (n < 0) {
+    un = 0 - un;
+  }
   int signChars{0};
   switch (edit.descriptor) {
   case DataEdit::ListDirected:
@@ -23,28 +100,11 @@ bool EditIntegerOutput(
     if (n < 0 || (edit.modes.editingFlags & signPlus)) {
       signChars = 1;  // '-' or '+'
     }
-    while (un > 0) {
-      auto quotient{common::DivideUnsignedBy<std::uint64_t, 10>(un)};
-      *--p = '0' + un - 10 * quotient;
-      un = quotient;
-    }
-    break;
-  case 'B':
-    for (; un > 0; un >>= 1) {
-      *--p = '0' + (un & 1);
-    }
-    break;
-  case 'O':
-    for (; un > 0; un >>= 3) {
-      *--p = '0' + (un & 7);
-    }
-    break;
-  case 'Z':
-    for (; un > 0; un >>= 4) {
-      int digit = un & 0xf;
-      *--p = digit >= 10 ? 'A' + (digit - 10) : '0' + digit;
-    }
+    p = FormatDecimal(un, end);
     break;
+  case 'B': p = FormatPowerOfTwoBase<1, 4>(un, end); break;
+  case 'O': p = FormatPowerOfTwoBase<3, 2>(un, end); break;
+  case 'Z': p = FormatPowerOfTwoBase<4, 2>(un, end); break;
   default:
     io.GetIoErrorHandler().Crash(
         "Data edit descriptor '%c' may not be used with an INTEGER data item",
@@ -80,9 +140,12 @@ bool EditIntegerOutput(
     }
     leadingSpaces = 1;
   }
-  return io.EmitRepeated(' ', leadingSpaces) &&
-      io.Emit(n < 0 ? "-" : "+", signChars) &&
-      io.EmitRepeated('0', leadingZeroes) && io.Emit(p, digits);
+  return OutputCursor{io, static_cast<std::size_t>(leadingSpaces + total)}
+      .Fill(' ', leadingSpaces)
+      .Put(n < 0 ? "-" : "+", signChars)
+      .Fill('0', leadingZeroes)
+      .Put(p, digits)
+      .Finish();
 }
 
 // Formats the exponent (see table 13.1 for all the cases)
@@ -116,37 +179,53 @@ const char *RealOutputEditingBase::FormatExponent(
   return exponent;
 }
 
-bool RealOutputEditingBase::EmitPrefix(
-    const DataEdit &edit, std::size_t length, std::size_t width) {
+std::optional<OutputCursor> RealOutputEditingBase::BeginField(
+    const DataEdit &edit, int length, int width, int trailingBlanks) {
+  int prefixLength{0}, suffixLength{0};
   if (edit.IsListDirected()) {
-    int prefixLength{edit.descriptor == DataEdit::ListDirectedRealPart
-            ? 2
-            : edit.descriptor == DataEdit::ListDirectedImaginaryPart ? 0 : 1};
-    int suffixLength{edit.descriptor == DataEdit::ListDirectedRealPart ||
-                edit.descriptor == DataEdit::ListDirectedImaginaryPart
-            ? 1
-            : 0};
-    length += prefixLength + suffixLength;
+    prefixLength = edit.descriptor == DataEdit::ListDirectedRealPart
+        ? 2
+        : edit.descriptor == DataEdit::ListDirectedImaginaryPart ? 0 : 1;
+    suffixLength = edit.descriptor == DataEdit::ListDirectedRealPart ||
+            edit.descriptor == DataEdit::ListDirectedImaginaryPart
+        ? 1
+        : 0;
     ConnectionState &connection{io_.GetConnectionState()};
-    return (connection.positionInRecord == 0 ||
-               length <= connection.RemainingSpaceInRecord() ||
-               io_.AdvanceRecord()) &&
-        io_.Emit(" (", prefixLength);
+    if (connection.positionInRecord > 0 &&
+        static_cast<std::size_t>(prefixLength + length + suffixLength) >
+            connection.RemainingSpaceInRecord() &&
+        !io_.AdvanceRecord()) {
+      return std::nullopt;
+    }
   } else if (width > length) {
-    return io_.EmitRepeated(' ', width - length);
+    prefixLength = width - length;
+  }
+  std::optional<OutputCursor> field;
+  field.emplace(io_,
+      static_cast<std::size_t>(
+          prefixLength + length + trailingBlanks + suffixLength));
+  if (edit.IsListDirected()) {
+    field->Put(" (", prefixLength);
   } else {
-    return true;
+    field->Fill(' ', prefixLength);
   }
+  return field;
 }
 
-bool RealOutputEditingBase::EmitSuffix(const DataEdit &edit) {
+bool RealOutputEditingBase::FinishField(
+    OutputCursor &field, const DataEdit &edit) {
   if (edit.descriptor == DataEdit::ListDirectedRealPart) {
-    return io_.Emit(edit.modes.editingFlags & decimalComma ? ";" : ",", 1);
+    field.Put(edit.modes.editingFlags & decimalComma ? ";" : ",", 1);
   } else if (edit.descriptor == DataEdit::ListDirectedImaginaryPart) {
-    return io_.Emit(")", 1);
-  } else {
-    return true;
+    field.Put(")", 1);
   }
+  return field.Finish();
+}
+
+bool RealOutputEditingBase::EmitAsIs(
+    const DataEdit &edit, const char *p, int length, int width) {
+  auto field{BeginField(edit, length, width)};
+  return field && FinishField(field->Put(p, length), edit);
 }
 
 }
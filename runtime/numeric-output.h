@@ -48,8 +48,18 @@ protected:
   }
 
   const char *FormatExponent(int, const DataEdit &edit, int &length);
-  bool EmitPrefix(const DataEdit &, std::size_t length, std::size_t width);
-  bool EmitSuffix(const DataEdit &);
+  // Begins a field that holds a value of the given length (and then any
+  // trailing blanks) in one reservation.  The value is preceded by blanks
+  // that right-justify it in the field's width or, when list-directed, by
+  // a blank and (for the real part of a complex value) a parenthesis; a
+  // list-directed value that won't fit in the rest of the record begins
+  // the next one.
+  std::optional<OutputCursor> BeginField(
+      const DataEdit &, int length, int width, int trailingBlanks = 0);
+  // Ends the field, with a separator or parenthesis after a part of a
+  // list-directed complex value.
+  bool FinishField(OutputCursor &, const DataEdit &);
+  bool EmitAsIs(const DataEdit &, const char *, int length, int width);
 
   IoStatementState &io_;
   int trailingBlanks_{0};  // created when Gw editing maps to Fw
@@ -136,8 +146,7 @@ bool RealOutputEditing<binaryPrecision>::EditEorDOutput(const DataEdit &edit) {
     decimal::ConversionToDecimalResult converted{
         Convert(significantDigits, edit, flags)};
     if (converted.length > 0 && !IsDecimalNumber(converted.str)) {  // Inf, NaN
-      return EmitPrefix(edit, converted.length, editWidth) &&
-          io_.Emit(converted.str, converted.length) && EmitSuffix(edit);
+      return EmitAsIs(edit, converted.str, converted.length, editWidth);
     }
     if (!IsZero()) {
       converted.decimalExponent -= scale;
@@ -174,15 +183,18 @@ bool RealOutputEditing<binaryPrecision>::EditEorDOutput(const DataEdit &edit) {
       zeroesBeforePoint = 1;
       ++totalLength;
     }
-    return EmitPrefix(edit, totalLength, width) &&
-        io_.Emit(converted.str, signLength + digitsBeforePoint) &&
-        io_.EmitRepeated('0', zeroesBeforePoint) &&
-        io_.Emit(edit.modes.editingFlags & decimalComma ? "," : ".", 1) &&
-        io_.EmitRepeated('0', zeroesAfterPoint) &&
-        io_.Emit(
-            converted.str + signLength + digitsBeforePoint, digitsAfterPoint) &&
-        io_.EmitRepeated('0', trailingZeroes) &&
-        io_.Emit(exponent, expoLength) && EmitSuffix(edit);
+    auto field{BeginField(edit, totalLength, width)};
+    return field &&
+        FinishField(
+            field->Put(converted.str, signLength + digitsBeforePoint)
+                .Fill('0', zeroesBeforePoint)
+                .Put(edit.modes.editingFlags & decimalComma ? "," : ".", 1)
+                .Fill('0', zeroesAfterPoint)
+                .Put(converted.str + signLength + digitsBeforePoint,
+                    digitsAfterPoint)
+                .Fill('0', trailingZeroes)
+                .Put(exponent, expoLength),
+            edit);
   }
 }
 
@@ -205,8 +217,7 @@ bool RealOutputEditing<binaryPrecision>::EditFOutput(const DataEdit &edit) {
     decimal::ConversionToDecimalResult converted{
         Convert(extraDigits + fracDigits, edit, flags)};
     if (converted.length > 0 && !IsDecimalNumber(converted.str)) {  // Inf, NaN
-      return EmitPrefix(edit, converted.length, editWidth) &&
-          io_.Emit(converted.str, converted.length) && EmitSuffix(edit);
+      return EmitAsIs(edit, converted.str, converted.length, editWidth);
     }
     int scale{IsZero() ? -1 : edit.modes.scale};
     int expo{converted.decimalExponent - scale};
@@ -241,15 +252,18 @@ bool RealOutputEditing<binaryPrecision>::EditFOutput(const DataEdit &edit) {
       zeroesBeforePoint = 1;
       ++totalLength;
     }
-    return EmitPrefix(edit, totalLength, width) &&
-        io_.Emit(converted.str, signLength + digitsBeforePoint) &&
-        io_.EmitRepeated('0', zeroesBeforePoint) &&
-        io_.Emit(edit.modes.editingFlags & decimalComma ? "," : ".", 1) &&
-        io_.EmitRepeated('0', zeroesAfterPoint) &&
-        io_.Emit(
-            converted.str + signLength + digitsBeforePoint, digitsAfterPoint) &&
-        io_.EmitRepeated('0', trailingZeroes) &&
-        io_.EmitRepeated(' ', trailingBlanks_) && EmitSuffix(edit);
+    auto field{BeginField(edit, totalLength, width, trailingBlanks_)};
+    return field &&
+        FinishField(
+            field->Put(converted.str, signLength + digitsBeforePoint)
+                .Fill('0', zeroesBeforePoint)
+                .Put(edit.modes.editingFlags & decimalComma ? "," : ".", 1)
+                .Fill('0', zeroesAfterPoint)
+                .Put(converted.str + signLength + digitsBeforePoint,
+                    digitsAfterPoint)
+                .Fill('0', trailingZeroes)
+                .Fill(' ', trailingBlanks_),
+            edit);
   }
 }
 
@@ -0,0 +1,810 @@
+//===-- runtime/reduction.cpp -----------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "reduction.h"
+#include "element-runs.h"
+#include "environment.h"
+#include "memory.h"
+#include "terminator.h"
+#include <algorithm>
+#include <cinttypes>
+#include <complex>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace Fortran::runtime {
+
+// Each reduction is an operation class OP with these members:
+//   Element, Accumulator, Result   types
+//   Identity()                     an Accumulator for no elements
+//   Neutral()                      an Element that changes nothing
+//   Combine(Accumulator &, Element)
+//   Merge(Accumulator, Accumulator)
+//   Finish(Accumulator)            the Result
+//   pairwise                       contiguous runs are split in halves
+//   sequential                     elements are combined strictly in order
+//
+// Kernels over contiguous runs keep this many independent accumulators,
+// so that their loops can be vectorized without reassociating the
+// operations of any one of them.  The lanes are written out one by one,
+// rather than in loops, so that they can be kept in registers.
+static constexpr std::size_t lanes{8};
+// Pairwise summation applies lanes to blocks of this many elements.
+static constexpr std::size_t pairwiseBlock{128};
+
+template<typename OP, typename ELEMENT>
+static inline void CombineLanes(
+    typename OP::Accumulator (&lane)[lanes], ELEMENT element) {
+  OP::Combine(lane[0], element(0));
+  OP::Combine(lane[1], element(1));
+  OP::Combine(lane[2], element(2));
+  OP::Combine(lane[3], element(3));
+  OP::Combine(lane[4], element(4));
+  OP::Combine(lane[5], element(5));
+  OP::Combine(lane[6], element(6));
+  OP::Combine(lane[7], element(7));
+}
+
+template<typename OP>
+static inline typename OP::Accumulator MergeLanes(
+    const typename OP::Accumulator (&lane)[lanes]) {
+  return OP::Merge(OP::Merge(OP::Merge(lane[0], lane[4]),
+                       OP::Merge(lane[2], lane[6])),
+      OP::Merge(OP::Merge(lane[1], lane[5]), OP::Merge(lane[3], lane[7])));
+}
+
+// Returns value when mask is true and neutral otherwise, by masking bits
+// rather than with a branch that can't be predicted.
+template<typename T> static inline T Select(bool mask, T value, T neutral) {
+  if constexpr (std::is_arithmetic_v<T> &&
+      (sizeof(T) == 4 || sizeof(T) == 8)) {
+    using Bits = std::conditional_t<sizeof(T) == 4, std::uint32_t,
+        std::uint64_t>;
+    Bits valueBits, neutralBits, select{static_cast<Bits>(-Bits(mask))};
+    std::memcpy(&valueBits, &value, sizeof value);
+    std::memcpy(&neutralBits, &neutral, sizeof neutral);
+    Bits bits{(valueBits & select) | (neutralBits & ~select)};
+    std::memcpy(&value, &bits, sizeof value);
+    return value;
+  } else {
+    return mask ? value : neutral;
+  }
+}
+
+// A masked element is replaced by Neutral() rather than skipped, so that
+// the loop has no branches.  An element of the mask is true when nonzero.
+template<typename OP, typename MASK = char>
+static typename OP::Accumulator ReduceLanes(
+    const typename OP::Element *x, std::size_t n, const MASK *mask) {
+  using Element = typename OP::Element;
+  typename OP::Accumulator lane[lanes];
+  for (auto &accumulator : lane) {
+    accumulator = OP::Identity();
+  }
+  std::size_t j{0};
+  if (mask) {
+    Element neutral{OP::Neutral()};
+    for (; j + lanes <= n; j += lanes) {
+      CombineLanes<OP>(lane, [&](std::size_t k) {
+        return Select(mask[j + k] != 0, x[j + k], neutral);
+      });
+    }
+  } else {
+    for (; j + lanes <= n; j += lanes) {
+      CombineLanes<OP>(lane, [&](std::size_t k) { return x[j + k]; });
+    }
+  }
+  typename OP::Accumulator result{MergeLanes<OP>(lane)};
+  for (; j < n; ++j) {
+    if (!mask || mask[j] != 0) {
+      OP::Combine(result, x[j]);
+    }
+  }
+  return result;
+}
+
+template<typename OP, typename MASK = char>
+static typename OP::Accumulator ReduceContiguous(
+    const typename OP::Element *x, std::size_t n, const MASK *mask) {
+  if (OP::pairwise && n > pairwiseBlock) {
+    std::size_t half{n / 2 / lanes * lanes};
+    return OP::Merge(ReduceContiguous<OP>(x, half, mask),
+        ReduceContiguous<OP>(x + half, n - half, mask ? mask + half : mask));
+  } else {
+    return ReduceLanes<OP>(x, n, mask);
+  }
+}
+
+// Reduces n elements at a byte stride into an accumulator.  A mask has
+// one byte, 0 or 1, for each element.
+template<typename OP>
+static void ReduceRun(typename OP::Accumulator &accumulator, const char *first,
+    std::size_t n, std::ptrdiff_t stride, const char *mask) {
+  using Element = typename OP::Element;
+  if (!OP::sequential &&
+      stride == static_cast<std::ptrdiff_t>(sizeof(Element))) {
+    accumulator = OP::Merge(accumulator,
+        ReduceContiguous<OP>(
+            reinterpret_cast<const Element *>(first), n, mask));
+  } else if (mask) {
+    for (std::size_t j{0}; j < n; ++j, first += stride) {
+      if (mask[j]) {
+        OP::Combine(accumulator, *reinterpret_cast<const Element *>(first));
+      }
+    }
+  } else {
+    for (std::size_t j{0}; j < n; ++j, first += stride) {
+      OP::Combine(accumulator, *reinterpret_cast<const Element *>(first));
+    }
+  }
+}
+
+// Combines n elements at a byte stride into n accumulators, one each,
+// as when reducing along a dimension other than the first.
+template<typename OP>
+static void CombineElementwise(typename OP::Accumulator *accumulator,
+    const char *first, std::size_t n, std::ptrdiff_t stride,
+    const char *mask) {
+  using Element = typename OP::Element;
+  if (mask) {
+    for (std::size_t j{0}; j < n; ++j, first += stride) {
+      if (mask[j]) {
+        OP::Combine(accumulator[j], *reinterpret_cast<const Element *>(first));
+      }
+    }
+  } else if (stride == static_cast<std::ptrdiff_t>(sizeof(Element))) {
+    const Element *x{reinterpret_cast<const Element *>(first)};
+    for (std::size_t j{0}; j < n; ++j) {
+      OP::Combine(accumulator[j], x[j]);
+    }
+  } else {
+    for (std::size_t j{0}; j < n; ++j, first += stride) {
+      OP::Combine(accumulator[j], *reinterpret_cast<const Element *>(first));
+    }
+  }
+}
+
+// Establishes a descriptor for dimensions [first, last) of an array at
+// the same base address.
+static void EstablishView(
+    Descriptor &view, const Descriptor &array, int first, int last) {
+  SubscriptValue extent[maxRank]{};
+  for (int j{first}; j < last; ++j) {
+    extent[j - first] = array.GetDimension(j).Extent();
+  }
+  view.Establish(array.type(), array.ElementBytes(),
+      const_cast<char *>(array.Element<const char>(std::size_t{0})),
+      last - first, extent, CFI_attribute_pointer);
+  for (int j{first}; j < last; ++j) {
+    view.raw().dim[j - first].sm = array.GetDimension(j).ByteStride();
+  }
+}
+
+static std::unique_ptr<Descriptor> CreateResult(const char *intrinsic,
+    TypeCode type, std::size_t elementBytes, int rank,
+    const SubscriptValue *extent, const Terminator &terminator) {
+  std::unique_ptr<Descriptor> result{Descriptor::Create(
+      type, elementBytes, nullptr, rank, extent, CFI_attribute_allocatable)};
+  SubscriptValue lowerBound[maxRank];
+  for (int j{0}; j < rank; ++j) {
+    lowerBound[j] = 1;
+  }
+  int status{result->Allocate(lowerBound, extent, elementBytes)};
+  if (status != CFI_SUCCESS) {
+    terminator.Crash("%s: Allocate failed (error %d)", intrinsic, status);
+  }
+  return result;
+}
+
+static bool IsTrue(const char *p, std::size_t bytes) {
+  switch (bytes) {
+  case 1: return *reinterpret_cast<const std::uint8_t *>(p) != 0;
+  case 2: return *reinterpret_cast<const std::uint16_t *>(p) != 0;
+  case 4: return *reinterpret_cast<const std::uint32_t *>(p) != 0;
+  case 8: return *reinterpret_cast<const std::uint64_t *>(p) != 0;
+  default:
+    for (std::size_t j{0}; j < bytes; ++j) {
+      if (p[j] != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+}
+
+static void CheckMask(const char *intrinsic, const Descriptor &array,
+    const Descriptor *mask, const Terminator &terminator) {
+  if (!mask || mask->rank() == 0) {
+    return;
+  }
+  if (mask->rank() != array.rank()) {
+    terminator.Crash("%s: MASK= has rank %d but ARRAY= has rank %d",
+        intrinsic, mask->rank(), array.rank());
+  }
+  for (int j{0}; j < array.rank(); ++j) {
+    if (mask->GetDimension(j).Extent() != array.GetDimension(j).Extent()) {
+      terminator.Crash(
+          "%s: MASK= does not conform to ARRAY= in dimension %d", intrinsic,
+          j + 1);
+    }
+  }
+}
+
+// Converts MASK= to one byte, 0 or 1, for each element of ARRAY= in array
+// element order.  Returns null when MASK= is absent or a true scalar.
+static OwningPtr<char> GetMask(const Descriptor &array,
+    const Descriptor *mask, const Terminator &terminator) {
+  OwningPtr<char> result;
+  if (!mask) {
+    return result;
+  }
+  std::size_t maskBytes{mask->ElementBytes()};
+  std::size_t elements{array.Elements()};
+  if (mask->rank() == 0 &&
+      IsTrue(mask->Element<const char>(std::size_t{0}), maskBytes)) {
+    return result;
+  }
+  result.reset(static_cast<char *>(
+      AllocateMemoryOrCrash(terminator, std::max<std::size_t>(elements, 1))));
+  if (mask->rank() == 0) {
+    std::memset(result.get(), 0, elements);
+  } else {
+    char *to{result.get()};
+    auto gather{[&](auto element) {
+      using M = decltype(element);
+      ElementRuns{*mask}.ForEachRun(
+          [&](const char *first, std::size_t n, std::ptrdiff_t stride) {
+            if (stride == static_cast<std::ptrdiff_t>(sizeof(M))) {
+              const M *from{reinterpret_cast<const M *>(first)};
+              for (std::size_t j{0}; j < n; ++j) {
+                to[j] = from[j] != 0;
+              }
+            } else {
+              for (std::size_t j{0}; j < n; ++j) {
+                to[j] = *reinterpret_cast<const M *>(first + j * stride) != 0;
+              }
+            }
+            to += n;
+            return true;
+          });
+    }};
+    switch (maskBytes) {
+    case 1: gather(std::uint8_t{}); break;
+    case 2: gather(std::uint16_t{}); break;
+    case 4: gather(std::uint32_t{}); break;
+    case 8: gather(std::uint64_t{}); break;
+    default:
+      ElementRuns{*mask}.ForEachRun(
+          [&](const char *first, std::size_t n, std::ptrdiff_t stride) {
+            for (std::size_t j{0}; j < n; ++j, first += stride) {
+              *to++ = IsTrue(first, maskBytes);
+            }
+            return true;
+          });
+    }
+  }
+  return result;
+}
+
+// Reduces a contiguous ARRAY= under a contiguous MASK= of the same shape
+// directly, without converting the mask.
+template<typename OP>
+static bool ReduceUnderContiguousMask(typename OP::Accumulator &accumulator,
+    const Descriptor &array, const Descriptor &mask) {
+  using Element = typename OP::Element;
+  if (OP::sequential || mask.rank() == 0 ||
+      !ElementRuns{array}.IsContiguous() ||
+      !ElementRuns{mask}.IsContiguous()) {
+    return false;
+  }
+  const Element *x{array.Element<const Element>(std::size_t{0})};
+  std::size_t n{array.Elements()};
+  auto reduce{[&](auto *m) {
+    accumulator = OP::Merge(accumulator, ReduceContiguous<OP>(x, n, m));
+    return true;
+  }};
+  switch (mask.ElementBytes()) {
+  case 1: return reduce(mask.Element<const std::uint8_t>(std::size_t{0}));
+  case 2: return reduce(mask.Element<const std::uint16_t>(std::size_t{0}));
+  case 4: return reduce(mask.Element<const std::uint32_t>(std::size_t{0}));
+  case 8: return reduce(mask.Element<const std::uint64_t>(std::size_t{0}));
+  default: return false;
+  }
+}
+
+// The reduction engine.  Without DIM=, the runs of the array are reduced
+// in array element order into one accumulator.  With DIM=1, each result
+// element is the reduction of one run along the first dimension.  With a
+// later DIM=, the array is traversed in its element order, which is its
+// memory order when contiguous, and each run of the dimensions before
+// DIM= is combined into a run of accumulators for the result elements.
+template<typename OP>
+static std::unique_ptr<Descriptor> Reduce(const char *intrinsic,
+    const Descriptor &array, int dim, const Descriptor *maskDescriptor,
+    TypeCode resultType, const Terminator &terminator) {
+  using Accumulator = typename OP::Accumulator;
+  using Result = typename OP::Result;
+  int rank{array.rank()};
+  OwningPtr<char> maskBytes;
+  if (dim == 0) {
+    Accumulator accumulator{OP::Identity()};
+    if (!maskDescriptor ||
+        !ReduceUnderContiguousMask<OP>(
+            accumulator, array, *maskDescriptor)) {
+      maskBytes = GetMask(array, maskDescriptor, terminator);
+      const char *mask{maskBytes.get()};
+      std::size_t at{0};
+      ElementRuns{array}.ForEachRun(
+          [&](const char *first, std::size_t n, std::ptrdiff_t stride) {
+            ReduceRun<OP>(
+                accumulator, first, n, stride, mask ? mask + at : nullptr);
+            at += n;
+            return true;
+          });
+    }
+    auto result{CreateResult(
+        intrinsic, resultType, sizeof(Result), 0, nullptr, terminator)};
+    *result->Element<Result>(std::size_t{0}) = OP::Finish(accumulator);
+    return result;
+  }
+  maskBytes = GetMask(array, maskDescriptor, terminator);
+  const char *mask{maskBytes.get()};
+  SubscriptValue resultExtent[maxRank];
+  std::size_t inner{1}, outer{1};
+  for (int j{0}; j < rank; ++j) {
+    SubscriptValue extent{array.GetDimension(j).Extent()};
+    if (j < dim - 1) {
+      inner *= extent;
+      resultExtent[j] = extent;
+    } else if (j >= dim) {
+      outer *= extent;
+      resultExtent[j - 1] = extent;
+    }
+  }
+  const Dimension &reduced{array.GetDimension(dim - 1)};
+  std::size_t n{static_cast<std::size_t>(reduced.Extent())};
+  std::ptrdiff_t stride{reduced.ByteStride()};
+  std::size_t resultElements{inner * outer};
+  OwningPtr<Accumulator> accumulators{
+      static_cast<Accumulator *>(AllocateMemoryOrCrash(terminator,
+          std::max<std::size_t>(resultElements, 1) * sizeof(Accumulator)))};
+  Accumulator *accumulator{accumulators.get()};
+  for (std::size_t j{0}; j < resultElements; ++j) {
+    new (&accumulator[j]) Accumulator{OP::Identity()};
+  }
+  StaticDescriptor<maxRank> innerDescriptor, outerDescriptor;
+  Descriptor &innerView{innerDescriptor.descriptor()};
+  Descriptor &outerView{outerDescriptor.descriptor()};
+  EstablishView(innerView, array, 0, dim - 1);
+  EstablishView(outerView, array, dim, rank);
+  std::size_t o{0};  // the index of a position in the outer dimensions
+  ElementRuns{outerView}.ForEachRun(
+      [&](const char *first, std::size_t count, std::ptrdiff_t outerStride) {
+        for (std::size_t j{0}; j < count; ++j, ++o, first += outerStride) {
+          if (resultElements == 0 || n == 0) {
+            return false;
+          } else if (dim == 1) {
+            ReduceRun<OP>(accumulator[o], first, n, stride,
+                mask ? mask + o * n : nullptr);
+            continue;
+          }
+          for (std::size_t k{0}; k < n; ++k) {
+            std::size_t at{0};
+            const char *maskAt{mask ? mask + inner * (k + n * o) : nullptr};
+            ElementRuns{innerView, nullptr, first + k * stride}.ForEachRun(
+                [&](const char *run, std::size_t runLength,
+                    std::ptrdiff_t runStride) {
+                  CombineElementwise<OP>(accumulator + o * inner + at, run,
+                      runLength, runStride, maskAt ? maskAt + at : nullptr);
+                  at += runLength;
+                  return true;
+                });
+          }
+        }
+        return true;
+      });
+  auto result{CreateResult(intrinsic, resultType, sizeof(Result), rank - 1,
+      resultExtent, terminator)};
+  Result *to{result->Element<Result>(std::size_t{0})};
+  for (std::size_t j{0}; j < resultElements; ++j) {
+    to[j] = OP::Finish(accumulator[j]);
+  }
+  return result;
+}
+
+template<typename T, bool PAIRWISE, bool SEQUENTIAL = false> struct Sum {
+  using Element = T;
+  using Accumulator = T;
+  using Result = T;
+  static constexpr bool pairwise{PAIRWISE}, sequential{SEQUENTIAL};
+  static T Identity() { return T{0}; }
+  static T Neutral() { return T{0}; }
+  static void Combine(T &sum, T x) { sum += x; }
+  static T Merge(T x, T y) { return x + y; }
+  static T Finish(T sum) { return sum; }
+};
+
+// Kahan's compensated summation: error is the amount by which sum
+// exceeds the exact sum of the elements combined.
+template<typename T> struct CompensatedSum {
+  using Element = T;
+  struct Accumulator {
+    T sum, error;
+  };
+  using Result = T;
+  static constexpr bool pairwise{false}, sequential{false};
+  static Accumulator Identity() { return {T{0}, T{0}}; }
+  static T Neutral() { return T{0}; }
+  static void Combine(Accumulator &x, T y) {
+    T corrected{y - x.error};
+    T sum{x.sum + corrected};
+    x.error = (sum - x.sum) - corrected;
+    x.sum = sum;
+  }
+  static Accumulator Merge(Accumulator x, const Accumulator &y) {
+    Combine(x, y.sum);
+    Combine(x, -y.error);
+    return x;
+  }
+  static T Finish(const Accumulator &x) { return x.sum - x.error; }
+};
+
+// Integer sums are exact (modulo overflow) in any order.
+template<typename T>
+using PairwiseSum = Sum<T, !std::is_integral_v<T>>;
+template<typename T>
+using KahanSum = std::conditional_t<std::is_integral_v<T>, Sum<T, false>,
+    CompensatedSum<T>>;
+template<typename T>
+using SequentialSum = std::conditional_t<std::is_integral_v<T>,
+    Sum<T, false>, Sum<T, false, true>>;
+
+template<typename T> struct Product {
+  using Element = T;
+  using Accumulator = T;
+  using Result = T;
+  static constexpr bool pairwise{false}, sequential{false};
+  static T Identity() { return T{1}; }
+  static T Neutral() { return T{1}; }
+  static void Combine(T &product, T x) { product *= x; }
+  static T Merge(T x, T y) { return x * y; }
+  static T Finish(T product) { return product; }
+};
+
+// An empty MAXVAL is the negative number of the greatest magnitude, and
+// an empty MINVAL the positive one.  NaNs are ignored.
+template<typename T, bool IS_MAX> struct Extremum {
+  using Element = T;
+  using Accumulator = T;
+  using Result = T;
+  static constexpr bool pairwise{false}, sequential{false};
+  static T Identity() {
+    using Limits = std::numeric_limits<T>;
+    if constexpr (Limits::has_infinity) {
+      return IS_MAX ? -Limits::infinity() : Limits::infinity();
+    } else {
+      return IS_MAX ? Limits::lowest() : Limits::max();
+    }
+  }
+  static T Neutral() { return Identity(); }
+  static void Combine(T &extremum, T x) {
+    extremum = (IS_MAX ? x > extremum : x < extremum) ? x : extremum;
+  }
+  static T Merge(T x, T y) {
+    Combine(x, y);
+    return x;
+  }
+  static T Finish(T extremum) { return extremum; }
+};
+template<typename T> using Maximum = Extremum<T, true>;
+template<typename T> using Minimum = Extremum<T, false>;
+
+// LOGICAL elements are unsigned integers of their size.
+template<typename M, typename R> struct Count {
+  using Element = M;
+  using Accumulator = std::int64_t;
+  using Result = R;
+  static constexpr bool pairwise{false}, sequential{false};
+  static std::int64_t Identity() { return 0; }
+  static M Neutral() { return 0; }
+  static void Combine(std::int64_t &count, M x) { count += x != 0; }
+  static std::int64_t Merge(std::int64_t x, std::int64_t y) { return x + y; }
+  static R Finish(std::int64_t count) { return count; }
+};
+
+template<typename M, bool IS_ANY> struct AnyOrAll {
+  using Element = M;
+  using Accumulator = bool;
+  using Result = M;
+  static constexpr bool pairwise{false}, sequential{false};
+  static bool Identity() { return !IS_ANY; }
+  static M Neutral() { return !IS_ANY; }
+  static void Combine(bool &truth, M x) {
+    if constexpr (IS_ANY) {
+      truth |= x != 0;
+    } else {
+      truth &= x != 0;
+    }
+  }
+  static bool Merge(bool x, bool y) { return IS_ANY ? x || y : x && y; }
+  static M Finish(bool truth) { return truth; }
+};
+template<typename M> using Any = AnyOrAll<M, true>;
+template<typename M> using All = AnyOrAll<M, false>;
+
+static void CheckDim(const char *intrinsic, const Descriptor &array, int dim,
+    const Terminator &terminator) {
+  if (dim < 0 || dim > array.rank()) {
+    terminator.Crash("%s: DIM=%d is not valid for an array of rank %d",
+        intrinsic, dim, array.rank());
+  }
+}
+
+// Applies OP<T> for the type and kind of a numeric ARRAY=.
+template<template<typename> class OP, bool ALLOW_COMPLEX>
+static std::unique_ptr<Descriptor> ReduceNumeric(const char *intrinsic,
+    const Descriptor &array, int dim, const Descriptor *mask) {
+  Terminator terminator{__FILE__, __LINE__};
+  CheckDim(intrinsic, array, dim, terminator);
+  CheckMask(intrinsic, array, mask, terminator);
+  TypeCode type{array.type()};
+  std::size_t bytes{array.ElementBytes()};
+  auto reduce{[&](auto element) {
+    return Reduce<OP<decltype(element)>>(
+        intrinsic, array, dim, mask, type, terminator);
+  }};
+  switch (type.Categorize()) {
+  case TypeCategory::Integer:
+    switch (bytes) {
+    case 1: return reduce(std::int8_t{});
+    case 2: return reduce(std::int16_t{});
+    case 4: return reduce(std::int32_t{});
+    case 8: return reduce(std::int64_t{});
+    }
+    break;
+  case TypeCategory::Real:
+    if (bytes == sizeof(float)) {
+      return reduce(float{});
+    } else if (bytes == sizeof(double)) {
+      return reduce(double{});
+    } else if (bytes == sizeof(long double)) {
+      return reduce(static_cast<long double>(0));
+    }
+    break;
+  case TypeCategory::Complex:
+    if constexpr (ALLOW_COMPLEX) {
+      if (bytes == sizeof(std::complex<float>)) {
+        return reduce(std::complex<float>{});
+      } else if (bytes == sizeof(std::complex<double>)) {
+        return reduce(std::complex<double>{});
+      } else if (bytes == sizeof(std::complex<long double>)) {
+        return reduce(std::complex<long double>{});
+      }
+    }
+    break;
+  default: break;
+  }
+  terminator.Crash("%s: ARRAY= of type code %d with %zd-byte elements is not "
+                   "supported",
+      intrinsic, static_cast<int>(type.raw()), bytes);
+}
+
+std::unique_ptr<Descriptor> SUM(
+    const Descriptor &array, int dim, const Descriptor *mask) {
+  switch (executionEnvironment.summation) {
+  case Summation::Kahan:
+    return ReduceNumeric<KahanSum, true>("SUM", array, dim, mask);
+  case Summation::Sequential:
+    return ReduceNumeric<SequentialSum, true>("SUM", array, dim, mask);
+  default: return ReduceNumeric<PairwiseSum, true>("SUM", array, dim, mask);
+  }
+}
+
+std::unique_ptr<Descriptor> PRODUCT(
+    const Descriptor &array, int dim, const Descriptor *mask) {
+  return ReduceNumeric<Product, true>("PRODUCT", array, dim, mask);
+}
+
+std::unique_ptr<Descriptor> MAXVAL(
+    const Descriptor &array, int dim, const Descriptor *mask) {
+  return ReduceNumeric<Maximum, false>("MAXVAL", array, dim, mask);
+}
+
+std::unique_ptr<Descriptor> MINVAL(
+    const Descriptor &array, int dim, const Descriptor *mask) {
+  return ReduceNumeric<Minimum, false>("MINVAL", array, dim, mask);
+}
+
+// Applies OP<M> for the size of the LOGICAL elements of MASK=.
+template<template<typename> class OP>
+static std::unique_ptr<Descriptor> ReduceLogical(const char *intrinsic,
+    const Descriptor &mask, int dim, TypeCode resultType) {
+  Terminator terminator{__FILE__, __LINE__};
+  CheckDim(intrinsic, mask, dim, terminator);
+  switch (mask.ElementBytes()) {
+  case 1:
+    return Reduce<OP<std::uint8_t>>(
+        intrinsic, mask, dim, nullptr, resultType, terminator);
+  case 2:
+    return Reduce<OP<std::uint16_t>>(
+        intrinsic, mask, dim, nullptr, resultType, terminator);
+  case 4:
+    return Reduce<OP<std::uint32_t>>(
+        intrinsic, mask, dim, nullptr, resultType, terminator);
+  case 8:
+    return Reduce<OP<std::uint64_t>>(
+        intrinsic, mask, dim, nullptr, resultType, terminator);
+  }
+  terminator.Crash("%s: MASK= with %zd-byte elements is not supported",
+      intrinsic, mask.ElementBytes());
+}
+
+template<typename R> struct CountKind {
+  template<typename M> using Operation = Count<M, R>;
+};
+
+std::unique_ptr<Descriptor> COUNT(const Descriptor &mask, int dim, int kind) {
+  TypeCode type{TypeCategory::Integer, kind};
+  switch (kind) {
+  case 1:
+    return ReduceLogical<CountKind<std::int8_t>::Operation>(
+        "COUNT", mask, dim, type);
+  case 2:
+    return ReduceLogical<CountKind<std::int16_t>::Operation>(
+        "COUNT", mask, dim, type);
+  case 4:
+    return ReduceLogical<CountKind<std::int32_t>::Operation>(
+        "COUNT", mask, dim, type);
+  case 8:
+    return ReduceLogical<CountKind<std::int64_t>::Operation>(
+        "COUNT", mask, dim, type);
+  }
+  Terminator{__FILE__, __LINE__}.Crash("COUNT: KIND=%d is not supported", kind);
+}
+
+std::unique_ptr<Descriptor> ANY(const Descriptor &mask, int dim) {
+  return ReduceLogical<Any>("ANY", mask, dim, mask.type());
+}
+
+std::unique_ptr<Descriptor> ALL(const Descriptor &mask, int dim) {
+  return ReduceLogical<All>("ALL", mask, dim, mask.type());
+}
+
+template<typename T> static T Conjugate(T x) { return x; }
+template<typename T> static std::complex<T> Conjugate(std::complex<T> x) {
+  return std::conj(x);
+}
+
+// The sum of the products in lanes, pairwise over contiguous vectors
+template<typename T>
+static T ContiguousDot(const T *x, const T *y, std::size_t n) {
+  if (!std::is_integral_v<T> && n > pairwiseBlock) {
+    std::size_t half{n / 2 / lanes * lanes};
+    return ContiguousDot(x, y, half) +
+        ContiguousDot(x + half, y + half, n - half);
+  }
+  using Lanes = Sum<T, false>;
+  T lane[lanes]{};
+  std::size_t j{0};
+  for (; j + lanes <= n; j += lanes) {
+    CombineLanes<Lanes>(lane,
+        [&](std::size_t k) { return Conjugate(x[j + k]) * y[j + k]; });
+  }
+  T result{MergeLanes<Lanes>(lane)};
+  for (; j < n; ++j) {
+    result += Conjugate(x[j]) * y[j];
+  }
+  return result;
+}
+
+template<typename T>
+static T Dot(const char *x, std::ptrdiff_t xStride, const char *y,
+    std::ptrdiff_t yStride, std::size_t n) {
+  auto at{[](const char *p) { return *reinterpret_cast<const T *>(p); }};
+  Summation summation{executionEnvironment.summation};
+  if constexpr (!std::is_integral_v<T>) {
+    if (summation == Summation::Kahan) {
+      using Compensated = CompensatedSum<T>;
+      auto sum{Compensated::Identity()};
+      for (std::size_t j{0}; j < n; ++j, x += xStride, y += yStride) {
+        Compensated::Combine(sum, Conjugate(at(x)) * at(y));
+      }
+      return Compensated::Finish(sum);
+    }
+  }
+  if (summation != Summation::Sequential &&
+      xStride == static_cast<std::ptrdiff_t>(sizeof(T)) &&
+      yStride == static_cast<std::ptrdiff_t>(sizeof(T))) {
+    return ContiguousDot(reinterpret_cast<const T *>(x),
+        reinterpret_cast<const T *>(y), n);
+  } else {
+    T sum{0};
+    for (std::size_t j{0}; j < n; ++j, x += xStride, y += yStride) {
+      sum += Conjugate(at(x)) * at(y);
+    }
+    return sum;
+  }
+}
+
+std::unique_ptr<Descriptor> DOT_PRODUCT(
+    const Descriptor &vectorA, const Descriptor &vectorB) {
+  Terminator terminator{__FILE__, __LINE__};
+  if (vectorA.rank() != 1 || vectorB.rank() != 1) {
+    terminator.Crash("DOT_PRODUCT: the arguments must be vectors");
+  }
+  std::size_t n{static_cast<std::size_t>(vectorA.GetDimension(0).Extent())};
+  if (static_cast<std::size_t>(vectorB.GetDimension(0).Extent()) != n) {
+    terminator.Crash("DOT_PRODUCT: the vectors have sizes %zd and %jd", n,
+        static_cast<std::intmax_t>(vectorB.GetDimension(0).Extent()));
+  }
+  TypeCode type{vectorA.type()};
+  std::size_t bytes{vectorA.ElementBytes()};
+  if (vectorB.type().raw() != type.raw() || vectorB.ElementBytes() != bytes) {
+    terminator.Crash("DOT_PRODUCT: vectors of distinct types or kinds are "
+                     "not supported");
+  }
+  auto result{
+      CreateResult("DOT_PRODUCT", type, bytes, 0, nullptr, terminator)};
+  const char *x{vectorA.Element<const char>(std::size_t{0})};
+  const char *y{vectorB.Element<const char>(std::size_t{0})};
+  std::ptrdiff_t xStride{vectorA.GetDimension(0).ByteStride()};
+  std::ptrdiff_t yStride{vectorB.GetDimension(0).ByteStride()};
+  auto store{[&](auto value) {
+    *result->Element<decltype(value)>(std::size_t{0}) = value;
+  }};
+  switch (type.Categorize()) {
+  case TypeCategory::Integer:
+    switch (bytes) {
+    case 1: store(Dot<std::int8_t>(x, xStride, y, yStride, n)); return result;
+    case 2: store(Dot<std::int16_t>(x, xStride, y, yStride, n)); return result;
+    case 4: store(Dot<std::int32_t>(x, xStride, y, yStride, n)); return result;
+    case 8: store(Dot<std::int64_t>(x, xStride, y, yStride, n)); return result;
+    }
+    break;
+  case TypeCategory::Real:
+    if (bytes == sizeof(float)) {
+      store(Dot<float>(x, xStride, y, yStride, n));
+      return result;
+    } else if (bytes == sizeof(double)) {
+      store(Dot<double>(x, xStride, y, yStride, n));
+      return result;
+    } else if (bytes == sizeof(long double)) {
+      store(Dot<long double>(x, xStride, y, yStride, n));
+      return result;
+    }
+    break;
+  case TypeCategory::Complex:
+    if (bytes == sizeof(std::complex<float>)) {
+      store(Dot<std::complex<float>>(x, xStride, y, yStride, n));
+      return result;
+    } else if (bytes == sizeof(std::complex<double>)) {
+      store(Dot<std::complex<double>>(x, xStride, y, yStride, n));
+      return result;
+    } else if (bytes == sizeof(std::complex<long double>)) {
+      store(Dot<std::complex<long double>>(x, xStride, y, yStride, n));
+      return result;
+    }
+    break;
+  case TypeCategory::Logical: {
+    // LOGICAL(1); other kinds have INTEGER type codes
+    bool truth{false};
+    for (std::size_t j{0}; j < n && !truth; ++j, x += xStride, y += yStride) {
+      truth = IsTrue(x, bytes) && IsTrue(y, bytes);
+    }
+    std::memset(result->Element<char>(std::size_t{0}), 0, bytes);
+    *result->Element<char>(std::size_t{0}) = truth;
+    return result;
+  }
+  default: break;
+  }
+  terminator.Crash("DOT_PRODUCT: vectors of type code %d with %zd-byte "
+                   "elements are not supported",
+      static_cast<int>(type.raw()), bytes);
+}
+}
@@ -0,0 +1,54 @@
+//===-- runtime/reduction.h -------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Array reduction intrinsic functions, on arrays of any rank and layout
+// described by descriptors.  Each returns a new allocated descriptor for
+// its result: a scalar (rank 0) when DIM= is absent (0), otherwise an
+// array with ARRAY='s shape less the dimension DIM=.  An optional MASK=
+// must be a scalar or conform to ARRAY=.
+//
+// LOGICAL arguments may be of any kind; since the type codes of LOGICAL
+// kinds other than 1 are those of INTEGER, any nonzero value is true.
+//
+// REAL and COMPLEX sums, including those of DOT_PRODUCT, are computed by
+// pairwise summation of contiguous runs unless the environment variable
+// FORT_SUMMATION selects KAHAN (compensated) or SEQUENTIAL (in array
+// element order) summation instead.  Sums along a dimension other than
+// the first are compensated under KAHAN and sequential otherwise.
+
+#ifndef FORTRAN_RUNTIME_REDUCTION_H_
+#define FORTRAN_RUNTIME_REDUCTION_H_
+
+#include "descriptor.h"
+#include <memory>
+
+namespace Fortran::runtime {
+
+enum class Summation { Pairwise, Kahan, Sequential };
+
+// F2018 16.9: SUM, PRODUCT, MAXVAL, MINVAL
+std::unique_ptr<Descriptor> SUM(
+    const Descriptor &array, int dim = 0, const Descriptor *mask = nullptr);
+std::unique_ptr<Descriptor> PRODUCT(
+    const Descriptor &array, int dim = 0, const Descriptor *mask = nullptr);
+std::unique_ptr<Descriptor> MAXVAL(
+    const Descriptor &array, int dim = 0, const Descriptor *mask = nullptr);
+std::unique_ptr<Descriptor> MINVAL(
+    const Descriptor &array, int dim = 0, const Descriptor *mask = nullptr);
+
+// COUNT, ANY, ALL; COUNT's KIND= defaults to 4
+std::unique_ptr<Descriptor> COUNT(
+    const Descriptor &mask, int dim = 0, int kind = 4);
+std::unique_ptr<Descriptor> ANY(const Descriptor &mask, int dim = 0);
+std::unique_ptr<Descriptor> ALL(const Descriptor &mask, int dim = 0);
+
+// VECTOR_A and VECTOR_B must be of the same type and kind.
+std::unique_ptr<Descriptor> DOT_PRODUCT(
+    const Descriptor &vectorA, const Descriptor &vectorB);
+}
+#endif  // FORTRAN_RUNTIME_REDUCTION_H_
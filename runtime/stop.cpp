@@ -39,11 +39,20 @@ static void DescribeIEEESignaledExceptions() {
     if (excepts & FE_UNDERFLOW) {
       std::fputs(" UNDERFLOW", stderr);
     }
+    std::fputc('\n', stderr);
   }
 }
 
+// Units remain open after STOP, but their output, including any being
+// written in the background, must be complete.
+static void FlushAllUnits(const char *statement) {
+  Fortran::runtime::io::IoErrorHandler handler{statement};
+  Fortran::runtime::io::ExternalFileUnit::FlushAll(handler);
+}
+
 [[noreturn]] void RTNAME(StopStatement)(
     int code, bool isErrorStop, bool quiet) {
+  FlushAllUnits(isErrorStop ? "ERROR STOP statement" : "STOP statement");
   if (!quiet) {
     if (code != EXIT_SUCCESS) {
       std::fprintf(stderr, "Fortran %s: code %d\n",
@@ -56,6 +65,7 @@ static void DescribeIEEESignaledExceptions() {
 
 [[noreturn]] void RTNAME(StopStatementText)(
     const char *code, bool isErrorStop, bool quiet) {
+  FlushAllUnits(isErrorStop ? "ERROR STOP statement" : "STOP statement");
   if (!quiet) {
     std::fprintf(
         stderr, "Fortran %s: %s\n", isErrorStop ? "ERROR STOP" : "STOP", code);
@@ -0,0 +1,229 @@
+//===-- runtime/storage.cpp -------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage.h"
+#include "environment.h"
+#include "tools.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace Fortran::runtime::io {
+
+Storage IdentifyStorage(char *path, std::size_t &length) {
+  if (!path || executionEnvironment.fileSchemes == 0) {
+    return Storage::Posix;
+  }
+  const char *colon{
+      static_cast<const char *>(std::memchr(path, ':', std::min<std::size_t>(
+                                                          length, 8)))};
+  if (!colon) {
+    return Storage::Posix;
+  }
+  static const char *schemes[]{"MEM", "GZIP", "ZSTD", nullptr};
+  int which{IdentifyValue(path, colon - path, schemes)};
+  if (which < 0) {
+    return Storage::Posix;
+  }
+  Storage storage{static_cast<Storage>(which + 1)};
+  if (!(executionEnvironment.fileSchemes &
+          (1u << static_cast<int>(storage)))) {
+    return Storage::Posix;
+  }
+  std::size_t prefix{static_cast<std::size_t>(colon - path) + 1};
+  length -= prefix;
+  std::memmove(path, path + prefix, length);
+  path[length] = '\0';
+  return storage;
+}
+
+bool MemoryFile::Load(int fd, IoErrorHandler &handler) {
+  Release();
+  struct stat buf;
+  if (::fstat(fd, &buf) != 0) {
+    handler.SignalErrno();
+    return false;
+  }
+  Reserve(buf.st_size, handler);
+  while (size_ < static_cast<std::size_t>(buf.st_size)) {
+    auto chunk{::pread(fd, data_.get() + size_, buf.st_size - size_, size_)};
+    if (chunk == 0) {
+      break;  // the file has shrunk
+    } else if (chunk > 0) {
+      size_ += chunk;
+    } else if (errno != EINTR) {
+      handler.SignalErrno();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MemoryFile::Save(int fd, IoErrorHandler &handler) {
+  if (!modified_) {
+    return true;
+  }
+  for (std::size_t done{0}; done < size_;) {
+    auto chunk{::pwrite(fd, data_.get() + done, size_ - done, done)};
+    if (chunk >= 0) {
+      done += chunk;
+    } else if (errno != EINTR) {
+      handler.SignalErrno();
+      return false;
+    }
+  }
+  if (::ftruncate(fd, size_) != 0) {
+    handler.SignalErrno();
+    return false;
+  }
+  modified_ = false;
+  return true;
+}
+
+void MemoryFile::Release() {
+  data_.reset();
+  size_ = capacity_ = 0;
+  modified_ = false;
+}
+
+std::size_t MemoryFile::Read(FileOffset at, char *buffer, std::size_t minBytes,
+    std::size_t maxBytes, IoErrorHandler &handler) {
+  std::size_t got{0};
+  if (at < static_cast<FileOffset>(size_)) {
+    got = std::min<std::size_t>(maxBytes, size_ - at);
+    std::memcpy(buffer, data_.get() + at, got);
+  }
+  if (got < minBytes) {
+    handler.SignalEnd();
+  }
+  return got;
+}
+
+std::size_t MemoryFile::Write(FileOffset at, const char *buffer,
+    std::size_t bytes, IoErrorHandler &handler) {
+  std::size_t end{static_cast<std::size_t>(at) + bytes};
+  Reserve(end, handler);
+  if (static_cast<std::size_t>(at) > size_) {
+    std::memset(data_.get() + size_, 0, at - size_);  // a hole
+  }
+  std::memcpy(data_.get() + at, buffer, bytes);
+  size_ = std::max(size_, end);
+  modified_ = true;
+  return bytes;
+}
+
+void MemoryFile::Truncate(FileOffset at) {
+  if (static_cast<std::size_t>(at) < size_) {
+    size_ = at;
+    modified_ = true;
+  }
+}
+
+// Grows the buffer geometrically.
+void MemoryFile::Reserve(std::size_t bytes, const Terminator &terminator) {
+  if (bytes > capacity_) {
+    std::size_t capacity{std::max<std::size_t>(bytes, 2 * capacity_)};
+    capacity = std::max<std::size_t>(capacity, 4096);
+    char *data{static_cast<char *>(
+        AllocateMemoryOrCrash(terminator, capacity))};
+    if (size_ > 0) {
+      std::memcpy(data, data_.get(), size_);
+    }
+    data_.reset(data);
+    capacity_ = capacity;
+  }
+}
+
+int StartFilter(
+    Storage storage, int fd, bool isRead, pid_t &pid, IoErrorHandler &handler) {
+  static const char *gzip[2][4]{
+      {"gzip", "-c", nullptr}, {"gzip", "-dc", nullptr}};
+  static const char *zstd[2][4]{
+      {"zstd", "-q", "-c", nullptr}, {"zstd", "-q", "-dc", nullptr}};
+  const char **argv{storage == Storage::Gzip ? gzip[isRead] : zstd[isRead]};
+  int pipeFds[2];
+  if (::pipe(pipeFds) != 0) {
+    handler.SignalErrno();
+    ::close(fd);
+    return -1;
+  }
+  // Other filters must not inherit this end of the pipe, or the process
+  // reading from it would never see its end.
+  int ours{pipeFds[isRead ? 0 : 1]}, theirs{pipeFds[isRead ? 1 : 0]};
+  ::fcntl(ours, F_SETFD, FD_CLOEXEC);
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, isRead ? fd : theirs, 0);
+  posix_spawn_file_actions_adddup2(&actions, isRead ? theirs : fd, 1);
+  int err{::posix_spawnp(&pid, argv[0], &actions, nullptr,
+      const_cast<char *const *>(argv), environ)};
+  posix_spawn_file_actions_destroy(&actions);
+  ::close(theirs);
+  ::close(fd);
+  if (err != 0) {
+    ::close(ours);
+    handler.SignalError(err, "Could not run '%s' for a %s file: %s", argv[0],
+        argv[0], std::strerror(err));
+    return -1;
+  }
+  return ours;
+}
+
+void FinishFilter(pid_t pid, bool isRead, IoErrorHandler &handler) {
+  int status;
+  while (::waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) {
+      handler.SignalErrno();
+      return;
+    }
+  }
+  // A reader that closed its pipe early stopped the decompressor.
+  if (isRead && WIFSIGNALED(status) && WTERMSIG(status) == SIGPIPE) {
+    return;
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    handler.SignalError(EIO, "The %s process failed",
+        isRead ? "decompression" : "compression");
+  }
+}
+
+FilterWriteGuard::FilterWriteGuard(bool active) : active_{active} {
+  if (active_) {
+    sigset_t sigpipe;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe, &saved_);
+    sigset_t pending;
+    wasPending_ = sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE);
+  }
+}
+
+FilterWriteGuard::~FilterWriteGuard() {
+  if (active_) {
+    sigset_t pending;
+    if (!wasPending_ && sigpending(&pending) == 0 &&
+        sigismember(&pending, SIGPIPE)) {
+      sigset_t sigpipe;
+      sigemptyset(&sigpipe);
+      sigaddset(&sigpipe, SIGPIPE);
+      int which;
+      sigwait(&sigpipe, &which);  // pending, so it returns at once
+    }
+    pthread_sigmask(SIG_SETMASK, &saved_, nullptr);
+  }
+}
+}
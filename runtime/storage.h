@@ -0,0 +1,84 @@
+//===-- runtime/storage.h ---------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Alternative backing stores for external files.  An OpenFile is
+// normally a POSIX file descriptor for the named file.  When the
+// environment variable FORT_FILE_SCHEMES enables them (e.g.,
+// FORT_FILE_SCHEMES=MEM,GZIP), a FILE= name may begin with a scheme
+// that selects another store:
+//   mem:path    the file is staged in memory while it is connected: it is
+//               read once at OPEN and written back at CLOSE, so that the
+//               transfers in between make no system calls
+//   gzip:path   the file is a compressed stream, written or read
+//   zstd:path   sequentially through a gzip or zstd process
+// Without FORT_FILE_SCHEMES, names are never interpreted.
+
+#ifndef FORTRAN_RUNTIME_STORAGE_H_
+#define FORTRAN_RUNTIME_STORAGE_H_
+
+#include "io-error.h"
+#include "memory.h"
+#include <cinttypes>
+#include <csignal>
+#include <cstddef>
+#include <sys/types.h>
+
+namespace Fortran::runtime::io {
+
+enum class Storage { Posix, Memory, Gzip, Zstd };
+
+// Identifies and removes an enabled scheme prefix on a file name.
+Storage IdentifyStorage(char *path, std::size_t &length);
+
+// The contents of a file held in memory
+class MemoryFile {
+public:
+  using FileOffset = std::int64_t;
+
+  FileOffset size() const { return size_; }
+  bool Load(int fd, IoErrorHandler &);  // reads the whole file
+  bool Save(int fd, IoErrorHandler &);  // if modified since Load()
+  void Release();
+
+  // Like OpenFile's: partial reads (less than minBytes) signify
+  // end-of-file.
+  std::size_t Read(FileOffset, char *, std::size_t minBytes,
+      std::size_t maxBytes, IoErrorHandler &);
+  std::size_t Write(FileOffset, const char *, std::size_t, IoErrorHandler &);
+  void Truncate(FileOffset);
+
+private:
+  void Reserve(std::size_t, const Terminator &);
+  OwningPtr<char> data_;
+  std::size_t size_{0}, capacity_{0};
+  bool modified_{false};
+};
+
+// Starts the gzip or zstd process that compresses what's written to the
+// returned pipe into the open file fd, or that decompresses fd's contents
+// into the returned pipe; fd is closed.  Returns -1 on failure.
+int StartFilter(Storage, int fd, bool isRead, pid_t &, IoErrorHandler &);
+// Waits for the process after its pipe has been closed.
+void FinishFilter(pid_t, bool isRead, IoErrorHandler &);
+
+// While one is active, SIGPIPE is blocked in the calling thread, so that
+// a write to the pipe of a compression process that has exited fails
+// with EPIPE rather than terminating the program.  A SIGPIPE that the
+// write raises is discarded.
+class FilterWriteGuard {
+public:
+  explicit FilterWriteGuard(bool active);
+  ~FilterWriteGuard();
+
+private:
+  bool active_;
+  bool wasPending_{false};
+  sigset_t saved_;
+};
+}
+#endif  // FORTRAN_RUNTIME_STORAGE_H_
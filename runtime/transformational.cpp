@@ -7,11 +7,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "transformational.h"
+#include "element-runs.h"
 #include "flang/common/idioms.h"
+#include "memory.h"
+#include "terminator.h"
 #include "flang/evaluate/integer.h"
 #include <algorithm>
 #include <bitset>
 #include <cinttypes>
+#include <cstring>
 #include <memory>
 
 namespace Fortran::runtime {
@@ -26,6 +30,184 @@ static inline std::int64_t GetInt64(const char *p, std::size_t bytes) {
   }
 }
 
+// RESHAPE copies elements in runs of contiguous storage where it can and
+// specializes its element-by-element copies for the common element sizes.
+// BYTES is 0 for other sizes, which are copied by a general memcpy.
+template<std::size_t BYTES> struct ElementCopier {
+  explicit ElementCopier(std::size_t bytes) : bytes_{BYTES ? BYTES : bytes} {}
+  std::size_t bytes() const { return bytes_; }
+  void Copy(char *to, const char *from) const {
+    std::memcpy(to, from, BYTES ? BYTES : bytes_);
+  }
+
+  // to[j] = from[j * stride], for a dimension of a source that is not
+  // contiguous; the stride is in bytes.
+  void Gather(char *to, const char *from, std::ptrdiff_t stride,
+      std::size_t n) const {
+    for (std::size_t j{0}; j < n; ++j, to += bytes(), from += stride) {
+      Copy(to, from);
+    }
+  }
+
+  // to[a * toA + b * toB] = from[a * fromA + b * fromB] for nA x nB
+  // elements; the strides are in bytes.  The loops are blocked into tiles
+  // whose rows and columns fit in cache together.
+  void Transpose(char *to, std::ptrdiff_t toA, std::ptrdiff_t toB,
+      const char *from, std::ptrdiff_t fromA, std::ptrdiff_t fromB,
+      SubscriptValue nA, SubscriptValue nB) const {
+    constexpr SubscriptValue tile{BYTES == 0 || BYTES > 8 ? 16 : 32};
+    for (SubscriptValue b0{0}; b0 < nB; b0 += tile) {
+      SubscriptValue b1{std::min(nB, b0 + tile)};
+      for (SubscriptValue a0{0}; a0 < nA; a0 += tile) {
+        SubscriptValue a1{std::min(nA, a0 + tile)};
+        for (SubscriptValue b{b0}; b < b1; ++b) {
+          char *t{to + a0 * toA + b * toB};
+          const char *f{from + a0 * fromA + b * fromB};
+          for (SubscriptValue a{a0}; a < a1; ++a, t += toA, f += fromA) {
+            Copy(t, f);
+          }
+        }
+      }
+    }
+  }
+
+private:
+  std::size_t bytes_;
+};
+
+template<typename F>
+static void DispatchOnElementBytes(std::size_t bytes, F f) {
+  switch (bytes) {
+  case 1: f(ElementCopier<1>{bytes}); break;
+  case 2: f(ElementCopier<2>{bytes}); break;
+  case 4: f(ElementCopier<4>{bytes}); break;
+  case 8: f(ElementCopier<8>{bytes}); break;
+  case 16: f(ElementCopier<16>{bytes}); break;
+  default: f(ElementCopier<0>{bytes}); break;
+  }
+}
+
+// Copies n elements of an array to contiguous storage in array element
+// order, repeating the array as often as necessary (as PAD= is), and
+// returns the end of the copy.
+static char *CopyInElementOrder(
+    char *to, const Descriptor &from, std::size_t n) {
+  ElementRuns runs{from};
+  if (n == 0 || runs.elements() == 0) {
+    return to;
+  }
+  std::size_t bytes{from.ElementBytes()};
+  DispatchOnElementBytes(bytes, [&](const auto &copier) {
+    while (n > 0) {
+      runs.ForEachRun(
+          [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+            count = std::min(count, n);
+            if (stride == static_cast<std::ptrdiff_t>(bytes)) {
+              std::memcpy(to, first, count * bytes);
+            } else {
+              copier.Gather(to, first, stride, count);
+            }
+            to += count * bytes;
+            n -= count;
+            return n > 0;
+          });
+    }
+  });
+  return to;
+}
+
+// Stores the elements of a contiguous sequence into a result in permuted
+// subscript order: the result's dimension order[0] varies most rapidly,
+// then order[1], and so on.  When that order begins with runs of adjacent
+// elements of the result, they are copied directly.  Otherwise each
+// element of the result's other dimensions, taken in the permuted order,
+// begins a column along dimension order[0] whose elements are adjacent in
+// the sequence, and each run of those columns is transposed in tiles.
+static void CopyPermuted(
+    const Descriptor &result, const char *from, const int *order) {
+  std::size_t bytes{result.ElementBytes()};
+  ElementRuns runs{result, order};
+  if (runs.elements() == 0) {
+    return;
+  }
+  if (runs.runByteStride() == static_cast<std::ptrdiff_t>(bytes)) {
+    runs.ForEachRun([&](char *first, std::size_t count, std::ptrdiff_t) {
+      std::memcpy(first, from, count * bytes);
+      from += count * bytes;
+      return true;
+    });
+    return;
+  }
+  // A view of the result without dimension order[0], and the permutation
+  // of its dimensions
+  int rank{result.rank()};
+  int b{order[0]};
+  const Dimension &column{result.GetDimension(b)};
+  SubscriptValue extent[maxRank];
+  int viewOrder[maxRank];
+  for (int j{0}; j + 1 < rank; ++j) {
+    extent[j] = result.GetDimension(j < b ? j : j + 1).Extent();
+    viewOrder[j] = order[j + 1] < b ? order[j + 1] : order[j + 1] - 1;
+  }
+  StaticDescriptor<maxRank> viewDescriptor;
+  Descriptor &view{viewDescriptor.descriptor()};
+  view.Establish(result.type(), bytes,
+      const_cast<char *>(result.Element<const char>(std::size_t{0})),
+      rank - 1, extent, CFI_attribute_pointer);
+  for (int j{0}; j + 1 < rank; ++j) {
+    view.raw().dim[j].sm = result.GetDimension(j < b ? j : j + 1).ByteStride();
+  }
+  std::ptrdiff_t columnBytes{
+      static_cast<std::ptrdiff_t>(column.Extent() * bytes)};
+  DispatchOnElementBytes(bytes, [&](const auto &copier) {
+    ElementRuns{view, viewOrder}.ForEachRun(
+        [&](char *first, std::size_t count, std::ptrdiff_t stride) {
+          copier.Transpose(first, stride, column.ByteStride(), from,
+              columnBytes, bytes, count, column.Extent());
+          from += count * columnBytes;
+          return true;
+        });
+  });
+}
+
+// Creates and allocates a result with the type and length parameters of
+// source and lower bounds of 1.
+static std::unique_ptr<Descriptor> CreateResult(const char *intrinsic,
+    const Descriptor &source, int rank, const SubscriptValue *extent) {
+  const DescriptorAddendum *sourceAddendum{source.Addendum()};
+  const DerivedType *sourceDerivedType{
+      sourceAddendum ? sourceAddendum->derivedType() : nullptr};
+  std::size_t elementBytes{source.ElementBytes()};
+  std::unique_ptr<Descriptor> result;
+  if (sourceDerivedType) {
+    result = Descriptor::Create(
+        *sourceDerivedType, nullptr, rank, extent, CFI_attribute_allocatable);
+  } else {
+    result = Descriptor::Create(source.type(), elementBytes, nullptr, rank,
+        extent, CFI_attribute_allocatable);  // TODO rearrange these arguments
+  }
+  DescriptorAddendum *resultAddendum{result->Addendum()};
+  CHECK(resultAddendum);
+  resultAddendum->flags() |= DescriptorAddendum::DoNotFinalize;
+  if (sourceDerivedType) {
+    std::size_t lenParameters{sourceDerivedType->lenParameters()};
+    for (std::size_t j{0}; j < lenParameters; ++j) {
+      resultAddendum->SetLenParameterValue(
+          j, sourceAddendum->LenParameterValue(j));
+    }
+  }
+  // Allocate storage for the result's data.
+  SubscriptValue lowerBound[maxRank];
+  for (int j{0}; j < rank; ++j) {
+    lowerBound[j] = 1;
+  }
+  int status{result->Allocate(lowerBound, extent, elementBytes)};
+  if (status != CFI_SUCCESS) {
+    common::die("%s: Allocate failed (error %d)", intrinsic, status);
+  }
+  return result;
+}
+
 // F2018 16.9.163
 std::unique_ptr<Descriptor> RESHAPE(const Descriptor &source,
     const Descriptor &shape, const Descriptor *pad, const Descriptor *order) {
@@ -36,13 +218,11 @@ std::unique_ptr<Descriptor> RESHAPE(const Descriptor &source,
   CHECK(resultRank >= 0 && resultRank <= static_cast<SubscriptValue>(maxRank));
 
   // Extract and check the shape of the result; compute its element count.
-  SubscriptValue lowerBound[maxRank];  // all 1's
   SubscriptValue resultExtent[maxRank];
   std::size_t shapeElementBytes{shape.ElementBytes()};
   std::size_t resultElements{1};
   SubscriptValue shapeSubscript{shape.GetDimension(0).LowerBound()};
   for (SubscriptValue j{0}; j < resultRank; ++j, ++shapeSubscript) {
-    lowerBound[j] = 1;
     resultExtent[j] =
         GetInt64(shape.Element<char>(&shapeSubscript), shapeElementBytes);
     CHECK(resultExtent[j] >= 0);
@@ -54,14 +234,16 @@ std::unique_ptr<Descriptor> RESHAPE(const Descriptor &source,
   std::size_t elementBytes{source.ElementBytes()};
   std::size_t sourceElements{source.Elements()};
   std::size_t padElements{pad ? pad->Elements() : 0};
-  if (resultElements < sourceElements) {
+  if (resultElements > sourceElements) {
     CHECK(padElements > 0);
     CHECK(pad->ElementBytes() == elementBytes);
   }
 
   // Extract and check the optional ORDER= argument, which must be a
-  // permutation of [1..resultRank].
+  // permutation of [1..resultRank]; dimension dimOrder[0] of the result
+  // varies most rapidly as it is filled.
   int dimOrder[maxRank];
+  bool isPermuted{false};
   if (order) {
     CHECK(order->rank() == 1);
     CHECK(order->type().IsInteger());
@@ -69,10 +251,12 @@ std::unique_ptr<Descriptor> RESHAPE(const Descriptor &source,
     std::bitset<maxRank> values;
     SubscriptValue orderSubscript{order->GetDimension(0).LowerBound()};
     for (SubscriptValue j{0}; j < resultRank; ++j, ++orderSubscript) {
-      auto k{GetInt64(order->Element<char>(orderSubscript), shapeElementBytes)};
+      auto k{GetInt64(
+          order->Element<char>(&orderSubscript), order->ElementBytes())};
       CHECK(k >= 1 && k <= resultRank && !values.test(k - 1));
       values.set(k - 1);
-      dimOrder[k - 1] = j;
+      dimOrder[j] = k - 1;
+      isPermuted |= k - 1 != j;
     }
   } else {
     for (int j{0}; j < resultRank; ++j) {
@@ -80,60 +264,56 @@ std::unique_ptr<Descriptor> RESHAPE(const Descriptor &source,
     }
   }
 
-  // Create and populate the result's descriptor.
-  const DescriptorAddendum *sourceAddendum{source.Addendum()};
-  const DerivedType *sourceDerivedType{
-      sourceAddendum ? sourceAddendum->derivedType() : nullptr};
-  std::unique_ptr<Descriptor> result;
-  if (sourceDerivedType) {
-    result = Descriptor::Create(*sourceDerivedType, nullptr, resultRank,
-        resultExtent, CFI_attribute_allocatable);
-  } else {
-    result = Descriptor::Create(source.type(), elementBytes, nullptr,
-        resultRank, resultExtent,
-        CFI_attribute_allocatable);  // TODO rearrange these arguments
-  }
-  DescriptorAddendum *resultAddendum{result->Addendum()};
-  CHECK(resultAddendum);
-  resultAddendum->flags() |= DescriptorAddendum::DoNotFinalize;
-  if (sourceDerivedType) {
-    std::size_t lenParameters{sourceDerivedType->lenParameters()};
-    for (std::size_t j{0}; j < lenParameters; ++j) {
-      resultAddendum->SetLenParameterValue(
-          j, sourceAddendum->LenParameterValue(j));
-    }
-  }
-  // Allocate storage for the result's data.
-  int status{result->Allocate(lowerBound, resultExtent, elementBytes)};
-  if (status != CFI_SUCCESS) {
-    common::die("RESHAPE: Allocate failed (error %d)", status);
-  }
+  std::unique_ptr<Descriptor> result{
+      CreateResult("RESHAPE", source, resultRank, resultExtent)};
 
-  // Populate the result's elements.
-  SubscriptValue resultSubscript[maxRank];
-  result->GetLowerBounds(resultSubscript);
-  SubscriptValue sourceSubscript[maxRank];
-  source.GetLowerBounds(sourceSubscript);
-  std::size_t resultElement{0};
+  // Populate the result's elements.  Its storage is contiguous, so in
+  // the absence of a permutation the elements of SOURCE= and then PAD=
+  // are copied directly in order.  Otherwise they are gathered into a
+  // contiguous sequence first, unless SOURCE= is one already.
   std::size_t elementsFromSource{std::min(resultElements, sourceElements)};
-  for (; resultElement < elementsFromSource; ++resultElement) {
-    std::memcpy(result->Element<void>(resultSubscript),
-        source.Element<const void>(sourceSubscript), elementBytes);
-    source.IncrementSubscripts(sourceSubscript);
-    result->IncrementSubscripts(resultSubscript, dimOrder);
-  }
-  if (resultElement < resultElements) {
-    // Remaining elements come from the optional PAD= argument.
-    SubscriptValue padSubscript[maxRank];
-    pad->GetLowerBounds(padSubscript);
-    for (; resultElement < resultElements; ++resultElement) {
-      std::memcpy(result->Element<void>(resultSubscript),
-          pad->Element<const void>(padSubscript), elementBytes);
-      pad->IncrementSubscripts(padSubscript);
-      result->IncrementSubscripts(resultSubscript, dimOrder);
+  char *resultData{result->Element<char>(std::size_t{0})};
+  const char *sequence{source.Element<const char>(std::size_t{0})};
+  OwningPtr<char> gathered;
+  if (!isPermuted || !source.IsContiguous() ||
+      resultElements > sourceElements) {
+    char *to{resultData};
+    if (isPermuted) {
+      Terminator terminator{__FILE__, __LINE__};
+      gathered.reset(static_cast<char *>(AllocateMemoryOrCrash(terminator,
+          std::max<std::size_t>(resultElements * elementBytes, 1))));
+      to = gathered.get();
+    }
+    sequence = to;
+    to = CopyInElementOrder(to, source, elementsFromSource);
+    if (resultElements > elementsFromSource) {
+      // Remaining elements come from the optional PAD= argument.
+      CopyInElementOrder(to, *pad, resultElements - elementsFromSource);
     }
   }
+  if (isPermuted) {
+    CopyPermuted(*result, sequence, dimOrder);
+  }
+
+  return result;
+}
 
+// F2018 16.9.193
+std::unique_ptr<Descriptor> TRANSPOSE(const Descriptor &matrix) {
+  CHECK(matrix.rank() == 2);
+  const Dimension &rows{matrix.GetDimension(0)};
+  const Dimension &columns{matrix.GetDimension(1)};
+  SubscriptValue resultExtent[2]{columns.Extent(), rows.Extent()};
+  std::unique_ptr<Descriptor> result{
+      CreateResult("TRANSPOSE", matrix, 2, resultExtent)};
+  // The rows of the result are the columns of MATRIX=.
+  DispatchOnElementBytes(matrix.ElementBytes(), [&](const auto &copier) {
+    copier.Transpose(result->Element<char>(std::size_t{0}),
+        result->GetDimension(0).ByteStride(),
+        result->GetDimension(1).ByteStride(),
+        matrix.Element<const char>(std::size_t{0}), columns.ByteStride(),
+        rows.ByteStride(), resultExtent[0], resultExtent[1]);
+  });
   return result;
 }
 }
@@ -17,5 +17,7 @@ namespace Fortran::runtime {
 std::unique_ptr<Descriptor> RESHAPE(const Descriptor &source,
     const Descriptor &shape, const Descriptor *pad = nullptr,
     const Descriptor *order = nullptr);
+
+std::unique_ptr<Descriptor> TRANSPOSE(const Descriptor &matrix);
 }
 #endif  // FORTRAN_RUNTIME_TRANSFORMATIONAL_H_
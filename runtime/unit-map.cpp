@@ -0,0 +1,250 @@
+//===-- runtime/unit-map.cpp ------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "unit-map.h"
+#include "memory.h"
+#include "unit.h"
+#include <cstring>
+#include <new>
+
+namespace Fortran::runtime::io {
+
+// Probing always terminates, since tables are never more than half used.
+const UnitMap::Slot *UnitMap::Find(const Table &table, int n) {
+  const Slot *slots{table.slots()};
+  std::size_t mask{static_cast<std::size_t>(table.capacity) - 1};
+  for (std::size_t j{Hash(n) & mask};; j = (j + 1) & mask) {
+    int key{slots[j].unitNumber.load(std::memory_order_acquire)};
+    if (key == n) {
+      return &slots[j];
+    } else if (key == emptySlot) {
+      return nullptr;
+    }
+  }
+}
+
+// The count of lookups in progress and the loads and stores of units
+// and tables are sequentially consistent: when Reclaim() finds no
+// lookup in progress after a unit or table has been unpublished, any
+// lookup that found it has already made its hold on the unit visible.
+ExternalFileUnit *UnitMap::LookUp(int n) {
+  lookups_.fetch_add(1);
+  ExternalFileUnit *unit{nullptr};
+  if (n >= 0 && n < directUnits) {
+    unit = direct_[n].load();
+  } else if (const Table * table{table_.load()}) {
+    if (const Slot * slot{Find(*table, n)}) {
+      unit = slot->unit.load();
+    }
+  }
+  if (unit) {
+    unit->holds_.fetch_add(1, std::memory_order_relaxed);
+  }
+  lookups_.fetch_sub(1, std::memory_order_release);
+  return unit;
+}
+
+ExternalFileUnit &UnitMap::LookUpOrCreate(
+    int n, const Terminator &terminator, bool &wasExtant) {
+  if (ExternalFileUnit * unit{LookUp(n)}) {
+    wasExtant = true;
+    return *unit;
+  }
+  CriticalSection criticalSection{lock_};
+  std::atomic<ExternalFileUnit *> &entry{
+      n >= 0 && n < directUnits ? direct_[n] : Insert(n, terminator).unit};
+  ExternalFileUnit *unit{entry.load(std::memory_order_relaxed)};
+  wasExtant = unit != nullptr;  // another thread may have created it
+  if (unit) {
+    unit->holds_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    Reclaim();
+    unit = &CreateUnit(n, terminator);
+    unit->holds_.store(1, std::memory_order_relaxed);
+    entry.store(unit);
+  }
+  return *unit;
+}
+
+void UnitMap::Release(ExternalFileUnit &unit) {
+  unit.holds_.fetch_sub(1, std::memory_order_release);
+}
+
+void UnitMap::Remove(ExternalFileUnit &unit) {
+  CriticalSection criticalSection{lock_};
+  int n{unit.unitNumber()};
+  if (n >= 0 && n < directUnits) {
+    direct_[n].store(nullptr);
+  } else if (Table * table{table_.load(std::memory_order_relaxed)}) {
+    if (const Slot * slot{Find(*table, n)}) {
+      const_cast<Slot *>(slot)->unit.store(nullptr);
+    }
+  }
+  if (n <= firstNewUnit) {
+    if (freeNewUnitCount_ == freeNewUnitCapacity_) {
+      int capacity{freeNewUnitCapacity_ > 0 ? 2 * freeNewUnitCapacity_ : 64};
+      Terminator terminator{__FILE__, __LINE__};
+      int *numbers{static_cast<int *>(
+          AllocateMemoryOrCrash(terminator, capacity * sizeof(int)))};
+      if (freeNewUnitCount_ > 0) {
+        std::memcpy(numbers, freeNewUnits_, freeNewUnitCount_ * sizeof(int));
+      }
+      FreeMemory(freeNewUnits_);
+      freeNewUnits_ = numbers;
+      freeNewUnitCapacity_ = capacity;
+    }
+    freeNewUnits_[freeNewUnitCount_++] = n;
+  }
+}
+
+void UnitMap::DestroyClosed(ExternalFileUnit &unit) {
+  CriticalSection criticalSection{lock_};
+  unit.nextRetired_ = retiredUnits_;
+  retiredUnits_ = &unit;
+  Reclaim();
+}
+
+int UnitMap::NewUnit(const Terminator &terminator) {
+  CriticalSection criticalSection{lock_};
+  if (freeNewUnitCount_ > 0) {
+    return freeNewUnits_[--freeNewUnitCount_];
+  }
+  if (nextNewUnit_ == std::numeric_limits<int>::min() + 1) {
+    terminator.Crash("NEWUNIT= unit numbers are exhausted");
+  }
+  return nextNewUnit_--;
+}
+
+ExternalFileUnit *UnitMap::AnyUnit() {
+  CriticalSection criticalSection{lock_};
+  for (const auto &entry : direct_) {
+    if (ExternalFileUnit * unit{entry.load(std::memory_order_relaxed)}) {
+      return unit;
+    }
+  }
+  if (Table * table{table_.load(std::memory_order_relaxed)}) {
+    for (int j{0}; j < table->capacity; ++j) {
+      if (ExternalFileUnit *
+          unit{table->slots()[j].unit.load(std::memory_order_relaxed)}) {
+        return unit;
+      }
+    }
+  }
+  return nullptr;
+}
+
+// Returns the slot for a unit number, claiming an empty one if needed.
+// A slot's unit number is stored last so that readers that find it will
+// also see its (null) unit.
+UnitMap::Slot &UnitMap::Insert(int n, const Terminator &terminator) {
+  Table *table{table_.load(std::memory_order_relaxed)};
+  if (table) {
+    if (const Slot * slot{Find(*table, n)}) {
+      return const_cast<Slot &>(*slot);
+    }
+  }
+  if (!table || 2 * (table->used + 1) > table->capacity) {
+    // Rebuild without removed units, at most a quarter full
+    int live{0};
+    if (table) {
+      for (int j{0}; j < table->capacity; ++j) {
+        live += table->slots()[j].unit.load(std::memory_order_relaxed) !=
+            nullptr;
+      }
+    }
+    int capacity{16};
+    while (capacity < 4 * (live + 1)) {
+      capacity *= 2;
+    }
+    Table &newTable{NewTable(capacity, terminator)};
+    if (table) {
+      std::size_t mask{static_cast<std::size_t>(capacity) - 1};
+      for (int j{0}; j < table->capacity; ++j) {
+        const Slot &old{table->slots()[j]};
+        if (ExternalFileUnit *
+            unit{old.unit.load(std::memory_order_relaxed)}) {
+          int key{old.unitNumber.load(std::memory_order_relaxed)};
+          std::size_t k{Hash(key) & mask};
+          while (newTable.slots()[k].unitNumber.load(
+                     std::memory_order_relaxed) != emptySlot) {
+            k = (k + 1) & mask;
+          }
+          newTable.slots()[k].unit.store(unit, std::memory_order_relaxed);
+          newTable.slots()[k].unitNumber.store(
+              key, std::memory_order_relaxed);
+          ++newTable.used;
+        }
+      }
+    }
+    table_.store(&newTable);
+    if (table) {
+      table->nextRetired = retiredTables_;
+      retiredTables_ = table;
+    }
+    table = &newTable;
+  }
+  Slot *slots{table->slots()};
+  std::size_t mask{static_cast<std::size_t>(table->capacity) - 1};
+  std::size_t j{Hash(n) & mask};
+  while (slots[j].unitNumber.load(std::memory_order_relaxed) != emptySlot) {
+    j = (j + 1) & mask;
+  }
+  slots[j].unitNumber.store(n, std::memory_order_release);
+  ++table->used;
+  return slots[j];
+}
+
+// Gives a new unit the buffer of a destroyed unit when there is one.
+ExternalFileUnit &UnitMap::CreateUnit(int n, const Terminator &terminator) {
+  ExternalFileUnit &unit{New<ExternalFileUnit>{}(terminator, n)};
+  if (recycledBufferCount_ > 0) {
+    RecycledBuffer &recycled{recycledBuffers_[--recycledBufferCount_]};
+    unit.AdoptBuffer(recycled.buffer, recycled.size);
+  }
+  return unit;
+}
+
+// Frees retired tables, and retired units that are no longer held, when
+// no lookup is in progress.  Others wait for a later call.
+void UnitMap::Reclaim() {
+  if (lookups_.load() != 0) {
+    return;
+  }
+  while (Table * table{retiredTables_}) {
+    retiredTables_ = table->nextRetired;
+    FreeMemory(table);
+  }
+  ExternalFileUnit **link{&retiredUnits_};
+  while (ExternalFileUnit * unit{*link}) {
+    if (unit->holds_.load(std::memory_order_acquire) == 0) {
+      *link = unit->nextRetired_;
+      if (recycledBufferCount_ < maxRecycledBuffers) {
+        std::size_t size;
+        if (char *buffer{unit->TakeBuffer(size)}) {
+          recycledBuffers_[recycledBufferCount_++] =
+              RecycledBuffer{buffer, size};
+        }
+      }
+      unit->~ExternalFileUnit();
+      FreeMemory(unit);
+    } else {
+      link = &unit->nextRetired_;
+    }
+  }
+}
+
+UnitMap::Table &UnitMap::NewTable(int capacity, const Terminator &terminator) {
+  void *p{AllocateMemoryOrCrash(
+      terminator, sizeof(Table) + capacity * sizeof(Slot))};
+  Table &table{*new (p) Table{capacity, 0, nullptr}};
+  for (int j{0}; j < capacity; ++j) {
+    new (&table.slots()[j]) Slot{};
+  }
+  return table;
+}
+}
@@ -0,0 +1,139 @@
+//===-- runtime/unit-map.h --------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Maps unit numbers to external units without locking lookups
+
+#ifndef FORTRAN_RUNTIME_UNIT_MAP_H_
+#define FORTRAN_RUNTIME_UNIT_MAP_H_
+
+#include "lock.h"
+#include "terminator.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace Fortran::runtime::io {
+
+class ExternalFileUnit;
+
+// Lookups take no lock, so I/O statements on distinct units never
+// contend here; creations and removals are serialized.  Small
+// nonnegative unit numbers index an array directly.  Others, such as
+// NEWUNIT= values, are hashed into an open-addressed table, which is
+// replaced by a larger one when it must grow.
+// A unit returned by a lookup is held until it is released, as at the
+// end of its statement.  A closed unit, or a replaced table, is retired
+// rather than freed; it is freed at a later creation or removal, once
+// no lookup that might have found it is in progress and, for a unit,
+// nothing holds it.
+// NEWUNIT= numbers of closed units are handed out again, most recently
+// closed first, so that programs that open and close many files neither
+// accumulate table slots nor exhaust the negative numbers.  The buffers
+// of a few closed units are kept for units created later.
+class UnitMap {
+public:
+  static constexpr int directUnits{1024};
+  static constexpr int firstNewUnit{-1001};  // and below
+  static constexpr int maxRecycledBuffers{16};
+
+  // These return units that are held.
+  ExternalFileUnit *LookUp(int);
+  ExternalFileUnit &LookUpOrCreate(int, const Terminator &, bool &wasExtant);
+  void Release(ExternalFileUnit &);
+  // Unregisters a unit that is being closed, so that no lookup finds it.
+  void Remove(ExternalFileUnit &);
+  // Destroys a removed unit once it is no longer held.
+  void DestroyClosed(ExternalFileUnit &);
+  // Returns an unused number for OPEN(NEWUNIT=)
+  int NewUnit(const Terminator &);
+  // Returns some registered unit, or null when there are none.
+  ExternalFileUnit *AnyUnit();
+  // Calls f(unit) for each registered unit, with creations and removals
+  // held off.
+  template<typename F> void ForEachUnit(F &&f) {
+    CriticalSection criticalSection{lock_};
+    VisitUnits(f);
+  }
+  // Likewise, but does nothing if they're not held off at once, as when
+  // crashing during one.
+  template<typename F> void ForEachUnitUnlessBusy(F &&f) {
+    if (!lock_.Try()) {
+      VisitUnits(f);
+      lock_.Drop();
+    }
+  }
+
+private:
+  static constexpr int emptySlot{std::numeric_limits<int>::min()};
+
+  // A removed unit leaves its number in its slot, with a null unit.
+  struct Slot {
+    std::atomic<int> unitNumber{emptySlot};
+    std::atomic<ExternalFileUnit *> unit{nullptr};
+  };
+
+  // The slots immediately follow the header.
+  struct Table {
+    Slot *slots() { return reinterpret_cast<Slot *>(this + 1); }
+    const Slot *slots() const {
+      return reinterpret_cast<const Slot *>(this + 1);
+    }
+    int capacity;  // a power of two
+    int used;  // slots with unit numbers, including removed units
+    Table *nextRetired;
+  };
+
+  static std::size_t Hash(int n) {
+    return static_cast<std::uint32_t>(n) * 0x9e3779b1u;
+  }
+  static const Slot *Find(const Table &, int);
+
+  // lock_ must be held
+  template<typename F> void VisitUnits(F &f) {
+    for (const auto &entry : direct_) {
+      if (ExternalFileUnit * unit{entry.load(std::memory_order_relaxed)}) {
+        f(*unit);
+      }
+    }
+    if (Table * table{table_.load(std::memory_order_relaxed)}) {
+      for (int j{0}; j < table->capacity; ++j) {
+        if (ExternalFileUnit *
+            unit{table->slots()[j].unit.load(std::memory_order_relaxed)}) {
+          f(*unit);
+        }
+      }
+    }
+  }
+
+  // The buffer of a destroyed unit
+  struct RecycledBuffer {
+    char *buffer;
+    std::size_t size;
+  };
+
+  // lock_ must be held for these
+  Slot &Insert(int, const Terminator &);
+  Table &NewTable(int capacity, const Terminator &);
+  ExternalFileUnit &CreateUnit(int, const Terminator &);
+  void Reclaim();
+
+  Lock lock_;
+  std::atomic<ExternalFileUnit *> direct_[directUnits]{};
+  std::atomic<Table *> table_{nullptr};
+  std::atomic<int> lookups_{0};  // in progress
+  ExternalFileUnit *retiredUnits_{nullptr};
+  Table *retiredTables_{nullptr};
+  int nextNewUnit_{firstNewUnit};
+  int *freeNewUnits_{nullptr};  // a stack of closed NEWUNIT= numbers
+  int freeNewUnitCount_{0}, freeNewUnitCapacity_{0};
+  RecycledBuffer recycledBuffers_[maxRecycledBuffers];
+  int recycledBufferCount_{0};
+};
+}
+#endif  // FORTRAN_RUNTIME_UNIT_MAP_H_
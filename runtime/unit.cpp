@@ -7,37 +7,45 @@
 //===----------------------------------------------------------------------===//
 
 #include "unit.h"
+#include "environment.h"
+#include "io-stats.h"
 #include "lock.h"
+#include "magic-numbers.h"
 #include "memory.h"
 #include "tools.h"
+#include "unit-map.h"
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <type_traits>
 
 namespace Fortran::runtime::io {
 
-static Lock mapLock;
 static Terminator mapTerminator;
-static Map<int, ExternalFileUnit> unitMap{
-    MapAllocator<int, ExternalFileUnit>{mapTerminator}};
+static UnitMap unitMap;
 static ExternalFileUnit *defaultOutput{nullptr};
 
 void FlushOutputOnCrash(const Terminator &terminator) {
+  IoErrorHandler handler{terminator};
+  handler.HasIoStat();  // prevent nested crash if flush has error
   if (defaultOutput) {
-    IoErrorHandler handler{terminator};
-    handler.HasIoStat();  // prevent nested crash if flush has error
     defaultOutput->Flush(handler);
   }
+  // Output being written in the background was complete as far as the
+  // program knew, so it must reach the file.
+  unitMap.ForEachUnitUnlessBusy([&](ExternalFileUnit &unit) {
+    if (unit.bufferingPolicy().mode == Buffering::Background) {
+      unit.Drain(handler);
+    }
+  });
 }
 
 ExternalFileUnit *ExternalFileUnit::LookUp(int unit) {
-  CriticalSection criticalSection{mapLock};
-  auto iter{unitMap.find(unit)};
-  return iter == unitMap.end() ? nullptr : &iter->second;
+  return unitMap.LookUp(unit);
 }
 
 ExternalFileUnit &ExternalFileUnit::LookUpOrCrash(
     int unit, const Terminator &terminator) {
-  CriticalSection criticalSection{mapLock};
   ExternalFileUnit *file{LookUp(unit)};
   if (!file) {
     terminator.Crash("Not an open I/O unit number: %d", unit);
@@ -46,24 +54,24 @@ ExternalFileUnit &ExternalFileUnit::LookUpOrCrash(
 }
 
 ExternalFileUnit &ExternalFileUnit::LookUpOrCreate(int unit, bool *wasExtant) {
-  CriticalSection criticalSection{mapLock};
-  auto pair{unitMap.emplace(unit, unit)};
+  bool extant;
+  ExternalFileUnit &result{
+      unitMap.LookUpOrCreate(unit, mapTerminator, extant)};
   if (wasExtant) {
-    *wasExtant = !pair.second;
+    *wasExtant = extant;
   }
-  return pair.first->second;
+  return result;
 }
 
 int ExternalFileUnit::NewUnit() {
-  CriticalSection criticalSection{mapLock};
-  static int nextNewUnit{-1000};  // see 12.5.6.12 in Fortran 2018
-  return --nextNewUnit;
+  // see 12.5.6.12 in Fortran 2018
+  return unitMap.NewUnit(mapTerminator);
 }
 
 void ExternalFileUnit::OpenUnit(OpenStatus status, Position position,
     OwningPtr<char> &&newPath, std::size_t newPathLength,
     IoErrorHandler &handler) {
-  CriticalSection criticalSection{lock()};
+  // N.B. OpenFile's members take lock() themselves
   if (IsOpen()) {
     if (status == OpenStatus::Old &&
         (!newPath.get() ||
@@ -74,24 +82,56 @@ void ExternalFileUnit::OpenUnit(OpenStatus status, Position position,
       return;
     }
     // Otherwise, OPEN on open unit with new FILE= implies CLOSE
-    Flush(handler);
+    Drain(handler);
+    ReleaseMappedFrame();
     Close(CloseStatus::Keep, handler);
   }
   set_path(std::move(newPath), newPathLength);
   Open(status, position, handler);
+  if (IsOpen() && storage() != Storage::Posix && !mayPosition() &&
+      (access == Access::Direct ||
+          (access == Access::Sequential && isUnformatted && mayWrite()))) {
+    // A compressed stream can't be positioned to a record, nor to the
+    // header of an unformatted sequential record after its data have been
+    // written.
+    handler.SignalError(ESPIPE,
+        "A compressed file may not have ACCESS='DIRECT' or be written "
+        "with FORM='UNFORMATTED' and ACCESS='SEQUENTIAL'");
+    Close(CloseStatus::Keep, handler);
+    return;
+  }
+  ConfigureBuffering();
 }
 
 void ExternalFileUnit::CloseUnit(CloseStatus status, IoErrorHandler &handler) {
   {
-    CriticalSection criticalSection{lock()};
-    Flush(handler);
+    CriticalSection criticalSection{statementLock_};
+    Drain(handler);
+    ReleaseMappedFrame();
+    if (IoStatisticsEnabled()) {
+      RetainIoStatistics(unitNumber_, path(), flushes(), statistics());
+    }
+    if (executionEnvironment.ioCounters) {
+      ReportIoCounters(unitNumber_, path(), flushes(), statistics());
+    }
     Close(status, handler);
+    if (defaultOutput == this) {
+      defaultOutput = nullptr;
+    }
+    // Unregistered while still locked, so that no lookup finds it closed
+    unitMap.Remove(*this);
   }
-  CriticalSection criticalSection{mapLock};
-  auto iter{unitMap.find(unitNumber_)};
-  if (iter != unitMap.end()) {
-    unitMap.erase(iter);
+  unitMap.DestroyClosed(*this);
+}
+
+// So that a later OPEN creates the unit afresh, without the connection
+// attributes of the failed one
+void ExternalFileUnit::AbandonUnit() {
+  {
+    CriticalSection criticalSection{statementLock_};
+    unitMap.Remove(*this);
   }
+  unitMap.DestroyClosed(*this);
 }
 
 void ExternalFileUnit::InitializePredefinedUnits() {
@@ -100,24 +140,45 @@ void ExternalFileUnit::InitializePredefinedUnits() {
   out.set_mayRead(false);
   out.set_mayWrite(true);
   out.set_mayPosition(false);
+  out.ConfigureBuffering();
   defaultOutput = &out;
   ExternalFileUnit &in{ExternalFileUnit::LookUpOrCreate(5)};
   in.Predefine(0);
   in.set_mayRead(true);
   in.set_mayWrite(false);
   in.set_mayPosition(false);
+  in.ConfigureBuffering();
   // TODO: Set UTF-8 mode from the environment
+  out.Release();
+  in.Release();
 }
 
 void ExternalFileUnit::CloseAll(IoErrorHandler &handler) {
-  CriticalSection criticalSection{mapLock};
   defaultOutput = nullptr;
-  while (!unitMap.empty()) {
-    auto &pair{*unitMap.begin()};
-    pair.second.CloseUnit(CloseStatus::Keep, handler);
+  while (ExternalFileUnit * unit{unitMap.AnyUnit()}) {
+    unit->CloseUnit(CloseStatus::Keep, handler);
+  }
+  if (IoStatisticsEnabled()) {
+    ReportStatistics();
+  }
+}
+
+void ExternalFileUnit::FlushAll(IoErrorHandler &handler) {
+  unitMap.ForEachUnit([&](ExternalFileUnit &unit) { unit.Drain(handler); });
+  if (IoStatisticsEnabled()) {
+    ReportStatistics();
   }
 }
 
+// Units that remain open, as after STOP, are reported as they stand.
+void ExternalFileUnit::ReportStatistics() {
+  unitMap.ForEachUnit([](ExternalFileUnit &unit) {
+    RetainIoStatistics(
+        unit.unitNumber_, unit.path(), unit.flushes(), unit.statistics());
+  });
+  ReportIoStatistics();
+}
+
 bool ExternalFileUnit::SetPositionInRecord(
     std::int64_t n, IoErrorHandler &handler) {
   n = std::max<std::int64_t>(0, n);
@@ -129,9 +190,9 @@ bool ExternalFileUnit::SetPositionInRecord(
   }
   if (n > furthestPositionInRecord) {
     if (!isReading_ && ok) {
-      WriteFrame(recordOffsetInFile, n, handler);
-      std::fill_n(Frame() + furthestPositionInRecord,
-          n - furthestPositionInRecord, ' ');
+      WriteFrame(recordOffsetInFile + furthestPositionInRecord,
+          n - furthestPositionInRecord, handler);
+      std::fill_n(Frame(), n - furthestPositionInRecord, ' ');
     }
     furthestPositionInRecord = n;
   }
@@ -143,19 +204,181 @@ bool ExternalFileUnit::Emit(
     const char *data, std::size_t bytes, IoErrorHandler &handler) {
   auto furthestAfter{std::max(furthestPositionInRecord,
       positionInRecord + static_cast<std::int64_t>(bytes))};
-  WriteFrame(recordOffsetInFile, furthestAfter, handler);
-  std::memcpy(Frame() + positionInRecord, data, bytes);
-  positionInRecord += bytes;
+  // Only the bytes being written are framed, so that earlier parts
+  // of the record may already have been flushed.  A long transfer is
+  // framed in pieces, so that it need not fit in the buffer.
+  std::size_t limit{BufferLimit()};
+  while (bytes > 0) {
+    std::size_t chunk{std::min(bytes, limit)};
+    WriteFrame(recordOffsetInFile + positionInRecord, chunk, handler);
+    std::memcpy(Frame(), data, chunk);
+    positionInRecord += chunk;
+    data += chunk;
+    bytes -= chunk;
+  }
   furthestPositionInRecord = furthestAfter;
+  if (bufferingPolicy().mode == Buffering::Unbuffered) {
+    Flush(handler);
+  }
   return true;
 }
 
+// Frames room in the buffer for formatted output that the caller stores
+// in place, as Emit() would have copied it.  An unbuffered unit's output
+// is instead left to Emit(), which flushes it.
+char *ExternalFileUnit::ReserveOutput(
+    std::size_t bytes, IoErrorHandler &handler) {
+  if (bytes > BufferLimit() ||
+      bufferingPolicy().mode == Buffering::Unbuffered) {
+    return nullptr;
+  }
+  WriteFrame(recordOffsetInFile + positionInRecord, bytes, handler);
+  positionInRecord += bytes;
+  furthestPositionInRecord =
+      std::max(furthestPositionInRecord, positionInRecord);
+  return Frame();
+}
+
+// Reads the next bytes of the current record for unformatted input.
+// A short read at the beginning of a record is the end of the file.
+bool ExternalFileUnit::Receive(
+    char *data, std::size_t bytes, IoErrorHandler &handler) {
+  if (recordLength &&
+      positionInRecord + static_cast<std::int64_t>(bytes) >
+          static_cast<std::int64_t>(*recordLength)) {
+    handler.SignalError(FORTRAN_RUNTIME_IOSTAT_SHORT_RECORD,
+        "Unformatted READ of %zd bytes at position %jd of a record of "
+        "%jd bytes",
+        bytes, static_cast<std::intmax_t>(positionInRecord),
+        static_cast<std::intmax_t>(*recordLength));
+    return false;
+  }
+  std::size_t limit{BufferLimit()};
+  while (bytes > 0) {
+    std::size_t chunk{std::min(bytes, limit)};
+    std::size_t got{
+        ReadInputFrame(recordOffsetInFile + positionInRecord, chunk, handler)};
+    if (got < chunk) {
+      if (!handler.InError()) {
+        if (positionInRecord == 0) {
+          handler.SignalEnd();
+        } else {
+          handler.SignalError(FORTRAN_RUNTIME_IOSTAT_SHORT_RECORD,
+              "Unformatted record at file offset %jd is truncated",
+              static_cast<std::intmax_t>(recordOffsetInFile));
+        }
+      }
+      return false;
+    }
+    std::memcpy(data, Frame(), chunk);
+    positionInRecord += chunk;
+    data += chunk;
+    bytes -= chunk;
+  }
+  furthestPositionInRecord =
+      std::max(furthestPositionInRecord, positionInRecord);
+  return true;
+}
+
+std::size_t ExternalFileUnit::BufferLimit() {
+  std::size_t bytes{bufferingPolicy().bufferBytes};
+  return bytes > 0 ? bytes : defaultBufferBytes;
+}
+
+// A short frame at the end of the file is not an error here; the caller
+// decides whether it ends the last record or the file.
+std::size_t ExternalFileUnit::ReadInputFrame(
+    std::int64_t at, std::size_t bytes, IoErrorHandler &handler) {
+  IoErrorHandler probe{handler};
+  probe.HasIoStat();
+  probe.HasEndLabel();
+  std::size_t got{ReadFrame(at, bytes, probe)};
+  if (probe.GetIoStat() > 0) {
+    handler.SignalError(probe.GetIoStat());
+  }
+  return got;
+}
+
+// Finds the end of the current record by searching for its newline,
+// extending the frame until one appears or the file ends.
+bool ExternalFileUnit::BeginVariableInputRecord(IoErrorHandler &handler) {
+  std::size_t searched{0};
+  std::size_t got{ReadInputFrame(recordOffsetInFile, 1, handler)};
+  while (!handler.InError()) {
+    const char *frame{Frame()};
+    if (const void *newline{
+            std::memchr(frame + searched, '\n', got - searched)}) {
+      std::int64_t length{static_cast<const char *>(newline) - frame};
+      inputRecordTerminatorBytes_ = 1;
+      if (length > 0 && frame[length - 1] == '\r') {
+        --length;
+        ++inputRecordTerminatorBytes_;
+      }
+      inputRecordLength_ = length;
+      return true;
+    }
+    searched = got;
+    std::size_t more{ReadInputFrame(recordOffsetInFile, got + 1, handler)};
+    if (more <= got) {
+      if (got == 0) {
+        handler.SignalEnd();
+        return false;
+      }
+      inputRecordLength_ = got;  // last record lacks a newline
+      inputRecordTerminatorBytes_ = 0;
+      return true;
+    }
+    got = more;
+  }
+  return false;
+}
+
+std::size_t ExternalFileUnit::GetNextInputBytes(
+    const char *&p, IoErrorHandler &handler) {
+  if (!recordLength && !inputRecordLength_ &&
+      !BeginVariableInputRecord(handler)) {
+    return 0;
+  }
+  std::int64_t length{recordLength ? static_cast<std::int64_t>(*recordLength)
+                                   : *inputRecordLength_};
+  if (positionInRecord >= length) {
+    return 0;
+  }
+  std::size_t want{static_cast<std::size_t>(length - positionInRecord)};
+  std::size_t got{
+      ReadInputFrame(recordOffsetInFile + positionInRecord, want, handler)};
+  if (got == 0 && positionInRecord == 0 && !handler.InError()) {
+    handler.SignalEnd();  // no fixed-length record remains
+  }
+  p = Frame();
+  return std::min(got, want);
+}
+
 void ExternalFileUnit::SetLeftTabLimit() {
   leftTabLimit = furthestPositionInRecord;
   positionInRecord = furthestPositionInRecord;
 }
 
 bool ExternalFileUnit::AdvanceRecord(IoErrorHandler &handler) {
+  if (isReading_) {
+    if (recordLength) {
+      recordOffsetInFile += *recordLength;
+    } else if (isUnformatted) {
+      // The statement has positioned past the record's last footer.
+      recordOffsetInFile += furthestPositionInRecord;
+    } else if (inputRecordLength_ || BeginVariableInputRecord(handler)) {
+      recordOffsetInFile += *inputRecordLength_ + inputRecordTerminatorBytes_;
+      inputRecordLength_.reset();
+    } else {
+      return false;
+    }
+    ++currentRecordNumber;
+    CountIoStatistic(statistics().records);
+    positionInRecord = 0;
+    furthestPositionInRecord = 0;
+    leftTabLimit.reset();
+    return true;
+  }
   bool ok{true};
   if (recordLength.has_value()) {  // fill fixed-size record
     ok &= SetPositionInRecord(*recordLength, handler);
@@ -165,9 +388,16 @@ bool ExternalFileUnit::AdvanceRecord(IoErrorHandler &handler) {
   }
   recordOffsetInFile += furthestPositionInRecord;
   ++currentRecordNumber;
+  CountIoStatistic(statistics().records);
   positionInRecord = 0;
   furthestPositionInRecord = 0;
   leftTabLimit.reset();
+  // Line buffered output is flushed at the end of the statement, so the
+  // records that a statement writes are written together; unbuffered
+  // output, with the blanks that fill a fixed-length record, goes now.
+  if (bufferingPolicy().mode == Buffering::Unbuffered) {
+    Flush(handler);
+  }
   return ok;
 }
 
@@ -177,19 +407,70 @@ bool ExternalFileUnit::HandleAbsolutePosition(
       std::max(n, std::int64_t{0}) + leftTabLimit.value_or(0), handler);
 }
 
+// Begins a record at the offset in the file that REC= or POS= selected.
+void ExternalFileUnit::SetPosition(std::int64_t offset) {
+  recordOffsetInFile = offset;
+  positionInRecord = 0;
+  furthestPositionInRecord = 0;
+  leftTabLimit.reset();
+  inputRecordLength_.reset();
+}
+
 bool ExternalFileUnit::HandleRelativePosition(
     std::int64_t n, IoErrorHandler &handler) {
   return HandleAbsolutePosition(positionInRecord + n, handler);
 }
 
-void ExternalFileUnit::FlushIfTerminal(IoErrorHandler &handler) {
-  if (isTerminal()) {
+void ExternalFileUnit::FlushOutput(IoErrorHandler &handler) {
+  if (bufferingPolicy().mode != Buffering::Full &&
+      bufferingPolicy().mode != Buffering::Background) {
     Flush(handler);
   }
 }
 
+// Completes the buffering policy with defaults from the environment,
+// the kind of file, and its preferred I/O block size.
+void ExternalFileUnit::ConfigureBuffering() {
+  BufferingPolicy &policy{bufferingPolicy()};
+  if (policy.mode == Buffering::Default) {
+    policy.mode = executionEnvironment.buffering;
+    if (policy.mode == Buffering::Default) {
+      policy.mode = isTerminal() ? Buffering::Line : Buffering::Full;
+    }
+  }
+  // Transfers in the background are positional.
+  if (policy.mode == Buffering::Background &&
+      (access != Access::Sequential || !mayPosition())) {
+    policy.mode = Buffering::Full;
+  }
+  if (policy.bufferBytes == 0) {
+    policy.bufferBytes = executionEnvironment.bufferBytes > 0
+        ? executionEnvironment.bufferBytes
+        : std::max(blockSize(), defaultBufferBytes);
+  }
+  if (policy.flushThreshold == 0) {
+    policy.flushThreshold = executionEnvironment.flushThreshold;
+  }
+}
+
+ExternalFileUnit::Statement &ExternalFileUnit::StatementAtLevel(int level) {
+  Statement *statement{&statement_};
+  for (; level > 0; --level) {
+    if (!statement->child) {
+      statement->child.reset(&New<Statement>{}(mapTerminator));
+    }
+    statement = statement->child.get();
+  }
+  return *statement;
+}
+
 void ExternalFileUnit::EndIoStatement() {
-  io_.reset();
-  u_.emplace<std::monostate>();
+  Statement &statement{StatementAtLevel(--level_)};
+  statement.io.reset();
+  statement.u.emplace<std::monostate>();
+  statementLock_.Drop();
+  Release();
 }
+
+void ExternalFileUnit::Release() { unitMap.Release(*this); }
 }
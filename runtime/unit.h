@@ -20,6 +20,7 @@
 #include "lock.h"
 #include "memory.h"
 #include "terminator.h"
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <optional>
@@ -34,50 +35,104 @@ public:
   explicit ExternalFileUnit(int unitNumber) : unitNumber_{unitNumber} {}
   int unitNumber() const { return unitNumber_; }
 
+  // A unit that these return is held, so that it is not destroyed even
+  // if another thread closes it, until it is released.
   static ExternalFileUnit *LookUp(int unit);
   static ExternalFileUnit &LookUpOrCrash(int unit, const Terminator &);
   static ExternalFileUnit &LookUpOrCreate(int unit, bool *wasExtant = nullptr);
   static int NewUnit();
   static void InitializePredefinedUnits();
   static void CloseAll(IoErrorHandler &);
+  // Completes all buffered output, as at STOP, leaving the units open
+  static void FlushAll(IoErrorHandler &);
+  // For FORT_IO_STATS at the end of the program, including STOP
+  static void ReportStatistics();
 
   void OpenUnit(OpenStatus, Position, OwningPtr<char> &&path,
       std::size_t pathLength, IoErrorHandler &);
   void CloseUnit(CloseStatus, IoErrorHandler &);
+  // Unregisters a unit that an OPEN failed to connect
+  void AbandonUnit();
 
+  // The unit's statement lock is held from here until EndIoStatement(),
+  // so that concurrent statements on the unit from multiple threads are
+  // serialized.  It may be retaken by a child I/O statement on the same
+  // unit (e.g., from a defined I/O procedure), whose state occupies
+  // the next level.
   template<typename A, typename... X>
   IoStatementState &BeginIoStatement(X &&... xs) {
-    // TODO: lock().Take() here, and keep it until EndIoStatement()?
-    // Nested I/O from derived types wouldn't work, though.
-    A &state{u_.emplace<A>(std::forward<X>(xs)...)};
+    statementLock_.Take();
+    Statement &statement{StatementAtLevel(level_++)};
+    A &state{statement.u.emplace<A>(std::forward<X>(xs)...)};
     if constexpr (!std::is_same_v<A, OpenStatementState>) {
       state.mutableModes() = ConnectionState::modes;
     }
-    io_.emplace(state);
-    return *io_;
+    if constexpr (std::is_base_of_v<InputStatementState, A>) {
+      isReading_ = true;
+    } else if constexpr (std::is_base_of_v<OutputStatementState, A>) {
+      isReading_ = false;
+    }
+    statement.io.emplace(state);
+    return *statement.io;
   }
 
   bool Emit(const char *, std::size_t bytes, IoErrorHandler &);
+  char *ReserveOutput(std::size_t bytes, IoErrorHandler &);
+  bool Receive(char *, std::size_t bytes, IoErrorHandler &);
+  // Returns the rest of the current input record, which is contiguous
+  // in the frame; signals END at the end of the file.
+  std::size_t GetNextInputBytes(const char *&, IoErrorHandler &);
   void SetLeftTabLimit();
   bool AdvanceRecord(IoErrorHandler &);
   bool HandleAbsolutePosition(std::int64_t, IoErrorHandler &);
+  void SetPosition(std::int64_t offset);  // REC= or POS=
   bool HandleRelativePosition(std::int64_t, IoErrorHandler &);
 
-  void FlushIfTerminal(IoErrorHandler &);
-  void EndIoStatement();
+  void ConfigureBuffering();
+  void FlushOutput(IoErrorHandler &);  // at the end of a statement
+  void EndIoStatement();  // also releases the unit
+  void Release();
 
 private:
+  friend class UnitMap;
+
   bool SetPositionInRecord(std::int64_t, IoErrorHandler &);
+  std::size_t ReadInputFrame(std::int64_t, std::size_t, IoErrorHandler &);
+  std::size_t BufferLimit();  // on the bytes of one transfer to the buffer
+  bool BeginVariableInputRecord(IoErrorHandler &);
+
+  // When an I/O statement is in progress on this unit, holds its state.
+  struct Statement {
+    ~Statement() {
+      if (child) {
+        child->~Statement();
+      }
+    }
+    std::variant<std::monostate, OpenStatementState, CloseStatementState,
+        WaitStatementState, FlushStatementState,
+        ExternalFormattedIoStatementState<false>,
+        ExternalFormattedIoStatementState<true>,
+        ExternalListIoStatementState<false>, ExternalListIoStatementState<true>,
+        UnformattedIoStatementState<false>, UnformattedIoStatementState<true>>
+        u;
+    // Points to the active alternative, if any, in u, for use as a Cookie
+    std::optional<IoStatementState> io;
+    OwningPtr<Statement> child;  // next level, created when first needed
+  };
+
+  Statement &StatementAtLevel(int);
 
   int unitNumber_{-1};
   bool isReading_{false};
-  // When an I/O statement is in progress on this unit, holds its state.
-  std::variant<std::monostate, OpenStatementState, CloseStatementState,
-      ExternalFormattedIoStatementState<false>,
-      ExternalListIoStatementState<false>, UnformattedIoStatementState<false>>
-      u_;
-  // Points to the active alternative, if any, in u_, for use as a Cookie
-  std::optional<IoStatementState> io_;
+  // When reading a file of variable-length records, the length of the
+  // current record and of its terminator, once its end has been found
+  std::optional<std::int64_t> inputRecordLength_;
+  int inputRecordTerminatorBytes_{0};
+  RecursiveLock statementLock_;
+  int level_{0};  // of nested I/O statements in progress
+  Statement statement_;
+  std::atomic<int> holds_{0};
+  ExternalFileUnit *nextRetired_{nullptr};  // after it is closed
 };
 
 }
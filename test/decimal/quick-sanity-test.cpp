@@ -1,8 +1,10 @@
 #include "flang/decimal/decimal.h"
 #include <cinttypes>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <limits>
 
 using namespace Fortran::decimal;
 
@@ -73,6 +75,42 @@ void testReadback(float x, int flags) {
   }
 }
 
+// Reads text that has an exponent too large in magnitude to convert on
+// the fast path, and which therefore must be read exactly.
+void testHugeExponent(const char *text, float expect) {
+  ++tests;
+  float y{-1};
+  const char *p{text};
+  ConvertDecimalToFloat(&p, &y, RoundNearest);
+  if (y != expect || *p != '\0') {
+    failed(y) << ": '" << text << "' -> " << y << " '" << p << "'\n";
+  }
+}
+
+// Reads text with more digits than the fast path can hold exactly, or
+// that lies (nearly) halfway between two representable values, and so
+// must fall back to the exact algorithm; strtod() and strtof() are the
+// references.
+void testHardRead(const char *text) {
+  ++tests;
+  double d{-1}, dExpect{std::strtod(text, nullptr)};
+  const char *p{text};
+  ConvertDecimalToDouble(&p, &d, RoundNearest);
+  if (d != dExpect || *p != '\0') {
+    ++fails;
+    std::cout << "FAIL: '" << text << "' -> REAL(8) " << d << ", expected "
+              << dExpect << " '" << p << "'\n";
+  }
+  ++tests;
+  float f{-1}, fExpect{std::strtof(text, nullptr)};
+  p = text;
+  ConvertDecimalToFloat(&p, &f, RoundNearest);
+  if (f != fExpect || *p != '\0') {
+    failed(f) << ": '" << text << "' -> REAL(4) " << f << ", expected "
+              << fExpect << " '" << p << "'\n";
+  }
+}
+
 int main() {
   union u u;
   testDirect(-1.0, "-1", 1);
@@ -138,6 +176,31 @@ int main() {
     testReadback(u.x, Minimize);
     testReadback(-u.x, Minimize);
   }
+  testHugeExponent("1e99999999", std::numeric_limits<float>::infinity());
+  testHugeExponent("1e4294967297", std::numeric_limits<float>::infinity());
+  testHugeExponent("1e-4294967295", 0);
+  testHugeExponent("1e000000002", 100);
+  testHardRead("1234567890123456789");
+  testHardRead("9999999999999999999");
+  testHardRead("9223372036854775807");
+  testHardRead("18446744073709551615");
+  testHardRead("18446744073709551616");
+  testHardRead("0.1234567890123456789e-300");
+  testHardRead("9007199254740993");
+  testHardRead("9007199254740993.0000000000000000001");
+  testHardRead("1.00000000000000011102230246251565404236316680908203125");
+  testHardRead("1.00000000000000011102230246251565404236316680908203124");
+  testHardRead("1.00000000000000011102230246251565404236316680908203126");
+  testHardRead("1.000000059604644775390625");
+  testHardRead("1.000000059604644775390624999");
+  testHardRead("1.000000059604644775390625001");
+  testHardRead("2.2250738585072011e-308");
+  testHardRead("2.4703282292062327e-324");
+  testHardRead("2.4703282292062328e-324");
+  testHardRead("1.7976931348623158e308");
+  testHardRead("1.7976931348623159e308");
+  testHardRead("7.038531e-26");
+  testHardRead("3.4028235677973366e38");
   std::cout << tests << " tests run, " << fails << " tests failed\n";
   return fails > 0;
 }
@@ -0,0 +1,127 @@
+// Throughput of decimal-to-binary conversion on large numeric inputs.
+// Each input is a text of blank-separated REAL values, either read from
+// a file or generated in several common styles.  Every value is
+// converted with RoundNearest, which can use the fast path for short
+// decimal numbers, and with RoundCompatible, which always uses the exact
+// big-radix algorithm and so serves as a baseline; the two must agree
+// except on exact ties.
+// Usage: read-benchmark [file of numbers]
+
+#include "flang/decimal/decimal.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Fortran::decimal;
+
+static std::uint64_t fails{0};
+
+// Converts every value in the text, and returns the elapsed seconds
+template<typename REAL>
+static double Convert(const std::string &text, enum FortranRounding rounding,
+    std::vector<REAL> &result) {
+  result.clear();
+  auto start{std::chrono::steady_clock::now()};
+  for (const char *p{text.c_str()};;) {
+    while (*p == ' ' || *p == '\n') {
+      ++p;
+    }
+    if (*p == '\0') {
+      break;
+    }
+    REAL x;
+    const char *before{p};
+    if constexpr (sizeof x == sizeof(float)) {
+      ConvertDecimalToFloat(&p, &x, rounding);
+    } else {
+      ConvertDecimalToDouble(&p, &x, rounding);
+    }
+    if (p == before) {
+      ++p;  // skip over anything that isn't a number
+    } else {
+      result.push_back(x);
+    }
+  }
+  std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start};
+  return elapsed.count();
+}
+
+template<typename REAL>
+static void Report(const char *name, const std::string &text) {
+  std::vector<REAL> nearest, compatible;
+  double fast{Convert(text, RoundNearest, nearest)};
+  double exact{Convert(text, RoundCompatible, compatible)};
+  std::size_t differences{0};
+  for (std::size_t j{0}; j < nearest.size(); ++j) {
+    differences += nearest[j] != compatible[j];
+  }
+  if (nearest.size() != compatible.size() ||
+      differences > nearest.size() / 1000) {
+    std::fprintf(stderr, "%s: results differ on %zd of %zd values\n", name,
+        differences, nearest.size());
+    ++fails;
+  }
+  double megabytes{text.size() / 1.0e6};
+  std::printf("%-24s %9zd values  RN %8.1f MB/s  exact %8.1f MB/s  (%.1fx)\n",
+      name, nearest.size(), megabytes / fast, megabytes / exact, exact / fast);
+}
+
+static std::string Generate(const char *format, std::size_t count,
+    std::mt19937_64 &random, bool wide) {
+  std::string text;
+  char buffer[64];
+  std::uniform_real_distribution<double> narrow{-1000.0, 1000.0};
+  while (count-- > 0) {
+    double x{narrow(random)};
+    if (wide) {
+      std::uint64_t bits{random()};
+      std::memcpy(&x, &bits, sizeof x);
+      if (x != x || x - x != 0) {
+        continue;
+      }
+    }
+    std::snprintf(buffer, sizeof buffer, format, x);
+    text += buffer;
+    text += ' ';
+  }
+  return text;
+}
+
+int main(int argc, const char *argv[]) {
+  if (argc > 1) {
+    std::FILE *fp{std::fopen(argv[1], "r")};
+    if (!fp) {
+      std::perror(argv[1]);
+      return 1;
+    }
+    std::string text;
+    char buffer[1 << 16];
+    while (std::size_t n{std::fread(buffer, 1, sizeof buffer, fp)}) {
+      text.append(buffer, n);
+    }
+    std::fclose(fp);
+    Report<double>("REAL(8) from file", text);
+    Report<float>("REAL(4) from file", text);
+  } else {
+    std::mt19937_64 random{2020};
+    const std::size_t count{1000000};
+    std::string fixed{Generate("%.6f", count, random, false)};
+    std::string scientific{Generate("%.8E", count, random, false)};
+    std::string roundTrip{Generate("%.17g", count, random, true)};
+    Report<double>("REAL(8) F13.6", fixed);
+    Report<double>("REAL(8) ES15.8", scientific);
+    Report<double>("REAL(8) 17 digits", roundTrip);
+    Report<float>("REAL(4) F13.6", fixed);
+    Report<float>("REAL(4) ES15.8", scientific);
+  }
+  if (fails > 0) {
+    std::printf("%ju failures\n", static_cast<std::uintmax_t>(fails));
+  }
+  return fails > 0;
+}
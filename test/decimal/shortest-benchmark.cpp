@@ -0,0 +1,116 @@
+// Throughput of minimized (shortest round-trip) binary-to-decimal
+// conversions, as used by list-directed and G0 output, on random
+// values and on values with few significant decimal digits.  Each
+// result is read back to verify that it converts to the original value.
+// Usage: shortest-benchmark [values per test]
+
+#include "flang/decimal/decimal.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Fortran::decimal;
+
+static std::uint64_t fails{0};
+
+template<typename REAL> static bool ReadsBack(REAL x, char *str, int expo);
+
+template<> bool ReadsBack(float x, char *str, int expo) {
+  std::sprintf(str + std::strlen(str), "e%d", expo);
+  const char *p{str};
+  float y{0};
+  ConvertDecimalToFloat(&p, &y, RoundNearest);
+  return y == x && *p == '\0';
+}
+
+template<> bool ReadsBack(double x, char *str, int expo) {
+  std::sprintf(str + std::strlen(str), "e%d", expo);
+  const char *p{str};
+  double y{0};
+  ConvertDecimalToDouble(&p, &y, RoundNearest);
+  return y == x && *p == '\0';
+}
+
+static ConversionToDecimalResult Convert(
+    char *buffer, std::size_t size, int flags, int digits, float x) {
+  return ConvertFloatToDecimal(buffer, size,
+      static_cast<enum DecimalConversionFlags>(flags), digits, RoundNearest, x);
+}
+
+static ConversionToDecimalResult Convert(
+    char *buffer, std::size_t size, int flags, int digits, double x) {
+  return ConvertDoubleToDecimal(buffer, size,
+      static_cast<enum DecimalConversionFlags>(flags), digits, RoundNearest, x);
+}
+
+// Returns conversions per second
+template<typename REAL>
+static double Run(const std::vector<REAL> &values, int flags, int digits) {
+  char buffer[1024];
+  std::size_t totalLength{0};
+  auto start{std::chrono::steady_clock::now()};
+  for (REAL x : values) {
+    totalLength += Convert(buffer, sizeof buffer, flags, digits, x).length;
+  }
+  std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start};
+  if (totalLength == 0) {
+    ++fails;
+  }
+  if (flags & Minimize) {
+    for (REAL x : values) {
+      auto result{Convert(buffer, sizeof buffer, flags, digits, x)};
+      // Express the result as an integer and exponent for reading
+      char str[1100];
+      std::strcpy(str, result.str);
+      int expo{result.decimalExponent - static_cast<int>(result.length)};
+      if (*result.str == '-') {
+        ++expo;
+      }
+      if (!ReadsBack(x, str, expo)) {
+        if (fails++ < 10) {
+          std::fprintf(stderr, "FAIL: %.17g -> '%s'\n",
+              static_cast<double>(x), str);
+        }
+      }
+    }
+  }
+  return values.size() / elapsed.count();
+}
+
+template<typename REAL, typename BITS>
+static void Report(const char *name, int precision, std::size_t count) {
+  std::mt19937_64 random{static_cast<std::uint64_t>(precision)};
+  std::vector<REAL> anyBits, fewDigits;
+  while (anyBits.size() < count) {
+    BITS bits{static_cast<BITS>(random())};
+    REAL x;
+    std::memcpy(&x, &bits, sizeof x);
+    if (x == x && x - x == 0) {  // finite
+      anyBits.push_back(x);
+    }
+  }
+  for (std::size_t j{0}; j < count; ++j) {
+    fewDigits.push_back(static_cast<REAL>((random() % 100000) / 1000.0));
+  }
+  std::printf("%-8s  random bits: minimized %12.0f/s, %2d digits %12.0f/s\n",
+      name, Run(anyBits, Minimize, 1024), precision,
+      Run(anyBits, 0, precision));
+  std::printf("%-8s  few digits:  minimized %12.0f/s, %2d digits %12.0f/s\n",
+      name, Run(fewDigits, Minimize, 1024), precision,
+      Run(fewDigits, 0, precision));
+}
+
+int main(int argc, const char *argv[]) {
+  std::size_t count{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000};
+  Report<float, std::uint32_t>("REAL(4)", 9, count);
+  Report<double, std::uint64_t>("REAL(8)", 17, count);
+  if (fails > 0) {
+    std::printf("%ju failures\n", static_cast<std::uintmax_t>(fails));
+  }
+  return fails > 0;
+}
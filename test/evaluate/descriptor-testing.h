@@ -0,0 +1,25 @@
+#ifndef FORTRAN_TEST_EVALUATE_DESCRIPTOR_TESTING_H_
+#define FORTRAN_TEST_EVALUATE_DESCRIPTOR_TESTING_H_
+
+#include "testing.h"
+#include "../../runtime/descriptor.h"
+#include <memory>
+
+// An array of the given type, kind, and extents, filled in array element
+// order by f(j) for each element j
+template<typename T, typename F>
+std::unique_ptr<Fortran::runtime::Descriptor> MakeArray(
+    Fortran::common::TypeCategory category, int kind, int rank,
+    const Fortran::runtime::SubscriptValue *extent, F f) {
+  using namespace Fortran::runtime;
+  static const SubscriptValue ones[maxRank]{1, 1, 1};
+  std::unique_ptr<Descriptor> result{Descriptor::Create(category, kind,
+      nullptr, rank, extent, CFI_attribute_allocatable)};
+  TEST(result->Allocate(ones, extent, sizeof(T)) == CFI_SUCCESS);
+  for (std::size_t j{0}; j < result->Elements(); ++j) {
+    *result->Element<T>(j * sizeof(T)) = f(j);
+  }
+  return result;
+}
+
+#endif  // FORTRAN_TEST_EVALUATE_DESCRIPTOR_TESTING_H_
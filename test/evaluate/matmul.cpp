@@ -0,0 +1,258 @@
+#include "descriptor-testing.h"
+#include "../../runtime/environment.h"
+#include "../../runtime/matmul.h"
+#include "../../runtime/transformational.h"
+#include <cinttypes>
+#include <cmath>
+#include <complex>
+
+using namespace Fortran::common;
+using namespace Fortran::runtime;
+
+// Element (i, j) of a matrix, or element i of a vector, from 0
+template<typename T>
+static T At(const Descriptor &x, SubscriptValue i, SubscriptValue j = 0) {
+  SubscriptValue offset{i * x.GetDimension(0).ByteStride()};
+  if (x.rank() == 2) {
+    offset += j * x.GetDimension(1).ByteStride();
+  }
+  return *x.Element<T>(offset);
+}
+
+static double Magnitude(double x) { return std::abs(x); }
+static double Magnitude(std::complex<double> x) { return std::abs(x); }
+
+// Compares MATMUL(a, b) with the sums of products computed one at a time
+// in double precision.
+template<typename T, typename WIDE = double>
+static void Check(const char *what, const Descriptor &a, const Descriptor &b,
+    double tolerance = 1e-12) {
+  std::unique_ptr<Descriptor> result{MATMUL(a, b)};
+  int rankA{a.rank()}, rankB{b.rank()};
+  SubscriptValue rows{rankA == 2 ? a.GetDimension(0).Extent() : 1};
+  SubscriptValue depth{b.GetDimension(0).Extent()};
+  SubscriptValue columns{rankB == 2 ? b.GetDimension(1).Extent() : 1};
+  MATCH(rankA + rankB - 2, result->rank());
+  if (rankA == 2) {
+    MATCH(rows, result->GetDimension(0).Extent());
+  }
+  if (rankB == 2) {
+    MATCH(columns, result->GetDimension(result->rank() - 1).Extent());
+  }
+  for (SubscriptValue j{0}; j < columns; ++j) {
+    for (SubscriptValue i{0}; i < rows; ++i) {
+      WIDE expect{0};
+      for (SubscriptValue p{0}; p < depth; ++p) {
+        auto x{static_cast<WIDE>(rankA == 2 ? At<T>(a, i, p) : At<T>(a, p))};
+        auto y{static_cast<WIDE>(rankB == 2 ? At<T>(b, p, j) : At<T>(b, p))};
+        expect += x * y;
+      }
+      T value{rankA == 1 ? At<T>(*result, j)
+              : rankB == 1 ? At<T>(*result, i)
+                           : At<T>(*result, i, j)};
+      if (Magnitude(static_cast<WIDE>(value) - expect) >
+          tolerance * depth * std::max(1.0, Magnitude(expect))) {
+        TEST(false)("%s (%jd,%jd)", what, static_cast<std::intmax_t>(i),
+            static_cast<std::intmax_t>(j));
+        return;
+      }
+    }
+  }
+}
+
+static double Value(std::size_t j) {
+  return static_cast<double>((j * 7919) % 61) / 8 - 3;
+}
+
+int main() {
+  // INTEGER a(2,3) = reshape([1,2,3,4,5,6], [2,3]); b(3,2) likewise
+  static const SubscriptValue extent23[]{2, 3}, extent32[]{3, 2};
+  auto a{MakeArray<std::int32_t>(TypeCategory::Integer, 4, 2, extent23,
+      [](std::size_t j) { return j + 1; })};
+  auto b{MakeArray<std::int32_t>(TypeCategory::Integer, 4, 2, extent32,
+      [](std::size_t j) { return j + 1; })};
+  auto ab{MATMUL(*a, *b)};
+  MATCH(2, ab->rank());
+  MATCH(2, ab->GetDimension(0).Extent());
+  MATCH(2, ab->GetDimension(1).Extent());
+  MATCH(1, ab->GetDimension(0).LowerBound());
+  MATCH(22, At<std::int32_t>(*ab, 0, 0));
+  MATCH(28, At<std::int32_t>(*ab, 1, 0));
+  MATCH(49, At<std::int32_t>(*ab, 0, 1));
+  MATCH(64, At<std::int32_t>(*ab, 1, 1));
+  auto ba{MATMUL(*b, *a)};
+  MATCH(3, ba->GetDimension(0).Extent());
+  MATCH(9, At<std::int32_t>(*ba, 0, 0));
+  MATCH(51, At<std::int32_t>(*ba, 2, 2));
+
+  // Vectors: MATMUL(a, [1,2,3]) and MATMUL([1,2], a)
+  static const SubscriptValue two{2}, three{3};
+  auto v3{MakeArray<std::int32_t>(TypeCategory::Integer, 4, 1, &three,
+      [](std::size_t j) { return j + 1; })};
+  auto v2{MakeArray<std::int32_t>(TypeCategory::Integer, 4, 1, &two,
+      [](std::size_t j) { return j + 1; })};
+  auto av{MATMUL(*a, *v3)};
+  MATCH(1, av->rank());
+  MATCH(2, av->GetDimension(0).Extent());
+  MATCH(22, At<std::int32_t>(*av, 0));
+  MATCH(28, At<std::int32_t>(*av, 1));
+  auto va{MATMUL(*v2, *a)};
+  MATCH(1, va->rank());
+  MATCH(3, va->GetDimension(0).Extent());
+  MATCH(5, At<std::int32_t>(*va, 0));
+  MATCH(11, At<std::int32_t>(*va, 1));
+  MATCH(17, At<std::int32_t>(*va, 2));
+
+  // Shapes around the tile and block sizes, of each numeric kind
+  static const SubscriptValue shapes[][3]{{1, 1, 1}, {3, 5, 2}, {4, 4, 4},
+      {17, 9, 13}, {33, 300, 7}, {130, 20, 35}, {5, 600, 1030},
+      {1, 40, 9}, {9, 40, 1}};
+  for (const auto &shape : shapes) {
+    SubscriptValue extentA[]{shape[0], shape[1]};
+    SubscriptValue extentB[]{shape[1], shape[2]};
+    auto r8a{MakeArray<double>(TypeCategory::Real, 8, 2, extentA, Value)};
+    auto r8b{MakeArray<double>(
+        TypeCategory::Real, 8, 2, extentB, [](std::size_t j) {
+          return Value(j + 5);
+        })};
+    Check<double>("real(8)", *r8a, *r8b);
+    auto r4a{MakeArray<float>(TypeCategory::Real, 4, 2, extentA, Value)};
+    auto r4b{MakeArray<float>(TypeCategory::Real, 4, 2, extentB, Value)};
+    Check<float>("real(4)", *r4a, *r4b, 1e-6);
+    auto i8a{MakeArray<std::int64_t>(TypeCategory::Integer, 8, 2, extentA,
+        [](std::size_t j) { return j % 23; })};
+    auto i8b{MakeArray<std::int64_t>(TypeCategory::Integer, 8, 2, extentB,
+        [](std::size_t j) { return j % 19 - 9; })};
+    Check<std::int64_t>("integer(8)", *i8a, *i8b, 0);
+    auto i2a{MakeArray<std::int16_t>(TypeCategory::Integer, 2, 2, extentA,
+        [](std::size_t j) { return j % 5; })};
+    auto i2b{MakeArray<std::int16_t>(TypeCategory::Integer, 2, 2, extentB,
+        [](std::size_t j) { return j % 3; })};
+    Check<std::int16_t>("integer(2)", *i2a, *i2b, 0);
+    using C8 = std::complex<double>;
+    auto c8a{MakeArray<C8>(TypeCategory::Complex, 8, 2, extentA,
+        [](std::size_t j) { return C8{Value(j), Value(j + 1)}; })};
+    auto c8b{MakeArray<C8>(TypeCategory::Complex, 8, 2, extentB,
+        [](std::size_t j) { return C8{Value(j + 2), -Value(j)}; })};
+    Check<C8, C8>("complex(8)", *c8a, *c8b);
+    using C4 = std::complex<float>;
+    auto c4a{MakeArray<C4>(TypeCategory::Complex, 4, 2, extentA,
+        [](std::size_t j) { return C4(Value(j + 3), Value(j)); })};
+    auto c4b{MakeArray<C4>(TypeCategory::Complex, 4, 2, extentB,
+        [](std::size_t j) { return C4(-Value(j), Value(j + 1)); })};
+    Check<C4, C8>("complex(4)", *c4a, *c4b, 1e-6);
+    using C10 = std::complex<long double>;
+    auto c10a{MakeArray<C10>(TypeCategory::Complex, sizeof(long double),
+        2, extentA, [](std::size_t j) { return C10{Value(j), 1}; })};
+    auto c10b{MakeArray<C10>(TypeCategory::Complex, sizeof(long double),
+        2, extentB, [](std::size_t j) { return C10{-1, Value(j)}; })};
+    std::unique_ptr<Descriptor> c10{MATMUL(*c10a, *c10b)};
+    C10 expect{0};
+    for (SubscriptValue p{0}; p < shape[1]; ++p) {
+      expect += At<C10>(*c10a, 0, p) * At<C10>(*c10b, p, shape[2] - 1);
+    }
+    long double error{std::abs(At<C10>(*c10, 0, shape[2] - 1) - expect)};
+    TEST(error <= 1e-12 * std::max<long double>(1, std::abs(expect)))
+    ("complex(long double) %jd", static_cast<std::intmax_t>(shape[1]));
+  }
+
+  // INTEGER(1) products wrap
+  static const SubscriptValue extent11[]{1, 1};
+  auto i1a{MakeArray<std::int8_t>(
+      TypeCategory::Integer, 1, 2, extent11, [](std::size_t) { return 16; })};
+  auto i1{MATMUL(*i1a, *i1a)};
+  MATCH(0, At<std::int8_t>(*i1, 0, 0));
+
+  // Sections that are not contiguous: x(1:33:2,:) times TRANSPOSE-like
+  // views of y whose first dimension is not the one of unit stride
+  static const SubscriptValue extentX[]{66, 70}, extentY[]{45, 70};
+  auto x{MakeArray<double>(TypeCategory::Real, 8, 2, extentX, Value)};
+  auto y{MakeArray<double>(TypeCategory::Real, 8, 2, extentY,
+      [](std::size_t j) { return Value(j * 3); })};
+  StaticDescriptor<2> sectionDescriptor, viewDescriptor;
+  Descriptor &section{sectionDescriptor.descriptor()};
+  SubscriptValue sectionExtent[]{33, 70};
+  section.Establish(TypeCategory::Real, 8, x->raw().base_addr, 2,
+      sectionExtent, CFI_attribute_pointer);
+  section.raw().dim[0].sm *= 2;
+  section.raw().dim[1].sm = x->GetDimension(1).ByteStride();
+  Descriptor &view{viewDescriptor.descriptor()};
+  SubscriptValue viewExtent[]{70, 45};
+  view.Establish(TypeCategory::Real, 8, y->raw().base_addr, 2, viewExtent,
+      CFI_attribute_pointer);
+  view.raw().dim[0].sm = y->GetDimension(1).ByteStride();
+  view.raw().dim[1].sm = y->GetDimension(0).ByteStride();
+  Check<double>("section x view", section, view);
+  // The vector y(3,:) and the column x(:,2) as vectors of stride > 1
+  StaticDescriptor<1> rowDescriptor, columnDescriptor;
+  Descriptor &row{rowDescriptor.descriptor()};
+  SubscriptValue rowExtent{70};
+  row.Establish(TypeCategory::Real, 8, y->Element<char>(2 * sizeof(double)),
+      1, &rowExtent, CFI_attribute_pointer);
+  row.raw().dim[0].sm = y->GetDimension(1).ByteStride();
+  Check<double>("section x row", section, row);
+  Check<double>("row x view", row, view);
+  Descriptor &column{columnDescriptor.descriptor()};
+  SubscriptValue columnExtent{33};
+  column.Establish(TypeCategory::Real, 8,
+      x->Element<char>(x->GetDimension(1).ByteStride()), 1, &columnExtent,
+      CFI_attribute_pointer);
+  column.raw().dim[0].sm *= 2;
+  Check<double>("column x section", column, section);
+
+  // LOGICAL(1): ANY(a(i,:) .AND. b(:,j))
+  auto la{MakeArray<std::uint8_t>(TypeCategory::Logical, 1, 2, extent23,
+      [](std::size_t j) { return j == 1 || j == 4; })};
+  auto lb{MakeArray<std::uint8_t>(TypeCategory::Logical, 1, 2, extent32,
+      [](std::size_t j) { return j == 2; })};
+  auto lab{MATMUL(*la, *lb)};
+  MATCH(1, At<std::uint8_t>(*lab, 0, 0));
+  MATCH(0, At<std::uint8_t>(*lab, 1, 0));
+  MATCH(0, At<std::uint8_t>(*lab, 0, 1));
+  MATCH(0, At<std::uint8_t>(*lab, 1, 1));
+
+  // Threads, with results identical to the serial ones
+  static const SubscriptValue extent300[]{300, 300};
+  auto big{MakeArray<double>(TypeCategory::Real, 8, 2, extent300, Value)};
+  auto serial{MATMUL(*big, *big)};
+  executionEnvironment.matmulThreads = 4;
+  auto threaded{MATMUL(*big, *big)};
+  executionEnvironment.matmulThreads = 0;
+  bool identical{true};
+  for (std::size_t j{0}; j < serial->Elements(); ++j) {
+    identical &= At<double>(*serial, j) == At<double>(*threaded, j);
+  }
+  TEST(identical)("FORT_MATMUL_THREADS=4");
+  Check<double>("real(8) 300x300", *big, *big);
+
+  // TRANSPOSE of a matrix and of a section
+  auto at{TRANSPOSE(*a)};
+  MATCH(2, at->rank());
+  MATCH(3, at->GetDimension(0).Extent());
+  MATCH(2, at->GetDimension(1).Extent());
+  for (int i{0}; i < 3; ++i) {
+    for (int j{0}; j < 2; ++j) {
+      MATCH(At<std::int32_t>(*a, j, i), At<std::int32_t>(*at, i, j));
+    }
+  }
+  auto st{TRANSPOSE(section)};
+  MATCH(70, st->GetDimension(0).Extent());
+  MATCH(33, st->GetDimension(1).Extent());
+  bool transposed{true};
+  for (SubscriptValue i{0}; i < 70; ++i) {
+    for (SubscriptValue j{0}; j < 33; ++j) {
+      transposed &= At<double>(section, j, i) == At<double>(*st, i, j);
+    }
+  }
+  TEST(transposed)("TRANSPOSE(x(1:66:2,:))");
+  auto bt{TRANSPOSE(*big)};
+  transposed = true;
+  for (SubscriptValue i{0}; i < 300; ++i) {
+    for (SubscriptValue j{0}; j < 300; ++j) {
+      transposed &= At<double>(*big, j, i) == At<double>(*bt, i, j);
+    }
+  }
+  TEST(transposed)("TRANSPOSE 300x300");
+
+  return testing::Complete();
+}
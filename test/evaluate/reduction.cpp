@@ -0,0 +1,210 @@
+#include "descriptor-testing.h"
+#include "../../runtime/environment.h"
+#include "../../runtime/reduction.h"
+#include <cinttypes>
+#include <cmath>
+#include <complex>
+#include <limits>
+
+using namespace Fortran::common;
+using namespace Fortran::runtime;
+
+template<typename T> static T Scalar(const std::unique_ptr<Descriptor> &x) {
+  TEST(x.get() != nullptr);
+  MATCH(0, x->rank());
+  return *x->Element<T>(std::size_t{0});
+}
+
+template<typename T>
+static T At(const std::unique_ptr<Descriptor> &x, std::size_t j) {
+  return *x->Element<T>(j * sizeof(T));
+}
+
+static bool Near(double x, double y, double tolerance = 1e-12) {
+  return std::abs(x - y) <= tolerance * std::max(1.0, std::abs(y));
+}
+
+int main() {
+  // INTEGER a(2,3) = reshape([1,2,3,4,5,6], [2,3])
+  static const SubscriptValue extent23[]{2, 3};
+  auto a{MakeArray<std::int32_t>(TypeCategory::Integer, 4, 2, extent23,
+      [](std::size_t j) { return j + 1; })};
+  MATCH(21, Scalar<std::int32_t>(SUM(*a)));
+  MATCH(720, Scalar<std::int32_t>(PRODUCT(*a)));
+  MATCH(6, Scalar<std::int32_t>(MAXVAL(*a)));
+  MATCH(1, Scalar<std::int32_t>(MINVAL(*a)));
+  auto sum1{SUM(*a, 1)};
+  MATCH(1, sum1->rank());
+  MATCH(3, sum1->GetDimension(0).Extent());
+  MATCH(3, At<std::int32_t>(sum1, 0));
+  MATCH(7, At<std::int32_t>(sum1, 1));
+  MATCH(11, At<std::int32_t>(sum1, 2));
+  auto sum2{SUM(*a, 2)};
+  MATCH(2, sum2->GetDimension(0).Extent());
+  MATCH(9, At<std::int32_t>(sum2, 0));
+  MATCH(12, At<std::int32_t>(sum2, 1));
+  auto max2{MAXVAL(*a, 2)};
+  MATCH(5, At<std::int32_t>(max2, 0));
+  MATCH(6, At<std::int32_t>(max2, 1));
+  auto product1{PRODUCT(*a, 1)};
+  MATCH(2, At<std::int32_t>(product1, 0));
+  MATCH(12, At<std::int32_t>(product1, 1));
+  MATCH(30, At<std::int32_t>(product1, 2));
+
+  // MASK= of LOGICAL(4), true for the odd elements; and scalar masks
+  auto odd{MakeArray<std::int32_t>(TypeCategory::Integer, 4, 2, extent23,
+      [](std::size_t j) { return j % 2 == 0; })};
+  MATCH(9, Scalar<std::int32_t>(SUM(*a, 0, odd.get())));
+  MATCH(5, Scalar<std::int32_t>(MAXVAL(*a, 0, odd.get())));
+  auto maskedSum2{SUM(*a, 2, odd.get())};
+  MATCH(9, At<std::int32_t>(maskedSum2, 0));
+  MATCH(0, At<std::int32_t>(maskedSum2, 1));
+  auto maskedProduct1{PRODUCT(*a, 1, odd.get())};
+  MATCH(1, At<std::int32_t>(maskedProduct1, 0));
+  MATCH(3, At<std::int32_t>(maskedProduct1, 1));
+  MATCH(5, At<std::int32_t>(maskedProduct1, 2));
+  StaticDescriptor<1> falseDescriptor;
+  Descriptor &falseMask{falseDescriptor.descriptor()};
+  bool falseValue{false};
+  falseMask.Establish(TypeCategory::Logical, 1, &falseValue, 0);
+  MATCH(0, Scalar<std::int32_t>(SUM(*a, 0, &falseMask)));
+  MATCH(std::numeric_limits<std::int32_t>::lowest(),
+      Scalar<std::int32_t>(MAXVAL(*a, 0, &falseMask)));
+
+  // A section a(:,1:3:2) that is not contiguous
+  StaticDescriptor<2> sectionDescriptor;
+  Descriptor &section{sectionDescriptor.descriptor()};
+  static const SubscriptValue extent22[]{2, 2};
+  section.Establish(TypeCategory::Integer, 4,
+      a->Element<char>(std::size_t{0}), 2, extent22, CFI_attribute_pointer);
+  section.raw().dim[1].sm *= 2;
+  MATCH(14, Scalar<std::int32_t>(SUM(section)));  // 1+2+5+6
+  auto sectionMax1{MAXVAL(section, 1)};
+  MATCH(2, At<std::int32_t>(sectionMax1, 0));
+  MATCH(6, At<std::int32_t>(sectionMax1, 1));
+  auto sectionMin2{MINVAL(section, 2)};
+  MATCH(1, At<std::int32_t>(sectionMin2, 0));
+  MATCH(2, At<std::int32_t>(sectionMin2, 1));
+
+  // Other integer kinds; empty arrays
+  static const SubscriptValue extent1000[]{1000};
+  auto bytes{MakeArray<std::int8_t>(TypeCategory::Integer, 1, 1, extent1000,
+      [](std::size_t j) { return j % 3 - 1; })};
+  MATCH(-1, static_cast<std::int64_t>(Scalar<std::int8_t>(SUM(*bytes))));
+  MATCH(1, static_cast<std::int64_t>(Scalar<std::int8_t>(MAXVAL(*bytes))));
+  static const SubscriptValue extent0[]{0};
+  auto empty{MakeArray<double>(
+      TypeCategory::Real, 8, 1, extent0, [](std::size_t) { return 0.0; })};
+  TEST(Scalar<double>(SUM(*empty)) == 0);
+  TEST(Scalar<double>(PRODUCT(*empty)) == 1);
+  TEST(Scalar<double>(MAXVAL(*empty)) ==
+      -std::numeric_limits<double>::infinity());
+  TEST(Scalar<double>(MINVAL(*empty)) ==
+      std::numeric_limits<double>::infinity());
+
+  // REAL sums in each mode, of enough elements to be pairwise, and along
+  // each dimension of a rank-3 array
+  static const SubscriptValue extent100000[]{100000};
+  auto tenths{MakeArray<double>(TypeCategory::Real, 8, 1, extent100000,
+      [](std::size_t) { return 0.1; })};
+  for (auto summation :
+      {Summation::Pairwise, Summation::Kahan, Summation::Sequential}) {
+    executionEnvironment.summation = summation;
+    double sum{Scalar<double>(SUM(*tenths))};
+    TEST(Near(sum, 1e4, 1e-9))("summation %d: %.17g", int(summation), sum);
+    if (summation != Summation::Sequential) {
+      TEST(Near(sum, 1e4, 1e-14))("summation %d: %.17g", int(summation), sum);
+    }
+    static const SubscriptValue extent345[]{3, 4, 5};
+    auto r{MakeArray<float>(TypeCategory::Real, 4, 3, extent345,
+        [](std::size_t j) { return 0.5f * j; })};
+    for (int dim{1}; dim <= 3; ++dim) {
+      auto s{SUM(*r, dim)};
+      auto x{MAXVAL(*r, dim)};
+      MATCH(2, s->rank());
+      std::size_t stride[]{1, 3, 12}, n{std::size_t(extent345[dim - 1])};
+      std::size_t k{0};
+      for (std::size_t j{0}; j < 60; ++j) {
+        if ((j / stride[dim - 1]) % n != 0) {
+          continue;  // not the first along DIM=
+        }
+        float expect{0};
+        for (std::size_t i{0}; i < n; ++i) {
+          expect += 0.5f * (j + i * stride[dim - 1]);
+        }
+        TEST(Near(At<float>(s, k), expect, 1e-6))
+        ("DIM=%d, element %zd: %g", dim, k, At<float>(s, k));
+        TEST(At<float>(x, k) == 0.5f * (j + (n - 1) * stride[dim - 1]));
+        ++k;
+      }
+      MATCH(60 / n, k);
+    }
+  }
+  executionEnvironment.summation = Summation::Pairwise;
+
+  // COMPLEX
+  static const SubscriptValue extent3[]{3};
+  auto z{MakeArray<std::complex<double>>(TypeCategory::Complex, 8, 1, extent3,
+      [](std::size_t j) { return std::complex<double>(j, 1); })};
+  auto zSum{Scalar<std::complex<double>>(SUM(*z))};
+  TEST(zSum == std::complex<double>(3, 3));
+  auto zProduct{Scalar<std::complex<double>>(PRODUCT(*z))};
+  TEST(zProduct == std::complex<double>(-3, 1));  // i(1+i)(2+i)
+
+  // COUNT, ANY, ALL of LOGICAL(1) and LOGICAL(4)
+  auto l1{MakeArray<bool>(TypeCategory::Logical, 1, 2, extent23,
+      [](std::size_t j) { return j >= 3; })};
+  MATCH(3, Scalar<std::int32_t>(COUNT(*l1)));
+  MATCH(3, Scalar<std::int64_t>(COUNT(*l1, 0, 8)));
+  auto count1{COUNT(*l1, 1, 2)};
+  MATCH(2, count1->ElementBytes());
+  MATCH(0, At<std::int16_t>(count1, 0));
+  MATCH(1, At<std::int16_t>(count1, 1));
+  MATCH(2, At<std::int16_t>(count1, 2));
+  TEST(Scalar<bool>(ANY(*l1)));
+  TEST(!Scalar<bool>(ALL(*l1)));
+  auto all1{ALL(*l1, 1)};
+  TEST(all1->type().raw() == l1->type().raw());
+  TEST(!At<bool>(all1, 0));
+  TEST(!At<bool>(all1, 1));
+  TEST(At<bool>(all1, 2));
+  auto any2{ANY(*l1, 2)};
+  TEST(At<bool>(any2, 0));
+  TEST(At<bool>(any2, 1));
+  MATCH(3, Scalar<std::int32_t>(COUNT(*odd)));
+  auto none{MakeArray<std::int32_t>(TypeCategory::Integer, 4, 1, extent1000,
+      [](std::size_t) { return 0; })};
+  MATCH(0, Scalar<std::int32_t>(ANY(*none)));
+  MATCH(0, Scalar<std::int32_t>(ALL(*none)));
+  auto noLogicals{MakeArray<bool>(TypeCategory::Logical, 1, 1, extent0,
+      [](std::size_t) { return false; })};
+  TEST(Scalar<bool>(ALL(*noLogicals)));
+  TEST(!Scalar<bool>(ANY(*noLogicals)));
+  MATCH(0, Scalar<std::int32_t>(COUNT(*noLogicals)));
+
+  // DOT_PRODUCT
+  MATCH(0, Scalar<std::int32_t>(DOT_PRODUCT(*none, *none)));
+  auto ints{MakeArray<std::int32_t>(TypeCategory::Integer, 4, 1, extent1000,
+      [](std::size_t j) { return j; })};
+  MATCH(332833500, Scalar<std::int32_t>(DOT_PRODUCT(*ints, *ints)));
+  auto reals{MakeArray<double>(TypeCategory::Real, 8, 1, extent100000,
+      [](std::size_t j) { return j % 2 ? 1.0 : 2.0; })};
+  TEST(Near(Scalar<double>(DOT_PRODUCT(*tenths, *reals)), 15000, 1e-12));
+  StaticDescriptor<1> evenDescriptor;
+  Descriptor &even{evenDescriptor.descriptor()};
+  static const SubscriptValue extent50000[]{50000};
+  even.Establish(TypeCategory::Real, 8, reals->Element<char>(std::size_t{0}),
+      1, extent50000, CFI_attribute_pointer);
+  even.raw().dim[0].sm *= 2;
+  TEST(Near(Scalar<double>(DOT_PRODUCT(even, even)), 200000, 1e-12));
+  auto zDot{Scalar<std::complex<double>>(DOT_PRODUCT(*z, *z))};
+  TEST(zDot == std::complex<double>(8, 0));  // sum of |z|**2
+  auto l2{MakeArray<bool>(TypeCategory::Logical, 1, 1, extent3,
+      [](std::size_t j) { return j == 1; })};
+  auto l3{MakeArray<bool>(TypeCategory::Logical, 1, 1, extent3,
+      [](std::size_t j) { return j != 1; })};
+  TEST(Scalar<bool>(DOT_PRODUCT(*l2, *l2)));
+  TEST(!Scalar<bool>(DOT_PRODUCT(*l2, *l3)));
+
+  return testing::Complete();
+}
@@ -1,5 +1,6 @@
 #include "testing.h"
 #include "../../runtime/descriptor.h"
+#include "../../runtime/element-runs.h"
 #include "../../runtime/transformational.h"
 #include <cinttypes>
 
@@ -69,7 +70,145 @@ int main() {
     MATCH(j, *result->Element<std::int32_t>(ss));
   }
 
-  // TODO: test ORDER=
+  // ORDER=[2,1]: the second dimension varies most rapidly.
+  static const std::int16_t orderData[]{2, 1};
+  std::unique_ptr<Descriptor> order{Descriptor::Create(TypeCategory::Integer,
+      static_cast<int>(sizeof orderData[0]),
+      const_cast<void *>(reinterpret_cast<const void *>(orderData)), 1,
+      &shapeExtent, CFI_attribute_pointer)};
+  result = RESHAPE(*source, *shape, &pad, order.get());
+  TEST(result.get() != nullptr);
+  MATCH(2, result->rank());
+  MATCH(8, result->GetDimension(0).Extent());
+  MATCH(4, result->GetDimension(1).Extent());
+  for (std::int32_t j{0}; j < 32; ++j) {
+    SubscriptValue ss[2]{1 + (j / 4), 1 + (j % 4)};
+    MATCH(j, *result->Element<std::int32_t>(ss));
+  }
+
+  // ORDER=[2,3,1] with the shape of SOURCE=
+  static const std::int32_t shape3Data[]{2, 3, 4}, order3Data[]{2, 3, 1};
+  static const SubscriptValue threeExtent{3};
+  std::unique_ptr<Descriptor> shape3{Descriptor::Create(TypeCategory::Integer,
+      static_cast<int>(sizeof shape3Data[0]),
+      const_cast<void *>(reinterpret_cast<const void *>(shape3Data)), 1,
+      &threeExtent, CFI_attribute_pointer)};
+  std::unique_ptr<Descriptor> order3{Descriptor::Create(TypeCategory::Integer,
+      static_cast<int>(sizeof order3Data[0]),
+      const_cast<void *>(reinterpret_cast<const void *>(order3Data)), 1,
+      &threeExtent, CFI_attribute_pointer)};
+  result = RESHAPE(*source, *shape3, nullptr, order3.get());
+  TEST(result.get() != nullptr);
+  MATCH(3, result->rank());
+  for (std::int32_t j{0}; j < 24; ++j) {
+    SubscriptValue ss[3]{1 + (j / 12), 1 + (j % 3), 1 + (j / 3 % 4)};
+    MATCH(j, *result->Element<std::int32_t>(ss));
+  }
+
+  // ORDER=[1,3,2] copies runs of the first dimension; ORDER=[3,1,2]
+  // transposes columns of the third dimension in tiles.
+  static const std::int32_t permutations[][3]{{1, 3, 2}, {3, 1, 2}};
+  for (const auto &permutation : permutations) {
+    order3 = Descriptor::Create(TypeCategory::Integer,
+        static_cast<int>(sizeof permutation[0]),
+        const_cast<void *>(reinterpret_cast<const void *>(permutation)), 1,
+        &threeExtent, CFI_attribute_pointer);
+    result = RESHAPE(*source, *shape3, nullptr, order3.get());
+    TEST(result.get() != nullptr);
+    MATCH(3, result->rank());
+    for (std::int32_t j{0}; j < 24; ++j) {
+      // Element j of SOURCE= lands where the subscripts of j, taken in
+      // the permuted order, place it.
+      SubscriptValue ss[3];
+      std::int32_t rest{j};
+      for (int k{0}; k < 3; ++k) {
+        int dim{permutation[k] - 1};
+        ss[dim] = 1 + rest % shape3Data[dim];
+        rest /= shape3Data[dim];
+      }
+      MATCH(j, *result->Element<std::int32_t>(ss));
+    }
+  }
+
+  // Dimensions are collapsed only when adjacent in the permuted order.
+  static const int skipSecond[]{0, 2, 1}, secondFirst[]{1, 2, 0};
+  ElementRuns skipRuns{*source, skipSecond};
+  MATCH(24, skipRuns.elements());
+  MATCH(3, skipRuns.dimensions());
+  MATCH(2, skipRuns.runLength());
+  ElementRuns columnRuns{*source, secondFirst};
+  MATCH(2, columnRuns.dimensions());
+  MATCH(12, columnRuns.runLength());
+  MATCH(2 * sizeof(std::int32_t), columnRuns.runByteStride());
+  std::int32_t next{0};
+  bool inOrder{true};
+  columnRuns.ForEachRun(
+      [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+        // SOURCE(i,:,:) for each i in turn
+        for (std::size_t j{0}; j < count; ++j) {
+          inOrder &= *reinterpret_cast<const std::int32_t *>(
+                         first + j * stride) == 2 * (next % 12) + next / 12;
+          ++next;
+        }
+        return true;
+      });
+  MATCH(24, next);
+  TEST(inOrder);
+
+  // A SOURCE= section that is not contiguous, SOURCE(:,1:3:2,:), with
+  // ORDER=[2,1]
+  StaticDescriptor<3> sectionDescriptor;
+  Descriptor &section{sectionDescriptor.descriptor()};
+  static const SubscriptValue sectionExtent[]{2, 2, 4};
+  section.Establish(TypeCategory::Integer, sizeof(std::int32_t),
+      source->Element<void>(std::size_t{0}), 3, sectionExtent,
+      CFI_attribute_pointer);
+  section.raw().dim[1].sm = 4 * sizeof(std::int32_t);
+  section.raw().dim[2].sm = 6 * sizeof(std::int32_t);
+  TEST(!section.IsContiguous());
+  ElementRuns sectionRuns{section};
+  MATCH(16, sectionRuns.elements());
+  MATCH(3, sectionRuns.dimensions());
+  MATCH(2, sectionRuns.runLength());
+  TEST(!sectionRuns.IsContiguous());
+  ElementRuns sourceRuns{*source};
+  MATCH(1, sourceRuns.dimensions());
+  MATCH(24, sourceRuns.runLength());
+  TEST(sourceRuns.IsContiguous());
+  // SOURCE(1,:,:) is a single run with a stride of two elements.
+  StaticDescriptor<3> rowDescriptor;
+  Descriptor &row{rowDescriptor.descriptor()};
+  static const SubscriptValue rowExtent[]{1, 3, 4};
+  row.Establish(TypeCategory::Integer, sizeof(std::int32_t),
+      source->Element<void>(std::size_t{0}), 3, rowExtent,
+      CFI_attribute_pointer);
+  row.raw().dim[1].sm = 2 * sizeof(std::int32_t);
+  row.raw().dim[2].sm = 6 * sizeof(std::int32_t);
+  ElementRuns rowRuns{row};
+  MATCH(1, rowRuns.dimensions());
+  MATCH(12, rowRuns.runLength());
+  MATCH(2 * sizeof(std::int32_t), rowRuns.runByteStride());
+  std::int32_t sum{0};
+  rowRuns.ForEachRun(
+      [&](const char *first, std::size_t count, std::ptrdiff_t stride) {
+        for (std::size_t j{0}; j < count; ++j) {
+          sum += *reinterpret_cast<const std::int32_t *>(first + j * stride);
+        }
+        return true;
+      });
+  MATCH(132, sum);  // 0 + 2 + ... + 22
+  static const std::int16_t sectionShapeData[]{4, 4};
+  std::unique_ptr<Descriptor> sectionShape{Descriptor::Create(
+      TypeCategory::Integer, static_cast<int>(sizeof sectionShapeData[0]),
+      const_cast<void *>(reinterpret_cast<const void *>(sectionShapeData)), 1,
+      &shapeExtent, CFI_attribute_pointer)};
+  result = RESHAPE(section, *sectionShape, nullptr, order.get());
+  TEST(result.get() != nullptr);
+  for (std::int32_t j{0}; j < 16; ++j) {
+    SubscriptValue ss[2]{1 + (j / 4), 1 + (j % 4)};
+    MATCH((j % 2) + 4 * (j / 2 % 2) + 6 * (j / 4),
+        *result->Element<std::int32_t>(ss));
+  }
 
   return testing::Complete();
 }
@@ -0,0 +1,137 @@
+// Tests asynchronous transfers to and from a file connected for
+// unformatted direct access: the completion of each transfer and its
+// IOSTAT= at the WAIT for its ID=, the end of the file, transfers longer
+// than the record, a WAIT without ID= for all those pending, and more
+// transfers whose IDs are never waited for than the table of pending
+// transfers can hold.
+
+#include "../../runtime/io-api.h"
+#include "../../runtime/main.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Fortran::runtime::io;
+
+static const char *fileName{"asynchronous.tmp"};
+static constexpr int unit{10};
+static constexpr std::size_t recl{8};
+static int failures{0};
+
+static void Open() {
+  Cookie cookie{IONAME(BeginOpenUnit)(unit)};
+  IONAME(SetFile)(cookie, fileName, std::strlen(fileName));
+  IONAME(SetAction)(cookie, "READWRITE", 9);
+  IONAME(SetStatus)(cookie, "REPLACE", 7);
+  IONAME(SetAccess)(cookie, "DIRECT", 6);
+  IONAME(SetForm)(cookie, "UNFORMATTED", 11);
+  IONAME(SetRecl)(cookie, recl);
+  IONAME(SetAsynchronous)(cookie, "YES", 3);
+  if (auto status{IONAME(EndIoStatement)(cookie)}) {
+    std::fprintf(stderr, "OPEN failed, status %d\n", status);
+    ++failures;
+  }
+}
+
+// WAIT(unit, ID=id, IOSTAT=), or WAIT(unit, IOSTAT=) for all
+static int Wait(const AsynchronousId *id = nullptr) {
+  Cookie cookie{id ? IONAME(BeginWait)(unit, *id) : IONAME(BeginWaitAll)(unit)};
+  IONAME(EnableHandlers)(cookie, true);
+  return IONAME(EndIoStatement)(cookie);
+}
+
+static void Check(bool ok, const char *what, int j) {
+  if (!ok) {
+    std::fprintf(stderr, "%s: record %d\n", what, j);
+    ++failures;
+  }
+}
+
+static void Record(char *record, int j) {
+  std::snprintf(record, recl + 1, "%08d", j);
+}
+
+int main(int argc, const char *argv[]) {
+  RTNAME(ProgramStart)(argc, argv, nullptr);
+  Open();
+
+  // Each transfer completes by the WAIT for its ID=.
+  static constexpr int records{100};
+  std::vector<char> out(records * (recl + 1));
+  std::vector<AsynchronousId> ids;
+  for (int j{0}; j < records; ++j) {
+    Record(&out[j * (recl + 1)], j);
+    ids.push_back(IONAME(BeginAsynchronousOutput)(
+        unit, j + 1, &out[j * (recl + 1)], recl));
+  }
+  for (int j{0}; j < records; ++j) {
+    Check(Wait(&ids[j]) == 0, "WAIT after output", j);
+  }
+  std::vector<char> in(records * recl);
+  ids.clear();
+  for (int j{0}; j < records; ++j) {
+    ids.push_back(
+        IONAME(BeginAsynchronousInput)(unit, j + 1, &in[j * recl], recl));
+  }
+  for (int j{records - 1}; j >= 0; --j) {
+    Check(Wait(&ids[j]) == 0, "WAIT after input", j);
+    Check(std::memcmp(&in[j * recl], &out[j * (recl + 1)], recl) == 0,
+        "input", j);
+  }
+  // A second WAIT for the same ID= has no effect.
+  Check(Wait(&ids[0]) == 0, "second WAIT", 0);
+
+  // Input past the end of the file
+  char past[recl];
+  AsynchronousId id{
+      IONAME(BeginAsynchronousInput)(unit, records + 10, past, recl)};
+  Check(Wait(&id) == IostatEnd, "IOSTAT=END at WAIT", records + 10);
+
+  // Transfers longer than RECL= fail, and leave the record unchanged
+  char wide[2 * recl];
+  std::memset(wide, 'x', sizeof wide);
+  id = IONAME(BeginAsynchronousOutput)(unit, 1, wide, sizeof wide);
+  Check(Wait(&id) == IostatRecordWriteOverflow, "IOSTAT= of long output", 1);
+  id = IONAME(BeginAsynchronousInput)(unit, 1, wide, sizeof wide);
+  Check(Wait(&id) == IostatRecordReadOverflow, "IOSTAT= of long input", 1);
+  id = IONAME(BeginAsynchronousInput)(unit, 1, wide, recl);
+  Check(Wait(&id) == 0 && std::memcmp(wide, &out[0], recl) == 0 &&
+          wide[recl] == 'x',
+      "record after long transfers", 1);
+
+  // A WAIT without ID= completes all pending transfers, including more
+  // than fit in the table of pending transfers.
+  static constexpr int manyRecords{5000};
+  std::vector<char> many(manyRecords * (recl + 1));
+  for (int j{0}; j < manyRecords; ++j) {
+    Record(&many[j * (recl + 1)], j);
+    IONAME(BeginAsynchronousOutput)(unit, j + 1, &many[j * (recl + 1)], recl);
+  }
+  Check(Wait() == 0, "WAIT without ID=", manyRecords);
+  std::vector<char> manyIn(manyRecords * recl);
+  for (int j{0}; j < manyRecords; ++j) {
+    IONAME(BeginAsynchronousInput)(unit, j + 1, &manyIn[j * recl], recl);
+  }
+  id = IONAME(BeginAsynchronousInput)(unit, manyRecords + 1, past, recl);
+  Check(Wait() == IostatEnd, "IOSTAT=END at WAIT without ID=", manyRecords);
+  for (int j{0}; j < manyRecords; ++j) {
+    if (std::memcmp(&manyIn[j * recl], &many[j * (recl + 1)], recl) != 0) {
+      Check(false, "input of many", j);
+      break;
+    }
+  }
+  Check(Wait(&id) == 0, "WAIT for an ID= that WAIT without ID= completed",
+      manyRecords + 1);
+
+  Cookie cookie{IONAME(BeginClose)(unit)};
+  IONAME(SetStatus)(cookie, "DELETE", 6);
+  IONAME(EndIoStatement)(cookie);
+
+  if (failures == 0) {
+    std::printf("PASS\n");
+  } else {
+    std::printf("FAIL %d tests\n", failures);
+  }
+  return failures > 0;
+}
@@ -0,0 +1,207 @@
+// Tests BUFFERING='BACKGROUND', with a buffer small enough that full
+// buffers are written by the background thread while the next is being
+// filled: formatted output with a FLUSH midway, after which all of it
+// must be in the file; input read ahead; unformatted records longer
+// than the buffer; and output that must reach its file at STOP, and
+// when the runtime crashes.
+
+#include "../../runtime/io-api.h"
+#include "../../runtime/main.h"
+#include "../../runtime/stop.h"
+#include "../../runtime/terminator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Fortran::runtime::io;
+
+static const char *fileName{"background.tmp"};
+static constexpr int unit{10};
+static constexpr std::size_t bufferBytes{4096};
+static constexpr int lines{2000};
+static int failures{0};
+
+static void Open(const char *action, const char *status,
+    const char *form = "FORMATTED") {
+  Cookie cookie{IONAME(BeginOpenUnit)(unit)};
+  IONAME(SetFile)(cookie, fileName, std::strlen(fileName));
+  IONAME(SetAction)(cookie, action, std::strlen(action));
+  IONAME(SetStatus)(cookie, status, std::strlen(status));
+  IONAME(SetForm)(cookie, form, std::strlen(form));
+  IONAME(SetBuffering)(cookie, "BACKGROUND", 10);
+  IONAME(SetBufferSize)(cookie, bufferBytes);
+  if (auto status{IONAME(EndIoStatement)(cookie)}) {
+    std::fprintf(stderr, "OPEN failed, status %d\n", status);
+    ++failures;
+  }
+}
+
+static void Close() {
+  if (auto status{IONAME(EndIoStatement)(IONAME(BeginClose)(unit))}) {
+    std::fprintf(stderr, "CLOSE failed, status %d\n", status);
+    ++failures;
+  }
+}
+
+// WRITE(unit, '(A,I0)') 'line ', j for lines [first, last)
+static void WriteLines(int first, int last) {
+  for (int j{first}; j < last; ++j) {
+    Cookie cookie{IONAME(BeginExternalFormattedOutput)("(A,I0)", 6, unit)};
+    IONAME(OutputAscii)(cookie, "line ", 5);
+    IONAME(OutputInteger64)(cookie, j);
+    IONAME(EndIoStatement)(cookie);
+  }
+}
+
+static std::string ExpectLines(int last) {
+  std::string result;
+  for (int j{0}; j < last; ++j) {
+    result += "line " + std::to_string(j) + '\n';
+  }
+  return result;
+}
+
+static std::string Contents() {
+  std::string result;
+  if (std::FILE * fp{std::fopen(fileName, "r")}) {
+    char buffer[4096];
+    while (auto got{std::fread(buffer, 1, sizeof buffer, fp)}) {
+      result.append(buffer, got);
+    }
+    std::fclose(fp);
+  } else {
+    ++failures;
+  }
+  return result;
+}
+
+static void Check(const char *what, const std::string &got,
+    const std::string &expect) {
+  if (got != expect) {
+    std::fprintf(stderr, "%s: got %zd bytes, expected %zd\n", what,
+        got.size(), expect.size());
+    ++failures;
+  }
+}
+
+static long long FileSize() {
+  struct stat st;
+  return ::stat(fileName, &st) == 0 ? st.st_size : -1;
+}
+
+// The output of a process that ends with STOP, or crashes, without a
+// CLOSE must all be in the file.
+static void TestEnd(int argc, const char *argv[], bool crash) {
+  pid_t child{::fork()};
+  if (child == 0) {
+    RTNAME(ProgramStart)(argc, argv, nullptr);
+    Open("WRITE", "REPLACE");
+    WriteLines(0, lines);
+    if (crash) {
+      ::close(2);  // quietly
+      Fortran::runtime::Terminator{__FILE__, __LINE__}.Crash("crash test");
+    }
+    RTNAME(StopStatement)();
+  }
+  int status{-1};
+  ::waitpid(child, &status, 0);
+  if (crash ? !WIFSIGNALED(status)
+            : !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    std::fprintf(stderr, "%s: child status %d\n", crash ? "crash" : "STOP",
+        status);
+    ++failures;
+  }
+  Check(crash ? "after crash" : "after STOP", Contents(), ExpectLines(lines));
+}
+
+static char Byte(int record, std::size_t j) {
+  return static_cast<char>(j * 7 + record);
+}
+
+int main(int argc, const char *argv[]) {
+  TestEnd(argc, argv, false);
+  TestEnd(argc, argv, true);
+  RTNAME(ProgramStart)(argc, argv, nullptr);
+
+  // Formatted output, with a FLUSH midway
+  Open("WRITE", "REPLACE");
+  WriteLines(0, lines / 2);
+  if (auto status{IONAME(EndIoStatement)(IONAME(BeginFlush)(unit))}) {
+    std::fprintf(stderr, "FLUSH failed, status %d\n", status);
+    ++failures;
+  }
+  long long expectSize{static_cast<long long>(ExpectLines(lines / 2).size())};
+  if (FileSize() != expectSize) {
+    std::fprintf(stderr, "after FLUSH: file has %lld bytes, expected %lld\n",
+        FileSize(), expectSize);
+    ++failures;
+  }
+  WriteLines(lines / 2, lines);
+  Close();
+  Check("after CLOSE", Contents(), ExpectLines(lines));
+
+  // Formatted input, read ahead
+  Open("READ", "OLD");
+  for (int j{0}; j < lines; ++j) {
+    std::int64_t n{-1};
+    Cookie cookie{IONAME(BeginExternalFormattedInput)("(5X,I10)", 8, unit)};
+    IONAME(InputInteger64)(cookie, n);
+    IONAME(EndIoStatement)(cookie);
+    if (n != j) {
+      std::fprintf(stderr, "line %d read as %jd\n", j,
+          static_cast<std::intmax_t>(n));
+      ++failures;
+      break;
+    }
+  }
+  Close();
+
+  // Unformatted records longer than the buffer, and short ones between
+  static constexpr std::size_t recordBytes[]{10000, 3, 3 * bufferBytes, 1};
+  Open("WRITE", "REPLACE", "UNFORMATTED");
+  int records{0};
+  for (std::size_t bytes : recordBytes) {
+    std::string record;
+    for (std::size_t j{0}; j < bytes; ++j) {
+      record += Byte(records, j);
+    }
+    Cookie cookie{IONAME(BeginUnformattedOutput)(unit)};
+    IONAME(OutputUnformattedBlock)(cookie, record.data(), bytes);
+    IONAME(EndIoStatement)(cookie);
+    ++records;
+  }
+  Close();
+  Open("READ", "OLD", "UNFORMATTED");
+  records = 0;
+  for (std::size_t bytes : recordBytes) {
+    std::string record(bytes, '\0');
+    Cookie cookie{IONAME(BeginUnformattedInput)(unit)};
+    IONAME(InputUnformattedBlock)(cookie, record.data(), bytes);
+    if (auto status{IONAME(EndIoStatement)(cookie)}) {
+      std::fprintf(stderr, "unformatted READ failed, status %d\n", status);
+      ++failures;
+    }
+    for (std::size_t j{0}; j < bytes; ++j) {
+      if (record[j] != Byte(records, j)) {
+        std::fprintf(stderr, "unformatted record %d differs at byte %zd\n",
+            records, j);
+        ++failures;
+        break;
+      }
+    }
+    ++records;
+  }
+  Close();
+  std::remove(fileName);
+
+  if (failures == 0) {
+    std::printf("PASS\n");
+  } else {
+    std::printf("FAIL %d tests\n", failures);
+  }
+  return failures > 0;
+}
@@ -0,0 +1,49 @@
+#ifndef FORTRAN_TEST_RUNTIME_BENCHMARK_H_
+#define FORTRAN_TEST_RUNTIME_BENCHMARK_H_
+
+// Helpers shared by the benchmarks of the runtime's transformational
+// intrinsic functions
+
+#include "../../runtime/descriptor.h"
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <memory>
+#include <type_traits>
+
+namespace Fortran::runtime {
+
+// The shortest time in seconds taken by any of the calls to f()
+template<typename F> double BestSeconds(int repetitions, F f) {
+  double best{1e99};
+  for (int j{0}; j < repetitions; ++j) {
+    auto start{std::chrono::steady_clock::now()};
+    f();
+    std::chrono::duration<double> elapsed{
+        std::chrono::steady_clock::now() - start};
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+template<typename T> struct IsComplex : std::false_type {};
+template<typename R> struct IsComplex<std::complex<R>> : std::true_type {};
+
+// An allocatable array of the given extents, filled in array element
+// order by f(j) for each element j
+template<typename T, typename F>
+std::unique_ptr<Descriptor> MakeArray(common::TypeCategory category, int rank,
+    const SubscriptValue *extent, F f) {
+  int kind = IsComplex<T>::value ? sizeof(T) / 2 : sizeof(T);
+  std::unique_ptr<Descriptor> result{Descriptor::Create(
+      category, kind, nullptr, rank, extent, CFI_attribute_allocatable)};
+  SubscriptValue ones[maxRank]{1, 1};
+  result->Allocate(ones, extent, sizeof(T));
+  T *x{result->Element<T>(std::size_t{0})};
+  for (std::size_t j{0}; j < result->Elements(); ++j) {
+    x[j] = static_cast<T>(f(j));
+  }
+  return result;
+}
+}
+#endif  // FORTRAN_TEST_RUNTIME_BENCHMARK_H_
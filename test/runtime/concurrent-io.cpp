@@ -0,0 +1,137 @@
+// Stress test and benchmark of concurrent external I/O statements.
+// Each of N threads writes list-directed records, first all to one
+// shared unit, and then each to a unit of its own; throughput is
+// reported for increasing N.  The shared file is then read back to
+// verify that no record was lost or interleaved with another.
+// Usage: concurrent-io [records per thread [max threads]]
+
+#include "../../runtime/io-api.h"
+#include "../../runtime/main.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Fortran::runtime::io;
+
+static std::string FileName(int unit) {
+  return "/tmp/concurrent-io-" + std::to_string(unit) + ".txt";
+}
+
+static void Open(int unit) {
+  std::string path{FileName(unit)};
+  auto *io{IONAME(BeginOpenUnit)(unit)};
+  IONAME(SetFile)(io, path.data(), path.size());
+  IONAME(SetStatus)(io, "REPLACE", 7);
+  IONAME(SetAction)(io, "WRITE", 5);
+  IONAME(EndIoStatement)(io);
+}
+
+static void Close(int unit, bool keep) {
+  auto *io{IONAME(BeginClose)(unit)};
+  if (!keep) {
+    IONAME(SetStatus)(io, "DELETE", 6);
+  }
+  IONAME(EndIoStatement)(io);
+}
+
+static void Write(int unit, int thread, int records) {
+  for (int j{0}; j < records; ++j) {
+    auto *io{IONAME(BeginExternalListOutput)(unit)};
+    IONAME(OutputInteger64)(io, thread);
+    IONAME(OutputInteger64)(io, j);
+    IONAME(OutputAscii)(io, "abcdefghijklmnopqrstuvwxyz", 26);
+    IONAME(OutputReal64)(io, j * 0.125);
+    IONAME(EndIoStatement)(io);
+  }
+}
+
+// Returns the elapsed seconds
+static double Run(int threads, int records, bool shared) {
+  const int sharedUnit{10}, firstUnit{11};
+  if (shared) {
+    Open(sharedUnit);
+  } else {
+    for (int t{0}; t < threads; ++t) {
+      Open(firstUnit + t);
+    }
+  }
+  auto start{std::chrono::steady_clock::now()};
+  std::vector<std::thread> workers;
+  for (int t{0}; t < threads; ++t) {
+    workers.emplace_back(
+        Write, shared ? sharedUnit : firstUnit + t, t, records);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (shared) {
+    Close(sharedUnit, true);
+  } else {
+    for (int t{0}; t < threads; ++t) {
+      Close(firstUnit + t, false);
+    }
+  }
+  std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start};
+  return elapsed.count();
+}
+
+static int Verify(int threads, int records) {
+  std::string path{FileName(10)};
+  std::FILE *fp{std::fopen(path.c_str(), "r")};
+  if (!fp) {
+    std::perror(path.c_str());
+    return 1;
+  }
+  std::vector<int> next(threads, 0);
+  int failures{0};
+  char line[256];
+  while (std::fgets(line, sizeof line, fp)) {
+    int thread, record;
+    char text[32];
+    double x;
+    if (std::sscanf(line, "%d %d %31s %lf", &thread, &record, text, &x) != 4 ||
+        thread < 0 || thread >= threads || record != next[thread] ||
+        std::strcmp(text, "abcdefghijklmnopqrstuvwxyz") != 0 ||
+        x != record * 0.125) {
+      if (failures++ < 10) {
+        std::fprintf(stderr, "bad record: %s", line);
+      }
+      continue;
+    }
+    ++next[thread];
+  }
+  std::fclose(fp);
+  std::remove(path.c_str());
+  for (int t{0}; t < threads; ++t) {
+    if (next[t] != records) {
+      std::fprintf(stderr, "thread %d: %d of %d records\n", t, next[t],
+          records);
+      ++failures;
+    }
+  }
+  return failures;
+}
+
+int main(int argc, const char *argv[], const char *envp[]) {
+  RTNAME(ProgramStart)(argc, argv, envp);
+  int records{argc > 1 ? std::atoi(argv[1]) : 100000};
+  int maxThreads{argc > 2 ? std::atoi(argv[2]) : 8};
+  int failures{0};
+  std::printf("threads  shared unit (records/s)  own units (records/s)\n");
+  for (int threads{1}; threads <= maxThreads; threads *= 2) {
+    double shared{Run(threads, records, true)};
+    failures += Verify(threads, records);
+    double own{Run(threads, records, false)};
+    double total{static_cast<double>(threads) * records};
+    std::printf("%7d  %23.0f  %21.0f\n", threads, total / shared, total / own);
+  }
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures);
+  }
+  return failures > 0;
+}
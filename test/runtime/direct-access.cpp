@@ -0,0 +1,114 @@
+// Stress test and benchmark of unformatted direct access READ and WRITE
+// statements with REC=, like those that write and read restart files.
+// N threads share one unit; each writes, and then reads back and checks,
+// its own records, in a scattered order.  Throughput is reported for
+// increasing N.
+// Usage: direct-access [records [max threads]]
+
+#include "../../runtime/io-api.h"
+#include "../../runtime/main.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace Fortran::runtime::io;
+
+static const char *fileName{"/tmp/direct-access.bin"};
+static constexpr int unit{10};
+static constexpr std::size_t recordBytes{8192};
+static constexpr std::size_t words{recordBytes / sizeof(std::int64_t)};
+static std::atomic<int> failures{0};
+
+// The records are visited in a scattered order that covers them all.
+static std::int64_t Record(std::size_t j, std::size_t records) {
+  return static_cast<std::int64_t>(j * 7919 % records + 1);
+}
+
+static void Transfer(bool isRead, std::size_t first, std::size_t last,
+    std::size_t records) {
+  std::vector<std::int64_t> data(words);
+  for (std::size_t j{first}; j < last; ++j) {
+    std::int64_t rec{Record(j, records)};
+    Cookie cookie;
+    if (isRead) {
+      cookie = IONAME(BeginUnformattedInput)(unit);
+      IONAME(SetRec)(cookie, rec);
+      // The record number, then the rest of the record
+      IONAME(InputUnformattedBlock)(
+          cookie, reinterpret_cast<char *>(&data[0]), sizeof data[0]);
+      IONAME(InputUnformattedBlock)(cookie,
+          reinterpret_cast<char *>(&data[1]), recordBytes - sizeof data[0]);
+    } else {
+      for (std::size_t k{0}; k < words; ++k) {
+        data[k] = rec * words + k;
+      }
+      cookie = IONAME(BeginUnformattedOutput)(unit);
+      IONAME(SetRec)(cookie, rec);
+      IONAME(OutputUnformattedBlock)(
+          cookie, reinterpret_cast<char *>(data.data()), recordBytes);
+    }
+    if (auto status{IONAME(EndIoStatement)(cookie)}) {
+      std::fprintf(stderr, "REC=%jd failed, status %d\n",
+          static_cast<std::intmax_t>(rec), static_cast<int>(status));
+      ++failures;
+      return;
+    }
+    if (isRead) {
+      for (std::size_t k{0}; k < words; ++k) {
+        if (data[k] != static_cast<std::int64_t>(rec * words + k)) {
+          std::fprintf(stderr, "REC=%jd: wrong data\n",
+              static_cast<std::intmax_t>(rec));
+          ++failures;
+          return;
+        }
+      }
+    }
+  }
+}
+
+// Returns records per second
+static double Run(bool isRead, int threads, std::size_t records) {
+  auto start{std::chrono::steady_clock::now()};
+  std::vector<std::thread> workers;
+  for (int t{0}; t < threads; ++t) {
+    workers.emplace_back(Transfer, isRead, records * t / threads,
+        records * (t + 1) / threads, records);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start};
+  return records / elapsed.count();
+}
+
+int main(int argc, const char *argv[]) {
+  RTNAME(ProgramStart)(argc, argv, nullptr);
+  std::size_t records{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000};
+  int maxThreads{argc > 2 ? std::atoi(argv[2]) : 8};
+  Cookie cookie{IONAME(BeginOpenUnit)(unit)};
+  IONAME(SetFile)(cookie, fileName, std::strlen(fileName));
+  IONAME(SetStatus)(cookie, "REPLACE", 7);
+  IONAME(SetAction)(cookie, "READWRITE", 9);
+  IONAME(SetAccess)(cookie, "DIRECT", 6);
+  IONAME(SetForm)(cookie, "UNFORMATTED", 11);
+  IONAME(SetRecl)(cookie, recordBytes);
+  IONAME(EndIoStatement)(cookie);
+  std::printf("threads   WRITE (records/s)   READ (records/s)\n");
+  for (int threads{1}; threads <= maxThreads; threads *= 2) {
+    double writeRate{Run(false, threads, records)};
+    double readRate{Run(true, threads, records)};
+    std::printf("%7d %19.0f %18.0f\n", threads, writeRate, readRate);
+  }
+  cookie = IONAME(BeginClose)(unit);
+  IONAME(SetStatus)(cookie, "DELETE", 6);
+  IONAME(EndIoStatement)(cookie);
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures.load());
+  }
+  return failures > 0;
+}
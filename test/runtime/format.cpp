@@ -1,6 +1,7 @@
 // Tests basic FORMAT string traversal
 
 #include "../runtime/format-implementation.h"
+#include "../runtime/memory.h"
 #include "../runtime/terminator.h"
 #include <cstdarg>
 #include <cstring>
@@ -119,10 +120,8 @@ void TestFormatContext::Check(Results &expect) {
   results.clear();
 }
 
-static void Test(int n, const char *format, Results &&expect, int repeat = 1) {
-  TestFormatContext context;
-  FormatControl<TestFormatContext> control{
-      context, format, std::strlen(format)};
+static void Run(TestFormatContext &context,
+    FormatControl<TestFormatContext> &control, int n, int repeat) {
   try {
     for (int j{0}; j < n; ++j) {
       context.Report(control.GetNextDataEdit(context, repeat));
@@ -131,10 +130,57 @@ static void Test(int n, const char *format, Results &&expect, int repeat = 1) {
   } catch (const std::string &crash) {
     context.results.push_back("Crash:"s + crash);
   }
+}
+
+// Each FORMAT is both interpreted and, if it can be, compiled;
+// the results must agree.
+static void Test(int n, const char *format, Results &&expect, int repeat = 1,
+    bool compilable = true) {
+  Results expectCompiled{expect};
+  TestFormatContext context;
+  FormatControl<TestFormatContext> control{
+      context, format, std::strlen(format)};
+  Run(context, control, n, repeat);
   context.Check(expect);
+  if (const CompiledFormat *
+      compiled{CompiledFormat::Create(context, format, std::strlen(format))}) {
+    FormatControl<TestFormatContext> compiledControl{context, *compiled};
+    Run(context, compiledControl, n, repeat);
+    context.Check(expectCompiled);
+    FreeMemory(const_cast<CompiledFormat *>(compiled));
+  } else if (compilable) {
+    std::cerr << "could not compile '" << format << "'\n";
+    ++failures;
+  }
+}
+
+// The cache returns the same compiled FORMAT for the same text, and a
+// new one when the text at the same address has changed.
+static void TestCache() {
+  TestFormatContext context;
+  char format[]{"(I5,F9.7)"};
+  const CompiledFormat *first{
+      CompiledFormat::LookUpOrCreate(context, format, std::strlen(format))};
+  if (!first ||
+      CompiledFormat::LookUpOrCreate(context, format, std::strlen(format)) !=
+          first) {
+    std::cerr << "format cache miss\n";
+    ++failures;
+  }
+  for (char kind : {'E', 'G', 'D'}) {
+    format[4] = kind;
+    const CompiledFormat *changed{
+        CompiledFormat::LookUpOrCreate(context, format, std::strlen(format))};
+    if (!changed || changed == first ||
+        !changed->Matches(format, std::strlen(format))) {
+      std::cerr << "format cache did not replace a changed FORMAT\n";
+      ++failures;
+    }
+  }
 }
 
 int main() {
+  TestCache();
   Test(1, "('PI=',F9.7)", Results{"'PI='", "F9.7"});
   Test(1, "(3HPI=F9.7)", Results{"'PI='", "F9.7"});
   Test(1, "(3HPI=/F9.7)", Results{"'PI='", "/", "F9.7"});
@@ -146,5 +192,18 @@ int main() {
   Test(2, "(*('PI=',F9.7,:),'tooFar')",
       Results{"'PI='", "F9.7", "'PI='", "F9.7"});
   Test(1, "(3F9.7)", Results{"2*F9.7"}, 2);
+  Test(3, "(3F9.7)", Results{"2*F9.7", "F9.7", "/", "2*F9.7"}, 2);
+  Test(2, "(1X,I5,T10,ES12.4E3,2(TR2,A))",
+      Results{"1X", "I5", "T9", "ES12.4E3", "2X"});
+  Test(2, "(2(I3,TL1),'x',:,'y')", Results{"I3", "TL1", "I3", "TL1", "'x'"});
+  Test(1, "('it''s',A,3/)", Results{"'it''", "'s'", "A", "/", "/", "/"});
+  Test(1, "(e12.4e2, 1P, E12.4)", Results{"E12.4E2"});
+  Test(3, "(en12.4, ES12.4E3, EX12.4)",
+      Results{"EN12.4", "ES12.4E3", "EX12.4"});
+  Test(1, "(I5, Q)",
+      Results{"I5", "Crash:Unknown 'Q' edit descriptor in FORMAT"});
+  Test(1, "(I5, 'x)",
+      Results{"I5", "Crash:FORMAT missing closing quote on character literal"},
+      1, false);
   return failures > 0;
 }
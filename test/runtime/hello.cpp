@@ -2,8 +2,10 @@
 
 #include "../../runtime/descriptor.h"
 #include "../../runtime/io-api.h"
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <string>
 
 using namespace Fortran::runtime;
 using namespace Fortran::runtime::io;
@@ -82,6 +84,34 @@ static void multiline() {
   }
 }
 
+static void descriptorTest() {
+  char buffer[32];
+  std::int32_t matrix[3][2]{{1, 2}, {3, 4}, {5, 6}};
+  double vector[2]{0.5, 1.5};
+  StaticDescriptor<1> staticDescriptor[2];
+  Descriptor &row{staticDescriptor[0].descriptor()};
+  SubscriptValue extent[]{3};
+  row.Establish(TypeCategory::Integer, 4, &matrix, 1, extent);
+  row.raw().dim[0].sm = sizeof matrix[0];  // every other element
+  row.Check();
+  Descriptor &reals{staticDescriptor[1].descriptor()};
+  extent[0] = 2;
+  reals.Establish(TypeCategory::Real, 8, &vector, 1, extent);
+  reals.Check();
+  const char *format{"(3I2,1X,2F5.1)"};
+  auto cookie{IONAME(BeginInternalFormattedOutput)(
+      buffer, sizeof buffer, format, std::strlen(format))};
+  IONAME(OutputDescriptor)(cookie, row);
+  IONAME(OutputDescriptor)(cookie, reals);
+  if (auto status{IONAME(EndIoStatement)(cookie)}) {
+    std::cerr << "descriptorTest: '" << format << "' failed, status "
+              << static_cast<int>(status) << '\n';
+    ++failures;
+  } else {
+    test(format, " 1 3 5   0.5  1.5", std::string{buffer, sizeof buffer});
+  }
+}
+
 static void realTest(const char *format, double x, const char *expect) {
   char buffer[800];
   auto cookie{IONAME(BeginInternalFormattedOutput)(
@@ -96,9 +126,119 @@ static void realTest(const char *format, double x, const char *expect) {
   }
 }
 
+static void integerTest(
+    const char *format, std::int64_t n, const char *expect) {
+  char buffer[80];
+  auto cookie{IONAME(BeginInternalFormattedOutput)(
+      buffer, sizeof buffer, format, std::strlen(format))};
+  IONAME(OutputInteger64)(cookie, n);
+  if (auto status{IONAME(EndIoStatement)(cookie)}) {
+    std::cerr << '\'' << format << "' failed, status "
+              << static_cast<int>(status) << '\n';
+    ++failures;
+  } else {
+    test(format, expect, std::string{buffer, sizeof buffer});
+  }
+}
+
+static void realInTest(
+    const char *format, const char *data, std::uint64_t want) {
+  union {
+    double x;
+    std::uint64_t raw;
+  } u;
+  u.raw = 0;
+  auto cookie{IONAME(BeginInternalFormattedInput)(const_cast<char *>(data),
+      std::strlen(data), format, std::strlen(format))};
+  IONAME(InputReal64)(cookie, u.x);
+  if (auto status{IONAME(EndIoStatement)(cookie)}) {
+    std::cerr << '\'' << format << "' failed reading '" << data
+              << "', status " << static_cast<int>(status) << '\n';
+    ++failures;
+  } else if (u.raw != want) {
+    std::cerr << '\'' << format << "' failed reading '" << data
+              << "', want 0x" << std::hex << want << ", got 0x" << u.raw
+              << std::dec << '\n';
+    ++failures;
+  }
+}
+
+// Null values, repeat counts, delimited CHARACTER, COMPLEX, and a slash,
+// with array items read across the records of an internal array.
+static void listInputTest() {
+  static const char *data[2]{",1*,(5.,6.),'ab''c' T", "1 3*4 / 9"};
+  char records[2][24];
+  for (int j{0}; j < 2; ++j) {
+    std::memset(records[j], ' ', sizeof records[j]);
+    std::memcpy(records[j], data[j], std::strlen(data[j]));
+  }
+  StaticDescriptor<1> staticDescriptor[3];
+  Descriptor &internal{staticDescriptor[0].descriptor()};
+  SubscriptValue extent[]{2};
+  internal.Establish(TypeCode{CFI_type_char}, sizeof records[0], &records, 1,
+      extent, CFI_attribute_pointer);
+  std::int64_t null[2]{-1, -1};
+  double z[2]{0, 0};
+  char str[6];
+  bool truth{false};
+  std::int32_t n[6]{-1, -1, -1, -1, -1, -1};
+  Descriptor &complex{staticDescriptor[1].descriptor()};
+  complex.Establish(TypeCategory::Complex, 8, &z, 0);
+  Descriptor &array{staticDescriptor[2].descriptor()};
+  extent[0] = 6;
+  array.Establish(TypeCategory::Integer, 4, &n, 1, extent);
+  auto cookie{IONAME(BeginInternalArrayListInput)(internal)};
+  IONAME(InputInteger64)(cookie, null[0]);
+  IONAME(InputInteger64)(cookie, null[1]);
+  IONAME(InputDescriptor)(cookie, complex);
+  IONAME(InputAscii)(cookie, str, sizeof str);
+  IONAME(InputLogical)(cookie, truth);
+  IONAME(InputDescriptor)(cookie, array);
+  if (auto status{IONAME(EndIoStatement)(cookie)}) {
+    std::cerr << "listInputTest: failed, status " << static_cast<int>(status)
+              << '\n';
+    ++failures;
+  } else if (null[0] != -1 || null[1] != -1 || z[0] != 5 || z[1] != 6 ||
+      std::string{str, sizeof str} != "ab'c  " || !truth || n[0] != 1 ||
+      n[1] != 4 || n[2] != 4 || n[3] != 4 || n[4] != -1 || n[5] != -1) {
+    std::cerr << "listInputTest: wrong values\n";
+    ++failures;
+  }
+}
+
 int main() {
   hello();
   multiline();
+  descriptorTest();
+
+  // The most negative INTEGER(8) has no positive counterpart.
+  static constexpr std::int64_t most{-0x7fffffffffffffff - 1};
+  integerTest("(I0,';')", most, "-9223372036854775808;");
+  integerTest("(I20,';')", most, "-9223372036854775808;");
+  integerTest("(I19,';')", most, "*******************;");
+  integerTest("(I21,';')", most + 1, " -9223372036854775807;");
+  integerTest("(I21,';')", -(most + 1), "  9223372036854775807;");
+  integerTest("(I8.6,';')", 42, "  000042;");
+  integerTest("(I8.6,';')", -42, " -000042;");
+  integerTest("(I3.3,';')", -5, "***;");
+  integerTest("(I0.3,';')", 7, "007;");
+  integerTest("(I5.0,';')", 0, "     ;");
+  integerTest("(I0,';')", 0, "0;");
+  integerTest("(B8,';')", 5, "     101;");
+  integerTest("(B2,';')", 5, "**;");
+  integerTest("(B8.6,';')", 5, "  000101;");
+  integerTest("(B0,';')", 0, "0;");
+  integerTest("(B64,';')", most,
+      "1000000000000000000000000000000000000000000000000000000000000000;");
+  integerTest("(O22,';')", most, "1000000000000000000000;");
+  integerTest("(O21,';')", -(most + 1), "777777777777777777777;");
+  integerTest("(O0,';')", 8, "10;");
+  integerTest("(Z16,';')", -(most + 1), "7FFFFFFFFFFFFFFF;");
+  integerTest("(Z15,';')", most, "***************;");
+  integerTest("(Z4.3,';')", 255, " 0FF;");
+  integerTest("(Z0,';')", 0xfeedface, "FEEDFACE;");
+  integerTest("(Z0,';')", most, "8000000000000000;");
+  integerTest("(SP,I0,';')", 0, "+0;");
 
   static const char *zeroes[][2]{
       {"(E32.17,';')", "         0.00000000000000000E+00;"},
@@ -382,6 +522,56 @@ int main() {
       "4040261841248583680000+306;");
   realTest("(G0,';')", u.d, ".17976931348623157+309;");
 
+  realInTest("(F18.0)", "                 0", 0x0);
+  realInTest("(F18.0)", "                  ", 0x0);
+  realInTest("(F18.0)", "                -0", 0x8000000000000000);
+  realInTest("(F18.0)", "                01", 0x3ff0000000000000);
+  realInTest("(F18.0)", "                 1", 0x3ff0000000000000);
+  realInTest("(F18.0)", "              125.", 0x405f400000000000);
+  realInTest("(F18.0)", "              12.5", 0x4029000000000000);
+  realInTest("(F18.0)", "              1.25", 0x3ff4000000000000);
+  realInTest("(F18.0)", "             01.25", 0x3ff4000000000000);
+  realInTest("(F18.0)", "              .125", 0x3fc0000000000000);
+  realInTest("(F18.0)", "             0.125", 0x3fc0000000000000);
+  realInTest("(F18.0)", "             .0625", 0x3fb0000000000000);
+  realInTest("(F18.0)", "            0.0625", 0x3fb0000000000000);
+  realInTest("(F18.0)", "               125", 0x405f400000000000);
+  realInTest("(F18.1)", "               125", 0x4029000000000000);
+  realInTest("(F18.2)", "               125", 0x3ff4000000000000);
+  realInTest("(F18.3)", "               125", 0x3fc0000000000000);
+  realInTest("(-1P,F18.0)", "              125", 0x4093880000000000);
+  realInTest("(1P,F18.0)", "               125", 0x4029000000000000);
+  realInTest("(1P,E18.0)", "            125e+0", 0x405f400000000000);
+  realInTest("(F18.0)", "            1.25e2", 0x405f400000000000);
+  realInTest("(F18.0)", "            1.25d2", 0x405f400000000000);
+  realInTest("(F18.0)", "            1.25+2", 0x405f400000000000);
+  realInTest("(F18.0)", "          1.25 E 2", 0x405f400000000000);
+  realInTest("(BZ,F18.0)", "              125 ", 0x4093880000000000);
+  realInTest("(DC,F18.0)", "              12,5", 0x4029000000000000);
+  realInTest("(F18.0)", "               Inf", 0x7ff0000000000000);
+  realInTest("(F18.0)", "         -Infinity", 0xfff0000000000000);
+  // Wide fields padded with blanks, which become zeros under BZ
+  std::string padded{"   1.5" + std::string(294, ' ')};
+  realInTest("(F300.2)", padded.c_str(), 0x3ff8000000000000);
+  realInTest("(BZ,F300.2)", padded.c_str(), 0x3ff8000000000000);
+  std::string leading{std::string(297, ' ') + "1.5"};
+  realInTest("(F300.2)", leading.c_str(), 0x3ff8000000000000);
+  realInTest("(BZ,F300.2)", leading.c_str(), 0x3ff8000000000000);
+  std::string hundreds{std::string(297, ' ') + "1  "};
+  realInTest("(BZ,F300.0)", hundreds.c_str(), 0x4059000000000000);
+  // More significant digits than are converted, which are truncated
+  std::string ninths{"0." + std::string(400, '1')};
+  realInTest("(F402.0)", ninths.c_str(), 0x3fbc71c71c71c71c);
+  std::string thirds(300, '3');
+  realInTest("(F300.0)", thirds.c_str(), 0x7e1fdafb60009cd0);
+  // 2**53+1, a tie, rounds up only when a dropped digit is nonzero
+  std::string tie{"9007199254740993." + std::string(300, '0')};
+  realInTest("(F317.0)", tie.c_str(), 0x4340000000000000);
+  tie += '1';
+  realInTest("(F318.0)", tie.c_str(), 0x4340000000000001);
+
+  listInputTest();
+
   if (failures == 0) {
     std::cout << "PASS\n";
   } else {
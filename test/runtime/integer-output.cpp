@@ -0,0 +1,117 @@
+// Microbenchmarks of INTEGER output editing, one for each edit
+// descriptor and for list-directed output.  Each writes arrays of many
+// items with internal WRITE statements, so that one repeated edit
+// descriptor serves them all, and reports items per second; the results
+// are checked against the C library's formatting.  The values are
+// nonnegative, since B, O, and Z editing of negative values is not
+// what is being measured here.
+// Usage: integer-output [items per test]
+
+#include "../../runtime/descriptor.h"
+#include "../../runtime/io-api.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Fortran::runtime;
+using namespace Fortran::runtime::io;
+
+static constexpr int itemsPerStatement{1000};
+static int failures{0};
+
+static std::string Binary(std::uint64_t n) {
+  std::string result;
+  do {
+    result.insert(result.begin(), '0' + (n & 1));
+    n >>= 1;
+  } while (n > 0);
+  return std::string(std::max<int>(0, 64 - result.size()), ' ') + result;
+}
+
+// The expected output of one item
+static std::string Expect(char descriptor, std::int64_t n) {
+  char buffer[80];
+  auto in{static_cast<std::intmax_t>(n)};
+  auto un{static_cast<std::uintmax_t>(n)};
+  switch (descriptor) {
+  case 'I': std::snprintf(buffer, sizeof buffer, "%21jd", in); return buffer;
+  case 'B': return Binary(un);
+  case 'O': std::snprintf(buffer, sizeof buffer, "%22jo", un); return buffer;
+  case 'Z': std::snprintf(buffer, sizeof buffer, "%16jX", un); return buffer;
+  default: std::snprintf(buffer, sizeof buffer, " %jd", in); return buffer;
+  }
+}
+
+// Returns items per second
+static double Run(char descriptor, const char *format,
+    const std::vector<std::int64_t> &items) {
+  std::vector<char> record(itemsPerStatement * 80);
+  StaticDescriptor<1> staticDescriptor;
+  Descriptor &array{staticDescriptor.descriptor()};
+  std::string expect;
+  auto start{std::chrono::steady_clock::now()};
+  std::chrono::duration<double> elapsed{0};
+  for (std::size_t j{0}; j < items.size(); j += itemsPerStatement) {
+    SubscriptValue extent[]{static_cast<SubscriptValue>(
+        std::min<std::size_t>(itemsPerStatement, items.size() - j))};
+    array.Establish(TypeCategory::Integer, 8,
+        const_cast<std::int64_t *>(&items[j]), 1, extent);
+    Cookie cookie{format
+            ? IONAME(BeginInternalFormattedOutput)(record.data(), record.size(),
+                  format, std::strlen(format))
+            : IONAME(BeginInternalListOutput)(record.data(), record.size())};
+    IONAME(OutputDescriptor)(cookie, array);
+    IONAME(EndIoStatement)(cookie);
+    if (j == 0) {  // check the first record outside the timing
+      elapsed += std::chrono::steady_clock::now() - start;
+      expect.clear();
+      for (SubscriptValue k{0}; k < extent[0]; ++k) {
+        expect += Expect(descriptor, items[k]);
+      }
+      std::string got{record.data(), expect.size()};
+      if (got != expect) {
+        std::fprintf(stderr, "%s: got '%.70s...'\n  expected '%.70s...'\n",
+            format ? format : "list-directed", got.c_str(), expect.c_str());
+        ++failures;
+      }
+      start = std::chrono::steady_clock::now();
+    }
+  }
+  elapsed += std::chrono::steady_clock::now() - start;
+  return items.size() / elapsed.count();
+}
+
+int main(int argc, const char *argv[]) {
+  std::size_t count{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000};
+  std::mt19937_64 random{1};
+  std::vector<std::int64_t> small, large;
+  for (std::size_t j{0}; j < count; ++j) {
+    small.push_back(random() % 100000);
+    large.push_back(static_cast<std::int64_t>(random() >> 1));
+  }
+  static const struct {
+    char descriptor;
+    const char *name, *format;
+  } tests[]{
+      {'I', "I21", "(1000I21)"},
+      {'B', "B64", "(1000B64)"},
+      {'O', "O22", "(1000O22)"},
+      {'Z', "Z16", "(1000Z16)"},
+      {'L', "list-directed", nullptr},
+  };
+  std::printf("edit           small (items/s)   large (items/s)\n");
+  for (const auto &test : tests) {
+    double smallRate{Run(test.descriptor, test.format, small)};
+    double largeRate{Run(test.descriptor, test.format, large)};
+    std::printf("%-13s %16.0f  %16.0f\n", test.name, smallRate, largeRate);
+  }
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures);
+  }
+  return failures > 0;
+}
@@ -0,0 +1,99 @@
+// Benchmarks tight loops of short internal WRITE statements, like those
+// that build file names and keys, with and without a scratch area loaned
+// to the runtime, and counts the runtime's dynamic allocations per
+// statement.  The statements with a loaned scratch area of the
+// recommended size must not allocate at all.
+// Usage: internal-write [statements per test]
+
+#include "../../runtime/environment.h"
+#include "../../runtime/io-api.h"
+#include "../../runtime/memory.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Fortran::runtime;
+using namespace Fortran::runtime::io;
+
+static int failures{0};
+
+struct Result {
+  double statementsPerSecond;
+  double allocationsPerStatement;
+};
+
+// WRITE(buffer, format) 'file', n, '.dat' or, with no format,
+// WRITE(buffer, *) n, for n < 1000000
+static Result Run(const char *format, const char *expectFormat,
+    std::size_t count, bool useScratch) {
+  char buffer[32];
+  // Aligned to hold a pointer, as the API requires
+  void *scratch[RecommendedInternalIoScratchAreaBytes(1) / sizeof(void *)];
+  void **scratchArea{useScratch ? scratch : nullptr};
+  std::size_t scratchBytes{useScratch ? sizeof scratch : 0};
+  std::uint64_t before{GetMemoryUsage().allocations};
+  auto start{std::chrono::steady_clock::now()};
+  for (std::size_t j{0}; j < count; ++j) {
+    std::size_t n{j % 1000000};
+    Cookie cookie;
+    if (format) {
+      cookie = IONAME(BeginInternalFormattedOutput)(buffer, sizeof buffer,
+          format, std::strlen(format), scratchArea, scratchBytes);
+      IONAME(OutputAscii)(cookie, "file", 4);
+      IONAME(OutputInteger64)(cookie, n);
+      IONAME(OutputAscii)(cookie, ".dat", 4);
+    } else {
+      cookie = IONAME(BeginInternalListOutput)(
+          buffer, sizeof buffer, scratchArea, scratchBytes);
+      IONAME(OutputInteger64)(cookie, n);
+    }
+    IONAME(EndIoStatement)(cookie);
+    if (j == count / 2) {
+      char expect[sizeof buffer + 1];
+      std::snprintf(expect, sizeof expect, expectFormat, n);
+      std::size_t length{std::strlen(expect)};
+      if (std::memcmp(buffer, expect, length) != 0 ||
+          buffer[length] != ' ') {
+        std::fprintf(stderr, "%s: got '%.*s', expected '%s'\n",
+            format ? format : "list-directed", static_cast<int>(sizeof buffer),
+            buffer, expect);
+        ++failures;
+      }
+    }
+  }
+  std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start};
+  return {count / elapsed.count(),
+      static_cast<double>(GetMemoryUsage().allocations - before) / count};
+}
+
+int main(int argc, const char *argv[]) {
+  std::size_t count{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000};
+  executionEnvironment.memoryStatistics = true;  // to count allocations
+  static const struct {
+    const char *name, *format, *expect;
+  } tests[]{
+      {"(A,I0,A)", "(A,I0,A)", "file%zu.dat"},
+      {"(A,I6.6,A)", "(A,I6.6,A)", "file%06zd.dat"},
+      {"list-directed", nullptr, " %zu"},
+  };
+  std::printf("statement        heap: stmts/s allocs/stmt"
+              "   scratch: stmts/s allocs/stmt\n");
+  for (const auto &test : tests) {
+    Result heap{Run(test.format, test.expect, count, false)};
+    Result scratch{Run(test.format, test.expect, count, true)};
+    std::printf("%-14s %16.0f %11.2f %18.0f %11.2f\n", test.name,
+        heap.statementsPerSecond, heap.allocationsPerStatement,
+        scratch.statementsPerSecond, scratch.allocationsPerStatement);
+    if (scratch.allocationsPerStatement != 0) {
+      std::fprintf(stderr, "%s: allocated with a scratch area\n", test.name);
+      ++failures;
+    }
+  }
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures);
+  }
+  return failures > 0;
+}
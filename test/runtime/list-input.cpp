@@ -0,0 +1,129 @@
+// Throughput of list-directed READ statements from an external file of
+// blank-separated INTEGER or REAL values, several to a line.  Each file
+// is read once by a statement with one array item, which the runtime can
+// scan in place, and once by a statement with a scalar item for each
+// value; the values are checked against those that were written.
+// Usage: list-input [values per test]
+
+#include "../../runtime/descriptor.h"
+#include "../../runtime/io-api.h"
+#include "../../runtime/main.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Fortran::runtime;
+using namespace Fortran::runtime::io;
+
+static const char *fileName{"list-input.tmp"};
+static constexpr int unit{10};
+static int failures{0};
+
+template<typename A>
+static std::size_t WriteFile(const std::vector<A> &values, const char *format) {
+  std::FILE *fp{std::fopen(fileName, "w")};
+  if (!fp) {
+    std::perror(fileName);
+    std::exit(1);
+  }
+  for (std::size_t j{0}; j < values.size(); ++j) {
+    std::fprintf(fp, format, values[j]);
+    std::fputc(j % 8 == 7 ? '\n' : ' ', fp);
+  }
+  std::size_t bytes{static_cast<std::size_t>(std::ftell(fp))};
+  std::fclose(fp);
+  return bytes;
+}
+
+static void Open() {
+  Cookie cookie{IONAME(BeginOpenUnit)(unit)};
+  IONAME(SetFile)(cookie, fileName, std::strlen(fileName));
+  IONAME(SetAction)(cookie, "READ", 4);
+  IONAME(EndIoStatement)(cookie);
+}
+
+static void Close() {
+  IONAME(EndIoStatement)(IONAME(BeginClose)(unit));
+}
+
+// READ(unit, *) array or READ(unit, *) (array(j), j = 1, n);
+// returns the elapsed seconds
+template<TypeCategory CAT, typename A>
+static double Read(std::vector<A> &values, bool wholeArray) {
+  Open();
+  auto start{std::chrono::steady_clock::now()};
+  Cookie cookie{IONAME(BeginExternalListInput)(unit)};
+  if (wholeArray) {
+    StaticDescriptor<1> staticDescriptor;
+    Descriptor &array{staticDescriptor.descriptor()};
+    SubscriptValue extent[]{static_cast<SubscriptValue>(values.size())};
+    array.Establish(CAT, sizeof(A), values.data(), 1, extent);
+    IONAME(InputDescriptor)(cookie, array);
+  } else {
+    for (A &x : values) {
+      if constexpr (CAT == TypeCategory::Integer) {
+        IONAME(InputInteger64)(cookie, x);
+      } else {
+        IONAME(InputReal64)(cookie, x);
+      }
+    }
+  }
+  if (auto status{IONAME(EndIoStatement)(cookie)}) {
+    std::fprintf(stderr, "READ failed, status %d\n", status);
+    ++failures;
+  }
+  std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start};
+  Close();
+  return elapsed.count();
+}
+
+template<TypeCategory CAT, typename A>
+static void Report(
+    const char *name, const std::vector<A> &values, const char *format) {
+  double megabytes{WriteFile(values, format) / 1.0e6};
+  double rate[2];
+  for (int wholeArray{0}; wholeArray < 2; ++wholeArray) {
+    std::vector<A> got(values.size(), 0);
+    rate[wholeArray] = megabytes / Read<CAT>(got, wholeArray);
+    for (std::size_t j{0}; j < values.size(); ++j) {
+      if (got[j] != values[j]) {
+        std::fprintf(stderr, "%s: value %zd is wrong\n", name, j);
+        ++failures;
+        break;
+      }
+    }
+  }
+  std::printf("%-22s %8.1f MB/s %12.1f MB/s\n", name, rate[1], rate[0]);
+}
+
+int main(int argc, const char *argv[]) {
+  RTNAME(ProgramStart)(argc, argv, nullptr);
+  std::size_t count{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000};
+  std::mt19937_64 random{1};
+  std::uniform_real_distribution<double> distribution{-1000.0, 1000.0};
+  std::vector<std::int64_t> small, large;
+  std::vector<double> fixed, roundTrip;
+  for (std::size_t j{0}; j < count; ++j) {
+    small.push_back(static_cast<std::int64_t>(random() % 200000) - 100000);
+    large.push_back(static_cast<std::int64_t>(random()));
+    fixed.push_back(std::strtod(
+        std::to_string(distribution(random)).c_str(), nullptr));
+    roundTrip.push_back(distribution(random));
+  }
+  std::printf("values                  array item     scalar items\n");
+  Report<TypeCategory::Integer>("INTEGER(8) small", small, "%" PRId64);
+  Report<TypeCategory::Integer>("INTEGER(8) large", large, "%" PRId64);
+  Report<TypeCategory::Real>("REAL(8) 6 places", fixed, "%.6f");
+  Report<TypeCategory::Real>("REAL(8) 17 digits", roundTrip, "%.17g");
+  std::remove(fileName);
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures);
+  }
+  return failures > 0;
+}
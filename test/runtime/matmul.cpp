@@ -0,0 +1,141 @@
+// Benchmark of MATMUL and TRANSPOSE: square products of REAL(4), REAL(8),
+// and COMPLEX(8) matrices, a product of a matrix and a vector, and a
+// product with FORT_MATMUL_THREADS threads are reported in GFLOP/s along
+// with a reference triple loop in the usual j, p, i order whose results
+// they must match; TRANSPOSE is reported in GB/s against a plain loop.
+// Usage: matmul [extent [repetitions [threads]]]
+
+#include "benchmark.h"
+#include "../../runtime/descriptor.h"
+#include "../../runtime/environment.h"
+#include "../../runtime/matmul.h"
+#include "../../runtime/transformational.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+using namespace Fortran::runtime;
+using Fortran::common::TypeCategory;
+
+static int failures{0};
+
+// Element values for the matrices, in [-1, 1)
+static double Fill(std::size_t j) {
+  return static_cast<double>((j * 7919) % 1000) / 500 - 1;
+}
+
+template<typename T> static const T *Data(const Descriptor &x) {
+  return x.Element<T>(std::size_t{0});
+}
+
+// c(rows, columns) = a(rows, depth) * b(depth, columns)
+template<typename T>
+static void Reference(T *c, const T *a, const T *b, std::size_t rows,
+    std::size_t depth, std::size_t columns) {
+  for (std::size_t j{0}; j < columns; ++j) {
+    for (std::size_t i{0}; i < rows; ++i) {
+      c[i + j * rows] = T{0};
+    }
+    for (std::size_t p{0}; p < depth; ++p) {
+      T bpj{b[p + j * depth]};
+      for (std::size_t i{0}; i < rows; ++i) {
+        c[i + j * rows] += a[i + p * rows] * bpj;
+      }
+    }
+  }
+}
+
+// Reports the GFLOP/s of MATMUL(a, b) and the reference loop, and
+// compares their results.
+template<typename T>
+static void Run(const char *what, const Descriptor &a, const Descriptor &b,
+    int repetitions) {
+  std::size_t rows{static_cast<std::size_t>(a.GetDimension(0).Extent())};
+  std::size_t depth{static_cast<std::size_t>(b.GetDimension(0).Extent())};
+  std::size_t columns{b.rank() == 2
+          ? static_cast<std::size_t>(b.GetDimension(1).Extent())
+          : 1};
+  std::unique_ptr<T[]> expect{new T[rows * columns]};
+  std::unique_ptr<Descriptor> result;
+  double referenceSeconds{BestSeconds(repetitions, [&]() {
+    Reference(expect.get(), Data<T>(a), Data<T>(b), rows, depth, columns);
+  })};
+  double matmulSeconds{
+      BestSeconds(repetitions, [&]() { result = MATMUL(a, b); })};
+  for (std::size_t j{0}; j < rows * columns; ++j) {
+    T x{expect[j]}, y{Data<T>(*result)[j]};
+    if (std::abs(x - y) > 1e-3 * std::max<double>(1, std::abs(x))) {
+      std::fprintf(stderr, "%s: result %zd differs\n", what, j);
+      ++failures;
+      break;
+    }
+  }
+  double flops{2.0 * rows * depth * columns};
+  if constexpr (!std::is_floating_point_v<T>) {
+    flops *= 4;  // a complex multiply-add is four
+  }
+  std::printf("%-28s %10.3f %8.2f %10.3f %8.2f %7.1fx\n", what,
+      referenceSeconds * 1e3, flops / referenceSeconds * 1e-9,
+      matmulSeconds * 1e3, flops / matmulSeconds * 1e-9,
+      referenceSeconds / matmulSeconds);
+}
+
+int main(int argc, const char *argv[]) {
+  SubscriptValue n{argc > 1 ? std::atoi(argv[1]) : 512};
+  int repetitions{argc > 2 ? std::atoi(argv[2]) : 3};
+  std::size_t threads{argc > 3 ? std::atoi(argv[3]) : 4u};
+  SubscriptValue extent[]{n, n};
+  auto r8a{MakeArray<double>(TypeCategory::Real, 2, extent, Fill)};
+  auto r8b{MakeArray<double>(TypeCategory::Real, 2, extent, Fill)};
+  auto r4a{MakeArray<float>(TypeCategory::Real, 2, extent, Fill)};
+  auto r4b{MakeArray<float>(TypeCategory::Real, 2, extent, Fill)};
+  auto c8a{MakeArray<std::complex<double>>(
+      TypeCategory::Complex, 2, extent, Fill)};
+  auto c8b{MakeArray<std::complex<double>>(
+      TypeCategory::Complex, 2, extent, Fill)};
+  SubscriptValue vectorExtent{n};
+  auto r8v{MakeArray<double>(TypeCategory::Real, 1, &vectorExtent, Fill)};
+
+  std::printf("%-28s %10s %8s %10s %8s %8s\n", "case", "loop (ms)",
+      "GFLOP/s", "MATMUL", "GFLOP/s", "speedup");
+  Run<double>("MATMUL real(8)", *r8a, *r8b, repetitions);
+  Run<float>("MATMUL real(4)", *r4a, *r4b, repetitions);
+  Run<std::complex<double>>("MATMUL complex(8)", *c8a, *c8b, repetitions);
+  Run<double>("MATMUL real(8) x vector", *r8a, *r8v, repetitions);
+  executionEnvironment.matmulThreads = threads;
+  char label[64];
+  std::snprintf(label, sizeof label, "MATMUL real(8), %zd threads", threads);
+  Run<double>(label, *r8a, *r8b, repetitions);
+  executionEnvironment.matmulThreads = 0;
+
+  std::size_t elements{static_cast<std::size_t>(n * n)};
+  std::unique_ptr<double[]> expect{new double[elements]};
+  const double *x{Data<double>(*r8a)};
+  double loopSeconds{BestSeconds(repetitions, [&]() {
+    for (SubscriptValue j{0}; j < n; ++j) {
+      for (SubscriptValue i{0}; i < n; ++i) {
+        expect[j + i * n] = x[i + j * n];
+      }
+    }
+  })};
+  std::unique_ptr<Descriptor> transposed;
+  double transposeSeconds{
+      BestSeconds(repetitions, [&]() { transposed = TRANSPOSE(*r8a); })};
+  if (!std::equal(expect.get(), expect.get() + elements,
+          Data<double>(*transposed))) {
+    std::fprintf(stderr, "TRANSPOSE differs\n");
+    ++failures;
+  }
+  double bytes{2.0 * elements * sizeof(double)};
+  std::printf("%-28s %10.3f %8.2f %10.3f %8.2f %7.1fx  (GB/s)\n",
+      "TRANSPOSE real(8)", loopSeconds * 1e3, bytes / loopSeconds * 1e-9,
+      transposeSeconds * 1e3, bytes / transposeSeconds * 1e-9,
+      loopSeconds / transposeSeconds);
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures);
+  }
+  return failures > 0;
+}
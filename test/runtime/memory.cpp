@@ -0,0 +1,103 @@
+// Tests the runtime's allocator: the reuse of small blocks through the
+// per-thread caches, blocks freed by other threads, the alignment of
+// array data from Descriptor::Allocate() and CFI_allocate(), and the
+// live and peak bytes counted for FORT_MEMORY_STATS.
+
+#include "../../runtime/descriptor.h"
+#include "../../runtime/environment.h"
+#include "../../runtime/memory.h"
+#include "../../runtime/terminator.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+
+using namespace Fortran::runtime;
+using Fortran::common::TypeCategory;
+
+static int failures{0};
+
+static void Check(bool ok, const char *what) {
+  if (!ok) {
+    std::fprintf(stderr, "FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+static bool IsAligned(const void *p, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+static void *AllocateAndFill(void *arg) {
+  Terminator terminator{__FILE__, __LINE__};
+  auto **blocks{static_cast<void **>(arg)};
+  for (int j{0}; j < 100; ++j) {
+    blocks[j] = AllocateMemoryOrCrash(terminator, 8 + j * 40);
+    std::memset(blocks[j], j, 8 + j * 40);
+  }
+  return nullptr;
+}
+
+int main() {
+  Terminator terminator{__FILE__, __LINE__};
+  executionEnvironment.memoryStatistics = true;
+
+  // A freed small block is reused for a block of the same size class.
+  void *p{AllocateMemoryOrCrash(terminator, 40)};
+  Check(IsAligned(p, 16), "small block alignment");
+  FreeMemory(p);
+  void *q{AllocateMemoryOrCrash(terminator, 60)};
+  Check(p == q, "reuse of a cached block");
+  void *r{AllocateMemoryOrCrash(terminator, 100000)};
+  std::memset(r, 0, 100000);
+  MemoryUsage usage{GetMemoryUsage()};
+  Check(usage.liveBytes == 100060, "live bytes");
+  Check(usage.liveBlocks == 2, "live blocks");
+  FreeMemory(q);
+  FreeMemory(r);
+  usage = GetMemoryUsage();
+  Check(usage.liveBytes == 0 && usage.liveBlocks == 0, "nothing live");
+  Check(usage.peakBytes >= 100060, "peak bytes");
+  FreeMemory(nullptr);
+
+  // Blocks allocated by another thread, which has exited, are freed here.
+  void *blocks[100];
+  pthread_t thread;
+  Check(::pthread_create(&thread, nullptr, AllocateAndFill, blocks) == 0,
+      "pthread_create");
+  ::pthread_join(thread, nullptr);
+  for (int j{0}; j < 100; ++j) {
+    auto *bytes{static_cast<const unsigned char *>(blocks[j])};
+    Check(bytes[0] == j && bytes[7 + j * 40] == j, "block of another thread");
+    FreeMemory(blocks[j]);
+  }
+  Check(GetMemoryUsage().liveBlocks == 0, "blocks of another thread freed");
+
+  // Array data are aligned to 64 bytes by default, else as configured.
+  for (std::size_t alignment : {std::size_t{0}, std::size_t{256}}) {
+    executionEnvironment.arrayAlignment = alignment;
+    for (SubscriptValue n : {1, 3, 17, 1000}) {
+      SubscriptValue extent[]{n, 2};
+      auto array{Descriptor::Create(TypeCategory::Real, 8, nullptr, 2, extent,
+          CFI_attribute_allocatable)};
+      SubscriptValue lb[]{1, 1}, ub[]{n, 2};
+      Check(array->Allocate(lb, ub, 8) == CFI_SUCCESS, "Allocate");
+      Check(IsAligned(array->raw().base_addr,
+                alignment ? alignment : defaultArrayAlignment),
+          "array data alignment");
+      std::memset(array->raw().base_addr, 0, 16 * n);
+      Check(array->Deallocate() == CFI_SUCCESS, "Deallocate");
+    }
+  }
+  executionEnvironment.arrayAlignment = 0;
+  usage = GetMemoryUsage();
+  Check(usage.liveBytes == 0 && usage.liveBlocks == 0,
+      "descriptors and array data freed");
+
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures);
+  } else {
+    ReportMemoryStatistics();
+  }
+  return failures > 0;
+}
@@ -0,0 +1,118 @@
+// Benchmark of OPEN/WRITE/CLOSE cycles on scratch files, as made by
+// programs that open and close many files.  Each of N threads repeatedly
+// opens a file with NEWUNIT=, writes a few records, and closes it with
+// STATUS='DELETE'; cycles per second are reported for increasing N, and
+// for files opened on fixed unit numbers.  NEWUNIT= numbers must be
+// recycled: the most negative number handed out may not exceed the
+// number of threads.  Closed units, and the storage of the unit map,
+// must be freed: few more blocks may be live at the end than after the
+// first cycle.
+// Usage: open-close [cycles per thread [max threads]]
+
+#include "../../runtime/environment.h"
+#include "../../runtime/io-api.h"
+#include "../../runtime/main.h"
+#include "../../runtime/memory.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Fortran::runtime;
+using namespace Fortran::runtime::io;
+
+static std::atomic<int> lowestNewUnit{0};
+static std::atomic<int> failures{0};
+
+static int Open(int thread, int fixedUnit) {
+  std::string path{"/tmp/open-close-" + std::to_string(thread) + ".txt"};
+  Cookie io{fixedUnit > 0 ? IONAME(BeginOpenUnit)(fixedUnit)
+                          : IONAME(BeginOpenNewUnit)()};
+  IONAME(SetFile)(io, path.data(), path.size());
+  IONAME(SetStatus)(io, "REPLACE", 7);
+  IONAME(SetAction)(io, "WRITE", 5);
+  int unit{fixedUnit};
+  if (fixedUnit <= 0) {
+    IONAME(GetNewUnit)(io, unit);
+  }
+  if (IONAME(EndIoStatement)(io) != 0) {
+    ++failures;
+  }
+  return unit;
+}
+
+static void Cycles(int thread, int cycles, bool newUnit) {
+  int lowest{0};
+  for (int j{0}; j < cycles; ++j) {
+    int unit{Open(thread, newUnit ? 0 : 10 + thread)};
+    lowest = std::min(lowest, unit);
+    for (int k{0}; k < 4; ++k) {
+      Cookie io{IONAME(BeginExternalListOutput)(unit)};
+      IONAME(OutputInteger64)(io, j);
+      IONAME(OutputAscii)(io, "abcdefghijklmnopqrstuvwxyz", 26);
+      IONAME(EndIoStatement)(io);
+    }
+    Cookie io{IONAME(BeginClose)(unit)};
+    IONAME(SetStatus)(io, "DELETE", 6);
+    if (IONAME(EndIoStatement)(io) != 0) {
+      ++failures;
+    }
+  }
+  int was{lowestNewUnit.load()};
+  while (lowest < was && !lowestNewUnit.compare_exchange_weak(was, lowest)) {
+  }
+}
+
+// Returns cycles per second
+static double Run(int threads, int cycles, bool newUnit) {
+  auto start{std::chrono::steady_clock::now()};
+  std::vector<std::thread> workers;
+  for (int t{0}; t < threads; ++t) {
+    workers.emplace_back(Cycles, t, cycles, newUnit);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start};
+  return threads * static_cast<double>(cycles) / elapsed.count();
+}
+
+int main(int argc, const char *argv[], const char *envp[]) {
+  RTNAME(ProgramStart)(argc, argv, envp);
+  int cycles{argc > 1 ? std::atoi(argv[1]) : 20000};
+  int maxThreads{argc > 2 ? std::atoi(argv[2]) : 4};
+  executionEnvironment.memoryStatistics = true;
+  Run(1, 1, true);
+  std::uint64_t liveBlocks{GetMemoryUsage().liveBlocks};
+  std::printf("threads  NEWUNIT= (cycles/s)  UNIT= (cycles/s)\n");
+  for (int threads{1}; threads <= maxThreads; threads *= 2) {
+    double newUnit{Run(threads, cycles, true)};
+    double fixed{Run(threads, cycles, false)};
+    std::printf("%7d  %19.0f  %16.0f\n", threads, newUnit, fixed);
+  }
+  Run(1, 1, true);  // frees what remains of other threads' units
+  std::uint64_t moreBlocks{GetMemoryUsage().liveBlocks - liveBlocks};
+  std::printf(
+      "more live blocks: %ju\n", static_cast<std::uintmax_t>(moreBlocks));
+  if (moreBlocks > 64) {
+    std::fprintf(stderr, "closed units were not freed\n");
+    ++failures;
+  }
+  // NEWUNIT= numbers begin at -1001.
+  int distinct{-1000 - lowestNewUnit.load()};
+  std::printf("distinct NEWUNIT= numbers: %d\n", distinct);
+  if (distinct > maxThreads) {
+    std::fprintf(stderr, "NEWUNIT= numbers were not recycled\n");
+    ++failures;
+  }
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures.load());
+  }
+  return failures > 0;
+}
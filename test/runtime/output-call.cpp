@@ -0,0 +1,102 @@
+// Microbenchmark of the per-call cost of the scalar output data transfer
+// calls OutputInteger64 and OutputReal64, as made for each item of a
+// WRITE statement's output list.  Small values and narrow fields keep
+// the numeric conversions cheap, so that the time measured is mostly
+// that of the calls themselves: fetching the data edit descriptor and
+// emitting the blanks, signs, digits, and zeroes of the field.  Internal
+// and external (formatted and list-directed) statements are measured;
+// the results are reported in nanoseconds per call.
+// Usage: output-call [calls per test]
+
+#include "../../runtime/io-api.h"
+#include "../../runtime/main.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Fortran::runtime::io;
+
+static const char *fileName{"output-call.tmp"};
+static constexpr int unit{10};
+static constexpr int itemsPerStatement{100};
+static int failures{0};
+
+enum class Item { Integer, Real };
+
+static Cookie Begin(
+    bool external, const char *format, std::vector<char> &record) {
+  if (external) {
+    return format ? IONAME(BeginExternalFormattedOutput)(
+                        format, std::strlen(format), unit)
+                  : IONAME(BeginExternalListOutput)(unit);
+  }
+  return format ? IONAME(BeginInternalFormattedOutput)(
+                      record.data(), record.size(), format, std::strlen(format))
+                : IONAME(BeginInternalListOutput)(record.data(), record.size());
+}
+
+// Returns nanoseconds per call
+static double Run(Item item, bool external, const char *format,
+    const char *expect, std::size_t calls) {
+  std::vector<char> record(itemsPerStatement * 40);
+  auto start{std::chrono::steady_clock::now()};
+  for (std::size_t j{0}; j < calls; j += itemsPerStatement) {
+    Cookie cookie{Begin(external, format, record)};
+    for (int k{0}; k < itemsPerStatement; ++k) {
+      if (item == Item::Integer) {
+        IONAME(OutputInteger64)(cookie, -k);
+      } else {
+        IONAME(OutputReal64)(cookie, -0.5 * (k + 1));
+      }
+    }
+    IONAME(EndIoStatement)(cookie);
+  }
+  std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start};
+  if (!external && std::strncmp(record.data(), expect, std::strlen(expect))) {
+    std::fprintf(stderr, "%s: got '%.40s', expected '%s'\n",
+        format ? format : "list-directed", record.data(), expect);
+    ++failures;
+  }
+  return 1.0e9 * elapsed.count() / calls;
+}
+
+int main(int argc, const char *argv[]) {
+  RTNAME(ProgramStart)(argc, argv, nullptr);
+  std::size_t calls{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000000};
+  Cookie cookie{IONAME(BeginOpenUnit)(unit)};
+  IONAME(SetFile)(cookie, fileName, std::strlen(fileName));
+  IONAME(SetStatus)(cookie, "REPLACE", 7);
+  IONAME(SetAction)(cookie, "WRITE", 5);
+  IONAME(EndIoStatement)(cookie);
+  static const struct {
+    Item item;
+    const char *name, *format, *expect;
+  } tests[]{
+      {Item::Integer, "I8", "(100I8)", "       0      -1      -2"},
+      {Item::Integer, "I8.4", "(100I8.4)", "    0000   -0001   -0002"},
+      {Item::Integer, "list-directed", nullptr, " 0 -1 -2"},
+      {Item::Real, "F8.2", "(100F8.2)", "   -0.50   -1.00   -1.50"},
+      {Item::Real, "E12.3", "(100E12.3)", "  -0.500E+00  -0.100E+01"},
+      {Item::Real, "list-directed", nullptr, " -.5 -1. -1.5"},
+  };
+  std::printf("item                       internal (ns)   external (ns)\n");
+  for (const auto &test : tests) {
+    double internal{Run(test.item, false, test.format, test.expect, calls)};
+    double external{Run(test.item, true, test.format, test.expect, calls)};
+    std::printf("%-10s %-13s %15.1f %15.1f\n",
+        test.item == Item::Integer ? "INTEGER(8)" : "REAL(8)", test.name,
+        internal, external);
+  }
+  cookie = IONAME(BeginClose)(unit);
+  IONAME(SetStatus)(cookie, "DELETE", 6);
+  IONAME(EndIoStatement)(cookie);
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures);
+  }
+  return failures > 0;
+}
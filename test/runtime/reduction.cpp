@@ -0,0 +1,178 @@
+// Benchmark of the array reductions on large arrays: whole-array SUM,
+// MAXVAL, COUNT, and DOT_PRODUCT; SUM along each dimension of a rank-2
+// array; SUM with a MASK=; and SUM of a section that is not contiguous.
+// Each result is compared with that of a reference loop over one element
+// at a time, whose time is also reported along with the bandwidth of both.
+// Usage: reduction [extent of rank-2 arrays [repetitions]]
+
+#include "benchmark.h"
+#include "../../runtime/descriptor.h"
+#include "../../runtime/reduction.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+using namespace Fortran::runtime;
+using Fortran::common::TypeCategory;
+
+static int failures{0};
+
+// Element values for the arrays, truncated for INTEGER
+static double Fill(std::size_t j) { return ((j * 7919) % 1000) / 8.0; }
+
+// Reports the times of a reduction and its reference, which produce n
+// results into arrays, and compares the results.
+template<typename T, typename REFERENCE, typename REDUCTION>
+static void Run(const char *what, std::size_t bytes, std::size_t n,
+    int repetitions, REFERENCE reference, REDUCTION reduction) {
+  std::unique_ptr<T[]> expect{new T[n]};
+  std::unique_ptr<Descriptor> result;
+  double referenceSeconds{
+      BestSeconds(repetitions, [&]() { reference(expect.get()); })};
+  double reductionSeconds{
+      BestSeconds(repetitions, [&]() { result = reduction(); })};
+  for (std::size_t j{0}; j < n; ++j) {
+    double x{static_cast<double>(expect[j])};
+    double y{static_cast<double>(*result->Element<T>(j * sizeof(T)))};
+    if (std::abs(x - y) > 1e-9 * std::max(1.0, std::abs(x))) {
+      std::fprintf(stderr, "%s: result %zd is %.17g, expected %.17g\n",
+          what, j, y, x);
+      ++failures;
+      break;
+    }
+  }
+  std::printf("%-28s %10.3f %8.2f %10.3f %8.2f %7.1fx\n", what,
+      referenceSeconds * 1e3, bytes / referenceSeconds * 1e-9,
+      reductionSeconds * 1e3, bytes / reductionSeconds * 1e-9,
+      referenceSeconds / reductionSeconds);
+}
+
+int main(int argc, const char *argv[]) {
+  SubscriptValue n{argc > 1 ? std::atoi(argv[1]) : 2048};
+  int repetitions{argc > 2 ? std::atoi(argv[2]) : 5};
+  SubscriptValue extent[]{n, n};
+  std::size_t elements{static_cast<std::size_t>(n * n)};
+  auto r8{MakeArray<double>(TypeCategory::Real, 2, extent, Fill)};
+  auto r4{MakeArray<float>(TypeCategory::Real, 2, extent, Fill)};
+  auto i4{MakeArray<std::int32_t>(TypeCategory::Integer, 2, extent, Fill)};
+  const double *x8{r8->Element<double>(std::size_t{0})};
+  const float *x4{r4->Element<float>(std::size_t{0})};
+  const std::int32_t *xi{i4->Element<std::int32_t>(std::size_t{0})};
+  // LOGICAL(4) MASK=, true when the integer element is even
+  auto mask{MakeArray<std::int32_t>(TypeCategory::Integer, 2, extent, Fill)};
+  std::int32_t *m{mask->Element<std::int32_t>(std::size_t{0})};
+  for (std::size_t j{0}; j < elements; ++j) {
+    m[j] = xi[j] % 2 == 0;
+  }
+
+  std::printf("%-28s %10s %8s %10s %8s %8s\n", "case", "loop (ms)", "GB/s",
+      "intrinsic", "GB/s", "speedup");
+  Run<double>("SUM real(8)", elements * 8, 1, repetitions,
+      [&](double *to) {
+        double sum{0};
+        for (std::size_t j{0}; j < elements; ++j) {
+          sum += x8[j];
+        }
+        *to = sum;
+      },
+      [&]() { return SUM(*r8); });
+  Run<std::int32_t>("SUM integer(4)", elements * 4, 1, repetitions,
+      [&](std::int32_t *to) {
+        std::int32_t sum{0};
+        for (std::size_t j{0}; j < elements; ++j) {
+          sum += xi[j];
+        }
+        *to = sum;
+      },
+      [&]() { return SUM(*i4); });
+  Run<float>("MAXVAL real(4)", elements * 4, 1, repetitions,
+      [&](float *to) {
+        float max{-HUGE_VALF};
+        for (std::size_t j{0}; j < elements; ++j) {
+          max = std::max(max, x4[j]);
+        }
+        *to = max;
+      },
+      [&]() { return MAXVAL(*r4); });
+  Run<std::int32_t>("COUNT logical(4)", elements * 4, 1, repetitions,
+      [&](std::int32_t *to) {
+        std::int32_t count{0};
+        for (std::size_t j{0}; j < elements; ++j) {
+          count += m[j] != 0;
+        }
+        *to = count;
+      },
+      [&]() { return COUNT(*mask); });
+  StaticDescriptor<1> vectorDescriptor;
+  Descriptor &vector{vectorDescriptor.descriptor()};
+  SubscriptValue vectorExtent{static_cast<SubscriptValue>(elements)};
+  vector.Establish(TypeCategory::Real, 8, const_cast<double *>(x8), 1,
+      &vectorExtent, CFI_attribute_pointer);
+  Run<double>("DOT_PRODUCT real(8)", elements * 8, 1, repetitions,
+      [&](double *to) {
+        double sum{0};
+        for (std::size_t j{0}; j < elements; ++j) {
+          sum += x8[j] * x8[j];
+        }
+        *to = sum;
+      },
+      [&]() { return DOT_PRODUCT(vector, vector); });
+  Run<double>("SUM real(8), DIM=1", elements * 8, n, repetitions,
+      [&](double *to) {
+        for (SubscriptValue k{0}; k < n; ++k) {
+          double sum{0};
+          for (SubscriptValue j{0}; j < n; ++j) {
+            sum += x8[j + k * n];
+          }
+          to[k] = sum;
+        }
+      },
+      [&]() { return SUM(*r8, 1); });
+  Run<double>("SUM real(8), DIM=2", elements * 8, n, repetitions,
+      [&](double *to) {
+        for (SubscriptValue j{0}; j < n; ++j) {
+          double sum{0};
+          for (SubscriptValue k{0}; k < n; ++k) {
+            sum += x8[j + k * n];
+          }
+          to[j] = sum;
+        }
+      },
+      [&]() { return SUM(*r8, 2); });
+  Run<double>("SUM real(8), MASK=", elements * 12, 1, repetitions,
+      [&](double *to) {
+        double sum{0};
+        for (std::size_t j{0}; j < elements; ++j) {
+          if (m[j]) {
+            sum += x8[j];
+          }
+        }
+        *to = sum;
+      },
+      [&]() { return SUM(*r8, 0, mask.get()); });
+  StaticDescriptor<2> sectionDescriptor;
+  Descriptor &section{sectionDescriptor.descriptor()};
+  SubscriptValue sectionExtent[]{n / 2, n};
+  section.Establish(TypeCategory::Real, 8, const_cast<double *>(x8), 2,
+      sectionExtent, CFI_attribute_pointer);
+  section.raw().dim[0].sm *= 2;
+  section.raw().dim[1].sm *= 2;
+  Run<double>("SUM real(8) section(::2,:)", elements * 4, 1, repetitions,
+      [&](double *to) {
+        double sum{0};
+        for (SubscriptValue k{0}; k < n; ++k) {
+          for (SubscriptValue j{0}; j < n; j += 2) {
+            sum += x8[j + k * n];
+          }
+        }
+        *to = sum;
+      },
+      [&]() { return SUM(section); });
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures);
+  }
+  return failures > 0;
+}
@@ -0,0 +1,130 @@
+// Benchmark of RESHAPE on large rank-2 and rank-3 arrays of 1, 4, 8, and
+// 16-byte elements, with and without ORDER=, and from a SOURCE= that is
+// not contiguous.  Each result is compared with that of a reference
+// implementation that copies one element at a time, whose time is also
+// reported.
+// Usage: reshape [extent of rank-2 arrays [repetitions]]
+
+#include "benchmark.h"
+#include "../../runtime/descriptor.h"
+#include "../../runtime/transformational.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+using namespace Fortran::runtime;
+using Fortran::common::TypeCategory;
+
+static int failures{0};
+
+// The result of RESHAPE(source, extent, ORDER=order) with all of the
+// elements of source, one element at a time
+static std::unique_ptr<Descriptor> Reference(const Descriptor &source,
+    int rank, const SubscriptValue *extent, const int *order) {
+  std::unique_ptr<Descriptor> result{Descriptor::Create(source.type(),
+      source.ElementBytes(), nullptr, rank, extent,
+      CFI_attribute_allocatable)};
+  SubscriptValue ones[maxRank]{1, 1, 1};
+  result->Allocate(ones, extent, source.ElementBytes());
+  int dimOrder[maxRank];
+  for (int j{0}; j < rank; ++j) {
+    dimOrder[j] = order ? order[j] - 1 : j;
+  }
+  SubscriptValue resultSubscript[maxRank], sourceSubscript[maxRank];
+  result->GetLowerBounds(resultSubscript);
+  source.GetLowerBounds(sourceSubscript);
+  for (std::size_t n{result->Elements()}; n > 0; --n) {
+    std::memcpy(result->Element<void>(resultSubscript),
+        source.Element<const void>(sourceSubscript), source.ElementBytes());
+    source.IncrementSubscripts(sourceSubscript);
+    result->IncrementSubscripts(resultSubscript, dimOrder);
+  }
+  return result;
+}
+
+static std::unique_ptr<Descriptor> IntegerVector(
+    int n, const int *values, std::int32_t *data) {
+  SubscriptValue extent{n};
+  std::copy(values, values + n, data);
+  return Descriptor::Create(TypeCategory::Integer, 4, data, 1, &extent,
+      CFI_attribute_pointer);
+}
+
+// Reshapes an array of the given element size and extents into the same
+// shape, optionally permuted by ORDER=.  When stride > 1, SOURCE= is a
+// section with that stride in its first dimension.
+static void Run(const char *what, int kind, int rank,
+    const SubscriptValue *extent, const int *order, int stride,
+    int repetitions) {
+  SubscriptValue baseExtent[maxRank];
+  std::copy(extent, extent + rank, baseExtent);
+  baseExtent[0] *= stride;
+  std::unique_ptr<Descriptor> base{Descriptor::Create(TypeCategory::Integer,
+      kind, nullptr, rank, baseExtent, CFI_attribute_allocatable)};
+  SubscriptValue ones[maxRank]{1, 1, 1};
+  base->Allocate(ones, baseExtent, kind);
+  auto *bytes{base->Element<unsigned char>(std::size_t{0})};
+  for (std::size_t j{0}; j < base->Elements() * kind; ++j) {
+    bytes[j] = static_cast<unsigned char>(j * 7 + j / 251);
+  }
+  StaticDescriptor<maxRank> sourceDescriptor;
+  Descriptor &source{sourceDescriptor.descriptor()};
+  source.Establish(TypeCategory::Integer, kind, bytes, rank, extent,
+      CFI_attribute_pointer);
+  for (int j{0}; j < rank; ++j) {
+    source.raw().dim[j].sm = base->GetDimension(j).ByteStride();
+  }
+  source.raw().dim[0].sm *= stride;
+  int extents[maxRank];
+  std::copy(extent, extent + rank, extents);
+  std::int32_t shapeData[maxRank], orderData[maxRank];
+  auto shape{IntegerVector(rank, extents, shapeData)};
+  std::unique_ptr<Descriptor> orderVector;
+  if (order) {
+    orderVector = IntegerVector(rank, order, orderData);
+  }
+
+  std::unique_ptr<Descriptor> expect, result;
+  double reference{BestSeconds(
+      repetitions, [&]() { expect = Reference(source, rank, extent, order); })};
+  double reshape{BestSeconds(repetitions, [&]() {
+    result = RESHAPE(source, *shape, nullptr, orderVector.get());
+  })};
+  std::size_t resultBytes{expect->Elements() * kind};
+  if (std::memcmp(expect->Element<char>(std::size_t{0}),
+          result->Element<char>(std::size_t{0}), resultBytes) != 0) {
+    std::fprintf(stderr, "%s, %d-byte elements: wrong result\n", what, kind);
+    ++failures;
+  }
+  std::printf("%-30s %2d  %12.3f  %12.3f  %7.1fx\n", what, kind,
+      reference * 1e3, reshape * 1e3, reference / reshape);
+}
+
+int main(int argc, const char *argv[]) {
+  SubscriptValue n{argc > 1 ? std::atoi(argv[1]) : 1024};
+  int repetitions{argc > 2 ? std::atoi(argv[2]) : 5};
+  SubscriptValue extent2[]{n, n};
+  SubscriptValue n3{std::max<SubscriptValue>(
+      2, static_cast<SubscriptValue>(std::cbrt(double(n) * n)))};
+  SubscriptValue extent3[]{n3, n3, n3};
+  static const int transpose[]{2, 1}, rotate[]{3, 1, 2}, swap23[]{1, 3, 2};
+  std::printf("%-30s %2s  %12s  %12s  %8s\n", "case", "kb", "element (ms)",
+      "RESHAPE (ms)", "speedup");
+  for (int kind : {1, 4, 8, 16}) {
+    Run("rank 2", kind, 2, extent2, nullptr, 1, repetitions);
+    Run("rank 2, ORDER=[2,1]", kind, 2, extent2, transpose, 1, repetitions);
+    Run("rank 2, section", kind, 2, extent2, nullptr, 2, repetitions);
+    Run("rank 3, ORDER=[3,1,2]", kind, 3, extent3, rotate, 1, repetitions);
+    Run("rank 3, ORDER=[1,3,2]", kind, 3, extent3, swap23, 1, repetitions);
+    Run("rank 3, section, ORDER=[3,1,2]", kind, 3, extent3, rotate, 2,
+        repetitions);
+  }
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failures\n", failures);
+  }
+  return failures > 0;
+}
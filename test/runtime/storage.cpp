@@ -0,0 +1,276 @@
+// Tests external files whose FILE= names select other stores: a file
+// staged in memory ("mem:") and a gzip-compressed stream ("gzip:").
+// The contents of the files that result are checked independently of
+// the runtime, and the files are read back.  OPENs that a compressed
+// stream can't support, and a compression process that fails, must be
+// reported with IOSTAT=.
+
+#include "../../runtime/io-api.h"
+#include "../../runtime/main.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+
+using namespace Fortran::runtime::io;
+
+static constexpr int unit{10};
+static constexpr int lines{1000};
+static int failures{0};
+
+static Cookie BeginOpen(const char *name, const char *action,
+    const char *status, const char *access, const char *form,
+    std::size_t recl) {
+  Cookie cookie{IONAME(BeginOpenUnit)(unit)};
+  IONAME(SetFile)(cookie, name, std::strlen(name));
+  IONAME(SetAction)(cookie, action, std::strlen(action));
+  IONAME(SetStatus)(cookie, status, std::strlen(status));
+  IONAME(SetAccess)(cookie, access, std::strlen(access));
+  IONAME(SetForm)(cookie, form, std::strlen(form));
+  if (recl > 0) {
+    IONAME(SetRecl)(cookie, recl);
+  }
+  return cookie;
+}
+
+static void Open(const char *name, const char *action, const char *status,
+    const char *access = "SEQUENTIAL", const char *form = "FORMATTED",
+    std::size_t recl = 0) {
+  Cookie cookie{BeginOpen(name, action, status, access, form, recl)};
+  if (auto status{IONAME(EndIoStatement)(cookie)}) {
+    std::fprintf(stderr, "OPEN of %s failed, status %d\n", name, status);
+    ++failures;
+  }
+}
+
+// An OPEN that must fail with IOSTAT=
+static void OpenFails(const char *name, const char *action,
+    const char *access, const char *form, std::size_t recl = 0) {
+  Cookie cookie{BeginOpen(name, action, "REPLACE", access, form, recl)};
+  IONAME(EnableHandlers)(cookie, true /*IOSTAT=*/);
+  if (IONAME(EndIoStatement)(cookie) == 0) {
+    std::fprintf(stderr, "OPEN of %s with ACCESS='%s', FORM='%s' succeeded\n",
+        name, access, form);
+    ++failures;
+  }
+}
+
+static void Close(const char *status = "KEEP") {
+  Cookie cookie{IONAME(BeginClose)(unit)};
+  IONAME(SetStatus)(cookie, status, std::strlen(status));
+  if (auto status{IONAME(EndIoStatement)(cookie)}) {
+    std::fprintf(stderr, "CLOSE failed, status %d\n", status);
+    ++failures;
+  }
+}
+
+// WRITE(unit, '(A,I0)') 'line ', j for each line
+static void WriteLines() {
+  for (int j{0}; j < lines; ++j) {
+    Cookie cookie{IONAME(BeginExternalFormattedOutput)("(A,I0)", 6, unit)};
+    IONAME(OutputAscii)(cookie, "line ", 5);
+    IONAME(OutputInteger64)(cookie, j);
+    IONAME(EndIoStatement)(cookie);
+  }
+}
+
+static std::string ExpectLines() {
+  std::string result;
+  for (int j{0}; j < lines; ++j) {
+    result += "line " + std::to_string(j) + '\n';
+  }
+  return result;
+}
+
+// READ(unit, '(5X,I10)') n for each line
+static void ReadLines(const char *name) {
+  for (int j{0}; j < lines; ++j) {
+    std::int64_t n{-1};
+    Cookie cookie{IONAME(BeginExternalFormattedInput)("(5X,I10)", 8, unit)};
+    IONAME(InputInteger64)(cookie, n);
+    IONAME(EndIoStatement)(cookie);
+    if (n != j) {
+      std::fprintf(stderr, "%s: line %d read as %jd\n", name, j,
+          static_cast<std::intmax_t>(n));
+      ++failures;
+      return;
+    }
+  }
+}
+
+// Unformatted records of increasing lengths, the last ones longer than
+// a buffer
+static constexpr int records{40};
+static constexpr char filler[]{"0123456789abcdefghijklmnopqrstuvwxyz"};
+
+static std::string Record(int j) {
+  std::string result;
+  for (std::size_t k{0}; k < static_cast<std::size_t>(j) * j * 100; ++k) {
+    result += filler[(j + k) % (sizeof filler - 1)];
+  }
+  return result;
+}
+
+static void WriteRecords() {
+  for (int j{0}; j < records; ++j) {
+    std::string record{Record(j)};
+    Cookie cookie{IONAME(BeginUnformattedOutput)(unit)};
+    IONAME(OutputUnformattedBlock)(cookie, record.data(), record.size());
+    IONAME(EndIoStatement)(cookie);
+  }
+}
+
+static void ReadRecords(const char *name) {
+  for (int j{0}; j < records; ++j) {
+    std::string expect{Record(j)}, record(expect.size(), ' ');
+    Cookie cookie{IONAME(BeginUnformattedInput)(unit)};
+    IONAME(InputUnformattedBlock)(cookie, &record[0], record.size());
+    IONAME(EndIoStatement)(cookie);
+    if (record != expect) {
+      std::fprintf(stderr, "%s: record %d differs\n", name, j);
+      ++failures;
+      return;
+    }
+  }
+}
+
+static std::string Contents(std::FILE *fp) {
+  std::string result;
+  if (!fp) {
+    ++failures;
+    return result;
+  }
+  char buffer[4096];
+  while (auto got{std::fread(buffer, 1, sizeof buffer, fp)}) {
+    result.append(buffer, got);
+  }
+  return result;
+}
+
+static void Check(const char *what, const std::string &got,
+    const std::string &expect) {
+  if (got != expect) {
+    std::fprintf(stderr, "%s: got %zd bytes '%.20s...', expected %zd\n", what,
+        got.size(), got.c_str(), expect.size());
+    ++failures;
+  }
+}
+
+int main(int argc, const char *argv[]) {
+  setenv("FORT_FILE_SCHEMES", "MEM,GZIP", 1);
+  RTNAME(ProgramStart)(argc, argv, nullptr);
+
+  // Staged in memory; the file is written at CLOSE.
+  Open("mem:storage.tmp", "WRITE", "REPLACE");
+  WriteLines();
+  if (std::FILE * fp{std::fopen("storage.tmp", "r")}) {
+    Check("mem: before CLOSE", Contents(fp), "");
+    std::fclose(fp);
+  }
+  Close();
+  if (std::FILE * fp{std::fopen("storage.tmp", "r")}) {
+    Check("mem: after CLOSE", Contents(fp), ExpectLines());
+    std::fclose(fp);
+  }
+  Open("mem:storage.tmp", "READ", "OLD");
+  ReadLines("mem:");
+  Close();
+  // A read-only file can be read through "mem:" too.
+  ::chmod("storage.tmp", 0444);
+  Open("mem:storage.tmp", "READ", "OLD");
+  ReadLines("mem: read-only");
+  Close();
+  if (std::FILE * fp{std::fopen("storage.tmp", "r")}) {
+    Check("mem: read-only after CLOSE", Contents(fp), ExpectLines());
+    std::fclose(fp);
+  }
+  std::remove("storage.tmp");
+
+  // Direct access records in memory, written out of order
+  Open("mem:storage.tmp", "READWRITE", "REPLACE", "DIRECT", "UNFORMATTED", 4);
+  for (int rec : {3, 1, 2}) {
+    Cookie cookie{IONAME(BeginUnformattedOutput)(unit)};
+    IONAME(SetRec)(cookie, rec);
+    IONAME(OutputUnformattedBlock)(cookie, "rec1rec2rec3" + 4 * (rec - 1), 4);
+    IONAME(EndIoStatement)(cookie);
+  }
+  Close();
+  if (std::FILE * fp{std::fopen("storage.tmp", "r")}) {
+    Check("mem: REC=", Contents(fp), "rec1rec2rec3");
+    std::fclose(fp);
+  }
+  std::remove("storage.tmp");
+
+  // A compressed stream, when gzip is available
+  if (std::system("gzip --version >/dev/null 2>&1") == 0) {
+    Open("gzip:storage.gz", "WRITE", "REPLACE");
+    WriteLines();
+    Close();
+    if (std::FILE * fp{::popen("gzip -dc storage.gz", "r")}) {
+      Check("gzip:", Contents(fp), ExpectLines());
+      ::pclose(fp);
+    }
+    Open("gzip:storage.gz", "READ", "OLD");
+    ReadLines("gzip:");
+    Close("DELETE");
+    if (std::FILE * fp{std::fopen("storage.gz", "r")}) {
+      std::fprintf(stderr, "gzip: file not deleted\n");
+      ++failures;
+      std::fclose(fp);
+    }
+
+    // Records can't be addressed in a stream, nor can their headers be
+    // patched after they're written; but a compressed file of unformatted
+    // sequential records can be read.
+    OpenFails("gzip:storage.gz", "WRITE", "DIRECT", "UNFORMATTED", 4);
+    OpenFails("gzip:storage.gz", "WRITE", "SEQUENTIAL", "UNFORMATTED");
+    Open("storage.tmp", "WRITE", "REPLACE", "SEQUENTIAL", "UNFORMATTED");
+    WriteRecords();
+    Close();
+    std::system("gzip -c storage.tmp >storage.gz");
+    std::remove("storage.tmp");
+    Open("gzip:storage.gz", "READ", "OLD", "SEQUENTIAL", "UNFORMATTED");
+    ReadRecords("gzip: unformatted");
+    Close("DELETE");
+
+    // A compression process that exits early fails the WRITE that fills
+    // its pipe, and the CLOSE, with IOSTAT=, rather than killing the
+    // program with SIGPIPE.
+    if (std::FILE * fp{std::fopen("gzip", "w")}) {
+      std::fputs("#!/bin/sh\nexit 1\n", fp);
+      std::fclose(fp);
+      ::chmod("gzip", 0755);
+      std::string savedPath{std::getenv("PATH") ? std::getenv("PATH") : ""};
+      setenv("PATH", (".:" + savedPath).c_str(), 1);
+      Open("gzip:storage.gz", "WRITE", "REPLACE");
+      setenv("PATH", savedPath.c_str(), 1);
+      int writeStatus{0};
+      for (int j{0}; j < 100 * lines && writeStatus == 0; ++j) {
+        Cookie cookie{IONAME(BeginExternalFormattedOutput)("(A)", 3, unit)};
+        IONAME(EnableHandlers)(cookie, true /*IOSTAT=*/);
+        IONAME(OutputAscii)(cookie, filler, sizeof filler - 1);
+        writeStatus = IONAME(EndIoStatement)(cookie);
+      }
+      if (writeStatus == 0) {
+        std::fprintf(stderr, "gzip: WRITE to a failed filter succeeded\n");
+        ++failures;
+      }
+      Cookie cookie{IONAME(BeginClose)(unit)};
+      IONAME(EnableHandlers)(cookie, true /*IOSTAT=*/);
+      if (IONAME(EndIoStatement)(cookie) == 0) {
+        std::fprintf(stderr, "gzip: CLOSE of a failed filter succeeded\n");
+        ++failures;
+      }
+      std::remove("gzip");
+      std::remove("storage.gz");
+    }
+  }
+
+  if (failures == 0) {
+    std::printf("PASS\n");
+  } else {
+    std::printf("FAIL %d tests\n", failures);
+  }
+  return failures > 0;
+}
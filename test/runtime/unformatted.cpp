@@ -0,0 +1,232 @@
+// Tests unformatted sequential WRITE and READ statements, with a small
+// maximum subrecord length so that long records are split.  The record
+// markers in the file are checked against the layout written by other
+// compilers, and the records are read back whole and in part.  Direct
+// access (REC=) and stream access (POS=) transfers are tested as well.
+
+#include "../../runtime/descriptor.h"
+#include "../../runtime/io-api.h"
+#include "../../runtime/main.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Fortran::runtime;
+using namespace Fortran::runtime::io;
+
+static const char *fileName{"unformatted.tmp"};
+static constexpr int unit{10};
+static constexpr int maxSubrecord{100};  // FORT_MAX_SUBRECORD_LENGTH
+static int failures{0};
+
+static void Open(const char *action, const char *status,
+    const char *access = "SEQUENTIAL", std::size_t recl = 0) {
+  Cookie cookie{IONAME(BeginOpenUnit)(unit)};
+  IONAME(SetFile)(cookie, fileName, std::strlen(fileName));
+  IONAME(SetAction)(cookie, action, std::strlen(action));
+  IONAME(SetStatus)(cookie, status, std::strlen(status));
+  IONAME(SetAccess)(cookie, access, std::strlen(access));
+  IONAME(SetForm)(cookie, "UNFORMATTED", 11);
+  if (recl > 0) {
+    IONAME(SetRecl)(cookie, recl);
+  }
+  IONAME(EndIoStatement)(cookie);
+}
+
+static void Close() {
+  IONAME(EndIoStatement)(IONAME(BeginClose)(unit));
+}
+
+static char Byte(std::size_t record, std::size_t j) {
+  return static_cast<char>(j * 7 + record);
+}
+
+// The expected markers: a negative header when more subrecords follow,
+// and a negative footer when others preceded.
+static std::string ExpectMarkers(std::size_t bytes) {
+  std::string result;
+  std::size_t offset{0};
+  do {
+    long long length{std::min<long long>(bytes - offset, maxSubrecord)};
+    bool more{offset + length < bytes};
+    bool continued{offset > 0};
+    result += '[' + std::to_string(more ? -length : length) + ',' +
+        std::to_string(continued ? -length : length) + ']';
+    offset += length;
+  } while (offset < bytes);
+  return result;
+}
+
+static std::string GetMarkers(std::FILE *fp) {
+  std::string result;
+  while (true) {
+    std::int32_t header, footer;
+    if (std::fread(&header, sizeof header, 1, fp) != 1) {
+      break;
+    }
+    std::fseek(fp, header < 0 ? -header : header, SEEK_CUR);
+    if (std::fread(&footer, sizeof footer, 1, fp) != 1) {
+      break;
+    }
+    result += '[' + std::to_string(header) + ',' + std::to_string(footer) + ']';
+    if (header >= 0) {
+      break;
+    }
+  }
+  return result;
+}
+
+int main(int argc, const char *argv[]) {
+  setenv("FORT_MAX_SUBRECORD_LENGTH", std::to_string(maxSubrecord).c_str(), 1);
+  RTNAME(ProgramStart)(argc, argv, nullptr);
+  static const std::size_t sizes[]{0, 5, 100, 101, 250, 1000};
+
+  Open("WRITE", "REPLACE");
+  for (std::size_t record{0}; record < std::size(sizes); ++record) {
+    std::size_t bytes{sizes[record]};
+    std::vector<char> data(bytes);
+    for (std::size_t j{0}; j < bytes; ++j) {
+      data[j] = Byte(record, j);
+    }
+    // Two transfers, so that one of them straddles subrecords
+    Cookie cookie{IONAME(BeginUnformattedOutput)(unit)};
+    IONAME(OutputUnformattedBlock)(cookie, data.data(), bytes / 2);
+    IONAME(OutputUnformattedBlock)(
+        cookie, data.data() + bytes / 2, bytes - bytes / 2);
+    if (auto status{IONAME(EndIoStatement)(cookie)}) {
+      std::fprintf(stderr, "WRITE of %zd bytes failed, status %d\n", bytes,
+          static_cast<int>(status));
+      ++failures;
+    }
+  }
+  Close();
+
+  if (std::FILE * fp{std::fopen(fileName, "rb")}) {
+    for (std::size_t bytes : sizes) {
+      std::string got{GetMarkers(fp)}, expect{ExpectMarkers(bytes)};
+      if (got != expect) {
+        std::fprintf(stderr, "record of %zd bytes: markers %s, expected %s\n",
+            bytes, got.c_str(), expect.c_str());
+        ++failures;
+      }
+    }
+    std::fclose(fp);
+  } else {
+    std::perror(fileName);
+    ++failures;
+  }
+
+  // Read all but the last few bytes of each record; the rest is skipped.
+  Open("READ", "OLD");
+  for (std::size_t record{0}; record < std::size(sizes); ++record) {
+    std::size_t bytes{sizes[record] > 3 ? sizes[record] - 3 : 0};
+    std::vector<char> data(bytes);
+    Cookie cookie{IONAME(BeginUnformattedInput)(unit)};
+    IONAME(InputUnformattedBlock)(cookie, data.data(), bytes);
+    if (auto status{IONAME(EndIoStatement)(cookie)}) {
+      std::fprintf(stderr, "READ of record %zd failed, status %d\n", record,
+          static_cast<int>(status));
+      ++failures;
+    }
+    for (std::size_t j{0}; j < bytes; ++j) {
+      if (data[j] != Byte(record, j)) {
+        std::fprintf(stderr, "READ of record %zd: byte %zd is wrong\n",
+            record, j);
+        ++failures;
+        break;
+      }
+    }
+  }
+  char buffer[4];
+  Cookie cookie{IONAME(BeginUnformattedInput)(unit)};
+  IONAME(EnableHandlers)(cookie, true /*IOSTAT=*/);
+  IONAME(InputUnformattedBlock)(cookie, buffer, sizeof buffer);
+  if (auto status{IONAME(EndIoStatement)(cookie)}; status != IostatEnd) {
+    std::fprintf(stderr, "READ at end of file: status %d\n",
+        static_cast<int>(status));
+    ++failures;
+  }
+  Close();
+
+  // Reading more than a record holds is an error, after which the next
+  // READ begins with the next record.
+  Open("READ", "OLD");
+  cookie = IONAME(BeginUnformattedInput)(unit);
+  IONAME(EnableHandlers)(cookie, true /*IOSTAT=*/);
+  IONAME(InputUnformattedBlock)(cookie, buffer, sizeof buffer);
+  if (auto status{IONAME(EndIoStatement)(cookie)};
+      status != IostatShortRecord) {
+    std::fprintf(stderr, "READ of empty record: status %d\n",
+        static_cast<int>(status));
+    ++failures;
+  }
+  cookie = IONAME(BeginUnformattedInput)(unit);
+  IONAME(InputUnformattedBlock)(cookie, buffer, sizeof buffer);
+  IONAME(EndIoStatement)(cookie);
+  for (std::size_t j{0}; j < sizeof buffer; ++j) {
+    if (buffer[j] != Byte(1, j)) {
+      std::fprintf(stderr, "READ after error: wrong record\n");
+      ++failures;
+      break;
+    }
+  }
+  Close();
+
+  // Direct access records written and read out of order with REC=
+  Open("READWRITE", "REPLACE", "DIRECT", 8);
+  for (std::int64_t rec : {3, 1, 2}) {
+    std::int64_t data[2]{rec, -rec};
+    cookie = IONAME(BeginUnformattedOutput)(unit);
+    IONAME(SetRec)(cookie, rec);
+    IONAME(OutputUnformattedBlock)(
+        cookie, reinterpret_cast<char *>(&data[rec == 2]), 8);
+    IONAME(EndIoStatement)(cookie);
+  }
+  for (std::int64_t rec : {2, 3, 1}) {
+    std::int64_t got{0};
+    cookie = IONAME(BeginUnformattedInput)(unit);
+    IONAME(SetRec)(cookie, rec);
+    IONAME(InputUnformattedBlock)(cookie, reinterpret_cast<char *>(&got), 8);
+    IONAME(EndIoStatement)(cookie);
+    if (got != (rec == 2 ? -rec : rec)) {
+      std::fprintf(stderr, "REC=%d: got %jd\n", static_cast<int>(rec),
+          static_cast<std::intmax_t>(got));
+      ++failures;
+    }
+  }
+  Close();
+
+  // Stream access with POS=; a transfer without POS= continues from the
+  // end of the last one.
+  Open("READWRITE", "REPLACE", "STREAM");
+  static const char *writes[]{"abcdefghij", "XY", "Z"};
+  static const int writePos[]{1, 4, 0};
+  for (int j{0}; j < 3; ++j) {
+    cookie = IONAME(BeginUnformattedOutput)(unit);
+    if (writePos[j] > 0) {
+      IONAME(SetPos)(cookie, writePos[j]);
+    }
+    IONAME(OutputUnformattedBlock)(cookie, writes[j], std::strlen(writes[j]));
+    IONAME(EndIoStatement)(cookie);
+  }
+  char stream[11]{};
+  cookie = IONAME(BeginUnformattedInput)(unit);
+  IONAME(SetPos)(cookie, 1);
+  IONAME(InputUnformattedBlock)(cookie, stream, 10);
+  IONAME(EndIoStatement)(cookie);
+  if (std::strcmp(stream, "abcXYZghij") != 0) {
+    std::fprintf(stderr, "stream access: got '%s'\n", stream);
+    ++failures;
+  }
+  Close();
+
+  std::remove(fileName);
+  if (failures == 0) {
+    std::printf("PASS\n");
+  } else {
+    std::printf("FAIL %d tests\n", failures);
+  }
+  return failures > 0;
+}